@@ -0,0 +1,613 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include "opentrackio-cpp/OpenTrackIOBatch.h"
+#include "opentrackio-cpp/OpenTrackIOProfile.h"
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+#include "opentrackio-cpp/OpenTrackIOSampleView.h"
+#include "opentrackio-cpp/OpenTrackIOSnapshot.h"
+#include "opentrackio-cpp/OpenTrackIOTime.h"
+
+/**
+ * Every allocation made by the process is counted so that each benchmark can report how many it makes per sample.
+ * The benchmark loop itself doesn't allocate, so the counts only cover the code being measured. */
+namespace
+{
+    // Atomic so the counts stay right while the batch benchmarks decode on several threads.
+    std::atomic<std::size_t> g_allocations = 0;
+    std::atomic<std::size_t> g_allocatedBytes = 0;
+}
+
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+// Every replaced operator new allocates with malloc or aligned_alloc, both of which free releases, but GCC pairs the
+// inlined free with operator new and warns.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// The default memory resource allocates through the aligned overloads, so the property containers land here.
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void* ptr = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+    using namespace opentrackio;
+
+    constexpr const char* MINIMAL_SAMPLE = R"({
+        "protocol": {"name": "OpenTrackIO", "version": "1.0.0"},
+        "sampleId": "urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a33",
+        "sourceId": "urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a34",
+        "sourceNumber": 0,
+        "timing": {
+            "mode": "internal",
+            "sampleTimestamp": {"seconds": 1718806554, "nanoseconds": 500000000, "attoseconds": 0},
+            "sequenceNumber": 12,
+            "frameRate": {"num": 24, "denom": 1}
+        },
+        "transforms": [
+            {"translation": {"x": 1.5, "y": 2.0, "z": 3.0}, "rotation": {"pan": 10.0, "tilt": -5.0, "roll": 0.5}, "transformId": "Camera"}
+        ]
+    })";
+
+    constexpr const char* COMPLETE_SAMPLE = R"({
+        "static": {
+            "duration": {"num": 1, "denom": 25},
+            "camera": {
+                "captureFrameRate": {"num": 24000, "denom": 1001},
+                "activeSensorPhysicalDimensions": {"height": 24.0, "width": 36.0},
+                "activeSensorResolution": {"height": 2160, "width": 3840},
+                "make": "SampleMake", "model": "SampleModel", "serialNumber": "1234567890A",
+                "firmwareVersion": "1.0", "label": "A", "anamorphicSqueeze": {"num": 1, "denom": 1},
+                "isoSpeed": 4000, "fdlLink": "urn:uuid:0e0e0e0e-0e0e-0e0e-0e0e-0e0e0e0e0e0e", "shutterAngle": 45.0
+            },
+            "lens": {
+                "distortionOverscanMax": 1.2, "firmwareVersion": "1.0", "make": "SampleMake",
+                "model": "SampleModel", "nominalFocalLength": 14.0, "serialNumber": "1234567890A"
+            },
+            "tracker": {"firmwareVersion": "1.0", "make": "SampleMake", "model": "SampleModel", "serialNumber": "1234567890A"}
+        },
+        "tracker": {"notes": "Example generated sample.", "recording": false, "slate": "A101_A_4", "status": "Optical Good"},
+        "timing": {
+            "mode": "internal",
+            "recordedTimestamp": {"seconds": 1718806000, "nanoseconds": 0},
+            "sampleTimestamp": {"seconds": 1718806554, "nanoseconds": 0, "attoseconds": 0},
+            "sequenceNumber": 0,
+            "synchronization": {
+                "locked": true, "source": "ptp", "frequency": {"num": 24000, "denom": 1001},
+                "offsets": {"translation": 0.0, "rotation": 0.0, "lensEncoders": 0.0},
+                "present": true,
+                "ptp": {"master": "00:11:22:33:44:55", "offset": 0.0, "domain": 1}
+            },
+            "timecode": {
+                "hours": 1, "minutes": 2, "seconds": 3, "frames": 4,
+                "format": {"frameRate": {"num": 24, "denom": 1}, "dropFrame": false, "oddField": true}
+            },
+            "frameRate": {"num": 24000, "denom": 1001}
+        },
+        "lens": {
+            "custom": [1.0, 2.0],
+            "distortion": {"radial": [1.0, 2.0, 3.0], "tangential": [1.0, 2.0]},
+            "distortionOverscan": 1.0,
+            "distortionShift": {"x": 0.0, "y": 0.0},
+            "encoders": {"focus": 0.1, "iris": 0.2, "zoom": 0.3},
+            "entrancePupilOffset": 0.123,
+            "exposureFalloff": {"a1": 1.0, "a2": 2.0, "a3": 3.0},
+            "fStop": 4.0, "focalLength": 24.305, "focusDistance": 10.0,
+            "perspectiveShift": {"x": 0.1, "y": 0.1},
+            "rawEncoders": {"focus": 1000, "iris": 2000, "zoom": 3000},
+            "tStop": 4.1,
+            "undistortion": {"radial": [1.0, 2.0, 3.0], "tangential": [1.0, 2.0]}
+        },
+        "protocol": {"name": "OpenTrackIO", "version": "1.0.0"},
+        "sampleId": "urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a33",
+        "sourceId": "urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a34",
+        "sourceNumber": 1,
+        "relatedSampleIds": ["urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a32", "urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a31"],
+        "globalStage": {"E": 100.0, "N": 200.0, "U": 300.0, "lat0": 100.0, "lon0": 200.0, "h0": 300.0},
+        "transforms": [
+            {"translation": {"x": 1.0, "y": 2.0, "z": 3.0}, "rotation": {"pan": 180.0, "tilt": 90.0, "roll": 45.0}, "transformId": "Stage"},
+            {"translation": {"x": 1.0, "y": 2.0, "z": 3.0}, "rotation": {"pan": 180.0, "tilt": 90.0, "roll": 45.0},
+             "scale": {"x": 1.0, "y": 2.0, "z": 3.0}, "transformId": "Camera", "parentTransformId": "Stage"}
+        ]
+    })";
+
+    constexpr std::size_t LONG_COEFFICIENT_COUNT = 64;
+    constexpr std::size_t DEEP_TRANSFORM_COUNT = 32;
+
+    nlohmann::json coefficients(std::size_t count, double scale)
+    {
+        auto arr = nlohmann::json::array();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            arr.push_back(scale / static_cast<double>(i + 1));
+        }
+        return arr;
+    }
+
+    nlohmann::json lensSample()
+    {
+        auto json = nlohmann::json::parse(MINIMAL_SAMPLE);
+        json["lens"] = {
+            {"custom", coefficients(LONG_COEFFICIENT_COUNT, 0.5)},
+            {"distortion", {{"radial", coefficients(LONG_COEFFICIENT_COUNT, 1.0)},
+                            {"tangential", coefficients(LONG_COEFFICIENT_COUNT, 0.01)}}},
+            {"undistortion", {{"radial", coefficients(LONG_COEFFICIENT_COUNT, -1.0)},
+                              {"tangential", coefficients(LONG_COEFFICIENT_COUNT, -0.01)}}},
+            {"encoders", {{"focus", 0.1}, {"iris", 0.2}, {"zoom", 0.3}}},
+            {"focalLength", 24.305},
+            {"focusDistance", 10.0}
+        };
+        return json;
+    }
+
+    nlohmann::json transformsSample()
+    {
+        auto json = nlohmann::json::parse(MINIMAL_SAMPLE);
+        auto transforms = nlohmann::json::array();
+        for (std::size_t i = 0; i < DEEP_TRANSFORM_COUNT; ++i)
+        {
+            nlohmann::json tf = {
+                {"translation", {{"x", 0.1 * i}, {"y", 0.2 * i}, {"z", 0.3 * i}}},
+                {"rotation", {{"pan", 1.0 * i}, {"tilt", -0.5 * i}, {"roll", 0.25 * i}}},
+                {"scale", {{"x", 1.0}, {"y", 1.0}, {"z", 1.0}}},
+                {"transformId", "Transform" + std::to_string(i)}
+            };
+            if (i > 0)
+            {
+                tf["parentTransformId"] = "Transform" + std::to_string(i - 1);
+            }
+            transforms.push_back(std::move(tf));
+        }
+        json["transforms"] = std::move(transforms);
+        return json;
+    }
+
+    struct Payload
+    {
+        std::string name;
+        nlohmann::json json;
+        std::string text;
+        std::vector<uint8_t> cbor;
+    };
+
+    std::vector<Payload> makePayloads()
+    {
+        std::vector<Payload> payloads;
+        const auto add = [&payloads](std::string name, nlohmann::json json)
+        {
+            auto text = json.dump();
+            auto cbor = nlohmann::json::to_cbor(json);
+            payloads.push_back({std::move(name), std::move(json), std::move(text), std::move(cbor)});
+        };
+
+        add("minimal", nlohmann::json::parse(MINIMAL_SAMPLE));
+        add("complete", nlohmann::json::parse(COMPLETE_SAMPLE));
+        add("lens", lensSample());
+        add("transforms", transformsSample());
+        return payloads;
+    }
+
+    /**
+     * Runs the benchmark loop and reports allocations and allocated bytes per sample alongside the time. */
+    template<typename Fn>
+    void measure(benchmark::State& state, Fn&& fn)
+    {
+        const auto allocations = g_allocations.load();
+        const auto bytes = g_allocatedBytes.load();
+        for (auto _ : state)
+        {
+            fn();
+        }
+        
+        const auto iterations = static_cast<double>(state.iterations());
+        state.counters["allocs/sample"] = static_cast<double>(g_allocations - allocations) / iterations;
+        state.counters["bytes/sample"] = static_cast<double>(g_allocatedBytes - bytes) / iterations;
+    }
+
+    void registerBenchmarks(const Payload& payload)
+    {
+        const auto name = [&payload](const char* benchmark)
+        {
+            return std::string{benchmark} + "/" + payload.name;
+        };
+
+        benchmark::RegisterBenchmark(name("initialiseText").c_str(), [&payload](benchmark::State& state)
+        {
+            measure(state, [&payload]
+            {
+                OpenTrackIOSample sample;
+                sample.initialise(std::string_view{payload.text});
+                benchmark::DoNotOptimize(sample);
+            });
+        });
+
+        benchmark::RegisterBenchmark(name("initialiseDom").c_str(), [&payload](benchmark::State& state)
+        {
+            measure(state, [&payload]
+            {
+                OpenTrackIOSample sample;
+                sample.initialise(payload.json);
+                benchmark::DoNotOptimize(sample);
+            });
+        });
+
+        benchmark::RegisterBenchmark(name("initialiseCbor").c_str(), [&payload](benchmark::State& state)
+        {
+            measure(state, [&payload]
+            {
+                OpenTrackIOSample sample;
+                sample.initialise(std::span<const uint8_t>{payload.cbor});
+                benchmark::DoNotOptimize(sample);
+            });
+        });
+
+        // A receive loop that keeps one sample alive and resets it for every packet.
+        benchmark::RegisterBenchmark(name("reinitialiseText").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSample sample;
+            measure(state, [&payload, &sample]
+            {
+                sample.reset();
+                sample.initialise(std::string_view{payload.text});
+                benchmark::DoNotOptimize(sample);
+            });
+        });
+
+        benchmark::RegisterBenchmark(name("reinitialiseCbor").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSample sample;
+            measure(state, [&payload, &sample]
+            {
+                sample.reset();
+                sample.initialise(std::span<const uint8_t>{payload.cbor});
+                benchmark::DoNotOptimize(sample);
+            });
+        });
+
+        // The same receive loop for a render node that only has the transforms, lens and timing compiled in.
+        benchmark::RegisterBenchmark(name("reinitialiseCborProfile").c_str(), [&payload](benchmark::State& state)
+        {
+            BasicOpenTrackIOSample<opentrackioproperties::Lens, opentrackioproperties::Timing,
+                                   opentrackioproperties::Transforms> sample;
+            measure(state, [&payload, &sample]
+            {
+                sample.reset();
+                sample.initialise(std::span<const uint8_t>{payload.cbor});
+                benchmark::DoNotOptimize(sample);
+            });
+        });
+
+        // The same receive loop recording into an Instrumentation, which only costs anything in an instrumented build.
+        benchmark::RegisterBenchmark(name("reinitialiseCborInstrumented").c_str(), [&payload](benchmark::State& state)
+        {
+            Instrumentation instrumentation;
+            ParseOptions options{};
+            options.instrumentation = &instrumentation;
+            OpenTrackIOSample sample;
+            measure(state, [&payload, &sample, &options]
+            {
+                sample.reset();
+                sample.initialise(std::span<const uint8_t>{payload.cbor}, options);
+                benchmark::DoNotOptimize(sample);
+            });
+        });
+
+        // A new sample every frame, with it and its properties in an arena that is released between frames.
+        benchmark::RegisterBenchmark(name("initialiseCborArena").c_str(), [&payload](benchmark::State& state)
+        {
+            std::vector<std::byte> buffer(1 << 20);
+            std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+            ParseOptions options{};
+            options.memoryResource = &arena;
+            measure(state, [&payload, &arena, &options]
+            {
+                {
+                    MemoryResourceScope scope{&arena};
+                    OpenTrackIOSample sample;
+                    sample.initialise(std::span<const uint8_t>{payload.cbor}, options);
+                    benchmark::DoNotOptimize(sample);
+                }
+                arena.release();
+            });
+        });
+
+        // A tracking consumer that only reads the pose, lens and timing of each packet.
+        benchmark::RegisterBenchmark(name("viewTrackingText").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSampleView view;
+            measure(state, [&payload, &view]
+            {
+                view.open(std::string_view{payload.text});
+                benchmark::DoNotOptimize(view.transforms());
+                benchmark::DoNotOptimize(view.lens());
+                benchmark::DoNotOptimize(view.timing());
+            });
+        });
+
+        benchmark::RegisterBenchmark(name("viewTrackingCbor").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSampleView view;
+            measure(state, [&payload, &view]
+            {
+                view.open(std::span<const uint8_t>{payload.cbor});
+                benchmark::DoNotOptimize(view.transforms());
+                benchmark::DoNotOptimize(view.lens());
+                benchmark::DoNotOptimize(view.timing());
+            });
+        });
+
+        // Handing each frame's state to another thread, as a whole sample or as a snapshot captured while parsing.
+        benchmark::RegisterBenchmark(name("copySample").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSample sample;
+            sample.initialise(std::span<const uint8_t>{payload.cbor});
+            SpscQueue<OpenTrackIOSample> queue{4};
+            measure(state, [&sample, &queue]
+            {
+                queue.push([&sample](OpenTrackIOSample& slot) { slot = sample; return true; });
+                benchmark::DoNotOptimize(queue.front());
+                queue.pop();
+            });
+        });
+
+        benchmark::RegisterBenchmark(name("copySnapshot").c_str(), [&payload](benchmark::State& state)
+        {
+            TrackingSnapshot snapshot;
+            ParseOptions options{};
+            options.snapshot = &snapshot;
+            OpenTrackIOSample sample;
+            sample.initialise(std::span<const uint8_t>{payload.cbor}, options);
+            SpscQueue<TrackingSnapshot> queue{4};
+            measure(state, [&snapshot, &queue]
+            {
+                queue.push([&snapshot](TrackingSnapshot& slot) { slot = snapshot; return true; });
+                benchmark::DoNotOptimize(queue.front());
+                queue.pop();
+            });
+        });
+
+        // reset() drops the generated JSON but keeps the properties, so getJson() rebuilds it every iteration.
+        benchmark::RegisterBenchmark(name("getJson").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSample sample;
+            sample.initialise(payload.json);
+            measure(state, [&sample]
+            {
+                sample.reset();
+                benchmark::DoNotOptimize(sample.getJson());
+            });
+        });
+
+        // A long lived sender that only updates the timing and transforms of each frame before asking for the JSON.
+        benchmark::RegisterBenchmark(name("getJsonUpdate").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSample sample;
+            sample.initialise(payload.json);
+            uint32_t frame = 0;
+            measure(state, [&sample, &frame]
+            {
+                ++frame;
+                if (sample.timing.has_value())
+                {
+                    sample.timing->sequenceNumber = static_cast<uint16_t>(frame);
+                    sample.markDirty(OpenTrackIOSample::Property::TIMING);
+                }
+                if (sample.transforms.has_value() && !sample.transforms->transforms.empty())
+                {
+                    sample.transforms->transforms.front().translation.x = frame;
+                    sample.markDirty(OpenTrackIOSample::Property::TRANSFORMS);
+                }
+                benchmark::DoNotOptimize(sample.getJson());
+            });
+        });
+
+        benchmark::RegisterBenchmark(name("dump").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSample sample;
+            sample.initialise(payload.json);
+            const auto& json = sample.getJson();
+            measure(state, [&json]
+            {
+                benchmark::DoNotOptimize(json.dump());
+            });
+        });
+
+        benchmark::RegisterBenchmark(name("toCbor").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSample sample;
+            sample.initialise(payload.json);
+            const auto& json = sample.getJson();
+            measure(state, [&json]
+            {
+                benchmark::DoNotOptimize(nlohmann::json::to_cbor(json));
+            });
+        });
+
+        benchmark::RegisterBenchmark(name("serializeJson").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSample sample;
+            sample.initialise(payload.json);
+            std::vector<char> buffer(payload.text.size() * 2);
+            measure(state, [&sample, &buffer]
+            {
+                benchmark::DoNotOptimize(sample.serializeJson(buffer));
+            });
+        });
+
+        benchmark::RegisterBenchmark(name("serializeCbor").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSample sample;
+            sample.initialise(payload.json);
+            std::vector<uint8_t> buffer(payload.cbor.size() * 2);
+            measure(state, [&sample, &buffer]
+            {
+                benchmark::DoNotOptimize(sample.serializeCbor(buffer));
+            });
+        });
+
+        benchmark::RegisterBenchmark(name("roundTripCbor").c_str(), [&payload](benchmark::State& state)
+        {
+            OpenTrackIOSample sample;
+            std::vector<uint8_t> buffer(payload.cbor.size() * 2);
+            measure(state, [&payload, &sample, &buffer]
+            {
+                sample.reset();
+                sample.initialise(std::span<const uint8_t>{payload.cbor});
+                benchmark::DoNotOptimize(sample.serializeCbor(buffer));
+            });
+        });
+
+        // A window of a recorded take decoded into the same samples every iteration, on one thread and on all.
+        auto* batch = benchmark::RegisterBenchmark(name("decodeBatch").c_str(), [&payload](benchmark::State& state)
+        {
+            constexpr std::size_t BATCH_SIZE = 4096;
+            const std::vector<std::span<const uint8_t>> payloads(BATCH_SIZE, std::span<const uint8_t>{payload.cbor});
+            std::vector<OpenTrackIOSample> samples(BATCH_SIZE);
+            BatchOptions options{};
+            options.threads = static_cast<unsigned int>(state.range(0));
+
+            const auto allocations = g_allocations.load();
+            const auto bytes = g_allocatedBytes.load();
+            for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(decodeBatch(payloads, samples, {}, options));
+            }
+
+            const auto decoded = static_cast<double>(state.iterations() * BATCH_SIZE);
+            state.SetItemsProcessed(static_cast<int64_t>(decoded));
+            state.counters["allocs/sample"] = static_cast<double>(g_allocations - allocations) / decoded;
+            state.counters["bytes/sample"] = static_cast<double>(g_allocatedBytes - bytes) / decoded;
+        });
+        batch->ArgName("threads")->Arg(1)->UseRealTime();
+        if (const auto threads = std::thread::hardware_concurrency(); threads > 1)
+        {
+            batch->Arg(threads);
+        }
+    }
+
+    /**
+     * Converts runs of timestamps from 2024 into frame indices at 30000/1001 and runs of frame counts into drop frame
+     * timecodes. */
+    void registerTimeBenchmarks()
+    {
+        constexpr std::size_t COUNT = 1024;
+        const opentrackiotypes::Timecode::Format format{{30000, 1001}, true};
+
+        benchmark::RegisterBenchmark("time/framesAt", [format](benchmark::State& state)
+        {
+            std::vector<opentrackiotypes::Timestamp> timestamps(COUNT);
+            for (std::size_t i = 0; i < COUNT; ++i)
+            {
+                timestamps[i] = frameStart(int64_t{52'000'000'000} + static_cast<int64_t>(i), format.frameRate).value();
+            }
+            std::vector<int64_t> frames(COUNT);
+            measure(state, [&timestamps, &frames, &format]
+            {
+                benchmark::DoNotOptimize(framesAt(timestamps, format.frameRate, frames));
+                benchmark::ClobberMemory();
+            });
+            state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * COUNT));
+        });
+
+        benchmark::RegisterBenchmark("time/toTimecodes", [format](benchmark::State& state)
+        {
+            std::vector<int64_t> frames(COUNT);
+            for (std::size_t i = 0; i < COUNT; ++i)
+            {
+                frames[i] = static_cast<int64_t>(i) * 1789;
+            }
+            std::vector<opentrackiotypes::Timecode> timecodes(COUNT);
+            measure(state, [&frames, &timecodes, &format]
+            {
+                benchmark::DoNotOptimize(toTimecodes(frames, format, timecodes));
+                benchmark::ClobberMemory();
+            });
+            state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * COUNT));
+        });
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Registered benchmarks hold references to the payloads, so they have to outlive the run.
+    const auto payloads = makePayloads();
+    for (const auto& payload : payloads)
+    {
+        registerBenchmarks(payload);
+    }
+    registerTimeBenchmarks();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOQueue.h"
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+
+namespace opentrackio
+{
+    /**
+     * One of the streams a FrameAligner groups. A sample belongs to it if its sourceId matches, a sample without a
+     * sourceId matching the nil UUID, and, if sourceNumber is set, its sourceNumber matches too. */
+    struct AlignerSource
+    {
+        opentrackiotypes::UrnUuid sourceId{};
+        std::optional<uint32_t> sourceNumber = std::nullopt;
+    };
+
+    enum class AlignerKey : uint8_t
+    {
+        /**
+         * Frames are counted from the timecode, at the nominal rate of its format. */
+        TIMECODE,
+        /**
+         * Frames are counted from the sample timestamp less the synchronization offset, at the frame rate. */
+        SAMPLE_TIMESTAMP
+    };
+
+    enum class AlignerOffset : uint8_t
+    {
+        NONE,
+        TRANSLATION,
+        ROTATION,
+        LENS_ENCODERS
+    };
+
+    struct AlignerOptions
+    {
+        AlignerKey key = AlignerKey::SAMPLE_TIMESTAMP;
+
+        /**
+         * Which of the synchronization offsets takes a sample timestamp back to the sync pulse it belongs to. */
+        AlignerOffset offset = AlignerOffset::TRANSLATION;
+
+        /**
+         * Rate sample timestamps are bucketed at. If unset each sample's synchronization frequency is used, or
+         * failing that its frame rate. */
+        std::optional<opentrackiotypes::Rational> frameRate = std::nullopt;
+
+        /**
+         * Samples each source can have waiting, rounded up to a power of two. */
+        std::size_t depth = 8;
+
+        /**
+         * Nanoseconds to wait for the rest of a frame once it is the oldest one waiting. */
+        int64_t deadline = 10'000'000;
+
+        /**
+         * A sample more than this many frames behind the last frame released means its source restarted, was
+         * re-jammed or had its clock stepped back. Rather than dropping that source for good the aligner starts
+         * again from the sample, dropping what the other sources still have queued from before the jump. */
+        int64_t resetFrames = 256;
+    };
+
+    /**
+     * A frame's samples in source order, nullptr for the sources that didn't deliver one. */
+    struct AlignedFrame
+    {
+        int64_t key = 0;
+        std::span<const OpenTrackIOSample* const> samples{};
+        std::size_t present = 0;
+
+        bool complete() const { return present == samples.size(); };
+    };
+
+    /**
+     * Groups the samples of several genlocked sources into frames. Each source has its own SpscQueue of depth
+     * samples, its receive thread fills them in place with push(), and the one consumer thread takes whole frames
+     * with next() and hands them back with release(), so neither side takes a lock or allocates once the samples
+     * have grown to size.
+     *
+     * Sources must deliver their frames in order. The oldest frame waiting is released as soon as every source has
+     * a sample waiting, as a source whose oldest sample is of a later frame has skipped it, or once it has waited
+     * deadline nanoseconds, which are measured from the first next() call that saw it. Samples without a key and
+     * samples of frames already released are dropped. Timecode keys carry on counting past midnight rather than
+     * going back to 0, see AlignerOptions::resetFrames for other jumps back. */
+    class FrameAligner
+    {
+    public:
+        explicit FrameAligner(std::vector<AlignerSource> sources, AlignerOptions options = {});
+
+        FrameAligner(const FrameAligner&) = delete;
+        FrameAligner& operator=(const FrameAligner&) = delete;
+
+        std::size_t sourceCount() const { return m_sources.size(); };
+        std::optional<std::size_t> find(const OpenTrackIOSample& sample) const;
+
+        /**
+         * The frame the sample belongs to, or nullopt if it lacks the timecode or timestamp and rate to tell. */
+        std::optional<int64_t> keyOf(const OpenTrackIOSample& sample) const;
+
+        /**
+         * Producer side, one thread per source. Calls fill(OpenTrackIOSample&) on the source's next slot and queues
+         * it if fill returns true. Returns false if the source is full or fill rejected the sample. */
+        template<typename Fill>
+        bool push(std::size_t source, Fill&& fill)
+        {
+            return m_sources[source].queue->push(std::forward<Fill>(fill));
+        }
+
+        /**
+         * Copies the sample into the queue of the source it belongs to, which reuses the capacity of the slot.
+         * Returns false if it belongs to none or the source is full. */
+        bool push(const OpenTrackIOSample& sample);
+
+        /**
+         * Consumer side. The oldest frame that is ready at now, or nullopt if none is. The samples stay valid and
+         * the same frame is returned until release(). */
+        std::optional<AlignedFrame> next(int64_t now);
+        void release();
+
+        /**
+         * Samples dropped by the consumer for lacking a key or arriving after their frame was released. */
+        std::size_t dropped() const { return m_dropped; };
+
+        /**
+         * Times the aligner started again after a source jumped back, see AlignerOptions::resetFrames. */
+        std::size_t resets() const { return m_resets; };
+
+    private:
+        struct Source
+        {
+            AlignerSource id{};
+            std::unique_ptr<SpscQueue<OpenTrackIOSample>> queue = nullptr;
+            std::optional<int64_t> headKey = std::nullopt;
+        };
+
+        const OpenTrackIOSample* head(Source& source);
+        std::optional<int64_t> continuedKeyOf(const OpenTrackIOSample& sample) const;
+        void reset(int64_t key);
+
+        std::vector<Source> m_sources{};
+        AlignerOptions m_options{};
+        std::vector<const OpenTrackIOSample*> m_frame{};
+        std::optional<AlignedFrame> m_current = std::nullopt;
+        std::optional<int64_t> m_released = std::nullopt;
+        std::optional<int64_t> m_waiting = std::nullopt;
+        int64_t m_waitingSince = 0;
+        std::size_t m_dropped = 0;
+        std::size_t m_resets = 0;
+    };
+} // namespace opentrackio
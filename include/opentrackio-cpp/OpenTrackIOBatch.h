@@ -0,0 +1,76 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "opentrackio-cpp/OpenTrackIOPacket.h"
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+#include "opentrackio-cpp/OpenTrackIOSnapshot.h"
+
+namespace opentrackio
+{
+    enum class DecodeStatus : uint8_t
+    {
+        OK,
+        /**
+         * The payload parsed but the sample reported errors, found in its diagnostics. */
+        INVALID,
+        /**
+         * The payload couldn't be parsed as JSON or CBOR, the sample is left reset. */
+        MALFORMED
+    };
+
+    struct BatchOptions
+    {
+        PacketEncoding encoding = PacketEncoding::CBOR;
+
+        /**
+         * Passed to every initialise(). A static cache isn't thread safe, so setting one decodes on a single thread
+         * in payload order. Neither is a typical memory resource, so setting parseOptions.memoryResource also decodes
+         * on a single thread unless memoryResources is given instead. parseOptions.snapshot is ignored, as every
+         * worker would capture into it at once, see snapshots. */
+        ParseOptions parseOptions{};
+
+        /**
+         * One memory resource per worker, such as a per thread pool or arena, which replaces
+         * parseOptions.memoryResource for every sample that worker decodes. No more workers are started than there
+         * are resources, and a resource is only ever used by one worker so it needn't be synchronised. */
+        std::span<std::pmr::memory_resource* const> memoryResources{};
+
+        /**
+         * Captures each samples[i] into snapshots[i] if it isn't empty, in which case it must be at least as long as
+         * the number of payloads decoded. */
+        std::span<TrackingSnapshot> snapshots{};
+
+        /**
+         * Worker threads to decode with, one per hardware thread if 0. The calling thread is one of them. */
+        unsigned int threads = 0;
+
+        /**
+         * Payloads a worker takes at a time. Workers take the next chunk as soon as they finish one, so uneven
+         * payloads balance out across threads. */
+        std::size_t chunkSize = 64;
+    };
+
+    /**
+     * Decodes payloads[i] into samples[i] across a pool of worker threads, resetting each sample first. Samples are
+     * independent and every one parses into its own tape and diagnostics, so the workers share nothing but the
+     * chunk counter, and decoding successive windows of a take into the same span of samples stops allocating
+     * once they have grown to fit. The status of each payload is written to statuses if it isn't empty. Returns
+     * the number of payloads that decoded without errors. Decodes min(payloads.size(), samples.size()) payloads,
+     * statuses must then be empty or at least that long. */
+    std::size_t decodeBatch(std::span<const std::span<const uint8_t>> payloads, std::span<OpenTrackIOSample> samples,
+                            std::span<DecodeStatus> statuses = {}, const BatchOptions& options = {});
+} // namespace opentrackio
@@ -0,0 +1,137 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+
+namespace opentrackio
+{
+    /**
+     * The sample a delta only carries the changes from. */
+    enum class DeltaReference : uint8_t
+    {
+        /**
+         * The sample sent just before, the smallest deltas but a lost one corrupts every delta until the next
+         * keyframe. */
+        PREVIOUS,
+        /**
+         * The latest keyframe, every delta decodes on its own as long as the keyframe arrived. */
+        KEYFRAME,
+        /**
+         * The latest sample the receiver acknowledged, or the latest keyframe if none has been since it. */
+        ACKNOWLEDGED
+    };
+
+    struct DeltaOptions
+    {
+        /**
+         * Samples from one keyframe to the next, 0 to only send them when they are needed or requested. */
+        std::size_t keyframeInterval = 60;
+        DeltaReference reference = DeltaReference::PREVIOUS;
+
+        /**
+         * Sent samples the encoder keeps for acknowledge() to find. */
+        std::size_t history = 8;
+    };
+
+    /**
+     * Encodes the samples sent to one destination as keyframes and deltas that are still valid OpenTrackIO. A
+     * keyframe is the whole sample, including its static block, which is folded in from staticProperties if the
+     * sample was parsed through a StaticCache. A delta leaves out the static block and every field that is equal
+     * to its reference, always keeps protocol, sampleId, sourceId and sourceNumber, and names the reference by
+     * appending its sampleId to relatedSampleIds.
+     *
+     * As a missing field can't be told apart from an unchanged one, a keyframe is sent instead of a delta whenever
+     * a field disappears, the static data changes, the sample has no sampleId or the interval comes round. Nested
+     * objects such as the distortion or synchronization are compared and sent whole, transforms field by field if
+     * their count hasn't changed. */
+    class DeltaEncoder
+    {
+    public:
+        explicit DeltaEncoder(DeltaOptions options = {});
+
+        /**
+         * Resets out and fills it with what to send for sample, returning true if it is a keyframe. */
+        bool encode(const OpenTrackIOSample& sample, OpenTrackIOSample& out);
+
+        /**
+         * Encodes the sample and serialises it into buffer, as OpenTrackIOSample::serializeJson and serializeCbor
+         * do. Returns the number of bytes written or std::nullopt if the buffer was too small, or for JSON if a
+         * string isn't valid UTF-8, in which case the sample still counts as sent. */
+        std::optional<std::size_t> encodeJson(const OpenTrackIOSample& sample, std::span<char> buffer);
+        std::optional<std::size_t> encodeCbor(const OpenTrackIOSample& sample, std::span<uint8_t> buffer);
+
+        /**
+         * Makes the next sample a keyframe, for when a receiver joins or has lost its reference. */
+        void requestKeyframe() { m_keyframeDue = true; };
+
+        /**
+         * With DeltaReference::ACKNOWLEDGED, makes a sample the receiver has decoded the reference for the next
+         * deltas. Returns false if the sample isn't one of the last history sent or is older than the reference. */
+        bool acknowledge(const opentrackiotypes::UrnUuid& sampleId);
+
+        void reset();
+
+    private:
+        struct Sent
+        {
+            OpenTrackIOSample sample{};
+            uint64_t serial = 0;
+        };
+
+        const Sent* reference() const;
+        bool needsKeyframe(const OpenTrackIOSample& reference) const;
+
+        DeltaOptions m_options;
+        OpenTrackIOSample m_scratch{};
+        Sent m_keyframe{};
+        Sent m_acknowledged{};
+        std::vector<Sent> m_recent;
+        uint64_t m_serial = 0;
+        std::size_t m_sinceKeyframe = 0;
+        bool m_keyframeDue = true;
+    };
+
+    /**
+     * Rebuilds the full samples of one stream from a DeltaEncoder's keyframes and deltas. A received sample is a
+     * delta if the last of its relatedSampleIds is the sampleId of the latest keyframe or of one of the last
+     * history samples decoded, anything else is taken as a keyframe. The reference that has to be held is the
+     * previous sample, the latest keyframe or the acknowledged sample, depending on the encoder's DeltaReference.
+     * An older reference that a delta is decoded against is kept until another one replaces it, so an acknowledged
+     * sample stays available however many samples arrive after it. A delta whose reference was lost decodes as the
+     * partial sample it is, which is why lossy links should use KEYFRAME or ACKNOWLEDGED. */
+    class DeltaDecoder
+    {
+    public:
+        explicit DeltaDecoder(std::size_t history = 8);
+
+        /**
+         * Resets out and fills it with the full sample, returning true if received was a delta. */
+        bool decode(const OpenTrackIOSample& received, OpenTrackIOSample& out);
+        void reset();
+
+    private:
+        const OpenTrackIOSample* find(const opentrackiotypes::UrnUuid& sampleId) const;
+
+        OpenTrackIOSample m_keyframe{};
+        OpenTrackIOSample m_pinned{};
+        std::vector<OpenTrackIOSample> m_recent;
+        std::size_t m_next = 0;
+        std::size_t m_count = 0;
+    };
+} // namespace opentrackio
@@ -0,0 +1,169 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace opentrackio
+{
+    enum class DiagnosticCode : uint8_t
+    {
+        TYPE_MISMATCH,
+        PATTERN_MISMATCH,
+        MISSING_FIELD,
+        OUT_OF_RANGE,
+        INVALID_VALUE,
+        LEFTOVER_FIELD
+    };
+
+    enum class DiagnosticSeverity : uint8_t
+    {
+        ERROR,
+        WARNING
+    };
+
+    /**
+     * A single problem found while parsing, kept to a few bytes so that a sample can carry a batch of them inline.
+     * The message and expected strings always point at string literals in the parsers, so they are kept as pointers.
+     * Which field the problem was in is an id into the path table of the Diagnostics that reported it, and any text
+     * taken from the document, such as the name of a leftover key, is an offset and length into its value arena.
+     * Resolve both through Diagnostics::path() and Diagnostics::value(). */
+    struct Diagnostic
+    {
+        static constexpr uint8_t NO_PATH = 0xFF;
+
+        DiagnosticCode code = DiagnosticCode::TYPE_MISMATCH;
+        DiagnosticSeverity severity = DiagnosticSeverity::ERROR;
+        /**
+         * Warnings have no path, their value is the leftover key. */
+        uint8_t pathId = NO_PATH;
+        uint8_t valueLength = 0;
+        uint16_t valueOffset = 0;
+        /**
+         * Format string of the message, {0} is the path, {1} the expected type and {2} the value. */
+        const char* message = "";
+        const char* expected = "";
+    };
+
+    /**
+     * Collects the diagnostics reported by the parsers. By default each one is formatted into a string as soon as it
+     * is reported, which is how errors and warnings have always been gathered. In structured mode up to CAPACITY
+     * diagnostics are kept inline without allocating and strings are only formatted if errors() or warnings() are
+     * called. Diagnostics that don't fit, or whose path doesn't fit in the PATH_CAPACITY entries of the path table,
+     * are counted but dropped, and values are truncated once VALUE_CAPACITY bytes of them have been kept. */
+    class Diagnostics
+    {
+    public:
+        static constexpr std::size_t CAPACITY = 8;
+        static constexpr std::size_t PATH_CAPACITY = 12;
+        static constexpr std::size_t VALUE_CAPACITY = 96;
+        static constexpr std::size_t MAX_DEPTH = 4;
+
+        /**
+         * Sets how the next parse reports. Structured diagnostics only ever describe the latest parse, strings
+         * keep accumulating across parses as they always have. */
+        void configure(bool structured, bool collectWarnings);
+        void clear();
+
+        /**
+         * The message, field and expected strings must be string literals, they are kept by pointer. */
+        void error(DiagnosticCode code, std::string_view message, std::string_view field = {},
+                   std::string_view expected = {});
+        void warning(DiagnosticCode code, std::string_view message, std::string_view value);
+
+        /**
+         * Parsers enter the key of each object they descend into and leave it on the way out, errors reported in
+         * between take the entered keys as their parents. Objects nested deeper than MAX_DEPTH are left out of the
+         * path. See DiagnosticScope. */
+        void enter(std::string_view key);
+        void leave();
+
+        bool collectsWarnings() const { return m_collectWarnings; };
+        std::span<const Diagnostic> entries() const { return {m_entries.data(), m_count}; };
+        std::size_t dropped() const { return m_dropped; };
+
+        /**
+         * The key of the field a diagnostic was reported for, and the keys of the objects it is in joined with '/'
+         * outermost first, so that lens/encoders/focus and lens/rawEncoders/focus can be told apart. hasPath
+         * compares against a path without building it. */
+        std::string_view field(const Diagnostic& diagnostic) const;
+        std::string path(const Diagnostic& diagnostic) const;
+        bool hasPath(const Diagnostic& diagnostic, std::string_view path) const;
+        std::string_view value(const Diagnostic& diagnostic) const;
+        std::string toString(const Diagnostic& diagnostic) const;
+
+        /**
+         * Number of errors or warnings reported since the last clear, including any that were dropped, without
+         * formatting them. */
+        std::size_t errorCount() const { return m_errorCount; };
+        std::size_t warningCount() const { return m_warningCount; };
+
+        const std::vector<std::string>& errors();
+        const std::vector<std::string>& warnings();
+
+    private:
+        /**
+         * A key in the path table and the id of the object it is in. */
+        struct PathNode
+        {
+            const char* key = "";
+            uint8_t parent = Diagnostic::NO_PATH;
+        };
+
+        void report(Diagnostic diagnostic, std::string_view field, std::string_view value);
+        uint8_t internPath(std::string_view field);
+        uint8_t internNode(uint8_t parent, const char* key);
+        void formatEntries();
+
+        std::array<Diagnostic, CAPACITY> m_entries{};
+        std::array<PathNode, PATH_CAPACITY> m_paths{};
+        std::array<char, VALUE_CAPACITY> m_values{};
+        std::array<const char*, MAX_DEPTH> m_scope{};
+        uint8_t m_count = 0;
+        uint8_t m_pathCount = 0;
+        uint16_t m_valueSize = 0;
+        uint8_t m_depth = 0;
+        bool m_structured = false;
+        bool m_collectWarnings = true;
+        uint32_t m_dropped = 0;
+        uint32_t m_errorCount = 0;
+        uint32_t m_warningCount = 0;
+        uint32_t m_formatted = 0;
+        std::vector<std::string> m_errorMessages{};
+        std::vector<std::string> m_warningMessages{};
+    };
+
+    /**
+     * Enters a key of the diagnostics for as long as it lives. */
+    class DiagnosticScope
+    {
+    public:
+        DiagnosticScope(Diagnostics& diagnostics, std::string_view key) : m_diagnostics{diagnostics}
+        {
+            m_diagnostics.enter(key);
+        };
+        ~DiagnosticScope() { m_diagnostics.leave(); };
+
+        DiagnosticScope(const DiagnosticScope&) = delete;
+        DiagnosticScope& operator=(const DiagnosticScope&) = delete;
+
+    private:
+        Diagnostics& m_diagnostics;
+    };
+} // namespace opentrackio
@@ -0,0 +1,152 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOProperties.h"
+
+namespace opentrackio
+{
+    struct Point2
+    {
+        double x = 0;
+        double y = 0;
+    };
+
+    enum class DistortionIsa : uint8_t
+    {
+        SCALAR,
+        AVX2,
+        NEON
+    };
+
+    /**
+     * One set of Brown-Conrady coefficients, radial k1 to kN and tangential p1 to pN, applied to normalised image
+     * coordinates, millimetres from the centre of distortion divided by the focal length:
+     *   r2 = x * x + y * y
+     *   x' = x * (1 + k1 r2 + k2 r2^2 + ...) + (2 p1 x y + p2 (r2 + 2 x^2)) * (1 + p3 r2 + p4 r2^2 + ...)
+     *   y' = y * (1 + k1 r2 + k2 r2^2 + ...) + (p1 (r2 + 2 y^2) + 2 p2 x y) * (1 + p3 r2 + p4 r2^2 + ...)
+     * The kernel for the coefficient count is chosen when the model is built, up to MAX_RADIAL radial and two
+     * tangential coefficients have dedicated vectorised kernels and anything longer runs a generic scalar one. */
+    class DistortionModel
+    {
+    public:
+        static constexpr std::size_t MAX_RADIAL = 6;
+
+        using Kernel = void (*)(const DistortionModel& model, const Point2* in, Point2* out, std::size_t count);
+
+        DistortionModel();
+        DistortionModel(std::span<const double> radial, std::span<const double> tangential);
+
+        void apply(std::span<const Point2> in, std::span<Point2> out) const;
+
+        /**
+         * Inverts the model by fixed point iteration, iterations of the forward kernel over each block of points.
+         * Converges for the moderate distortion of real lenses, but isn't a substitute for measured undistortion
+         * coefficients. in and out may be the same span. */
+        void invert(std::span<const Point2> in, std::span<Point2> out, std::size_t iterations = 12) const;
+
+        bool isIdentity() const { return m_identity; };
+        std::size_t radialCount() const { return m_radial.size(); };
+        std::size_t tangentialCount() const { return m_tangential.size(); };
+
+        /**
+         * The instruction set the kernels of this process run on. */
+        static DistortionIsa isa();
+
+        // Read by the kernels.
+        std::array<double, MAX_RADIAL> k{};
+        std::array<double, 2> p{};
+        const std::vector<double>& radial() const { return m_radial; };
+        const std::vector<double>& tangential() const { return m_tangential; };
+
+    private:
+        std::vector<double> m_radial{};
+        std::vector<double> m_tangential{};
+        Kernel m_kernel;
+        bool m_identity = true;
+    };
+
+    /**
+     * The distortion of a lens at one sample, built once from its Lens property and then applied to any number of
+     * points. distort() maps undistorted to distorted coordinates with the distortion coefficients, undistort()
+     * maps back with the undistortion coefficients if the lens sent them and by inverting the distortion if not.
+     * Points are in normalised image coordinates as described on DistortionModel, toNormalised() and fromNormalised()
+     * convert from and to millimetres on the sensor. */
+    class LensDistortion
+    {
+    public:
+        LensDistortion() = default;
+        explicit LensDistortion(const opentrackioproperties::Lens& lens);
+
+        /**
+         * in and out may be the same span, they must be the same size. */
+        void distort(std::span<const Point2> in, std::span<Point2> out) const;
+        void undistort(std::span<const Point2> in, std::span<Point2> out) const;
+
+        /**
+         * Millimetres from the sensor centre to normalised coordinates, about the distortion shifted centre. */
+        Point2 toNormalised(Point2 millimetres) const;
+        Point2 fromNormalised(Point2 normalised) const;
+
+        const DistortionModel& distortion() const { return m_distortion; };
+        const std::optional<DistortionModel>& undistortion() const { return m_undistortion; };
+        std::optional<double> focalLength() const { return m_focalLength; };
+        double overscan() const { return m_overscan; };
+
+    private:
+        DistortionModel m_distortion{};
+        std::optional<DistortionModel> m_undistortion = std::nullopt;
+        std::optional<double> m_focalLength = std::nullopt;
+        Point2 m_shift{};
+        double m_overscan = 1.0;
+    };
+
+    /**
+     * How an ST-map is laid out and which way it maps. Pixels are sampled at their centres, row 0 is the top of the
+     * image and v increases downwards, so an identity lens bakes to the pixel centres. */
+    struct StMapOptions
+    {
+        enum class Direction : uint8_t
+        {
+            /**
+             * The map is the size of the plate and looks up the undistorted, overscanned render, for distorting
+             * CG to match the plate. */
+            APPLY_DISTORTION,
+            /**
+             * The map is the size of the overscanned undistorted image and looks up the plate. */
+            REMOVE_DISTORTION
+        };
+
+        uint32_t width = 0;
+        uint32_t height = 0;
+        /**
+         * Active sensor size in millimetres, normally Camera::activeSensorPhysicalDimensions. */
+        double sensorWidth = 0;
+        double sensorHeight = 0;
+        /**
+         * Size of the undistorted image relative to the sensor, defaults to the lens distortionOverscan. */
+        std::optional<double> overscan = std::nullopt;
+        Direction direction = Direction::APPLY_DISTORTION;
+    };
+
+    /**
+     * Bakes a width * height map of interleaved u, v floats ready for upload as an RG32F texture. Returns false and
+     * leaves uv untouched if the lens has no focal length or the options are empty. */
+    bool bakeStMap(const LensDistortion& distortion, const StMapOptions& options, std::vector<float>& uv);
+} // namespace opentrackio
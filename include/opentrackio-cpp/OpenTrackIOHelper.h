@@ -12,9 +12,22 @@
  */
 
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <concepts>
 #include <format>
+#include <limits>
+#include <optional>
 #include <regex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <nlohmann/json.hpp>
+#include "opentrackio-cpp/OpenTrackIODiagnostics.h"
+#include "opentrackio-cpp/OpenTrackIOMemory.h"
+#include "opentrackio-cpp/OpenTrackIOUuid.h"
 
 namespace opentrackio
 {
@@ -33,56 +46,322 @@ namespace opentrackio
         { t.zoom } -> std::convertible_to<std::optional<uint16_t>>;
     };
     
+    /**
+     * A string matcher such as the ones in OpenTrackIOValidators.h. */
+    template<typename T>
+    concept Validator = std::is_nothrow_invocable_r_v<bool, const T&, std::string_view>;
+    
+    /**
+     * Value accessors for nlohmann::json, TapeNode has matching overloads in OpenTrackIOTape.h. These are what the
+     * helpers below read through so that they work with either kind of node. */
+    inline const bool* getBoolean(const nlohmann::json& json)
+    {
+        return json.get_ptr<const nlohmann::json::boolean_t*>();
+    }
+
+    inline const int64_t* getInteger(const nlohmann::json& json)
+    {
+        return json.get_ptr<const nlohmann::json::number_integer_t*>();
+    }
+
+    inline const uint64_t* getUnsigned(const nlohmann::json& json)
+    {
+        return json.get_ptr<const nlohmann::json::number_unsigned_t*>();
+    }
+
+    inline const double* getFloat(const nlohmann::json& json)
+    {
+        return json.get_ptr<const nlohmann::json::number_float_t*>();
+    }
+
+    inline std::optional<std::string_view> getString(const nlohmann::json& json)
+    {
+        const auto* str = json.get_ptr<const nlohmann::json::string_t*>();
+        if (str == nullptr)
+        {
+            return std::nullopt;
+        }
+        return std::string_view{*str};
+    }
+
+    /**
+     * Identifies a node for as long as the document it belongs to is alive. */
+    inline const void* nodeId(const nlohmann::json& json)
+    {
+        return &json;
+    }
+
+    /**
+     * Replaces out with an encoding of a node and everything below it, equal nodes of the same kind of document
+     * give the same bytes and unequal ones different bytes. Reusing out avoids allocating once it has grown. */
+    inline void nodeBytes(const nlohmann::json& json, std::string& out)
+    {
+        out.clear();
+        nlohmann::json::to_cbor(json, out);
+    }
+
+    /**
+     * A read only document node that the property parsers can run against, either a const nlohmann::json or a
+     * TapeNode. Missing keys must be checked with contains() before they are looked up. */
+    template<typename T>
+    concept JsonNode =
+    requires(const T& node, std::string_view key)
+    {
+        { node.contains(key) } -> std::convertible_to<bool>;
+        { node.is_object() } -> std::convertible_to<bool>;
+        { node.is_array() } -> std::convertible_to<bool>;
+        { node.size() } -> std::convertible_to<std::size_t>;
+        node[key];
+        { nodeId(node) } -> std::convertible_to<const void*>;
+        { getString(node) } -> std::same_as<std::optional<std::string_view>>;
+    };
+    
+    /**
+     * Records which nodes of a read-only document have been consumed by the property parsers. Marking a node as
+     * consumed is the equivalent of erasing it from its parent, which lets the leftover field check run against the
+     * original document instead of a copy that the parsers erase from. */
+    class ConsumedFields
+    {
+    public:
+        void clear()
+        {
+            m_nodes.clear();
+            m_sorted = true;
+        }
+
+        template<JsonNode Json>
+        void consume(const Json& node)
+        {
+            m_nodes.push_back(nodeId(node));
+            m_sorted = false;
+        }
+
+        template<JsonNode Json>
+        bool isConsumed(const Json& node)
+        {
+            if (!m_sorted)
+            {
+                std::sort(m_nodes.begin(), m_nodes.end());
+                m_sorted = true;
+            }
+            return std::binary_search(m_nodes.begin(), m_nodes.end(), nodeId(node));
+        }
+
+        /**
+         * Consumes an object node if every one of its members has already been consumed.
+         * Non-object nodes are left untouched. */
+        template<JsonNode Json>
+        void consumeIfEmpty(const Json& node)
+        {
+            if (!node.is_object())
+            {
+                return;
+            }
+
+            for (const auto& value : node)
+            {
+                if (!isConsumed(value))
+                {
+                    return;
+                }
+            }
+            consume(node);
+        }
+
+    private:
+        Vector<const void*> m_nodes{};
+        bool m_sorted = true;
+    };
+
+    /**
+     * State threaded through every parse call, diagnostics are reported to and consumed nodes are recorded in the
+     * referenced objects which are owned by the caller. */
+    struct ParseContext
+    {
+        Diagnostics& diagnostics;
+        ConsumedFields& consumed;
+        
+        /**
+         * Lens and Tracker carry both static and per sample fields, these select which of the two get parsed. */
+        bool parseStatic = true;
+        bool parseDynamic = true;
+    };
+    
     class OpenTrackIOHelpers
     {
     public:
-        static inline void clearFieldIfEmpty(nlohmann::json &json, std::string_view fieldStr)
+        template<JsonNode Json>
+        static inline void consumeFieldIfEmpty(const Json &json, std::string_view fieldStr, ParseContext &ctx)
         {
-            if (json[fieldStr].is_object() && std::distance(json[fieldStr].items().begin(), json[fieldStr].items().end()) == 0)
+            if (json.contains(fieldStr))
             {
-                json.erase(fieldStr);
+                ctx.consumed.consumeIfEmpty(json[fieldStr]);
             }
         }
         
-        template<typename T>
-        static inline bool checkTypeAndSetField(const nlohmann::json &jsonVal, T &field)
+        /**
+         * Warns for every field of the document that no parser consumed, descending into unconsumed objects. */
+        template<JsonNode Json>
+        static void warnForRemainingFields(const Json &json, ParseContext &ctx)
         {
-            try
+            if (!json.is_object())
+            {
+                return;
+            }
+            
+            for (auto it = json.begin(); it != json.end(); ++it)
+            {
+                if (ctx.consumed.isConsumed(*it))
+                {
+                    continue;
+                }
+                
+                const std::string_view key = it.key();
+                if (key != "static")
+                {
+                    ctx.diagnostics.warning(DiagnosticCode::LEFTOVER_FIELD, "Key: {2} was still remaining after parsing.",
+                                            key);
+                }
+                warnForRemainingFields(*it, ctx);
+            }
+        }
+        
+        /**
+         * Reads a JSON value into the target type without throwing. The stored type of the value is checked up front
+         * and integral targets are range checked, so a mistyped or out of range value costs the same as a valid one.
+         * Floating point values are only accepted for integral targets if they hold an exact integer. */
+        template<JsonNode Json, typename T>
+        static inline bool readJsonValue(const Json &jsonVal, T &out)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                const auto* val = getBoolean(jsonVal);
+                if (val == nullptr)
+                {
+                    return false;
+                }
+                out = *val;
+                return true;
+            }
+            else if constexpr (std::is_integral_v<T>)
             {
-                field = jsonVal.get<T>();
+                if (const auto* val = getUnsigned(jsonVal))
+                {
+                    if (!std::in_range<T>(*val))
+                    {
+                        return false;
+                    }
+                    out = static_cast<T>(*val);
+                    return true;
+                }
+                if (const auto* val = getInteger(jsonVal))
+                {
+                    if (!std::in_range<T>(*val))
+                    {
+                        return false;
+                    }
+                    out = static_cast<T>(*val);
+                    return true;
+                }
+                if (const auto* val = getFloat(jsonVal))
+                {
+                    constexpr auto min = static_cast<double>(std::numeric_limits<T>::min());
+                    constexpr auto maxExclusive = static_cast<double>(std::numeric_limits<T>::max()) + 1.0;
+                    if (!(*val >= min && *val < maxExclusive) || std::trunc(*val) != *val)
+                    {
+                        return false;
+                    }
+                    out = static_cast<T>(*val);
+                    return true;
+                }
+                return false;
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                if (const auto* val = getFloat(jsonVal))
+                {
+                    out = static_cast<T>(*val);
+                    return true;
+                }
+                if (const auto* val = getUnsigned(jsonVal))
+                {
+                    out = static_cast<T>(*val);
+                    return true;
+                }
+                if (const auto* val = getInteger(jsonVal))
+                {
+                    out = static_cast<T>(*val);
+                    return true;
+                }
+                return false;
+            }
+            else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, String>)
+            {
+                const auto val = getString(jsonVal);
+                if (!val.has_value())
+                {
+                    return false;
+                }
+                out.assign(val->data(), val->size());
                 return true;
             }
-            catch (...)
+            else
+            {
+                // Types without a dedicated check fall back to nlohmann's conversion.
+                static_assert(std::is_same_v<Json, nlohmann::json>, "Only nlohmann::json supports generic conversions");
+                try
+                {
+                    out = jsonVal.template get<T>();
+                    return true;
+                }
+                catch (...)
+                {
+                    return false;
+                }
+            }
+        }
+        
+        template<JsonNode Json, typename T>
+        static inline bool checkTypeAndSetField(const Json &jsonVal, T &field)
+        {
+            if (!readJsonValue(jsonVal, field))
             {
                 // Reset field to default if failed.
                 field = T{};
                 return false;
             }
+            return true;
         }
 
-        template<typename T>
-        static inline bool checkTypeAndSetField(const nlohmann::json &jsonVal, std::optional<T> &field)
+        template<JsonNode Json, typename T>
+        static inline bool checkTypeAndSetField(const Json &jsonVal, std::optional<T> &field)
         {
-            try
+            if (!field.has_value())
             {
-                field = jsonVal.get<T>();
-                return true;
+                field.emplace();
             }
-            catch (...)
+            
+            if (!readJsonValue(jsonVal, field.value()))
             {
                 // Reset field to default if failed.
                 field = std::nullopt;
                 return false;
             }
+            return true;
         }
 
-        template<typename T>
-        static inline bool iterateJsonArrayAndPopulateVector(const nlohmann::json &jsonVal, std::vector<T> &vec)
+        template<JsonNode Json, typename T, typename A>
+        static inline bool iterateJsonArrayAndPopulateVector(const Json &jsonVal, std::vector<T, A> &vec)
         {
-            for (const auto &item: jsonVal.items())
+            if (jsonVal.is_array())
+            {
+                vec.reserve(vec.size() + jsonVal.size());
+            }
+            
+            for (const auto &item: jsonVal)
             {
                 T val;
-                if (!checkTypeAndSetField(item.value(), val))
+                if (!checkTypeAndSetField(item, val))
                 {
                     return false;
                 }
@@ -92,43 +371,50 @@ namespace opentrackio
             return true;
         }
 
-        template<typename T>
-        static inline bool iterateJsonArrayAndPopulateVector(const nlohmann::json &jsonVal, std::optional<std::vector<T>> &vec)
+        /**
+         * Refills the vector in place so that a previously parsed value lends it its capacity. */
+        template<JsonNode Json, typename T, typename A>
+        static inline bool iterateJsonArrayAndPopulateVector(const Json &jsonVal, std::optional<std::vector<T, A>> &vec)
         {
-            std::vector<T> out;
-            for (const auto &item: jsonVal.items())
+            if (!vec.has_value())
             {
-                T val;
-                if (!checkTypeAndSetField(item.value(), val))
-                {
-                    return false;
-                }
-                out.emplace_back(val);
+                vec.emplace();
+            }
+            
+            vec->clear();
+            if (!iterateJsonArrayAndPopulateVector(jsonVal, vec.value()))
+            {
+                vec = std::nullopt;
+                return false;
             }
-
-            vec = std::move(out);
             return true;
         }
 
-        template<typename T>
-        static inline void assignField(nlohmann::json &json, std::string_view fieldStr, std::optional<T> &field,
-                         std::string_view typeStr, std::vector<std::string> &errors)
+        /**
+         * The assign helpers overwrite the field in place, so a field left over from a previous parse reuses its
+         * storage, and clear it if the document doesn't contain it. */
+        template<JsonNode Json, typename T>
+        static inline void assignField(const Json &json, std::string_view fieldStr, std::optional<T> &field,
+                         std::string_view typeStr, ParseContext &ctx)
         {
-            if (json.contains(fieldStr))
+            if (!json.contains(fieldStr))
             {
-                if (!checkTypeAndSetField(json[fieldStr], field))
-                {
-                    errors.emplace_back(std::format("field: {} isn't of type: {}", fieldStr, typeStr));
-                    field = std::nullopt;
-                    return;
-                }
-                json.erase(fieldStr);
+                field = std::nullopt;
+                return;
+            }
+            
+            if (!checkTypeAndSetField(json[fieldStr], field))
+            {
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", fieldStr, typeStr);
+                field = std::nullopt;
+                return;
             }
+            ctx.consumed.consume(json[fieldStr]);
         }
         
-        template<Encoder T>
-        static inline void assignField(nlohmann::json &json, std::string_view fieldStr, std::optional<T> &field,
-                         std::string_view typeStr, std::vector<std::string> &errors)
+        template<JsonNode Json, Encoder T>
+        static inline void assignField(const Json &json, std::string_view fieldStr, std::optional<T> &field,
+                         std::string_view typeStr, ParseContext &ctx)
         {
             if (!json.contains(fieldStr))
             {
@@ -137,10 +423,13 @@ namespace opentrackio
             }
 
             field = T{};
-            auto &encoderJson = json[fieldStr];
-            assignField(encoderJson, "focus", field->focus, typeStr, errors);
-            assignField(encoderJson, "iris", field->iris, typeStr, errors);
-            assignField(encoderJson, "zoom", field->zoom, typeStr, errors);
+            const auto &encoderJson = json[fieldStr];
+            {
+                DiagnosticScope encodersScope{ctx.diagnostics, fieldStr};
+                assignField(encoderJson, "focus", field->focus, typeStr, ctx);
+                assignField(encoderJson, "iris", field->iris, typeStr, ctx);
+                assignField(encoderJson, "zoom", field->zoom, typeStr, ctx);
+            }
 
             if (!(field->focus.has_value() && field->iris.has_value() && field->zoom.has_value()))
             {
@@ -148,51 +437,115 @@ namespace opentrackio
                 return;
             }
 
-            json.erase(fieldStr);
+            ctx.consumed.consume(encoderJson);
         }
 
-        static inline void assignRegexField(nlohmann::json &json, std::string_view fieldStr, std::optional<std::string> &field,
-                              const std::regex &pattern, std::vector<std::string> &errors)
+        template<JsonNode Json>
+        static inline void assignRegexField(const Json &json, std::string_view fieldStr, std::optional<String> &field,
+                              const std::regex &pattern, ParseContext &ctx)
         {
-            if (json.contains(fieldStr))
+            if (!json.contains(fieldStr))
             {
-                if (!checkTypeAndSetField(json[fieldStr], field))
-                {
-                    errors.emplace_back(std::format("field: {} isn't of type: string", fieldStr));
-                    field = std::nullopt;
-                    return;
-                }
-                if (std::smatch res; !std::regex_match(field.value(), res, pattern))
-                {
-                    errors.emplace_back(std::format("field: {} doesn't match the required pattern", fieldStr));
-                    field = std::nullopt;
-                    return;
-                }
-                json.erase(fieldStr);
+                field = std::nullopt;
+                return;
             }
-        }  
-    };
+            
+            if (!checkTypeAndSetField(json[fieldStr], field))
+            {
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", fieldStr, "string");
+                field = std::nullopt;
+                return;
+            }
+            if (!std::regex_match(field->begin(), field->end(), pattern))
+            {
+                ctx.diagnostics.error(DiagnosticCode::PATTERN_MISMATCH, "field: {} doesn't match the required pattern", fieldStr);
+                field = std::nullopt;
+                return;
+            }
+            ctx.consumed.consume(json[fieldStr]);
+        }
 
-    template<>
-    inline void OpenTrackIOHelpers::assignField<std::vector<double>>(nlohmann::json &json, std::string_view fieldStr,
-                                                 std::optional<std::vector<double>> &field,
-                                                 std::string_view typeStr, std::vector<std::string> &errors)
-    {
-        if (!json.contains(fieldStr) || !json[fieldStr].is_array())
+        template<JsonNode Json, Validator V>
+        static inline void assignRegexField(const Json &json, std::string_view fieldStr, std::optional<String> &field,
+                              const V &validator, ParseContext &ctx)
         {
-            field = std::nullopt;
-            return;
+            if (!json.contains(fieldStr))
+            {
+                field = std::nullopt;
+                return;
+            }
+            
+            if (!checkTypeAndSetField(json[fieldStr], field))
+            {
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", fieldStr, "string");
+                field = std::nullopt;
+                return;
+            }
+            if (!validator(field.value()))
+            {
+                ctx.diagnostics.error(DiagnosticCode::PATTERN_MISMATCH, "field: {} doesn't match the required pattern", fieldStr);
+                field = std::nullopt;
+                return;
+            }
+            ctx.consumed.consume(json[fieldStr]);
+        }
+
+        /**
+         * Reads a urn:uuid string straight into its 16 byte value, reporting what assignRegexField does with the
+         * urnUuid validator. */
+        template<JsonNode Json>
+        static inline bool setUuidField(const Json &jsonVal, std::string_view fieldStr,
+                                        std::optional<opentrackiotypes::UrnUuid> &field, ParseContext &ctx)
+        {
+            const auto str = getString(jsonVal);
+            if (!str.has_value())
+            {
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", fieldStr, "string");
+                field = std::nullopt;
+                return false;
+            }
+
+            field = opentrackiotypes::UrnUuid::parse(str.value());
+            if (!field.has_value())
+            {
+                ctx.diagnostics.error(DiagnosticCode::PATTERN_MISMATCH, "field: {} doesn't match the required pattern", fieldStr);
+                return false;
+            }
+            return true;
         }
 
-        std::vector<double> vec{};
-        if (!iterateJsonArrayAndPopulateVector(json[fieldStr], vec))
+        template<JsonNode Json>
+        static inline void assignUuidField(const Json &json, std::string_view fieldStr,
+                                           std::optional<opentrackiotypes::UrnUuid> &field, ParseContext &ctx)
         {
-            errors.emplace_back("field: {} had elements not of type: double");
-            field = std::nullopt;
-            return;
+            if (!json.contains(fieldStr))
+            {
+                field = std::nullopt;
+                return;
+            }
+
+            if (setUuidField(json[fieldStr], fieldStr, field, ctx))
+            {
+                ctx.consumed.consume(json[fieldStr]);
+            }
         }
 
-        field = std::move(vec);
-        json.erase(fieldStr);
-    }
+        template<JsonNode Json>
+        static inline void assignField(const Json &json, std::string_view fieldStr, std::optional<Vector<double>> &field,
+                         std::string_view typeStr, ParseContext &ctx)
+        {
+            if (!json.contains(fieldStr) || !json[fieldStr].is_array())
+            {
+                field = std::nullopt;
+                return;
+            }
+
+            if (!iterateJsonArrayAndPopulateVector(json[fieldStr], field))
+            {
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} had elements not of type: {}", fieldStr, "double");
+                return;
+            }
+            ctx.consumed.consume(json[fieldStr]);
+        }
+    };
 } // namespace opentrackio
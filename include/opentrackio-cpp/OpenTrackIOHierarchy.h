@@ -0,0 +1,152 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOMath.h"
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+
+namespace opentrackio
+{
+    /**
+     * The parent links of a transform list, resolved from its transformId and parentTransformId strings into
+     * indices. Transforms without a parent, or whose parent id matches no transform, are roots relative to the stage.
+     * Where ids are repeated the first transform with the id is the parent. */
+    struct TransformHierarchy
+    {
+        static constexpr uint32_t ROOT = std::numeric_limits<uint32_t>::max();
+
+        /**
+         * Indices into the transform list with every parent before its children. Siblings keep their order in the
+         * list, as the specification asks. */
+        std::vector<uint32_t> order{};
+        /**
+         * The parent index of each transform, by its position in the list, or ROOT. */
+        std::vector<uint32_t> parents{};
+        std::size_t unresolvedParents = 0;
+        /**
+         * Set if some parents formed a cycle. The first transform of each cycle in list order is made a root. */
+        bool cyclic = false;
+
+        static void build(std::span<const opentrackiotypes::Transform> transforms, TransformHierarchy& out);
+
+        /**
+         * Whether this hierarchy was built from a list with the same ids in the same positions. */
+        bool matches(std::span<const opentrackiotypes::Transform> transforms) const;
+
+    private:
+        std::vector<std::optional<std::string>> m_ids{};
+        std::vector<std::optional<std::string>> m_parentIds{};
+    };
+
+    /**
+     * Composes the world pose of every transform in a list, by position, given its hierarchy. Local poses are
+     * converted in one pass and then multiplied down the hierarchy in a second, pose is Matrix4f, Matrix4d or
+     * DualQuaternion. */
+    template<typename Pose>
+    void composeHierarchy(const TransformHierarchy& hierarchy, std::span<const opentrackiotypes::Transform> transforms,
+                          std::span<Pose> world)
+    {
+        for (std::size_t i = 0; i < transforms.size(); ++i)
+        {
+            world[i] = Pose::fromTransform(transforms[i]);
+        }
+
+        for (const uint32_t index : hierarchy.order)
+        {
+            const uint32_t parent = hierarchy.parents[index];
+            if (parent != TransformHierarchy::ROOT)
+            {
+                world[index] = world[parent] * world[index];
+            }
+        }
+    }
+
+    /**
+     * Resolves samples' transforms into world poses. The hierarchy of each source is built once and kept for as long
+     * as the source keeps sending the same transform ids, after which resolving a sample is a comparison of its ids
+     * against the cached ones and the composition, with no lookups or allocations. Samples without a source id share
+     * one cache entry. Not thread safe, use one resolver per thread. */
+    class HierarchyResolver
+    {
+    public:
+        /**
+         * The hierarchy of the sample's transforms, rebuilt if its source has changed layout. */
+        const TransformHierarchy& hierarchy(const OpenTrackIOSample& sample);
+
+        /**
+         * Fills world with the pose of each of the sample's transforms, by position. Returns false and leaves world
+         * empty if the sample has no transforms. */
+        template<typename Pose>
+        bool resolve(const OpenTrackIOSample& sample, std::vector<Pose>& world)
+        {
+            if (!sample.transforms.has_value() || sample.transforms->transforms.empty())
+            {
+                world.clear();
+                return false;
+            }
+
+            const auto& transforms = sample.transforms->transforms;
+            world.resize(transforms.size());
+            composeHierarchy<Pose>(hierarchy(sample), transforms, world);
+            return true;
+        }
+
+        /**
+         * Resolves a take in one call. The poses of sample i are world[offsets[i]] up to world[offsets[i + 1]],
+         * offsets has one more entry than there are samples. Samples without transforms get an empty range. */
+        template<typename Pose>
+        void resolve(std::span<const OpenTrackIOSample> samples, std::vector<Pose>& world,
+                     std::vector<std::size_t>& offsets)
+        {
+            offsets.resize(samples.size() + 1);
+            std::size_t total = 0;
+            for (std::size_t i = 0; i < samples.size(); ++i)
+            {
+                offsets[i] = total;
+                if (samples[i].transforms.has_value())
+                {
+                    total += samples[i].transforms->transforms.size();
+                }
+            }
+            offsets[samples.size()] = total;
+            world.resize(total);
+
+            for (std::size_t i = 0; i < samples.size(); ++i)
+            {
+                if (offsets[i + 1] != offsets[i])
+                {
+                    const auto& transforms = samples[i].transforms->transforms;
+                    composeHierarchy<Pose>(hierarchy(samples[i]), transforms,
+                                           std::span<Pose>(world).subspan(offsets[i], transforms.size()));
+                }
+            }
+        }
+
+        /**
+         * Number of times a hierarchy has been built, for checking that a source's layout is being reused. */
+        std::size_t builds() const { return m_builds; };
+        void clear();
+
+    private:
+        std::unordered_map<opentrackiotypes::UrnUuid, TransformHierarchy> m_hierarchies{};
+        std::size_t m_builds = 0;
+    };
+} // namespace opentrackio
@@ -0,0 +1,134 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOMath.h"
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+#include "opentrackio-cpp/OpenTrackIOSnapshot.h"
+
+namespace opentrackio
+{
+    struct TransformState
+    {
+        opentrackiotypes::Vector3 translation{};
+        Quaternion orientation{};
+        /**
+         * The orientation as pan, tilt and roll, unwrapped to stay within a turn of the recorded angles. */
+        opentrackiotypes::Rotation rotation{};
+        opentrackiotypes::Vector3 scale{1, 1, 1};
+    };
+
+    struct InterpolatedState
+    {
+        enum class Status : uint8_t
+        {
+            EMPTY,
+            /**
+             * Outside the history, or only one sample in it, so the nearest sample was returned as it is. */
+            HELD,
+            INTERPOLATED,
+            EXTRAPOLATED
+        };
+
+        Status status = Status::EMPTY;
+        int64_t time = 0;
+
+        std::array<double, LENS_VALUE_COUNT> lens{};
+        uint32_t lensValid = 0;
+
+        /**
+         * Matched by position between the two samples, so only as many as the shorter of the two. */
+        std::vector<TransformState> transforms{};
+
+        bool has(LensValue value) const { return (lensValid >> static_cast<uint32_t>(value) & 1) != 0; };
+        double get(LensValue value) const { return lens[static_cast<std::size_t>(value)]; };
+    };
+
+    /**
+     * The latest samples from one source ordered by their sample timestamp, for finding the camera and lens state
+     * at any time between them. Samples are kept in a ring of fixed capacity with every transform slot allocated up
+     * front, so neither pushing nor querying allocates once out has grown to the transform count. Queries at
+     * increasing times, as a renderer makes them, continue from the previous bracket and cost O(1) amortised,
+     * anything else binary searches. Translations, scales and lens values are interpolated linearly, rotations are
+     * slerped as quaternions. Queries past the newest sample extrapolate from the last two, up to maxExtrapolation,
+     * to compensate for tracking latency.
+     *
+     * Times are nanoseconds, attoseconds are dropped. A history isn't thread safe, queries update the cursor. */
+    class SampleHistory
+    {
+    public:
+        explicit SampleHistory(std::size_t capacity = 64, std::size_t maxTransforms = 8,
+                               int64_t maxExtrapolation = 100'000'000);
+
+        static int64_t toNanoseconds(const opentrackiotypes::Timestamp& timestamp);
+
+        /**
+         * Adds a sample with a sample timestamp, returning false if it has none or is older than every sample in
+         * a full history. Samples that arrive out of order are moved into place and a sample with the same
+         * timestamp as one already held replaces it. Transforms past maxTransforms are ignored. */
+        bool push(const OpenTrackIOSample& sample);
+
+        /**
+         * As push(const OpenTrackIOSample&) for the state captured in a snapshot, for a history fed from a queue of
+         * snapshots. Transforms a snapshot dropped on overflow stay missing. */
+        bool push(const TrackingSnapshot& snapshot);
+
+        /**
+         * Fills out with the state at time, returning false if the history is empty. */
+        bool at(int64_t time, InterpolatedState& out) const;
+        bool at(const opentrackiotypes::Timestamp& timestamp, InterpolatedState& out) const
+        {
+            return at(toNanoseconds(timestamp), out);
+        };
+
+        std::size_t size() const { return m_count; };
+        std::size_t capacity() const { return m_entries.size(); };
+        void clear();
+
+    private:
+        struct Entry
+        {
+            int64_t time = 0;
+            uint32_t lensValid = 0;
+            uint32_t transformCount = 0;
+            std::array<double, LENS_VALUE_COUNT> lens{};
+        };
+
+        std::size_t slot(std::size_t index) const { return (m_head + index) % m_entries.size(); };
+        const Entry& entry(std::size_t index) const { return m_entries[slot(index)]; };
+        const TransformState* transformsOf(std::size_t index) const
+        {
+            return &m_transforms[slot(index) * m_maxTransforms];
+        };
+        template<typename Source>
+        bool insert(int64_t time, const Source& source);
+        void store(std::size_t position, int64_t time, const OpenTrackIOSample& sample);
+        void store(std::size_t position, int64_t time, const TrackingSnapshot& snapshot);
+        std::size_t findBracket(int64_t time) const;
+        void swapEntries(std::size_t a, std::size_t b);
+        void hold(std::size_t index, InterpolatedState& out) const;
+        void blend(std::size_t from, double alpha, InterpolatedState& out) const;
+
+        std::vector<Entry> m_entries;
+        std::vector<TransformState> m_transforms;
+        std::size_t m_maxTransforms;
+        int64_t m_maxExtrapolation;
+        std::size_t m_head = 0;
+        std::size_t m_count = 0;
+        mutable std::size_t m_cursor = 0;
+    };
+} // namespace opentrackio
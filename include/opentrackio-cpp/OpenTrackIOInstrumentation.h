@@ -0,0 +1,263 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "OpenTrackIODiagnostics.h"
+#include "OpenTrackIOMemory.h"
+#include "OpenTrackIOUuid.h"
+
+namespace opentrackio
+{
+    struct OpenTrackIOSample;
+
+    /**
+     * Set by the OPENTRACKIO_INSTRUMENTATION CMake option. Without it every hook compiles away and an
+     * Instrumentation passed to the library is never written to. */
+#if defined(OPEN_TRACK_IO_INSTRUMENTATION)
+    constexpr bool OPEN_TRACK_IO_INSTRUMENTED = true;
+#else
+    constexpr bool OPEN_TRACK_IO_INSTRUMENTED = false;
+#endif
+
+    enum class InstrumentedPhase : uint8_t
+    {
+        /**
+         * Tokenising JSON text or decoding CBOR into the tape, or into a DOM when it is retained. */
+        DOM_BUILD,
+        PROPERTY_PARSE,
+        /**
+         * The walk over the document for fields no parser consumed. */
+        LEFTOVER_WALK,
+        SERIALISE,
+        COUNT
+    };
+
+    constexpr std::size_t INSTRUMENTED_PHASE_COUNT = static_cast<std::size_t>(InstrumentedPhase::COUNT);
+
+    /**
+     * A histogram of nanoseconds with power of two buckets, bucket i counting the values that are i bits wide, so
+     * recording is a few instructions and the storage fixed. */
+    struct Histogram
+    {
+        static constexpr std::size_t BUCKETS = 40;
+
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t count = 0;
+        uint64_t total = 0;
+        uint64_t min = std::numeric_limits<uint64_t>::max();
+        uint64_t max = 0;
+
+        void record(uint64_t value);
+        double mean() const { return count == 0 ? 0.0 : static_cast<double>(total) / static_cast<double>(count); };
+
+        /**
+         * The upper bound of the bucket holding the given quantile, between 0 and 1. */
+        uint64_t quantile(double q) const;
+    };
+
+    struct FieldCount
+    {
+        std::string field{};
+        uint64_t count = 0;
+    };
+
+    /**
+     * Everything measured for one source, keyed by sourceId, samples without one share the nil UUID. */
+    struct SourceStats
+    {
+        opentrackiotypes::UrnUuid sourceId{};
+        uint64_t parsed = 0;
+        uint64_t serialised = 0;
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+
+        /**
+         * Made through the library's allocators while parsing, which covers the tape and the properties but not a
+         * DOM that nlohmann builds. */
+        uint64_t allocations = 0;
+        uint64_t errors = 0;
+        uint64_t warnings = 0;
+
+        /**
+         * Sequence numbers skipped between consecutive samples, samples that arrived after a later one, samples that
+         * repeated the previous one and jumps back too far to be late, taken as the source restarting. Sequence
+         * numbers wrap at 65536, so a step forwards of more than half of that is a step back. */
+        uint64_t sequenceGaps = 0;
+        uint64_t sequenceReorders = 0;
+        uint64_t sequenceRepeats = 0;
+        uint64_t sequenceResets = 0;
+
+        std::array<Histogram, INSTRUMENTED_PHASE_COUNT> phases{};
+
+        /**
+         * How far the time between two samples arriving was from the frame period given by Timing::frameRate. A
+         * sample is taken to arrive when its parse finishes. */
+        Histogram jitter{};
+
+        /**
+         * Errors by field path, such as lens/encoders/focus, and warnings by leftover key. Only parses with
+         * ParseOptions::structuredDiagnostics report which field a problem was in, the totals above count every
+         * parse. */
+        std::vector<FieldCount> fieldErrors{};
+        std::vector<FieldCount> fieldWarnings{};
+
+        const Histogram& phase(InstrumentedPhase p) const { return phases[static_cast<std::size_t>(p)]; };
+    };
+
+    /**
+     * What a PhaseTimer measured for one parse or serialise. */
+    struct PhaseMeasurement
+    {
+        std::array<uint64_t, INSTRUMENTED_PHASE_COUNT> durations{};
+        uint32_t timed = 0;
+        std::size_t bytes = 0;
+        std::size_t allocations = 0;
+        std::size_t errors = 0;
+        std::size_t warnings = 0;
+    };
+
+    /**
+     * Collects stream health and decode cost per source from every sample parsed or serialised with it. It is
+     * thread safe, so several receive threads can share one while another pulls stats() or a callback set with
+     * setCallback() is given each source's stats at most once per period. Recording a sample takes a lock and a few
+     * clock reads, a build without instrumentation leaves out even those. */
+    class Instrumentation
+    {
+    public:
+        using Callback = std::function<void(const SourceStats&)>;
+
+        std::vector<SourceStats> stats() const;
+        std::optional<SourceStats> stats(const opentrackiotypes::UrnUuid& sourceId) const;
+        void clear();
+
+        /**
+         * Called from whichever thread records a sample of the source, outside the lock. */
+        void setCallback(Callback callback, std::chrono::nanoseconds period);
+
+        void recordParse(const OpenTrackIOSample& sample, const Diagnostics& diagnostics,
+                         const PhaseMeasurement& measurement);
+        void recordSerialise(const OpenTrackIOSample& sample, const PhaseMeasurement& measurement);
+
+    private:
+        struct Source
+        {
+            SourceStats stats{};
+            std::optional<uint16_t> lastSequence = std::nullopt;
+            std::optional<std::chrono::steady_clock::time_point> lastArrival = std::nullopt;
+            std::chrono::steady_clock::time_point lastReport{};
+        };
+
+        Source& sourceOf(const OpenTrackIOSample& sample);
+        void report(Source& source, std::chrono::steady_clock::time_point now, std::unique_lock<std::mutex>& lock);
+
+        mutable std::mutex m_mutex{};
+        std::unordered_map<opentrackiotypes::UrnUuid, Source> m_sources{};
+        Callback m_callback{};
+        std::chrono::nanoseconds m_period{};
+    };
+
+    /**
+     * Times the phases of one parse or serialise for an Instrumentation. It only runs when the library is built
+     * with instrumentation and start() is given one, otherwise every call returns straight away. */
+    class PhaseTimer
+    {
+    public:
+        void start(Instrumentation* instrumentation, std::size_t bytes)
+        {
+            if constexpr (OPEN_TRACK_IO_INSTRUMENTED)
+            {
+                m_instrumentation = instrumentation;
+                if (instrumentation != nullptr)
+                {
+                    m_measurement = {};
+                    m_measurement.bytes = bytes;
+                    m_allocations = allocationCount();
+                    m_lap = std::chrono::steady_clock::now();
+                }
+            }
+        }
+
+        /**
+         * Ends the current phase and starts the next one. */
+        void lap(InstrumentedPhase phase)
+        {
+            if constexpr (OPEN_TRACK_IO_INSTRUMENTED)
+            {
+                if (m_instrumentation != nullptr)
+                {
+                    const auto now = std::chrono::steady_clock::now();
+                    const auto index = static_cast<std::size_t>(phase);
+                    m_measurement.durations[index] += static_cast<uint64_t>((now - m_lap).count());
+                    m_measurement.timed |= 1u << index;
+                    m_lap = now;
+                }
+            }
+        }
+
+        /**
+         * Remembers how many problems the diagnostics held before the parse, so that only its own are counted. */
+        void baseline(const Diagnostics& diagnostics)
+        {
+            if constexpr (OPEN_TRACK_IO_INSTRUMENTED)
+            {
+                m_errors = diagnostics.errorCount();
+                m_warnings = diagnostics.warningCount();
+            }
+        }
+
+        /**
+         * Stops the timer, returning the instrumentation to record the measurement in or nullptr if it wasn't
+         * running. */
+        Instrumentation* finish(const Diagnostics* diagnostics = nullptr)
+        {
+            if constexpr (OPEN_TRACK_IO_INSTRUMENTED)
+            {
+                Instrumentation* instrumentation = m_instrumentation;
+                if (instrumentation != nullptr)
+                {
+                    m_measurement.allocations = allocationCount() - m_allocations;
+                    if (diagnostics != nullptr)
+                    {
+                        m_measurement.errors = diagnostics->errorCount() - m_errors;
+                        m_measurement.warnings = diagnostics->warningCount() - m_warnings;
+                    }
+                    m_instrumentation = nullptr;
+                }
+                return instrumentation;
+            }
+            return nullptr;
+        }
+
+        PhaseMeasurement& measurement() { return m_measurement; };
+
+    private:
+        Instrumentation* m_instrumentation = nullptr;
+        std::chrono::steady_clock::time_point m_lap{};
+        PhaseMeasurement m_measurement{};
+        std::size_t m_allocations = 0;
+        std::size_t m_errors = 0;
+        std::size_t m_warnings = 0;
+    };
+} // namespace opentrackio
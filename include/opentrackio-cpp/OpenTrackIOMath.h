@@ -0,0 +1,228 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include "opentrackio-cpp/OpenTrackIOTypes.h"
+
+namespace opentrackio
+{
+    constexpr double degreesToRadians(double degrees) { return degrees * (std::numbers::pi / 180.0); }
+    constexpr double radiansToDegrees(double radians) { return radians * (180.0 / std::numbers::pi); }
+
+    /**
+     * The angle equal to angle modulo 360 that is closest to reference, so that angles taken back out of a rotation
+     * keep the cycles the samples were recorded with. */
+    inline double nearestAngle(double angle, double reference)
+    {
+        return angle + 360.0 * std::round((reference - angle) / 360.0);
+    }
+
+    inline opentrackiotypes::Vector3 lerp(const opentrackiotypes::Vector3& a, const opentrackiotypes::Vector3& b,
+                                          double t)
+    {
+        return {a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t};
+    }
+
+    /**
+     * A unit quaternion. Conversions to and from Rotation follow the OpenTrackIO convention, intrinsic rotations in
+     * degrees about Z, then X, then Y, that is pan, tilt and roll, so R = Rz(pan) * Rx(tilt) * Ry(roll). */
+    struct Quaternion
+    {
+        double w = 1;
+        double x = 0;
+        double y = 0;
+        double z = 0;
+
+        static Quaternion fromRotation(const opentrackiotypes::Rotation& rotation)
+        {
+            const double pan = degreesToRadians(rotation.pan) * 0.5;
+            const double tilt = degreesToRadians(rotation.tilt) * 0.5;
+            const double roll = degreesToRadians(rotation.roll) * 0.5;
+            const Quaternion qz{std::cos(pan), 0, 0, std::sin(pan)};
+            const Quaternion qx{std::cos(tilt), std::sin(tilt), 0, 0};
+            const Quaternion qy{std::cos(roll), 0, std::sin(roll), 0};
+            return qz * qx * qy;
+        }
+
+        /**
+         * Tilt comes back in [-90, 90] and pan and roll in (-180, 180], at gimbal lock roll is folded into pan. */
+        opentrackiotypes::Rotation toRotation() const
+        {
+            const double r01 = 2 * (x * y - w * z);
+            const double r11 = 1 - 2 * (x * x + z * z);
+            const double r20 = 2 * (x * z - w * y);
+            const double r21 = 2 * (y * z + w * x);
+            const double r22 = 1 - 2 * (x * x + y * y);
+
+            const double sinTilt = std::clamp(r21, -1.0, 1.0);
+            if (std::abs(sinTilt) < 1 - 1e-12)
+            {
+                return {radiansToDegrees(std::atan2(-r01, r11)), radiansToDegrees(std::asin(sinTilt)),
+                        radiansToDegrees(std::atan2(-r20, r22))};
+            }
+
+            const double r00 = 1 - 2 * (y * y + z * z);
+            const double r10 = 2 * (x * y + w * z);
+            return {radiansToDegrees(std::atan2(r10, r00)), sinTilt > 0 ? 90.0 : -90.0, 0.0};
+        }
+
+        Quaternion operator*(const Quaternion& o) const
+        {
+            return {w * o.w - x * o.x - y * o.y - z * o.z,
+                    w * o.x + x * o.w + y * o.z - z * o.y,
+                    w * o.y - x * o.z + y * o.w + z * o.x,
+                    w * o.z + x * o.y - y * o.x + z * o.w};
+        }
+
+        Quaternion conjugate() const { return {w, -x, -y, -z}; };
+        double dot(const Quaternion& o) const { return w * o.w + x * o.x + y * o.y + z * o.z; };
+
+        Quaternion normalised() const
+        {
+            const double length = std::sqrt(dot(*this));
+            return length > 0 ? Quaternion{w / length, x / length, y / length, z / length} : Quaternion{};
+        }
+
+        /**
+         * Rotates a vector by this quaternion. */
+        opentrackiotypes::Vector3 rotate(const opentrackiotypes::Vector3& v) const
+        {
+            const Quaternion p = *this * Quaternion{0, v.x, v.y, v.z} * conjugate();
+            return {p.x, p.y, p.z};
+        }
+    };
+
+    /**
+     * Spherical interpolation along the shorter arc. t outside [0, 1] extrapolates along the same arc at the same
+     * angular rate, nearly identical rotations fall back to a normalised lerp. */
+    inline Quaternion slerp(const Quaternion& a, const Quaternion& b, double t)
+    {
+        Quaternion end = b;
+        double cosTheta = a.dot(b);
+        if (cosTheta < 0)
+        {
+            end = {-b.w, -b.x, -b.y, -b.z};
+            cosTheta = -cosTheta;
+        }
+
+        double wa = 1 - t;
+        double wb = t;
+        if (cosTheta < 1 - 1e-9)
+        {
+            const double theta = std::acos(std::min(cosTheta, 1.0));
+            const double sinTheta = std::sin(theta);
+            wa = std::sin((1 - t) * theta) / sinTheta;
+            wb = std::sin(t * theta) / sinTheta;
+        }
+
+        return Quaternion{wa * a.w + wb * end.w, wa * a.x + wb * end.x, wa * a.y + wb * end.y,
+                          wa * a.z + wb * end.z}.normalised();
+    }
+
+    /**
+     * A row major 4x4 affine matrix acting on column vectors, so a point transforms as M * p and the translation
+     * sits in the last column. T is float or double. */
+    template<typename T>
+    struct Matrix4
+    {
+        std::array<T, 16> m{1, 0, 0, 0,
+                            0, 1, 0, 0,
+                            0, 0, 1, 0,
+                            0, 0, 0, 1};
+
+        T& operator()(std::size_t row, std::size_t column) { return m[row * 4 + column]; };
+        T operator()(std::size_t row, std::size_t column) const { return m[row * 4 + column]; };
+
+        /**
+         * The matrix translate * rotate * scale of an OpenTrackIO transform, a missing scale is taken as 1. */
+        static Matrix4 fromTransform(const opentrackiotypes::Transform& transform)
+        {
+            const Quaternion q = Quaternion::fromRotation(transform.rotation);
+            const auto scale = transform.scale.value_or(opentrackiotypes::Vector3{1, 1, 1});
+            const double xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+            const double xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+            const double wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+            Matrix4 out{};
+            out.m = {static_cast<T>((1 - 2 * (yy + zz)) * scale.x), static_cast<T>(2 * (xy - wz) * scale.y),
+                     static_cast<T>(2 * (xz + wy) * scale.z), static_cast<T>(transform.translation.x),
+                     static_cast<T>(2 * (xy + wz) * scale.x), static_cast<T>((1 - 2 * (xx + zz)) * scale.y),
+                     static_cast<T>(2 * (yz - wx) * scale.z), static_cast<T>(transform.translation.y),
+                     static_cast<T>(2 * (xz - wy) * scale.x), static_cast<T>(2 * (yz + wx) * scale.y),
+                     static_cast<T>((1 - 2 * (xx + yy)) * scale.z), static_cast<T>(transform.translation.z),
+                     0, 0, 0, 1};
+            return out;
+        }
+
+        Matrix4 operator*(const Matrix4& o) const
+        {
+            // Each output row is a sum of the rows of o scaled by this row, which compilers turn into vector code.
+            Matrix4 out{};
+            for (std::size_t row = 0; row < 4; ++row)
+            {
+                for (std::size_t column = 0; column < 4; ++column)
+                {
+                    out.m[row * 4 + column] = m[row * 4] * o.m[column] + m[row * 4 + 1] * o.m[4 + column] +
+                                              m[row * 4 + 2] * o.m[8 + column] + m[row * 4 + 3] * o.m[12 + column];
+                }
+            }
+            return out;
+        }
+
+        opentrackiotypes::Vector3 translation() const { return {m[3], m[7], m[11]}; };
+    };
+
+    using Matrix4f = Matrix4<float>;
+    using Matrix4d = Matrix4<double>;
+
+    /**
+     * A rigid transform as a unit dual quaternion, rotation first then translation. Dual quaternions cannot
+     * represent scale, which is dropped when converting from a transform. */
+    struct DualQuaternion
+    {
+        Quaternion real{};
+        Quaternion dual{0, 0, 0, 0};
+
+        static DualQuaternion fromTransform(const opentrackiotypes::Transform& transform)
+        {
+            const Quaternion rotation = Quaternion::fromRotation(transform.rotation);
+            const Quaternion t{0, transform.translation.x, transform.translation.y, transform.translation.z};
+            const Quaternion half = t * rotation;
+            return {rotation, {half.w * 0.5, half.x * 0.5, half.y * 0.5, half.z * 0.5}};
+        }
+
+        DualQuaternion operator*(const DualQuaternion& o) const
+        {
+            const Quaternion a = real * o.dual;
+            const Quaternion b = dual * o.real;
+            return {real * o.real, {a.w + b.w, a.x + b.x, a.y + b.y, a.z + b.z}};
+        }
+
+        opentrackiotypes::Vector3 translation() const
+        {
+            const Quaternion t = dual * real.conjugate();
+            return {2 * t.x, 2 * t.y, 2 * t.z};
+        }
+
+        opentrackiotypes::Vector3 transformPoint(const opentrackiotypes::Vector3& p) const
+        {
+            const auto rotated = real.rotate(p);
+            const auto t = translation();
+            return {rotated.x + t.x, rotated.y + t.y, rotated.z + t.z};
+        }
+    };
+} // namespace opentrackio
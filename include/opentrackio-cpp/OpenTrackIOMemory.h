@@ -0,0 +1,107 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace opentrackio
+{
+    /**
+     * The resource the strings and vectors of the property types allocate from when they are constructed on this
+     * thread, std::pmr::get_default_resource() unless a MemoryResourceScope is active. */
+    std::pmr::memory_resource* currentMemoryResource() noexcept;
+
+    /**
+     * How many allocations Allocator has made on this thread. Only counted when the library is built with
+     * instrumentation, see OpenTrackIOInstrumentation.h, otherwise always 0. */
+    std::size_t allocationCount() noexcept;
+    void countAllocation() noexcept;
+
+    /**
+     * Makes a resource current on this thread for as long as the scope lives, restoring the previous one after.
+     * Everything constructed meanwhile keeps allocating from it for its whole life, so constructing an
+     * OpenTrackIOSample inside a scope puts its tape and other buffers in the resource as well, and the resource
+     * then has to outlive the sample. */
+    class MemoryResourceScope
+    {
+    public:
+        explicit MemoryResourceScope(std::pmr::memory_resource* resource) noexcept;
+        ~MemoryResourceScope();
+        MemoryResourceScope(const MemoryResourceScope&) = delete;
+        MemoryResourceScope& operator=(const MemoryResourceScope&) = delete;
+
+    private:
+        std::pmr::memory_resource* m_previous;
+    };
+
+    /**
+     * A polymorphic allocator that a default constructed container binds to the current resource rather than the
+     * process wide default one. The property parsers construct their strings and vectors without passing an
+     * allocator, so this is what lets OpenTrackIOSample::initialise hand them a resource. Like
+     * std::pmr::polymorphic_allocator it sticks to the container that was constructed with it, a copy constructed
+     * container takes the current resource and an assigned one keeps its own. */
+    template<typename T>
+    class Allocator
+    {
+    public:
+        using value_type = T;
+
+        Allocator() noexcept : m_resource{currentMemoryResource()} {};
+        Allocator(std::pmr::memory_resource* resource) noexcept : m_resource{resource} {};
+
+        template<typename U>
+        Allocator(const Allocator<U>& other) noexcept : m_resource{other.resource()} {};
+
+        T* allocate(std::size_t n)
+        {
+#if defined(OPEN_TRACK_IO_INSTRUMENTATION)
+            countAllocation();
+#endif
+            return static_cast<T*>(m_resource->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* ptr, std::size_t n) noexcept
+        {
+            m_resource->deallocate(ptr, n * sizeof(T), alignof(T));
+        }
+
+        Allocator select_on_container_copy_construction() const noexcept { return {}; };
+        std::pmr::memory_resource* resource() const noexcept { return m_resource; };
+
+        template<typename U>
+        bool operator==(const Allocator<U>& other) const noexcept
+        {
+            return *m_resource == *other.resource();
+        }
+
+    private:
+        std::pmr::memory_resource* m_resource;
+    };
+
+    using String = std::basic_string<char, std::char_traits<char>, Allocator<char>>;
+
+    template<typename T>
+    using Vector = std::vector<T, Allocator<T>>;
+
+    /**
+     * Strings compare by value whatever they allocate from, found by argument dependent lookup through Allocator. */
+    inline bool operator==(const String& a, const std::string& b) noexcept
+    {
+        return std::string_view{a} == std::string_view{b};
+    }
+} // namespace opentrackio
@@ -0,0 +1,173 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace opentrackio
+{
+    enum class PacketEncoding : uint8_t
+    {
+        JSON = 0x01,
+        CBOR = 0x02
+    };
+
+    enum class PacketStatus : uint8_t
+    {
+        OK,
+        INCOMPLETE,
+        TOO_SHORT,
+        INVALID_IDENTIFIER,
+        UNSUPPORTED_ENCODING,
+        INVALID_LENGTH,
+        CHECKSUM_MISMATCH,
+        DUPLICATE_SEGMENT,
+        INCONSISTENT_SEGMENT,
+        BUFFER_TOO_SMALL,
+        TOO_MANY_SEGMENTS
+    };
+
+    /**
+     * The 16 byte header at the start of every OpenTrackIO datagram, all fields are big endian.
+     *  Identifier: "OTrk"
+     *  Reserved: 1 byte
+     *  Encoding: 1 byte, see PacketEncoding
+     *  Sequence number: 2 bytes, shared by every segment of a payload
+     *  Segment offset: 4 bytes, byte offset of this segment in the whole payload
+     *  Last segment flag and payload length: 1 bit flag followed by the 15 bit length of this segment
+     *  Checksum: 2 byte Fletcher-16 of the header up to the checksum followed by the segment */
+    struct PacketHeader
+    {
+        static constexpr std::size_t SIZE = 16;
+        static constexpr std::size_t MAX_SEGMENT_SIZE = 0x7FFF;
+        static constexpr std::array<uint8_t, 4> IDENTIFIER{'O', 'T', 'r', 'k'};
+
+        PacketEncoding encoding = PacketEncoding::CBOR;
+        uint16_t sequenceNumber = 0;
+        uint32_t segmentOffset = 0;
+        bool lastSegment = true;
+        uint16_t payloadLength = 0;
+        uint16_t checksum = 0;
+
+        /**
+         * Writes the header for the given segment into out, filling in its payload length and checksum. */
+        void write(std::span<const uint8_t> segment, std::span<uint8_t, SIZE> out);
+    };
+
+    /**
+     * A validated datagram, the payload points into the datagram it was parsed from rather than a copy of it. */
+    struct Packet
+    {
+        PacketHeader header{};
+        std::span<const uint8_t> payload{};
+
+        /**
+         * Checks the identifier, encoding, length and checksum of a received datagram. Bytes after the segment are
+         * ignored, as some senders pad their datagrams. */
+        static PacketStatus parse(std::span<const uint8_t> datagram, Packet& out);
+    };
+
+    /**
+     * A whole payload ready to be handed to OpenTrackIOSample::initialise. */
+    struct PacketPayload
+    {
+        PacketEncoding encoding = PacketEncoding::CBOR;
+        uint16_t sequenceNumber = 0;
+        std::span<const uint8_t> data{};
+    };
+
+    /**
+     * Reassembles segmented payloads into a caller owned buffer. Segments may arrive in any order, a payload that
+     * wasn't segmented is passed straight through without being copied. Only one payload is assembled at a time,
+     * a segment with a new sequence number abandons the one in progress. */
+    class PacketAssembler
+    {
+    public:
+        static constexpr std::size_t MAX_SEGMENTS = 256;
+
+        explicit PacketAssembler(std::span<uint8_t> buffer) : m_buffer{buffer} {};
+
+        /**
+         * Returns OK and sets out once the packet completes a payload, INCOMPLETE while segments are still missing
+         * or the reason the packet was rejected. The payload stays valid until the next call, or for as long as
+         * the datagram lives if it wasn't segmented. A rejected segment abandons its payload, apart from a
+         * duplicate which is ignored. */
+        PacketStatus add(const Packet& packet, PacketPayload& out);
+        void clear();
+
+        /**
+         * Number of payloads that were abandoned before all of their segments arrived. */
+        std::size_t abandoned() const { return m_abandoned; };
+
+    private:
+        struct Segment
+        {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+        };
+
+        void begin(const PacketHeader& header);
+        void abandon();
+
+        std::span<uint8_t> m_buffer{};
+        std::array<Segment, MAX_SEGMENTS> m_segments{};
+        std::size_t m_segmentCount = 0;
+        std::size_t m_received = 0;
+        std::size_t m_total = 0;
+        std::size_t m_abandoned = 0;
+        PacketEncoding m_encoding = PacketEncoding::CBOR;
+        uint16_t m_sequenceNumber = 0;
+        bool m_active = false;
+        bool m_lastSeen = false;
+    };
+
+    /**
+     * Splits a payload into segments of at most maxSegmentSize bytes and calls sink(header, segment) for each one
+     * in order. The header is written into a small internal buffer and the segment points into the payload, so
+     * a sink that gathers both into one datagram, e.g. with sendmsg, never copies the payload. Returns false
+     * without calling the sink if the payload can't be addressed by the 32 bit segment offset. */
+    template<typename Sink>
+    bool writePackets(std::span<const uint8_t> payload, PacketEncoding encoding, uint16_t sequenceNumber,
+                      std::size_t maxSegmentSize, Sink&& sink)
+    {
+        maxSegmentSize = std::clamp<std::size_t>(maxSegmentSize, 1, PacketHeader::MAX_SEGMENT_SIZE);
+        if (payload.size() > std::numeric_limits<uint32_t>::max())
+        {
+            return false;
+        }
+
+        std::array<uint8_t, PacketHeader::SIZE> headerBytes{};
+        std::size_t offset = 0;
+        do
+        {
+            const auto length = std::min(maxSegmentSize, payload.size() - offset);
+            const auto segment = payload.subspan(offset, length);
+
+            PacketHeader header{};
+            header.encoding = encoding;
+            header.sequenceNumber = sequenceNumber;
+            header.segmentOffset = static_cast<uint32_t>(offset);
+            header.lastSegment = offset + length == payload.size();
+            header.write(segment, headerBytes);
+
+            sink(std::span<const uint8_t>{headerBytes}, segment);
+            offset += length;
+        } while (offset < payload.size());
+        return true;
+    }
+} // namespace opentrackio
@@ -0,0 +1,200 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "OpenTrackIOSample.h"
+#include "OpenTrackIOSnapshot.h"
+
+namespace opentrackio
+{
+    /**
+     * Where a property is found in a sample, under its own key and, for properties with static fields, under its
+     * key in the static block. */
+    template<typename P>
+    struct PropertyKeys;
+
+#define OPEN_TRACK_IO_PROPERTY_KEYS(Property, Key, StaticKey) \
+    template<> \
+    struct PropertyKeys<opentrackioproperties::Property> \
+    { \
+        static constexpr std::string_view key = Key; \
+        static constexpr std::string_view staticKey = StaticKey; \
+    };
+
+    OPEN_TRACK_IO_PROPERTY_KEYS(Camera, "", "camera")
+    OPEN_TRACK_IO_PROPERTY_KEYS(Duration, "", "duration")
+    OPEN_TRACK_IO_PROPERTY_KEYS(GlobalStage, "globalStage", "")
+    OPEN_TRACK_IO_PROPERTY_KEYS(Lens, "lens", "lens")
+    OPEN_TRACK_IO_PROPERTY_KEYS(Protocol, "protocol", "")
+    OPEN_TRACK_IO_PROPERTY_KEYS(RelatedSampleIds, "relatedSampleIds", "")
+    OPEN_TRACK_IO_PROPERTY_KEYS(SampleId, "sampleId", "")
+    OPEN_TRACK_IO_PROPERTY_KEYS(SourceId, "sourceId", "")
+    OPEN_TRACK_IO_PROPERTY_KEYS(SourceNumber, "sourceNumber", "")
+    OPEN_TRACK_IO_PROPERTY_KEYS(Timing, "timing", "")
+    OPEN_TRACK_IO_PROPERTY_KEYS(Tracker, "tracker", "tracker")
+    OPEN_TRACK_IO_PROPERTY_KEYS(Transforms, "transforms", "")
+#undef OPEN_TRACK_IO_PROPERTY_KEYS
+
+    template<typename P>
+    concept SampleProperty = requires { PropertyKeys<P>::key; };
+
+    template<typename P, typename... Props>
+    inline constexpr bool includesProperty = (std::is_same_v<P, Props> || ...);
+
+    template<typename P, typename... Props>
+    using PropertySlot = std::conditional_t<includesProperty<P, Props...>, std::optional<P>,
+                                            opentrackioproperties::Excluded<P>>;
+
+    /**
+     * A sample that only carries and parses the properties it is instantiated with, for consumers that only need a
+     * few of them, such as a render node that reads the transforms, lens and timing:
+     *
+     *     using RenderSample = BasicOpenTrackIOSample<opentrackioproperties::Lens, opentrackioproperties::Timing,
+     *                                                 opentrackioproperties::Transforms>;
+     *
+     * Every property keeps its member name. A property that is left out is an opentrackioproperties::Excluded,
+     * which takes no space and never has a value, so code that reads it through propertyOf() compiles for any
+     * profile and anything else fails to compile. The parsers of excluded properties are never instantiated, their
+     * keys are only marked as consumed so that they aren't reported as leftover fields.
+     *
+     * It parses exactly as OpenTrackIOSample does, static fields included, and honours structuredDiagnostics,
+     * collectWarnings and snapshot from ParseOptions. Retaining or generating JSON, serialising, the static cache,
+     * memory resources and instrumentation need the full OpenTrackIOSample. Like it, a sample that is reset and
+     * initialised again refills its properties in place. */
+    template<SampleProperty... Props>
+    struct BasicOpenTrackIOSample
+    {
+        [[no_unique_address]] PropertySlot<opentrackioproperties::Camera, Props...> camera{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::Duration, Props...> duration{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::GlobalStage, Props...> globalStage{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::Lens, Props...> lens{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::Protocol, Props...> protocol{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::RelatedSampleIds, Props...> relatedSampleIds{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::SampleId, Props...> sampleId{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::SourceId, Props...> sourceId{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::SourceNumber, Props...> sourceNumber{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::Timing, Props...> timing{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::Tracker, Props...> tracker{};
+        [[no_unique_address]] PropertySlot<opentrackioproperties::Transforms, Props...> transforms{};
+
+        template<typename P>
+        static constexpr bool includes = includesProperty<P, Props...>;
+
+        bool initialise(const nlohmann::json& json, const ParseOptions& options = {})
+        {
+            parseProperties(json, options);
+            return true;
+        }
+
+        bool initialise(std::string_view jsonString, const ParseOptions& options = {})
+        {
+            m_tape.parseJson(jsonString);
+            parseProperties(m_tape.root(), options);
+            return true;
+        }
+
+        bool initialise(std::span<const uint8_t> cbor, const ParseOptions& options = {})
+        {
+            m_tape.parseCbor(cbor);
+            parseProperties(m_tape.root(), options);
+            return true;
+        }
+
+        bool initialise(const PacketPayload& payload, const ParseOptions& options = {})
+        {
+            if (payload.encoding == PacketEncoding::JSON)
+            {
+                const std::string_view text{reinterpret_cast<const char*>(payload.data.data()), payload.data.size()};
+                return initialise(text, options);
+            }
+            return initialise(payload.data, options);
+        }
+
+        void reset()
+        {
+            m_tape.clear();
+            m_consumedFields.clear();
+            m_diagnostics.clear();
+        }
+
+        const std::vector<std::string>& getErrors() { return m_diagnostics.errors(); };
+        const std::vector<std::string>& getWarnings() { return m_diagnostics.warnings(); };
+        const Diagnostics& getDiagnostics() const { return m_diagnostics; };
+
+    private:
+        template<typename P, JsonNode Json>
+        void parseProperty(const Json& json, ParseContext& ctx, PropertySlot<P, Props...>& slot)
+        {
+            if constexpr (includes<P>)
+            {
+                P::parse(json, ctx, slot);
+            }
+            else
+            {
+                constexpr auto key = PropertyKeys<P>::key;
+                constexpr auto staticKey = PropertyKeys<P>::staticKey;
+                if (!key.empty() && json.contains(key))
+                {
+                    ctx.consumed.consume(json[key]);
+                }
+                if (!staticKey.empty() && json.contains("static") && json["static"].contains(staticKey))
+                {
+                    ctx.consumed.consume(json["static"][staticKey]);
+                }
+            }
+        }
+
+        template<JsonNode Json>
+        void parseProperties(const Json& json, const ParseOptions& options)
+        {
+            m_consumedFields.clear();
+            m_diagnostics.configure(options.structuredDiagnostics, options.collectWarnings);
+            ParseContext ctx{m_diagnostics, m_consumedFields};
+
+            parseProperty<opentrackioproperties::Camera>(json, ctx, camera);
+            parseProperty<opentrackioproperties::Duration>(json, ctx, duration);
+            parseProperty<opentrackioproperties::GlobalStage>(json, ctx, globalStage);
+            parseProperty<opentrackioproperties::Lens>(json, ctx, lens);
+            parseProperty<opentrackioproperties::Protocol>(json, ctx, protocol);
+            parseProperty<opentrackioproperties::RelatedSampleIds>(json, ctx, relatedSampleIds);
+            parseProperty<opentrackioproperties::SampleId>(json, ctx, sampleId);
+            parseProperty<opentrackioproperties::SourceId>(json, ctx, sourceId);
+            parseProperty<opentrackioproperties::SourceNumber>(json, ctx, sourceNumber);
+            parseProperty<opentrackioproperties::Timing>(json, ctx, timing);
+            parseProperty<opentrackioproperties::Tracker>(json, ctx, tracker);
+            parseProperty<opentrackioproperties::Transforms>(json, ctx, transforms);
+
+            if (options.collectWarnings)
+            {
+                OpenTrackIOHelpers::warnForRemainingFields(json, ctx);
+            }
+
+            if (options.snapshot != nullptr)
+            {
+                options.snapshot->capture(*this);
+            }
+        }
+
+        SampleTape m_tape{};
+        ConsumedFields m_consumedFields{};
+        Diagnostics m_diagnostics{};
+    };
+} // namespace opentrackio
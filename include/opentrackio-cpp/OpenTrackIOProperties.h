@@ -17,9 +17,15 @@
 #include <optional>
 #include <nlohmann/json.hpp>
 #include "OpenTrackIOTypes.h"
+#include "OpenTrackIOSchema.h"
+#include "OpenTrackIOValidators.h"
 
 namespace opentrackio::opentrackioproperties
 {
+    /**
+     * Every property parses into an optional owned by the caller rather than returning a new one. A value left in it
+     * by a previous parse is overwritten in place, so its strings and vectors keep their capacity, and it is reset to
+     * std::nullopt if the document doesn't contain the property or it fails to parse. */
     struct Camera
     {
         /**
@@ -40,23 +46,23 @@ namespace opentrackio::opentrackioproperties
 
         /**
          * Non-blank string identifying camera firmware version. */
-        std::optional<std::string> firmwareVersion = std::nullopt;
+        std::optional<String> firmwareVersion = std::nullopt;
 
         /**
          * Non-blank string containing user-determined camera identifier. */
-        std::optional<std::string> label = std::nullopt;
+        std::optional<String> label = std::nullopt;
 
         /**
          * Non-blank string naming camera manufacturer. */
-        std::optional<std::string> make = std::nullopt;
+        std::optional<String> make = std::nullopt;
 
         /**
          * Non-blank string identifying camera model. */
-        std::optional<std::string> model = std::nullopt;
+        std::optional<String> model = std::nullopt;
 
         /**
          * Non-blank string uniquely identifying the camera.*/
-        std::optional<std::string> serialNumber = std::nullopt;
+        std::optional<String> serialNumber = std::nullopt;
 
         /**
          * Capture frame rate of the camera
@@ -66,7 +72,7 @@ namespace opentrackio::opentrackioproperties
         /**
          * URN identifying the ASC Framing Decision List used by the camera.
          * Pattern: ^urn:uuid:[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}$ */
-        std::optional<std::string> fdlLink = std::nullopt;
+        std::optional<opentrackiotypes::UrnUuid> fdlLink = std::nullopt;
 
         /**
          * Arithmetic ISO scale as defined in ISO 12232 */
@@ -78,7 +84,10 @@ namespace opentrackio::opentrackioproperties
          * Units: Degree */
         std::optional<double> shutterAngle = std::nullopt;
 
-        static std::optional<Camera> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<Camera>& out);
+
+        bool operator==(const Camera&) const = default;
     };
 
     /** Duration of the clip.
@@ -87,7 +96,10 @@ namespace opentrackio::opentrackioproperties
     {
         opentrackiotypes::Rational rational{};
         
-        static std::optional<Duration> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<Duration>& out);
+
+        bool operator==(const Duration&) const = default;
     };
 
     /**
@@ -103,7 +115,10 @@ namespace opentrackio::opentrackioproperties
         double lon0;
         double h0;
 
-        static std::optional<GlobalStage> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<GlobalStage>& out);
+
+        bool operator==(const GlobalStage&) const = default;
     };
 
     struct Lens
@@ -111,7 +126,7 @@ namespace opentrackio::opentrackioproperties
         /**
          * Until the OpenLensIO model is finalised, this list provides custom
          * coefficients for a particular lens model e.g. undistortion, anamorphic etc. */
-        std::optional<std::vector<double>> custom = std::nullopt;
+        std::optional<Vector<double>> custom = std::nullopt;
 
         /**
          * Coefficients for calculating the distortion characteristics of a lens
@@ -119,8 +134,10 @@ namespace opentrackio::opentrackioproperties
          * and the tangential distortion (p1-N). */
         struct Distortion
         {
-            std::vector<double> radial{};
-            std::optional<std::vector<double>> tangential = std::nullopt;            
+            Vector<double> radial{};
+            std::optional<Vector<double>> tangential = std::nullopt;            
+
+            bool operator==(const Distortion&) const = default;
         };
         std::optional<Distortion> distortion = std::nullopt;
 
@@ -139,6 +156,8 @@ namespace opentrackio::opentrackioproperties
         {
             double x;
             double y;
+
+            bool operator==(const DistortionShift&) const = default;
         };
         std::optional<DistortionShift> distortionShift = std::nullopt;
 
@@ -155,6 +174,8 @@ namespace opentrackio::opentrackioproperties
             std::optional<double> focus = std::nullopt;
             std::optional<double> iris = std::nullopt;
             std::optional<double> zoom = std::nullopt;            
+
+            bool operator==(const Encoders&) const = default;
         };
         std::optional<Encoders> encoders = std::nullopt;
         
@@ -170,6 +191,8 @@ namespace opentrackio::opentrackioproperties
             double a1;
             std::optional<double> a2 = std::nullopt;
             std::optional<double> a3 = std::nullopt;            
+
+            bool operator==(const ExposureFalloff&) const = default;
         };
         std::optional<ExposureFalloff> exposureFalloff = std::nullopt;
 
@@ -179,7 +202,7 @@ namespace opentrackio::opentrackioproperties
      
         /**
          * Non-blank string identifying lens firmware version. */
-        std::optional<std::string> firmwareVersion = std::nullopt;
+        std::optional<String> firmwareVersion = std::nullopt;
 
         /**
          * Focal length of the lens
@@ -193,11 +216,11 @@ namespace opentrackio::opentrackioproperties
 
         /**
          * Non-blank string naming lens manufacturer. */
-        std::optional<std::string> make = std::nullopt;
+        std::optional<String> make = std::nullopt;
 
         /**
          * Non-blank string identifying lens model. */
-        std::optional<std::string> model = std::nullopt;
+        std::optional<String> model = std::nullopt;
 
         /**
          * Nominal focal length of the lens.
@@ -211,6 +234,8 @@ namespace opentrackio::opentrackioproperties
          {
              double x;
              double y;
+
+             bool operator==(const PerspectiveShift&) const = default;
          };
         std::optional<PerspectiveShift> perspectiveShift = std::nullopt;
 
@@ -222,12 +247,14 @@ namespace opentrackio::opentrackioproperties
             std::optional<uint16_t> focus = std::nullopt;
             std::optional<uint16_t> iris = std::nullopt;
             std::optional<uint16_t> zoom = std::nullopt;
+
+            bool operator==(const RawEncoders&) const = default;
         };
         std::optional<RawEncoders> rawEncoders = std::nullopt;
 
         /**
          * Non-blank string uniquely identifying the lens.*/
-        std::optional<std::string> serialNumber = std::nullopt;        
+        std::optional<String> serialNumber = std::nullopt;        
         
         /**
          * The linear t-number of the lens, equal to the F-number of the lens divided by the square root of the
@@ -239,25 +266,37 @@ namespace opentrackio::opentrackioproperties
          * coefficients of the spherical distortion (k1-N) and the tangential distortion (p1-N) */
         struct Undistortion
         {
-            std::vector<double> radial{};
-            std::optional<std::vector<double>> tangential = std::nullopt;
+            Vector<double> radial{};
+            std::optional<Vector<double>> tangential = std::nullopt;
+
+            bool operator==(const Undistortion&) const = default;
         };
         std::optional<Undistortion> undistortion = std::nullopt;
 
-        static std::optional<Lens> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<Lens>& out);
+        
+        bool operator==(const Lens&) const = default;
+
+    private:
+        template<JsonNode Json, typename Coefficients>
+        static void parseCoefficients(const Json& json, ParseContext& ctx, std::optional<Coefficients>& out);
     };
     
     struct Protocol
     {
         /**
          * Name of the protocol in which the sample is being employed, and version of that protocol. */
-        std::string name;
+        String name;
         
         /**
          * Pattern: ^[0-9]+.[0-9]+.[0-9]+$ */
-        std::string version;
+        String version;
 
-        static std::optional<Protocol> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<Protocol>& out);
+
+        bool operator==(const Protocol&) const = default;
     };
 
     struct RelatedSampleIds
@@ -267,9 +306,12 @@ namespace opentrackio::opentrackioproperties
          * E.g. a related performance capture sample or a sample of static data from the same device.
          * The existence of the related sample should not be relied upon.
          * Pattern: ^urn:uuid:[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}$ */
-        std::vector<std::string> samples;
+        Vector<opentrackiotypes::UrnUuid> samples;
+
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<RelatedSampleIds>& out);
 
-        static std::optional<RelatedSampleIds> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        bool operator==(const RelatedSampleIds&) const = default;
     };
 
     struct SampleId
@@ -277,9 +319,12 @@ namespace opentrackio::opentrackioproperties
         /**
          * URN serving as unique identifier of the sample in which data is being transported.
          * Pattern: ^urn:uuid:[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}$ */
-        std::string id;
+        opentrackiotypes::UrnUuid id{};
+
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<SampleId>& out);
 
-        static std::optional<SampleId> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        bool operator==(const SampleId&) const = default;
     };
     
     struct SourceId
@@ -287,9 +332,12 @@ namespace opentrackio::opentrackioproperties
         /**
          * URN serving as unique identifier of the source from which data is being transported.
          * pattern: ^urn:uuid:[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}$ */
-        std::string id;
+        opentrackiotypes::UrnUuid id{};
 
-        static std::optional<SourceId> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<SourceId>& out);
+
+        bool operator==(const SourceId&) const = default;
     };
 
     struct SourceNumber
@@ -299,7 +347,10 @@ namespace opentrackio::opentrackioproperties
          * This is most important in the case where a source is producing multiple streams of samples. */
         uint32_t value;
 
-        static std::optional<SourceNumber> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<SourceNumber>& out);
+
+        bool operator==(const SourceNumber&) const = default;
     };
 
     struct Timing
@@ -367,6 +418,8 @@ namespace opentrackio::opentrackioproperties
                 std::optional<double> translation = std::nullopt;
                 std::optional<double> rotation = std::nullopt;
                 std::optional<double> lensEncoders = std::nullopt;
+
+                bool operator==(const Offsets&) const = default;
             };
             std::optional<Offsets> offsets = std::nullopt;
             
@@ -374,9 +427,11 @@ namespace opentrackio::opentrackioproperties
             
             struct Ptp 
             {
-                std::optional<std::string> master = std::nullopt;
+                std::optional<String> master = std::nullopt;
                 std::optional<double> offset = std::nullopt;
                 std::optional<uint16_t> domain = std::nullopt;                
+
+                bool operator==(const Ptp&) const = default;
             };
             std::optional<Ptp> ptp = std::nullopt;
 
@@ -388,6 +443,8 @@ namespace opentrackio::opentrackioproperties
                 NTP
             };
             SourceType source;
+
+            bool operator==(const Synchronization&) const = default;
         };
         std::optional<Synchronization> synchronization = std::nullopt;
         
@@ -400,29 +457,33 @@ namespace opentrackio::opentrackioproperties
          *                      as e.g. 30000/1001. Note the timecode frame rate may differ from the sample frequency */
         std::optional<opentrackiotypes::Timecode> timecode = std::nullopt;
 
-        static std::optional<Timing> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<Timing>& out);
         
+        bool operator==(const Timing&) const = default;
+
     private:
-        static std::optional<Synchronization> parseSynchronization(nlohmann::json& json, std::vector<std::string>& errors);
+        template<JsonNode Json>
+        static void parseSynchronization(const Json& json, ParseContext& ctx, std::optional<Synchronization>& out);
     };
 
     struct Tracker
     {
         /**
          * 	Non-blank string identifying tracking device firmware version. */
-        std::optional<std::string> firmwareVersion = std::nullopt;
+        std::optional<String> firmwareVersion = std::nullopt;
 
         /**
         * Non-blank string naming tracking device manufacturer. */
-        std::optional<std::string> make = std::nullopt;
+        std::optional<String> make = std::nullopt;
 
         /**
          * Non-blank string identifying tracking device model. */
-        std::optional<std::string> model = std::nullopt;
+        std::optional<String> model = std::nullopt;
 
         /**
          * Non-blank string containing notes about tracking system. */
-        std::optional<std::string> notes = std::nullopt;
+        std::optional<String> notes = std::nullopt;
 
         /**
          * Boolean indicating whether tracking system is recording data. */
@@ -430,17 +491,20 @@ namespace opentrackio::opentrackioproperties
 
         /**
          * Non-blank string uniquely identifying the tracking device.*/
-        std::optional<std::string> serialNumber = std::nullopt;
+        std::optional<String> serialNumber = std::nullopt;
 
         /**
          * Non-blank string describing the recording slate. */
-        std::optional<std::string> slate = std::nullopt;
+        std::optional<String> slate = std::nullopt;
 
         /**
          * Non-blank string describing status of tracking system. */
-        std::optional<std::string> status = std::nullopt;
+        std::optional<String> status = std::nullopt;
+
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<Tracker>& out);
 
-        static std::optional<Tracker> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        bool operator==(const Tracker&) const = default;
     };    
 
     /**
@@ -459,8 +523,85 @@ namespace opentrackio::opentrackioproperties
      * Conversion to and from quarternions is trivial with an acceptable loss of precision */
     struct Transforms
     {
-        std::vector<opentrackiotypes::Transform> transforms{};
+        Vector<opentrackiotypes::Transform> transforms{};
+
+        template<JsonNode Json>
+        static void parse(const Json& json, ParseContext& ctx, std::optional<Transforms>& out);
 
-        static std::optional<Transforms> parse(nlohmann::json& json, std::vector<std::string>& errors);
+        bool operator==(const Transforms&) const = default;
     };
+
+    /**
+     * Takes the place of a property a BasicOpenTrackIOSample leaves out. It is empty and never has a value, so a
+     * member of this type takes up no space, and code that reads properties through propertyOf() compiles for both. */
+    template<typename P>
+    struct Excluded
+    {
+        constexpr bool has_value() const noexcept { return false; };
+    };
+
+    template<typename P>
+    constexpr const P* propertyOf(const std::optional<P>& property) noexcept
+    {
+        return property.has_value() ? &property.value() : nullptr;
+    }
+
+    template<typename P>
+    constexpr const P* propertyOf(const Excluded<P>&) noexcept
+    {
+        return nullptr;
+    }
 } // namespace opentrackio::opentrackioproperties
+
+namespace opentrackio::schema
+{
+    template<>
+    struct Descriptor<opentrackioproperties::Camera>
+    {
+        using C = opentrackioproperties::Camera;
+        using fields = Fields<
+                Field<"activeSensorPhysicalDimensions", &C::activeSensorPhysicalDimensions, "object", Scope::STATIC>,
+                Field<"activeSensorResolution", &C::activeSensorResolution, "object", Scope::STATIC>,
+                Field<"anamorphicSqueeze", &C::anamorphicSqueeze, "object", Scope::STATIC>,
+                Field<"captureFrameRate", &C::captureFrameRate, "object", Scope::STATIC>,
+                Field<"fdlLink", &C::fdlLink, "string", Scope::STATIC>,
+                Field<"firmwareVersion", &C::firmwareVersion, "string", Scope::STATIC>,
+                Field<"isoSpeed", &C::isoSpeed, "integer", Scope::STATIC>,
+                Field<"label", &C::label, "string", Scope::STATIC>,
+                Field<"make", &C::make, "string", Scope::STATIC>,
+                Field<"model", &C::model, "string", Scope::STATIC>,
+                Field<"serialNumber", &C::serialNumber, "string", Scope::STATIC>,
+                Field<"shutterAngle", &C::shutterAngle, "double", Scope::STATIC>>;
+    };
+
+    /**
+     * Only the static lens fields are described, the per sample ones are mostly nested objects with their own
+     * rules and are parsed by hand. */
+    template<>
+    struct Descriptor<opentrackioproperties::Lens>
+    {
+        using L = opentrackioproperties::Lens;
+        using fields = Fields<
+                Field<"distortionOverscanMax", &L::distortionOverscanMax, "double", Scope::STATIC>,
+                Field<"firmwareVersion", &L::firmwareVersion, "string", Scope::STATIC>,
+                Field<"make", &L::make, "string", Scope::STATIC>,
+                Field<"model", &L::model, "string", Scope::STATIC>,
+                Field<"nominalFocalLength", &L::nominalFocalLength, "double", Scope::STATIC>,
+                Field<"serialNumber", &L::serialNumber, "string", Scope::STATIC>>;
+    };
+
+    template<>
+    struct Descriptor<opentrackioproperties::Tracker>
+    {
+        using T = opentrackioproperties::Tracker;
+        using fields = Fields<
+                Field<"firmwareVersion", &T::firmwareVersion, "string", Scope::STATIC>,
+                Field<"make", &T::make, "string", Scope::STATIC>,
+                Field<"model", &T::model, "string", Scope::STATIC>,
+                Field<"serialNumber", &T::serialNumber, "string", Scope::STATIC>,
+                Field<"notes", &T::notes, "string">,
+                Field<"recording", &T::recording, "boolean">,
+                Field<"slate", &T::slate, "string">,
+                Field<"status", &T::status, "string">>;
+    };
+} // namespace opentrackio::schema
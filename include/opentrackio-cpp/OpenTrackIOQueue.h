@@ -0,0 +1,246 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+
+namespace opentrackio
+{
+    /**
+     * Keeps the indices written by producers and consumers on separate cache lines. */
+    constexpr std::size_t OPEN_TRACK_IO_CACHE_LINE = 64;
+
+    /**
+     * A bounded single producer, single consumer ring of pre-allocated values. The producer fills a slot in place,
+     * typically by resetting and initialising the sample already in it, and publishes it with a release store. The
+     * consumer reads the slot where it lies and pops it, which hands every string and vector back to the producer
+     * with its capacity intact, so after the first lap neither thread allocates and neither ever blocks. Capacity
+     * is rounded up to a power of two. */
+    template<typename T = OpenTrackIOSample>
+    class SpscQueue
+    {
+    public:
+        explicit SpscQueue(std::size_t capacity) : m_slots(std::bit_ceil(capacity < 2 ? 2 : capacity)),
+                                                   m_mask{m_slots.size() - 1} {};
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        /**
+         * Producer side. Returns the slot to fill, or nullptr if the queue is full. Nothing is visible to the
+         * consumer until commit(), a slot that is never committed is simply handed out again. */
+        T* claim()
+        {
+            const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_cachedHead == m_slots.size())
+            {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (tail - m_cachedHead == m_slots.size())
+                {
+                    return nullptr;
+                }
+            }
+            return &m_slots[tail & m_mask];
+        }
+
+        void commit()
+        {
+            m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /**
+         * Claims a slot, calls fill(T&) on it and commits it if fill returns true. Returns false if the queue was
+         * full or fill rejected the value. */
+        template<typename Fill>
+        bool push(Fill&& fill)
+        {
+            T* slot = claim();
+            if (slot == nullptr || !fill(*slot))
+            {
+                return false;
+            }
+            commit();
+            return true;
+        }
+
+        /**
+         * Consumer side. Returns the oldest published value, or nullptr if the queue is empty. The value belongs to
+         * the consumer until pop(). */
+        T* front()
+        {
+            const std::size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_cachedTail)
+            {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+                if (head == m_cachedTail)
+                {
+                    return nullptr;
+                }
+            }
+            return &m_slots[head & m_mask];
+        }
+
+        void pop()
+        {
+            m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        std::size_t capacity() const { return m_slots.size(); };
+
+    private:
+        std::vector<T> m_slots;
+        const std::size_t m_mask;
+
+        alignas(OPEN_TRACK_IO_CACHE_LINE) std::atomic<std::size_t> m_head{0};
+        std::size_t m_cachedTail = 0;
+
+        alignas(OPEN_TRACK_IO_CACHE_LINE) std::atomic<std::size_t> m_tail{0};
+        std::size_t m_cachedHead = 0;
+    };
+
+    /**
+     * A bounded multiple producer, single consumer ring of pre-allocated values. Each slot carries a sequence
+     * number, producers take slots by advancing a shared ticket and publish them by storing the sequence, so a
+     * producer only ever contends on the ticket and never waits on another producer's parse. Slots are consumed in
+     * ticket order, so a producer that has claimed a slot must always publish it, passing keep as false if it has
+     * nothing to deliver, the consumer then skips it. */
+    template<typename T = OpenTrackIOSample>
+    class MpscQueue
+    {
+    public:
+        explicit MpscQueue(std::size_t capacity) : m_capacity{std::bit_ceil(capacity < 2 ? 2 : capacity)},
+                                                   m_mask{m_capacity - 1},
+                                                   m_slots{std::make_unique<Slot[]>(m_capacity)}
+        {
+            for (std::size_t i = 0; i < m_capacity; ++i)
+            {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        };
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        /**
+         * Producer side, safe to call from any number of threads. Returns the slot to fill and sets ticket, or
+         * returns nullptr if the queue is full. */
+        T* claim(std::size_t& ticket)
+        {
+            std::size_t position = m_tail.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Slot& slot = m_slots[position & m_mask];
+                const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+                if (difference == 0)
+                {
+                    if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        ticket = position;
+                        return &slot.value;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return nullptr;
+                }
+                else
+                {
+                    position = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void publish(std::size_t ticket, bool keep = true)
+        {
+            Slot& slot = m_slots[ticket & m_mask];
+            slot.keep = keep;
+            slot.sequence.store(ticket + 1, std::memory_order_release);
+        }
+
+        /**
+         * Claims a slot, calls fill(T&) on it and publishes it, kept only if fill returns true. Returns false if the
+         * queue was full or fill rejected the value. */
+        template<typename Fill>
+        bool push(Fill&& fill)
+        {
+            std::size_t ticket = 0;
+            T* slot = claim(ticket);
+            if (slot == nullptr)
+            {
+                return false;
+            }
+
+            bool keep = false;
+            try
+            {
+                keep = fill(*slot);
+            }
+            catch (...)
+            {
+                publish(ticket, false);
+                throw;
+            }
+            publish(ticket, keep);
+            return keep;
+        }
+
+        /**
+         * Consumer side, a single thread only. Returns the oldest published value, or nullptr if the queue is empty
+         * or the oldest slot is still being filled. The value belongs to the consumer until pop(). */
+        T* front()
+        {
+            while (true)
+            {
+                Slot& slot = m_slots[m_head & m_mask];
+                if (slot.sequence.load(std::memory_order_acquire) != m_head + 1)
+                {
+                    return nullptr;
+                }
+                if (slot.keep)
+                {
+                    return &slot.value;
+                }
+                pop();
+            }
+        }
+
+        void pop()
+        {
+            m_slots[m_head & m_mask].sequence.store(m_head + m_capacity, std::memory_order_release);
+            ++m_head;
+        }
+
+        std::size_t capacity() const { return m_capacity; };
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::size_t> sequence{0};
+            bool keep = false;
+            T value{};
+        };
+
+        const std::size_t m_capacity;
+        const std::size_t m_mask;
+        std::unique_ptr<Slot[]> m_slots;
+
+        alignas(OPEN_TRACK_IO_CACHE_LINE) std::atomic<std::size_t> m_tail{0};
+        alignas(OPEN_TRACK_IO_CACHE_LINE) std::size_t m_head = 0;
+    };
+} // namespace opentrackio
@@ -0,0 +1,337 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+
+namespace opentrackio
+{
+    /**
+     * The on-disk layout of a recording. Every structure is fixed size, 8 byte aligned and in the writer's native
+     * byte order, which the header records so a reader on a machine of the other order refuses the file rather than
+     * misreading it. A file is the header followed by records, each an 8 byte RecordHeader then its payload padded
+     * to 8 bytes:
+     *
+     * - STRING: UTF-8 text, interned strings are numbered in the order they appear.
+     * - STATIC: a CBOR sample holding everything the frame records don't, such as the static block. These are
+     *   deduplicated, a frame refers to the one that applies to it by number.
+     * - FRAME: a RecordedFrame followed by its RecordedTransforms.
+     * - INDEX: written when the recording is closed, the offset of every record and the timestamp and timecode keys.
+     *
+     * The file ends with a RecordingTrailer pointing at the index. A recording whose writer never closed it, after
+     * a crash for example, is still readable, the reader rebuilds the index by walking the records. */
+    namespace recording
+    {
+        constexpr std::array<char, 8> FILE_MAGIC{'O', 'T', 'I', 'O', 'R', 'E', 'C', '\0'};
+        constexpr std::array<char, 8> INDEX_MAGIC{'O', 'T', 'I', 'O', 'I', 'D', 'X', '\0'};
+        constexpr uint32_t VERSION = 1;
+        constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+        constexpr uint32_t NONE = UINT32_MAX;
+
+        /**
+         * Frames between successive timestamp and timecode keys in the index. */
+        constexpr uint32_t INDEX_STRIDE = 64;
+
+        struct FileHeader
+        {
+            std::array<char, 8> magic = FILE_MAGIC;
+            uint32_t version = VERSION;
+            uint32_t byteOrder = BYTE_ORDER_MARK;
+            uint32_t frameSize = 0;
+            uint32_t transformSize = 0;
+            uint32_t indexStride = INDEX_STRIDE;
+            uint32_t reserved[9]{};
+        };
+
+        enum class RecordType : uint32_t
+        {
+            STRING = 1,
+            STATIC = 2,
+            FRAME = 3,
+            INDEX = 4
+        };
+
+        struct RecordHeader
+        {
+            RecordType type = RecordType::FRAME;
+            uint32_t size = 0;
+        };
+
+        struct Timestamp
+        {
+            uint64_t seconds = 0;
+            uint32_t nanoseconds = 0;
+            uint32_t attoseconds = 0;
+        };
+
+        struct Timecode
+        {
+            uint8_t hours = 0;
+            uint8_t minutes = 0;
+            uint8_t seconds = 0;
+            uint8_t frames = 0;
+            uint8_t dropFrame = 0;
+            uint8_t oddField = 0;
+            uint8_t reserved[2]{};
+            int64_t frameRateNumerator = 0;
+            int64_t frameRateDenominator = 0;
+        };
+
+        /**
+         * Which of the optional fields of a RecordedFrame hold a value. TIMING, LENS, TRACKER and TRANSFORMS record
+         * whether the property itself was present, RECORDING_ACTIVE is the value of tracker recording. Encoders are
+         * recorded when all three values are present, as the parser always produces them. */
+        enum FrameField : uint64_t
+        {
+            SAMPLE_ID = 1ull << 0,
+            SAMPLE_ID_STRING = 1ull << 1,
+            SOURCE_ID = 1ull << 2,
+            SOURCE_NUMBER = 1ull << 3,
+            TIMING = 1ull << 4,
+            SAMPLE_TIMESTAMP = 1ull << 5,
+            RECORDED_TIMESTAMP = 1ull << 6,
+            SEQUENCE_NUMBER = 1ull << 7,
+            TIMECODE = 1ull << 8,
+            TIMECODE_ODD_FIELD = 1ull << 9,
+            LENS = 1ull << 10,
+            ENTRANCE_PUPIL_OFFSET = 1ull << 11,
+            F_STOP = 1ull << 12,
+            FOCAL_LENGTH = 1ull << 13,
+            FOCUS_DISTANCE = 1ull << 14,
+            T_STOP = 1ull << 15,
+            ENCODERS = 1ull << 16,
+            RAW_ENCODERS = 1ull << 17,
+            TRACKER = 1ull << 18,
+            NOTES = 1ull << 19,
+            RECORDING = 1ull << 20,
+            SLATE = 1ull << 21,
+            STATUS = 1ull << 22,
+            TRANSFORMS = 1ull << 23,
+            RECORDING_ACTIVE = 1ull << 24
+        };
+
+        struct RecordedFrame
+        {
+            static constexpr std::size_t SAMPLE_ID_CAPACITY = 47;
+
+            uint64_t fields = 0;
+            Timestamp sampleTimestamp{};
+            Timestamp recordedTimestamp{};
+            Timecode timecode{};
+            double entrancePupilOffset = 0;
+            double fStop = 0;
+            double focalLength = 0;
+            double focusDistance = 0;
+            double tStop = 0;
+            double encoders[3]{};
+            uint16_t rawEncoders[3]{};
+            uint16_t sequenceNumber = 0;
+            uint32_t sourceNumber = 0;
+            uint32_t sourceId = NONE;
+            uint32_t notes = NONE;
+            uint32_t slate = NONE;
+            uint32_t status = NONE;
+            uint32_t staticBlock = NONE;
+            uint32_t transformCount = 0;
+            /**
+             * Sample ids are held inline as their urn:uuid strings. The writer no longer produces SAMPLE_ID_STRING,
+             * as every UrnUuid fits, but older recordings are still read. */
+            uint32_t sampleIdString = NONE;
+            uint8_t sampleIdLength = 0;
+            char sampleId[SAMPLE_ID_CAPACITY]{};
+
+            bool has(FrameField field) const { return (fields & field) != 0; };
+            std::string_view id() const { return {sampleId, sampleIdLength}; };
+        };
+
+        enum TransformField : uint32_t
+        {
+            SCALE = 1u << 0,
+            TRANSFORM_ID = 1u << 1,
+            PARENT_TRANSFORM_ID = 1u << 2
+        };
+
+        struct RecordedTransform
+        {
+            double translation[3]{};
+            double rotation[3]{};
+            double scale[3]{};
+            uint32_t transformId = NONE;
+            uint32_t parentTransformId = NONE;
+            uint32_t fields = 0;
+            uint32_t reserved = 0;
+        };
+
+        struct IndexHeader
+        {
+            uint64_t frameCount = 0;
+            uint64_t staticCount = 0;
+            uint64_t stringCount = 0;
+            uint64_t timestampKeyCount = 0;
+            uint64_t timecodeKeyCount = 0;
+        };
+
+        struct TimestampKey
+        {
+            uint64_t seconds = 0;
+            uint32_t nanoseconds = 0;
+            uint32_t reserved = 0;
+            uint64_t frame = 0;
+        };
+
+        /**
+         * Timecodes are keyed as hours, minutes, seconds and frames packed into one integer, which orders them
+         * within a day without depending on the frame rate. */
+        struct TimecodeKey
+        {
+            uint32_t timecode = 0;
+            uint32_t reserved = 0;
+            uint64_t frame = 0;
+        };
+
+        struct RecordingTrailer
+        {
+            uint64_t indexOffset = 0;
+            std::array<char, 8> magic = INDEX_MAGIC;
+        };
+
+        static_assert(sizeof(FileHeader) == 64);
+        static_assert(sizeof(RecordHeader) == 8);
+        static_assert(sizeof(RecordedFrame) == 216);
+        static_assert(sizeof(RecordedTransform) == 88);
+        static_assert(sizeof(TimestampKey) == 24);
+        static_assert(sizeof(TimecodeKey) == 16);
+    } // namespace recording
+
+    /**
+     * Appends samples to a recording. Strings and static blocks are written the first time they are seen, so every
+     * record only refers back to records before it, and close() writes the index. */
+    class RecordingWriter
+    {
+    public:
+        RecordingWriter() = default;
+        ~RecordingWriter();
+        RecordingWriter(const RecordingWriter&) = delete;
+        RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+        /**
+         * Creates the file, replacing any that exists. */
+        bool open(const std::filesystem::path& path);
+        bool append(const OpenTrackIOSample& sample);
+        bool close();
+
+        bool isOpen() const { return m_file.is_open(); };
+        std::size_t frameCount() const { return m_frameOffsets.size(); };
+
+    private:
+        uint32_t intern(std::string_view text);
+        uint32_t storeStatic(const OpenTrackIOSample& sample);
+        void writeRecord(recording::RecordType type, std::initializer_list<std::span<const uint8_t>> parts);
+
+        std::ofstream m_file{};
+        uint64_t m_offset = 0;
+
+        std::map<std::string, uint32_t, std::less<>> m_stringIds{};
+        std::vector<uint64_t> m_stringOffsets{};
+        std::vector<uint64_t> m_staticOffsets{};
+        std::vector<std::vector<uint8_t>> m_statics{};
+        std::unordered_multimap<std::size_t, uint32_t> m_staticIndex{};
+        std::vector<uint64_t> m_frameOffsets{};
+        std::vector<recording::TimestampKey> m_timestampKeys{};
+        std::vector<recording::TimecodeKey> m_timecodeKeys{};
+
+        OpenTrackIOSample m_scratch{};
+        std::vector<uint8_t> m_scratchBytes{};
+        std::vector<recording::RecordedTransform> m_transforms{};
+    };
+
+    /**
+     * Reads a recording through a read only memory map. Frames, transforms, strings and static blocks are returned
+     * as views into the map, so reading a field is a load from the page cache with nothing parsed. frame() is O(1),
+     * the finds binary search the index and then step through at most a stride of frames. read() converts a frame back into a sample, from which getJson() or the
+     * serialisers give the JSON or CBOR form. */
+    class RecordingReader
+    {
+    public:
+        RecordingReader() = default;
+        ~RecordingReader();
+        RecordingReader(const RecordingReader&) = delete;
+        RecordingReader& operator=(const RecordingReader&) = delete;
+
+        bool open(const std::filesystem::path& path);
+        void close();
+
+        bool isOpen() const { return m_data != nullptr; };
+
+        /**
+         * False if the recording wasn't closed and its index had to be rebuilt. */
+        bool hasIndex() const { return m_hasIndex; };
+
+        std::size_t frameCount() const { return m_frameOffsets.size(); };
+        std::size_t staticCount() const { return m_staticOffsets.size(); };
+        std::size_t stringCount() const { return m_stringOffsets.size(); };
+
+        /**
+         * Views into the map, index must be less than the matching count. */
+        const recording::RecordedFrame& frame(std::size_t index) const;
+        std::span<const recording::RecordedTransform> transforms(std::size_t index) const;
+        std::string_view string(uint32_t id) const;
+        std::span<const uint8_t> staticBlock(uint32_t id) const;
+
+        /**
+         * The first frame whose sample timestamp or timecode is at or after the one given. Both assume the recorded
+         * values never decrease, as they do within a take, frames without the value are skipped. */
+        std::optional<std::size_t> findTimestamp(const opentrackiotypes::Timestamp& timestamp) const;
+        std::optional<std::size_t> findTimecode(const opentrackiotypes::Timecode& timecode) const;
+
+        /**
+         * Overwrites out with frame index, reusing its storage. Returns false if there is no such frame. */
+        bool read(std::size_t index, OpenTrackIOSample& out) const;
+
+    private:
+        bool loadIndex();
+        void rebuildIndex();
+        std::span<const uint8_t> payload(uint64_t offset) const;
+
+        const uint8_t* m_data = nullptr;
+        std::size_t m_size = 0;
+        bool m_hasIndex = false;
+
+        // Views into the index when the file has one, otherwise into the rebuilt vectors below.
+        std::span<const uint64_t> m_frameOffsets{};
+        std::span<const uint64_t> m_staticOffsets{};
+        std::span<const uint64_t> m_stringOffsets{};
+        std::span<const recording::TimestampKey> m_timestampKeys{};
+        std::span<const recording::TimecodeKey> m_timecodeKeys{};
+
+        std::vector<uint64_t> m_rebuiltFrames{};
+        std::vector<uint64_t> m_rebuiltStatics{};
+        std::vector<uint64_t> m_rebuiltStrings{};
+        std::vector<recording::TimestampKey> m_rebuiltTimestampKeys{};
+        std::vector<recording::TimecodeKey> m_rebuiltTimecodeKeys{};
+    };
+} // namespace opentrackio
@@ -15,12 +15,69 @@
 #include <optional>
 #include <span>
 #include <nlohmann/json.hpp>
+#include "OpenTrackIOInstrumentation.h"
+#include "OpenTrackIOMemory.h"
+#include "OpenTrackIOPacket.h"
 #include "OpenTrackIOProperties.h"
+#include "OpenTrackIOStaticCache.h"
+#include "OpenTrackIOTape.h"
 
 namespace opentrackio
 {
     #define OPEN_TRACK_IO_PROTOCOL_NAME "OpenTrackIO"
     #define OPEN_TRACK_IO_PROTOCOL_VERSION "1.0.0"
+
+    struct TrackingSnapshot;
+
+    struct ParseOptions
+    {
+        /**
+         * Keep the input DOM so that getJson() returns it verbatim rather than regenerating it from the parsed
+         * properties. Retaining a const DOM costs a deep copy, retaining an rvalue DOM only costs a move. */
+        bool retainJson = false;
+
+        /**
+         * Record errors and warnings as codes in a fixed size inline buffer rather than formatting a string for each
+         * one as it is found. getErrors() and getWarnings() then only format them when called, getDiagnostics()
+         * gives access to the codes themselves. The buffer holds Diagnostics::CAPACITY of them, any beyond that are
+         * counted but dropped. */
+        bool structuredDiagnostics = false;
+
+        /**
+         * Warnings only report fields that no parser consumed, turning them off also skips the leftover field check. */
+        bool collectWarnings = true;
+
+        /**
+         * Resolve the static block through a cache shared by every sample the caller receives. The static properties
+         * are then found in staticProperties rather than in camera, duration and the static fields of lens and
+         * tracker, a repeated static block isn't parsed again and a sample without one gets the latest one from its
+         * source. getJson() and the serialisers only write the sample's own properties, so they leave it out.
+         * A repeat is one whose bytes equal the block the cached properties were parsed from, and it isn't validated
+         * again: its errors and warnings were reported by the sample that first parsed it, later samples repeating
+         * it report none. */
+        StaticCache* staticCache = nullptr;
+
+        /**
+         * Allocate the strings and vectors of the properties from this resource rather than the global heap, for
+         * instance from an arena that is released every frame or a per thread pool. The properties are dropped
+         * before parsing whenever a resource is given or was given last time, rather than refilled in place, and
+         * reset() drops them too, so a frame arena is used as reset(), release the arena, initialise(). The
+         * resource must outlive the properties parsed from it, static blocks resolved through a StaticCache are
+         * always parsed on the default resource as the cache outlives them. The sample's own buffers allocate from
+         * the resource that was current when it was constructed, see MemoryResourceScope. */
+        std::pmr::memory_resource* memoryResource = nullptr;
+
+        /**
+         * Capture the tracking state of the parsed sample into this snapshot, see TrackingSnapshot. It is
+         * overwritten by every initialise(), whether or not it reports errors, so it always matches the properties. */
+        TrackingSnapshot* snapshot = nullptr;
+
+        /**
+         * Record the parse's phase durations, bytes, allocations and diagnostics and the stream's sequence and
+         * arrival timing in this instrumentation. Ignored unless the library is built with instrumentation. */
+        Instrumentation* instrumentation = nullptr;
+    };
+    
     struct OpenTrackIOSample
     {
         std::optional<opentrackioproperties::Camera> camera = std::nullopt;
@@ -35,17 +92,85 @@ namespace opentrackio
         std::optional<opentrackioproperties::Timing> timing = std::nullopt;
         std::optional<opentrackioproperties::Tracker> tracker = std::nullopt;
         std::optional<opentrackioproperties::Transforms> transforms = std::nullopt;
+        
+        /**
+         * Only set when parsing with ParseOptions::staticCache. */
+        std::shared_ptr<const StaticProperties> staticProperties = nullptr;
 
         OpenTrackIOSample() = default;
-        bool initialise(const nlohmann::json& json);
-        bool initialise(const std::string_view jsonString);
-        bool initialise(std::span<const uint8_t> cbor);
-        const std::vector<std::string>& getErrors() { return m_errorMessages; };
-        const std::vector<std::string>& getWarnings() { return m_warningMessages; };
+        bool initialise(const nlohmann::json& json, const ParseOptions& options = {});
+        bool initialise(nlohmann::json&& json, const ParseOptions& options = {});
+        bool initialise(const std::string_view jsonString, const ParseOptions& options = {});
+        bool initialise(std::span<const uint8_t> cbor, const ParseOptions& options = {});
+        
+        /**
+         * Initialises from a payload received through a PacketAssembler using the overload for its encoding. */
+        bool initialise(const PacketPayload& payload, const ParseOptions& options = {});
+
+        /**
+         * Prepares the sample to be initialised again, clearing its errors, warnings and JSON while keeping the
+         * memory behind them. The properties are left as they are until the next initialise(), which overwrites them
+         * in place so their strings and vectors keep their capacity, unless they were parsed with
+         * ParseOptions::memoryResource, in which case they are dropped. A sample that is reset and initialised from CBOR
+         * for every packet stops allocating once it has seen the largest one, provided the JSON isn't retained and no
+         * errors or warnings are formatted into strings. JSON text still pays for the few small buffers nlohmann's
+         * tokeniser allocates on each parse. */
+        void reset();
+        const std::vector<std::string>& getErrors() { return m_diagnostics.errors(); };
+        const std::vector<std::string>& getWarnings() { return m_diagnostics.warnings(); };
+        const Diagnostics& getDiagnostics() const { return m_diagnostics; };
+
+        /**
+         * The subtrees of getJson() that markDirty() can ask to be regenerated. Lens and tracker have their static
+         * fields under the static block and their dynamic fields under their own key, which are marked separately. */
+        enum class Property : uint8_t
+        {
+            CAMERA,
+            DURATION,
+            GLOBAL_STAGE,
+            LENS,
+            LENS_STATIC,
+            PROTOCOL,
+            RELATED_SAMPLE_IDS,
+            SAMPLE_ID,
+            SOURCE_ID,
+            SOURCE_NUMBER,
+            TIMING,
+            TRACKER,
+            TRACKER_STATIC,
+            TRANSFORMS
+        };
+
+        /**
+         * Records that a property was changed since getJson() was last called, so that the next call regenerates
+         * its subtree. Properties are plain members, so nothing is regenerated unless it is marked. */
+        void markDirty(Property property) { m_dirty |= 1u << static_cast<uint8_t>(property); };
+
+        /**
+         * The sample as JSON, either the retained input or a tree generated from the properties. Once built, only
+         * the subtrees of the properties passed to markDirty() since the last call are regenerated, so a long lived
+         * sender that updates timing and transforms each frame doesn't rebuild the rest. The returned reference
+         * stays valid and is updated in place. */
         const nlohmann::json& getJson();
+
+        /**
+         * Serialise the sample straight into a caller supplied buffer without building a DOM or allocating.
+         * The output is identical to dumping, or converting to CBOR, the DOM that getJson() generates.
+         * Returns the number of bytes written or std::nullopt if the buffer was too small. serializeJson also
+         * returns std::nullopt if a string isn't valid UTF-8, as dump() would throw, which no larger buffer fixes, so
+         * a caller growing the buffer to retry should stop once it is larger than any sample it sends. serializeCbor
+         * writes strings as they are and only fails for a small buffer. Given an instrumentation, the duration and
+         * bytes written are recorded against the sample's source. */
+        std::optional<std::size_t> serializeJson(std::span<char> buffer,
+                                                 Instrumentation* instrumentation = nullptr) const;
+        std::optional<std::size_t> serializeCbor(std::span<uint8_t> buffer,
+                                                 Instrumentation* instrumentation = nullptr) const;
         
     private:
         void generateJson();
+        void updateJson();
+        void regenerateJson(void (OpenTrackIOSample::*toJson)(nlohmann::json&), std::string_view key,
+                            std::string_view staticKey = {});
         void parseCameraToJson(nlohmann::json& baseJson);
         void parseDurationToJson(nlohmann::json& baseJson);
         void parseGlobalStageToJson(nlohmann::json& baseJson);
@@ -59,10 +184,20 @@ namespace opentrackio
         void parseTrackerToJson(nlohmann::json& baseJson);
         void parseTransformsToJson(nlohmann::json& baseJson);
         
-        void warnForRemainingFields(const nlohmann::json& json);
+        bool initialiseFromDom(nlohmann::json&& json, const ParseOptions& options);
+        void clearProperties();
+        template<JsonNode Json>
+        void parseProperties(const Json& json, const ParseOptions& options);
+        template<JsonNode Json>
+        void resolveStaticProperties(const Json& json, StaticCache& cache);
         
         std::optional<nlohmann::json> m_json = std::nullopt;
-        std::vector<std::string> m_errorMessages{};
-        std::vector<std::string> m_warningMessages{};
+        uint16_t m_dirty = 0;
+        std::string m_staticBlock{};
+        std::pmr::memory_resource* m_memoryResource = nullptr;
+        SampleTape m_tape{};
+        ConsumedFields m_consumedFields{};
+        Diagnostics m_diagnostics{};
+        PhaseTimer m_timer{};
     };
 } // namespace opentrackio
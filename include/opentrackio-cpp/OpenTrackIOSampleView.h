@@ -0,0 +1,112 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+
+namespace opentrackio
+{
+    /**
+     * A sample that only decodes the properties it is asked for. Opening a view runs the one pass that indexes the
+     * document into a tape, each property is then parsed and validated the first time it's accessed and cached
+     * until the view is opened again. A consumer that only reads transforms, lens and timing never pays for the
+     * strings and patterns of camera, tracker or the ids.
+     *
+     * Properties parse exactly as they do in OpenTrackIOSample without a static cache, and report to the same
+     * kind of diagnostics, but only for the properties that were accessed. As nothing sees the whole document there
+     * is no leftover field check. Accessors are const but fill the cache, so a view isn't safe to share between
+     * threads. Reopening a view reuses the tape and the cached properties' storage. */
+    class OpenTrackIOSampleView
+    {
+    public:
+        /**
+         * Indexes a document, throwing the same nlohmann::json::parse_error as OpenTrackIOSample::initialise() on
+         * malformed input. Of the options only structuredDiagnostics and collectWarnings apply. */
+        bool open(std::string_view jsonString, const ParseOptions& options = {});
+        bool open(std::span<const uint8_t> cbor, const ParseOptions& options = {});
+        bool open(const PacketPayload& payload, const ParseOptions& options = {});
+
+        bool isOpen() const { return m_open; };
+
+        /**
+         * Whether the document has a top level key, without decoding anything. */
+        bool contains(std::string_view key) const;
+
+        const std::optional<opentrackioproperties::Camera>& camera() const;
+        const std::optional<opentrackioproperties::Duration>& duration() const;
+        const std::optional<opentrackioproperties::GlobalStage>& globalStage() const;
+        const std::optional<opentrackioproperties::Lens>& lens() const;
+        const std::optional<opentrackioproperties::Protocol>& protocol() const;
+        const std::optional<opentrackioproperties::RelatedSampleIds>& relatedSampleIds() const;
+        const std::optional<opentrackioproperties::SampleId>& sampleId() const;
+        const std::optional<opentrackioproperties::SourceId>& sourceId() const;
+        const std::optional<opentrackioproperties::SourceNumber>& sourceNumber() const;
+        const std::optional<opentrackioproperties::Timing>& timing() const;
+        const std::optional<opentrackioproperties::Tracker>& tracker() const;
+        const std::optional<opentrackioproperties::Transforms>& transforms() const;
+
+        /**
+         * Decodes whatever hasn't been accessed yet and copies every property into a sample, which is reset first. */
+        void copyTo(OpenTrackIOSample& sample) const;
+
+        const std::vector<std::string>& getErrors() { return m_diagnostics.errors(); };
+        const std::vector<std::string>& getWarnings() { return m_diagnostics.warnings(); };
+        const Diagnostics& getDiagnostics() const { return m_diagnostics; };
+
+    private:
+        enum class Property : uint8_t
+        {
+            CAMERA,
+            DURATION,
+            GLOBAL_STAGE,
+            LENS,
+            PROTOCOL,
+            RELATED_SAMPLE_IDS,
+            SAMPLE_ID,
+            SOURCE_ID,
+            SOURCE_NUMBER,
+            TIMING,
+            TRACKER,
+            TRANSFORMS
+        };
+
+        template<typename T>
+        const std::optional<T>& decode(Property property, std::optional<T>& out) const;
+        void opened(const ParseOptions& options);
+
+        SampleTape m_tape{};
+        bool m_open = false;
+        mutable uint32_t m_decoded = 0;
+        mutable Diagnostics m_diagnostics{};
+        mutable ConsumedFields m_consumedFields{};
+
+        mutable std::optional<opentrackioproperties::Camera> m_camera = std::nullopt;
+        mutable std::optional<opentrackioproperties::Duration> m_duration = std::nullopt;
+        mutable std::optional<opentrackioproperties::GlobalStage> m_globalStage = std::nullopt;
+        mutable std::optional<opentrackioproperties::Lens> m_lens = std::nullopt;
+        mutable std::optional<opentrackioproperties::Protocol> m_protocol = std::nullopt;
+        mutable std::optional<opentrackioproperties::RelatedSampleIds> m_relatedSampleIds = std::nullopt;
+        mutable std::optional<opentrackioproperties::SampleId> m_sampleId = std::nullopt;
+        mutable std::optional<opentrackioproperties::SourceId> m_sourceId = std::nullopt;
+        mutable std::optional<opentrackioproperties::SourceNumber> m_sourceNumber = std::nullopt;
+        mutable std::optional<opentrackioproperties::Timing> m_timing = std::nullopt;
+        mutable std::optional<opentrackioproperties::Tracker> m_tracker = std::nullopt;
+        mutable std::optional<opentrackioproperties::Transforms> m_transforms = std::nullopt;
+    };
+} // namespace opentrackio
@@ -0,0 +1,394 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOHelper.h"
+
+/**
+ * Compile time descriptions of the members of a property, from which its parser, getJson() and the JSON and CBOR
+ * serialisers are generated instead of each listing the members by hand. A property is described by specialising
+ * Descriptor with a Fields list, the parsers then run on any JsonNode, so the DOM, tape, CBOR and SAX paths all
+ * share it. Properties, or parts of them, whose layout the generic code can't express are still written by hand. */
+namespace opentrackio::schema
+{
+    template<std::size_t N>
+    struct FixedString
+    {
+        char value[N]{};
+
+        constexpr FixedString(const char (&text)[N])
+        {
+            std::copy_n(text, N, value);
+        }
+
+        constexpr std::string_view view() const { return {value, N - 1}; };
+    };
+
+    /**
+     * Whether a member lives in the static block or in the property itself, for properties split across both. */
+    enum class Scope : uint8_t
+    {
+        STATIC,
+        DYNAMIC
+    };
+
+    template<typename T>
+    struct MemberPointer;
+
+    template<typename C, typename M>
+    struct MemberPointer<M C::*>
+    {
+        using Class = C;
+        using Value = M;
+    };
+
+    template<typename T>
+    inline constexpr bool isOptional = false;
+
+    template<typename T>
+    inline constexpr bool isOptional<std::optional<T>> = true;
+
+    /**
+     * One member of a property. Key is its name in the document and TypeName the type diagnostics say was expected.
+     * Members that aren't optional are required. Validator optionally points at one of the string validators in
+     * OpenTrackIOValidators.h. */
+    template<FixedString Key, auto Member, FixedString TypeName, Scope S = Scope::DYNAMIC, auto Validator = nullptr>
+    struct Field
+    {
+        using Class = typename MemberPointer<decltype(Member)>::Class;
+        using Value = typename MemberPointer<decltype(Member)>::Value;
+
+        static constexpr std::string_view key = Key.view();
+        static constexpr std::string_view typeName = TypeName.view();
+        static constexpr Scope scope = S;
+        static constexpr bool required = !isOptional<Value>;
+        static constexpr auto member = Member;
+        static constexpr auto validator = Validator;
+        static constexpr bool validated = !std::is_null_pointer_v<decltype(Validator)>;
+    };
+
+    template<typename... Fs>
+    struct Fields
+    {
+        static constexpr std::size_t size = sizeof...(Fs);
+        static_assert(size <= 64, "Seen fields are tracked in a 64 bit mask");
+        using Tuple = std::tuple<Fs...>;
+    };
+
+    /**
+     * Specialised for each described property with a fields member naming its Fields list. Keys must be unique and,
+     * within each scope, listed in the sorted order the serialisers write them in. */
+    template<typename T>
+    struct Descriptor;
+
+    template<typename T>
+    using FieldList = typename Descriptor<T>::fields;
+
+    template<typename T, std::size_t I>
+    using FieldAt = std::tuple_element_t<I, typename FieldList<T>::Tuple>;
+
+    template<typename T>
+    constexpr std::array<std::string_view, FieldList<T>::size> keysOf()
+    {
+        return [] <std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            return std::array<std::string_view, sizeof...(Is)>{FieldAt<T, Is>::key...};
+        }(std::make_index_sequence<FieldList<T>::size>{});
+    }
+
+    template<typename T>
+    constexpr bool validLayout()
+    {
+        constexpr auto keys = keysOf<T>();
+        constexpr auto scopes = [] <std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            return std::array<Scope, sizeof...(Is)>{FieldAt<T, Is>::scope...};
+        }(std::make_index_sequence<FieldList<T>::size>{});
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            for (std::size_t j = i + 1; j < keys.size(); ++j)
+            {
+                if (keys[i] == keys[j] || (scopes[i] == scopes[j] && !(keys[i] < keys[j])))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    constexpr uint32_t hashKey(std::string_view key, uint32_t seed)
+    {
+        uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (const char c : key)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+        }
+        // FNV-1a's low bits only depend on the low bits of its state, so mix the high bits down before masking.
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6Bu;
+        hash ^= hash >> 13;
+        return hash;
+    }
+
+    /**
+     * A collision free hash table over a property's keys, with the seed searched for at compile time, so finding a
+     * member's field costs one hash and one string comparison. */
+    template<std::size_t N>
+    struct KeyTable
+    {
+        static constexpr std::size_t SLOTS = std::bit_ceil(std::max<std::size_t>(N * 2, 2));
+        static constexpr uint8_t EMPTY = 0xFF;
+
+        std::array<std::string_view, N> keys{};
+        std::array<uint8_t, SLOTS> slots{};
+        uint32_t seed = 0;
+        bool found = false;
+
+        /**
+         * The index of the field with the key, or N if there isn't one. */
+        constexpr std::size_t find(std::string_view key) const
+        {
+            const uint8_t index = slots[hashKey(key, seed) & (SLOTS - 1)];
+            return index != EMPTY && keys[index] == key ? index : N;
+        }
+    };
+
+    template<std::size_t N>
+    constexpr KeyTable<N> makeKeyTable(const std::array<std::string_view, N>& keys)
+    {
+        KeyTable<N> table{};
+        table.keys = keys;
+        for (uint32_t seed = 0; seed < 4096 && !table.found; ++seed)
+        {
+            table.slots.fill(KeyTable<N>::EMPTY);
+            table.seed = seed;
+            table.found = true;
+            for (std::size_t i = 0; i < N && table.found; ++i)
+            {
+                auto& slot = table.slots[hashKey(keys[i], seed) & (KeyTable<N>::SLOTS - 1)];
+                table.found = slot == KeyTable<N>::EMPTY;
+                slot = static_cast<uint8_t>(i);
+            }
+        }
+        return table;
+    }
+
+    template<typename T>
+    inline constexpr auto keyTable = makeKeyTable(keysOf<T>());
+
+    /**
+     * Calls fn with a default constructed Field for each field of scope S, in the order they are listed. */
+    template<typename T, Scope S, typename F>
+    constexpr void forEachField(F&& fn)
+    {
+        static_assert(validLayout<T>(), "Descriptor keys must be unique and sorted within each scope");
+        [&] <std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            ([&]
+            {
+                if constexpr (FieldAt<T, Is>::scope == S)
+                {
+                    fn(FieldAt<T, Is>{});
+                }
+            }(), ...);
+        }(std::make_index_sequence<FieldList<T>::size>{});
+    }
+
+    template<typename T>
+    concept NestedParse = requires(const nlohmann::json& json, ParseContext& ctx)
+    {
+        { T::parse(json, std::string_view{}, ctx) } -> std::same_as<std::optional<T>>;
+    };
+
+    template<typename T>
+    inline constexpr bool isNested = false;
+
+    template<NestedParse T>
+    inline constexpr bool isNested<std::optional<T>> = true;
+
+    /**
+     * Parses one member into its field, reporting what the hand written assign helpers do. Types with their own
+     * parse(parent, key, ctx), such as Rational and Dimensions, are handed the parent object. */
+    template<typename F, typename T, JsonNode Json>
+    bool parseField(const Json& object, const Json& value, ParseContext& ctx, T& out)
+    {
+        auto& field = out.*F::member;
+        using Value = typename F::Value;
+
+        if constexpr (isNested<Value>)
+        {
+            field = Value::value_type::parse(object, F::key, ctx);
+            ctx.consumed.consume(value);
+            return true;
+        }
+        else if constexpr (std::is_same_v<Value, std::optional<opentrackiotypes::UrnUuid>>)
+        {
+            if (OpenTrackIOHelpers::setUuidField(value, F::key, field, ctx))
+            {
+                ctx.consumed.consume(value);
+            }
+            return true;
+        }
+        else if constexpr (std::is_same_v<Value, std::optional<Vector<double>>>)
+        {
+            if (!value.is_array())
+            {
+                field = std::nullopt;
+                return true;
+            }
+
+            if (!OpenTrackIOHelpers::iterateJsonArrayAndPopulateVector(value, field))
+            {
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} had elements not of type: {}",
+                                      F::key, "double");
+                return true;
+            }
+            ctx.consumed.consume(value);
+            return true;
+        }
+        else
+        {
+            if (!OpenTrackIOHelpers::checkTypeAndSetField(value, field))
+            {
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", F::key,
+                                      F::typeName);
+                return !F::required;
+            }
+
+            if constexpr (F::validated)
+            {
+                static_assert(isOptional<Value>, "Validated fields must be optional");
+                if (!(*F::validator)(field.value()))
+                {
+                    ctx.diagnostics.error(DiagnosticCode::PATTERN_MISMATCH,
+                                          "field: {} doesn't match the required pattern", F::key);
+                    field = std::nullopt;
+                    return true;
+                }
+            }
+            ctx.consumed.consume(value);
+            return true;
+        }
+    }
+
+    /**
+     * Clears every optional field of scope S, as parsing a document without them does. */
+    template<Scope S, typename T>
+    void resetFields(T& out)
+    {
+        forEachField<T, S>([&](auto field)
+        {
+            using F = decltype(field);
+            if constexpr (!F::required)
+            {
+                out.*F::member = std::nullopt;
+            }
+        });
+    }
+
+    /**
+     * Compares the fields of scope S of two optional values, a missing value comparing equal to one whose fields
+     * of that scope are all empty. */
+    template<Scope S, typename T>
+    bool sameFields(const std::optional<T>& a, const std::optional<T>& b)
+    {
+        bool same = true;
+        forEachField<T, S>([&](auto field)
+        {
+            using F = decltype(field);
+            const auto none = typename F::Value{};
+            same &= (a.has_value() ? a.value().*F::member : none) == (b.has_value() ? b.value().*F::member : none);
+        });
+        return same;
+    }
+
+    /**
+     * Parses the fields of scope S from an object in a single pass over its members, finding each member's field
+     * through the key table rather than looking every field up. Fields the object doesn't have are cleared, members
+     * without a field are left for the leftover check. Returns false if a required field is missing or invalid. */
+    template<Scope S, typename T, JsonNode Json>
+    bool parseFields(const Json& object, ParseContext& ctx, T& out)
+    {
+        using List = FieldList<T>;
+        static_assert(validLayout<T>(), "Descriptor keys must be unique and sorted within each scope");
+        static_assert(keyTable<T>.found, "No collision free seed was found for the descriptor keys");
+
+        uint64_t seen = 0;
+        bool valid = true;
+        if (object.is_object())
+        {
+            for (auto it = object.begin(); it != object.end(); ++it)
+            {
+                const std::size_t index = keyTable<T>.find(it.key());
+                if (index == List::size || (seen >> index & 1) != 0)
+                {
+                    continue;
+                }
+
+                [&] <std::size_t... Is>(std::index_sequence<Is...>)
+                {
+                    ([&]
+                    {
+                        if constexpr (FieldAt<T, Is>::scope == S)
+                        {
+                            if (index == Is)
+                            {
+                                seen |= uint64_t{1} << Is;
+                                valid = parseField<FieldAt<T, Is>>(object, *it, ctx, out) && valid;
+                            }
+                        }
+                    }(), ...);
+                }(std::make_index_sequence<List::size>{});
+            }
+        }
+
+        [&] <std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            ([&]
+            {
+                using F = FieldAt<T, Is>;
+                if constexpr (F::scope == S)
+                {
+                    if ((seen >> Is & 1) != 0)
+                    {
+                        return;
+                    }
+
+                    if constexpr (F::required)
+                    {
+                        ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "field: {} is missing", F::key);
+                        valid = false;
+                    }
+                    else
+                    {
+                        out.*F::member = std::nullopt;
+                    }
+                }
+            }(), ...);
+        }(std::make_index_sequence<List::size>{});
+        return valid;
+    }
+} // namespace opentrackio::schema
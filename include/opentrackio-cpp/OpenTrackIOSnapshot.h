@@ -0,0 +1,154 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "opentrackio-cpp/OpenTrackIOQueue.h"
+
+namespace opentrackio
+{
+    /**
+     * The lens values a TrackingSnapshot carries and a SampleHistory interpolates, as indices into their lens arrays. */
+    enum class LensValue : uint8_t
+    {
+        FOCAL_LENGTH,
+        FOCUS_DISTANCE,
+        F_STOP,
+        T_STOP,
+        ENTRANCE_PUPIL_OFFSET,
+        ENCODER_FOCUS,
+        ENCODER_IRIS,
+        ENCODER_ZOOM,
+        COUNT
+    };
+
+    constexpr std::size_t LENS_VALUE_COUNT = static_cast<std::size_t>(LensValue::COUNT);
+
+    /**
+     * The values a TrackingSnapshot carries besides its lens values, as bits of TrackingSnapshot::present. */
+    enum class SnapshotField : uint8_t
+    {
+        SOURCE_ID,
+        SOURCE_NUMBER,
+        SAMPLE_TIMESTAMP,
+        SEQUENCE_NUMBER,
+        FRAME_RATE,
+        TRANSFORMS,
+        DISTORTION,
+        UNDISTORTION,
+        DISTORTION_OVERSCAN,
+        DISTORTION_SHIFT,
+        PERSPECTIVE_SHIFT
+    };
+
+    /**
+     * The per frame tracking state of a sample in a fixed layout, for engines that store a snapshot every frame,
+     * hand it between threads or upload it to the GPU. It holds no pointers and is trivially copyable, so it can be
+     * copied with memcpy, carried by value in an SpscQueue or MpscQueue and pushed into a SampleHistory. Transforms
+     * are kept in the order the sample lists them without their ids, and only the dynamic lens values are kept, so
+     * static blocks resolved through a StaticCache don't change it. Transforms and coefficients beyond the fixed
+     * capacities are dropped and their field is set in overflow. */
+    struct alignas(OPEN_TRACK_IO_CACHE_LINE) TrackingSnapshot
+    {
+        static constexpr std::size_t MAX_TRANSFORMS = 8;
+        static constexpr std::size_t MAX_RADIAL = 8;
+        static constexpr std::size_t MAX_TANGENTIAL = 4;
+
+        struct Transform
+        {
+            std::array<double, 3> translation{};
+            /**
+             * Pan, tilt and roll in degrees. */
+            std::array<double, 3> rotation{};
+            std::array<double, 3> scale{1, 1, 1};
+        };
+
+        struct Coefficients
+        {
+            std::array<double, MAX_RADIAL> radial{};
+            std::array<double, MAX_TANGENTIAL> tangential{};
+            uint8_t radialCount = 0;
+            uint8_t tangentialCount = 0;
+        };
+
+        uint32_t present = 0;
+        uint32_t overflow = 0;
+        uint32_t lensValid = 0;
+        uint32_t transformCount = 0;
+
+        opentrackiotypes::UrnUuid sourceId{};
+        uint32_t sourceNumber = 0;
+        uint16_t sequenceNumber = 0;
+        opentrackiotypes::Timestamp sampleTimestamp{};
+        opentrackiotypes::Rational frameRate{};
+
+        std::array<double, LENS_VALUE_COUNT> lens{};
+        double distortionOverscan = 0;
+        std::array<double, 2> distortionShift{};
+        std::array<double, 2> perspectiveShift{};
+        Coefficients distortion{};
+        Coefficients undistortion{};
+
+        std::array<Transform, MAX_TRANSFORMS> transforms{};
+
+        /**
+         * Overwrites the snapshot with the tracking state of an OpenTrackIOSample or a BasicOpenTrackIOSample. */
+        template<typename Sample>
+        void capture(const Sample& sample);
+
+        bool has(SnapshotField field) const { return (present >> static_cast<uint32_t>(field) & 1) != 0; };
+        bool has(LensValue value) const { return (lensValid >> static_cast<uint32_t>(value) & 1) != 0; };
+        bool overflowed(SnapshotField field) const { return (overflow >> static_cast<uint32_t>(field) & 1) != 0; };
+        double get(LensValue value) const { return lens[static_cast<std::size_t>(value)]; };
+
+    private:
+        void captureTiming(const opentrackioproperties::Timing& timing);
+        void captureLens(const opentrackioproperties::Lens& sampleLens);
+        void captureTransforms(const opentrackioproperties::Transforms& sampleTransforms);
+    };
+
+    static_assert(std::is_trivially_copyable_v<TrackingSnapshot>);
+
+    template<typename Sample>
+    void TrackingSnapshot::capture(const Sample& sample)
+    {
+        using opentrackioproperties::propertyOf;
+        *this = TrackingSnapshot{};
+
+        if (const auto* id = propertyOf(sample.sourceId))
+        {
+            present |= 1u << static_cast<uint32_t>(SnapshotField::SOURCE_ID);
+            sourceId = id->id;
+        }
+        if (const auto* number = propertyOf(sample.sourceNumber))
+        {
+            present |= 1u << static_cast<uint32_t>(SnapshotField::SOURCE_NUMBER);
+            sourceNumber = number->value;
+        }
+        if (const auto* timing = propertyOf(sample.timing))
+        {
+            captureTiming(*timing);
+        }
+        if (const auto* sampleLens = propertyOf(sample.lens))
+        {
+            captureLens(*sampleLens);
+        }
+        if (const auto* sampleTransforms = propertyOf(sample.transforms))
+        {
+            captureTransforms(*sampleTransforms);
+        }
+    }
+} // namespace opentrackio
@@ -0,0 +1,70 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "OpenTrackIOProperties.h"
+
+namespace opentrackio
+{
+    /**
+     * The properties carried by the static block of a sample. Only the static fields of lens and tracker are set,
+     * their per sample fields stay on the sample itself. */
+    struct StaticProperties
+    {
+        std::optional<opentrackioproperties::Camera> camera = std::nullopt;
+        std::optional<opentrackioproperties::Duration> duration = std::nullopt;
+        std::optional<opentrackioproperties::Lens> lens = std::nullopt;
+        std::optional<opentrackioproperties::Tracker> tracker = std::nullopt;
+    };
+
+    /**
+     * Remembers the latest static block seen from each source, keyed by sourceId, so that samples which repeat it
+     * share one immutable StaticProperties instead of parsing it again. A repeat is recognised by comparing the
+     * encoded bytes of the block with those the entry was parsed from, see nodeBytes(), never by a hash alone. Samples without a sourceId share the entry of
+     * the nil UUID. The records can be held on to and read from any thread, the cache itself isn't thread safe and would
+     * normally belong to a single receive loop. */
+    class StaticCache
+    {
+    public:
+        /**
+         * The latest static properties of the source, or nullptr if it hasn't sent a static block yet. */
+        std::shared_ptr<const StaticProperties> find(const opentrackiotypes::UrnUuid& sourceId) const;
+
+        /**
+         * The latest static properties of the source if they were parsed from a static block with the same bytes,
+         * otherwise nullptr. */
+        std::shared_ptr<const StaticProperties> find(const opentrackiotypes::UrnUuid& sourceId,
+                                                     std::string_view block) const;
+
+        void store(const opentrackiotypes::UrnUuid& sourceId, std::string_view block,
+                   std::shared_ptr<const StaticProperties> properties);
+        void clear() { m_sources.clear(); };
+        std::size_t size() const { return m_sources.size(); };
+
+    private:
+        struct Entry
+        {
+            std::string block{};
+            std::shared_ptr<const StaticProperties> properties = nullptr;
+        };
+
+        std::unordered_map<opentrackiotypes::UrnUuid, Entry> m_sources{};
+    };
+} // namespace opentrackio
@@ -0,0 +1,248 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+
+namespace opentrackio
+{
+    /**
+     * One field of every sample in a take, stored contiguously with a validity bit per row. Rows without a value
+     * hold a default constructed T, so values() can be scanned without branching and masked with validity() after.
+     * forEachValid() walks the set bits a 64 bit word at a time. Booleans are stored as bytes, so that values()
+     * can still be a span. */
+    template<typename T>
+    class TakeColumn
+    {
+    public:
+        using Value = std::conditional_t<std::is_same_v<T, bool>, uint8_t, T>;
+
+        std::size_t size() const { return m_values.size(); };
+        std::span<const Value> values() const { return m_values; };
+        std::span<const uint64_t> validity() const { return m_validity; };
+
+        bool valid(std::size_t row) const { return ((m_validity[row / 64] >> (row % 64)) & 1) != 0; };
+        std::optional<T> get(std::size_t row) const
+        {
+            return valid(row) ? std::optional<T>{static_cast<T>(m_values[row])} : std::nullopt;
+        };
+
+        /**
+         * Calls fn(row, value) for every row that has a value, in row order. */
+        template<typename Fn>
+        void forEachValid(Fn&& fn) const
+        {
+            for (std::size_t word = 0; word < m_validity.size(); ++word)
+            {
+                for (uint64_t bits = m_validity[word]; bits != 0; bits &= bits - 1)
+                {
+                    const std::size_t row = word * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+                    fn(row, m_values[row]);
+                }
+            }
+        }
+
+        void push(const std::optional<T>& value)
+        {
+            const std::size_t row = m_values.size();
+            if (row % 64 == 0)
+            {
+                m_validity.push_back(0);
+            }
+
+            if (value.has_value())
+            {
+                m_values.push_back(static_cast<Value>(value.value()));
+                m_validity.back() |= uint64_t{1} << (row % 64);
+            }
+            else
+            {
+                m_values.push_back(Value{});
+            }
+        }
+
+        void reserve(std::size_t rows)
+        {
+            m_values.reserve(rows);
+            m_validity.reserve((rows + 63) / 64);
+        }
+
+        void clear()
+        {
+            m_values.clear();
+            m_validity.clear();
+        }
+
+    private:
+        std::vector<Value> m_values{};
+        std::vector<uint64_t> m_validity{};
+    };
+
+    /**
+     * Row i of a transform column is the range of entries that sample i's transforms occupy in the flat per
+     * transform columns. */
+    struct TransformRange
+    {
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+
+    /**
+     * The columns a TakeStore keeps, laid out like the sample properties they come from. The sample and source ids
+     * are kept as their 16 byte values. Columns holding uint32_t ids for strings that repeat through a take, such as
+     * the tracker status, are interned and resolved with TakeStore::string(). */
+    struct TakeColumns
+    {
+        TakeColumn<opentrackiotypes::UrnUuid> sampleId{};
+        TakeColumn<opentrackiotypes::UrnUuid> sourceId{};
+        TakeColumn<uint32_t> sourceNumber{};
+
+        struct Timing
+        {
+            TakeColumn<opentrackiotypes::Timestamp> sampleTimestamp{};
+            TakeColumn<opentrackiotypes::Timestamp> recordedTimestamp{};
+            TakeColumn<uint16_t> sequenceNumber{};
+            TakeColumn<opentrackiotypes::Timecode> timecode{};
+        };
+        Timing timing{};
+
+        struct Lens
+        {
+            TakeColumn<double> entrancePupilOffset{};
+            TakeColumn<double> fStop{};
+            TakeColumn<double> focalLength{};
+            TakeColumn<double> focusDistance{};
+            TakeColumn<double> tStop{};
+
+            /**
+             * Encoders are either present with all three values or absent, so the three columns share validity. */
+            struct Encoders
+            {
+                TakeColumn<double> focus{};
+                TakeColumn<double> iris{};
+                TakeColumn<double> zoom{};
+            };
+            Encoders encoders{};
+
+            struct RawEncoders
+            {
+                TakeColumn<uint16_t> focus{};
+                TakeColumn<uint16_t> iris{};
+                TakeColumn<uint16_t> zoom{};
+            };
+            RawEncoders rawEncoders{};
+        };
+        Lens lens{};
+
+        struct Tracker
+        {
+            TakeColumn<uint32_t> notes{};
+            TakeColumn<bool> recording{};
+            TakeColumn<uint32_t> slate{};
+            TakeColumn<uint32_t> status{};
+        };
+        Tracker tracker{};
+
+        /**
+         * rows has an entry per sample, the remaining columns an entry per transform. */
+        struct Transforms
+        {
+            TakeColumn<TransformRange> rows{};
+            std::vector<opentrackiotypes::Vector3> translation{};
+            std::vector<opentrackiotypes::Rotation> rotation{};
+            TakeColumn<opentrackiotypes::Vector3> scale{};
+            TakeColumn<uint32_t> transformId{};
+            TakeColumn<uint32_t> parentTransformId{};
+        };
+        Transforms transforms{};
+    };
+
+    /**
+     * Copy assigns every property of sample that isn't one of the per frame fields in TakeColumns into residual,
+     * and clears those fields in it. Assigning into the same residual every time reuses its storage. */
+    void copyResidualProperties(const OpenTrackIOSample& sample, OpenTrackIOSample& residual);
+
+    /**
+     * Stores a take as columns rather than as a vector of samples, so scanning one field across every frame reads
+     * contiguous memory. The per frame fields are split into the columns above, everything else a sample holds,
+     * such as the static block, distortion coefficients or synchronisation, is serialised to CBOR and stored once per
+     * distinct value, so a static block that repeats through the take is only kept once. row() puts both back
+     * together into a sample equal to the one appended. Properties held in a sample's staticProperties by a
+     * StaticCache aren't stored. */
+    class TakeStore
+    {
+    public:
+        static constexpr uint32_t NO_RESIDUAL = UINT32_MAX;
+
+        void append(const OpenTrackIOSample& sample);
+
+        /**
+         * Overwrites out with row index, reusing its storage. Returns false if there is no such row. */
+        bool row(std::size_t index, OpenTrackIOSample& out) const;
+
+        std::size_t size() const { return m_present.size(); };
+        const TakeColumns& columns() const { return m_columns; };
+
+        /**
+         * The text behind an id from one of the interned columns. */
+        std::string_view string(uint32_t id) const { return m_strings[id]; };
+        std::size_t stringCount() const { return m_strings.size(); };
+
+        /**
+         * Number of distinct residual blocks and the bytes they take up. */
+        std::size_t residualCount() const { return m_residualOffsets.size() - 1; };
+        std::size_t residualBytes() const { return m_residuals.size(); };
+
+        void reserve(std::size_t rows);
+        void clear();
+
+    private:
+        enum Presence : uint8_t
+        {
+            LENS = 1 << 0,
+            TIMING = 1 << 1,
+            TRACKER = 1 << 2,
+            TRANSFORMS = 1 << 3
+        };
+
+        std::optional<uint32_t> intern(const std::optional<String>& text);
+        uint32_t storeResidual(const OpenTrackIOSample& sample);
+        std::optional<String> lookup(const TakeColumn<uint32_t>& column, std::size_t row) const;
+
+        TakeColumns m_columns{};
+        std::vector<uint8_t> m_present{};
+
+        std::vector<std::string> m_strings{};
+        std::map<std::string, uint32_t, std::less<>> m_stringIds{};
+
+        std::vector<uint32_t> m_residualIds{};
+        std::vector<uint8_t> m_residuals{};
+        std::vector<uint32_t> m_residualOffsets{0};
+        std::unordered_multimap<std::size_t, uint32_t> m_residualIndex{};
+
+        OpenTrackIOSample m_scratch{};
+        std::vector<uint8_t> m_scratchBytes{};
+    };
+} // namespace opentrackio
@@ -0,0 +1,222 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOMemory.h"
+
+namespace opentrackio
+{
+    class TapeNode;
+
+    /**
+     * A document decoded into a flat, pre-order array of fixed size entries, with every key and string copied into a
+     * single shared buffer. Containers record where their last descendant ends so siblings can be skipped without
+     * walking their contents. A tape that is reused from sample to sample stops allocating once it has grown to fit
+     * the largest sample, which is what lets the DOM-free initialise paths avoid building a nlohmann::json. */
+    class SampleTape
+    {
+    public:
+        enum class Type : uint8_t
+        {
+            NULL_VALUE,
+            BOOLEAN,
+            NUMBER_INTEGER,
+            NUMBER_UNSIGNED,
+            NUMBER_FLOAT,
+            STRING,
+            BINARY,
+            OBJECT,
+            ARRAY
+        };
+
+        struct Entry
+        {
+            Type type = Type::NULL_VALUE;
+            uint32_t keyOffset = 0;
+            uint32_t keyLength = 0;
+            // Direct child count for objects and arrays, byte length for strings and binary values.
+            uint32_t size = 0;
+            // Index one past the last entry that belongs to this value.
+            uint32_t next = 0;
+            union
+            {
+                uint64_t numberUnsigned = 0;
+                int64_t numberInteger;
+                double numberFloat;
+                bool boolean;
+                uint32_t stringOffset;
+            };
+        };
+
+        /**
+         * Decodes a CBOR document into the tape, replacing its previous contents. The decoder accepts the same input
+         * as nlohmann::json::from_cbor with its default arguments, tagged items are rejected and trailing bytes are
+         * an error, and it throws the same nlohmann::json::parse_error type on malformed input. */
+        void parseCbor(std::span<const uint8_t> cbor);
+
+        /**
+         * Decodes JSON text into the tape through nlohmann's SAX interface, replacing its previous contents. Accepts
+         * and rejects the same input as nlohmann::json::parse and throws the same exceptions. */
+        void parseJson(std::string_view json);
+
+        void clear();
+        TapeNode root() const;
+        const Vector<Entry>& entries() const { return m_entries; };
+        std::string_view text(uint32_t offset, uint32_t length) const;
+
+        /**
+         * Low level builders used by the decoders. Containers are opened and closed in document order, inside an
+         * object each value must be preceded by its key. */
+        void key(std::string_view key);
+        void beginObject();
+        void beginArray();
+        void endContainer();
+        void addNull();
+        void addBoolean(bool value);
+        void addInteger(int64_t value);
+        void addUnsigned(uint64_t value);
+        void addFloat(double value);
+        void addString(std::string_view value);
+        void addBinary(std::span<const uint8_t> value);
+
+    private:
+        Entry& addEntry(Type type);
+        uint32_t storeText(std::string_view text);
+
+        Vector<Entry> m_entries{};
+        Vector<char> m_text{};
+        Vector<uint32_t> m_openContainers{};
+        String m_scratch{};
+        uint32_t m_pendingKeyOffset = 0;
+        uint32_t m_pendingKeyLength = 0;
+    };
+
+    /**
+     * A read only view of one value in a SampleTape. It mirrors the parts of the const nlohmann::json interface that
+     * the property parsers use, so the same parsers run against either representation. Looking up a missing key
+     * returns a null node rather than asserting. */
+    class TapeNode
+    {
+    public:
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = TapeNode;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() = default;
+            Iterator(const SampleTape* tape, uint32_t index) : m_tape{tape}, m_index{index} {};
+
+            TapeNode operator*() const { return {*m_tape, m_index}; };
+            Iterator& operator++()
+            {
+                m_index = m_tape->entries()[m_index].next;
+                return *this;
+            };
+            Iterator operator++(int)
+            {
+                Iterator it = *this;
+                ++*this;
+                return it;
+            };
+            bool operator==(const Iterator& other) const { return m_index == other.m_index; };
+
+            /**
+             * The key of the current member when iterating an object. */
+            std::string_view key() const { return (**this).key(); };
+
+        private:
+            const SampleTape* m_tape = nullptr;
+            uint32_t m_index = 0;
+        };
+
+        TapeNode() = default;
+        TapeNode(const SampleTape& tape, uint32_t index) : m_tape{&tape}, m_entry{&tape.entries()[index]},
+                                                           m_index{index} {};
+
+        SampleTape::Type type() const { return m_entry->type; };
+        bool is_null() const { return type() == SampleTape::Type::NULL_VALUE; };
+        bool is_object() const { return type() == SampleTape::Type::OBJECT; };
+        bool is_array() const { return type() == SampleTape::Type::ARRAY; };
+        bool is_string() const { return type() == SampleTape::Type::STRING; };
+
+        /**
+         * Number of members or elements for containers, otherwise 1 for values and 0 for null, as nlohmann does. */
+        std::size_t size() const;
+        bool contains(std::string_view key) const;
+        TapeNode operator[](std::string_view key) const;
+
+        Iterator begin() const;
+        Iterator end() const;
+
+        std::string_view key() const;
+        const SampleTape::Entry* entry() const { return m_entry; };
+        const SampleTape* tape() const { return m_tape; };
+
+    private:
+        std::optional<uint32_t> find(std::string_view key) const;
+
+        static constexpr SampleTape::Entry s_nullEntry{};
+
+        const SampleTape* m_tape = nullptr;
+        const SampleTape::Entry* m_entry = &s_nullEntry;
+        uint32_t m_index = 0;
+    };
+
+    /**
+     * Value accessors matching the nlohmann::json ones in OpenTrackIOHelper.h, found by argument dependent lookup. */
+    inline const bool* getBoolean(const TapeNode& node)
+    {
+        return node.type() == SampleTape::Type::BOOLEAN ? &node.entry()->boolean : nullptr;
+    }
+
+    inline const int64_t* getInteger(const TapeNode& node)
+    {
+        return node.type() == SampleTape::Type::NUMBER_INTEGER ? &node.entry()->numberInteger : nullptr;
+    }
+
+    inline const uint64_t* getUnsigned(const TapeNode& node)
+    {
+        return node.type() == SampleTape::Type::NUMBER_UNSIGNED ? &node.entry()->numberUnsigned : nullptr;
+    }
+
+    inline const double* getFloat(const TapeNode& node)
+    {
+        return node.type() == SampleTape::Type::NUMBER_FLOAT ? &node.entry()->numberFloat : nullptr;
+    }
+
+    inline std::optional<std::string_view> getString(const TapeNode& node)
+    {
+        if (!node.is_string())
+        {
+            return std::nullopt;
+        }
+        return node.tape()->text(node.entry()->stringOffset, node.entry()->size);
+    }
+
+    inline const void* nodeId(const TapeNode& node)
+    {
+        return node.entry();
+    }
+
+    void nodeBytes(const TapeNode& node, std::string& out);
+} // namespace opentrackio
@@ -0,0 +1,403 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include "opentrackio-cpp/OpenTrackIOTypes.h"
+
+namespace opentrackio
+{
+    constexpr uint64_t OPEN_TRACK_IO_NANOSECONDS_PER_SECOND = 1'000'000'000;
+    constexpr uint64_t OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND = 1'000'000'000;
+    constexpr uint64_t OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND =
+            OPEN_TRACK_IO_NANOSECONDS_PER_SECOND * OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND;
+} // namespace opentrackio
+
+namespace opentrackio::opentrackiotypes
+{
+    /**
+     * A signed span of time to attosecond precision. The fraction is always below a second and counts forwards
+     * from seconds, so half a second before zero is {-1, 500000000000000000}, which keeps comparisons a plain field
+     * by field ordering. */
+    struct TimeOffset
+    {
+        int64_t seconds = 0;
+        uint64_t attoseconds = 0;
+
+        static constexpr TimeOffset fromNanoseconds(int64_t nanoseconds)
+        {
+            constexpr auto perSecond = static_cast<int64_t>(OPEN_TRACK_IO_NANOSECONDS_PER_SECOND);
+            const int64_t remainder = nanoseconds % perSecond;
+            const int64_t borrow = remainder < 0;
+            return {nanoseconds / perSecond - borrow,
+                    static_cast<uint64_t>(remainder + borrow * perSecond) * OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND};
+        }
+
+        /**
+         * Rounds to the nearest attosecond. Values that aren't numbers or don't fit in the seconds give a zero
+         * offset. */
+        static constexpr TimeOffset fromSeconds(double seconds)
+        {
+            constexpr double limit = 9.2e18;
+            if (!(seconds > -limit && seconds < limit))
+            {
+                return {};
+            }
+
+            auto whole = static_cast<int64_t>(seconds);
+            whole -= static_cast<double>(whole) > seconds;
+            const double fraction = (seconds - static_cast<double>(whole)) *
+                                    static_cast<double>(OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND);
+            const auto attoseconds = static_cast<uint64_t>(fraction + 0.5);
+            const bool carry = attoseconds >= OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND;
+            return {whole + carry, carry ? 0 : attoseconds};
+        }
+
+        /**
+         * Rounded down to a whole nanosecond. */
+        constexpr int64_t toNanoseconds() const
+        {
+            return seconds * static_cast<int64_t>(OPEN_TRACK_IO_NANOSECONDS_PER_SECOND) +
+                   static_cast<int64_t>(attoseconds / OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND);
+        }
+
+        constexpr double toSeconds() const
+        {
+            return static_cast<double>(seconds) +
+                   static_cast<double>(attoseconds) / static_cast<double>(OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND);
+        }
+
+        constexpr TimeOffset operator-() const
+        {
+            const bool borrow = attoseconds != 0;
+            return {-seconds - borrow, borrow ? OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND - attoseconds : 0};
+        }
+
+        constexpr TimeOffset operator+(const TimeOffset& other) const
+        {
+            const uint64_t sum = attoseconds + other.attoseconds;
+            const bool carry = sum >= OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND;
+            return {seconds + other.seconds + carry, sum - carry * OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND};
+        }
+
+        constexpr TimeOffset operator-(const TimeOffset& other) const { return *this + -other; }
+
+        bool operator==(const TimeOffset&) const = default;
+        auto operator<=>(const TimeOffset&) const = default;
+    };
+
+    /**
+     * The fraction of a second past the timestamp's seconds in attoseconds, which may reach a second or more if
+     * the nanoseconds or attoseconds aren't normalised. */
+    constexpr uint64_t subsecondAttoseconds(const Timestamp& timestamp)
+    {
+        return uint64_t{timestamp.nanoseconds} * OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND + timestamp.attoseconds;
+    }
+
+    /**
+     * Carries nanoseconds and attoseconds of a billion or more into the fields above them. */
+    constexpr Timestamp normalised(const Timestamp& timestamp)
+    {
+        const uint64_t fraction = subsecondAttoseconds(timestamp);
+        const uint64_t remainder = fraction % OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND;
+        return {timestamp.seconds + fraction / OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND,
+                static_cast<uint32_t>(remainder / OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND),
+                static_cast<uint32_t>(remainder % OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND)};
+    }
+
+    /**
+     * Timestamps can't go below zero, an offset that would take one there gives zero instead. The result is
+     * always normalised. */
+    constexpr Timestamp operator+(const Timestamp& timestamp, const TimeOffset& offset)
+    {
+        const Timestamp start = normalised(timestamp);
+        const uint64_t sum = subsecondAttoseconds(start) + offset.attoseconds;
+        const bool carry = sum >= OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND;
+        const uint64_t fraction = sum - carry * OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND;
+        const int64_t seconds = offset.seconds + carry;
+        if (seconds < 0 && start.seconds < static_cast<uint64_t>(-(seconds + 1)) + 1)
+        {
+            return {};
+        }
+
+        return {start.seconds + static_cast<uint64_t>(seconds),
+                static_cast<uint32_t>(fraction / OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND),
+                static_cast<uint32_t>(fraction % OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND)};
+    }
+
+    constexpr Timestamp operator-(const Timestamp& timestamp, const TimeOffset& offset)
+    {
+        return timestamp + -offset;
+    }
+
+    constexpr TimeOffset operator-(const Timestamp& a, const Timestamp& b)
+    {
+        const Timestamp lhs = normalised(a);
+        const Timestamp rhs = normalised(b);
+        const uint64_t lhsFraction = subsecondAttoseconds(lhs);
+        const uint64_t rhsFraction = subsecondAttoseconds(rhs);
+        const bool borrow = lhsFraction < rhsFraction;
+        return {static_cast<int64_t>(lhs.seconds - rhs.seconds) - borrow,
+                lhsFraction + borrow * OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND - rhsFraction};
+    }
+} // namespace opentrackio::opentrackiotypes
+
+namespace opentrackio
+{
+    /**
+     * Frame indexing works on any rate whose numerator and denominator are positive and fit in 32 bits, as the
+     * schema requires, and on timestamps up to 2^63 / numerator seconds, which for 120000/1001 is over two
+     * thousand years past the epoch. Everything is done in integers, so frame boundaries land exactly where the
+     * rate puts them however many frames in they are. */
+    constexpr bool isValidRate(const opentrackiotypes::Rational& rate)
+    {
+        constexpr int64_t limit = std::numeric_limits<uint32_t>::max();
+        return rate.numerator > 0 && rate.denominator > 0 && rate.numerator <= limit && rate.denominator <= limit;
+    }
+
+    /**
+     * The timestamp multiplied by a whole number, with the attosecond fraction of the product carried exactly. */
+    constexpr opentrackiotypes::Timestamp scaled(const opentrackiotypes::Timestamp& timestamp, uint32_t factor)
+    {
+        constexpr uint64_t billion = OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND;
+        const opentrackiotypes::Timestamp start = opentrackiotypes::normalised(timestamp);
+        const uint64_t atto = uint64_t{start.attoseconds} * factor;
+        const uint64_t nano = uint64_t{start.nanoseconds} * factor + atto / billion;
+        return {start.seconds * factor + nano / billion, static_cast<uint32_t>(nano % billion),
+                static_cast<uint32_t>(atto % billion)};
+    }
+
+    /**
+     * Index of the frame the timestamp falls in, counting frame 0 from zero time, so frame n covers
+     * [n * denominator / numerator, (n + 1) * denominator / numerator) seconds. */
+    constexpr std::optional<int64_t> frameAt(const opentrackiotypes::Timestamp& timestamp,
+                                             const opentrackiotypes::Rational& rate)
+    {
+        if (!isValidRate(rate))
+        {
+            return std::nullopt;
+        }
+
+        const auto denominator = static_cast<uint64_t>(rate.denominator);
+        return static_cast<int64_t>(scaled(timestamp, static_cast<uint32_t>(rate.numerator)).seconds / denominator);
+    }
+
+    /**
+     * Index of the frame whose start is nearest to the timestamp, a timestamp exactly halfway rounds up. */
+    constexpr std::optional<int64_t> nearestFrameAt(const opentrackiotypes::Timestamp& timestamp,
+                                                    const opentrackiotypes::Rational& rate)
+    {
+        if (!isValidRate(rate))
+        {
+            return std::nullopt;
+        }
+
+        // Adding half a frame before rounding down gives the nearest, half of an odd denominator is half a second.
+        const auto denominator = static_cast<uint64_t>(rate.denominator);
+        const opentrackiotypes::TimeOffset half{static_cast<int64_t>(denominator / 2),
+                                                (denominator % 2) * (OPEN_TRACK_IO_ATTOSECONDS_PER_SECOND / 2)};
+        const auto shifted = scaled(timestamp, static_cast<uint32_t>(rate.numerator)) + half;
+        return static_cast<int64_t>(shifted.seconds / denominator);
+    }
+
+    /**
+     * The first attosecond of the frame. Frame starts are rounded up to a whole attosecond so that frameAt always
+     * gives back the same frame. */
+    constexpr std::optional<opentrackiotypes::Timestamp> frameStart(int64_t frame,
+                                                                    const opentrackiotypes::Rational& rate)
+    {
+        const auto denominator = static_cast<uint64_t>(rate.denominator);
+        if (!isValidRate(rate) || frame < 0 ||
+            static_cast<uint64_t>(frame) > std::numeric_limits<uint64_t>::max() / denominator)
+        {
+            return std::nullopt;
+        }
+
+        constexpr uint64_t billion = OPEN_TRACK_IO_ATTOSECONDS_PER_NANOSECOND;
+        const auto numerator = static_cast<uint64_t>(rate.numerator);
+        const uint64_t total = static_cast<uint64_t>(frame) * denominator;
+        const uint64_t remainder = total % numerator;
+        const uint64_t nanoseconds = remainder * billion / numerator;
+        const uint64_t attoseconds = (remainder * billion % numerator * billion + numerator - 1) / numerator;
+        return opentrackiotypes::normalised({total / numerator, static_cast<uint32_t>(nanoseconds),
+                                             static_cast<uint32_t>(attoseconds)});
+    }
+
+    /**
+     * The number of labels per second a timecode at the rate counts, 30 for 30000/1001. */
+    constexpr int64_t nominalRate(const opentrackiotypes::Rational& rate)
+    {
+        return isValidRate(rate) ? (rate.numerator + rate.denominator - 1) / rate.denominator : 0;
+    }
+
+    /**
+     * Frame labels skipped at the start of each minute other than every tenth, 2 at 30 and 4 at 60 for drop frame
+     * timecodes, 0 otherwise. Drop frame is only defined for nominal rates that are multiples of 30. */
+    constexpr std::optional<int64_t> droppedLabels(const opentrackiotypes::Timecode::Format& format)
+    {
+        const int64_t nominal = nominalRate(format.frameRate);
+        if (nominal == 0 || (format.dropFrame && nominal % 30 != 0))
+        {
+            return std::nullopt;
+        }
+        return format.dropFrame ? nominal / 15 : 0;
+    }
+
+    /**
+     * Frames from one midnight to the next. */
+    constexpr std::optional<int64_t> framesPerDay(const opentrackiotypes::Timecode::Format& format)
+    {
+        const auto dropped = droppedLabels(format);
+        if (!dropped.has_value())
+        {
+            return std::nullopt;
+        }
+        return nominalRate(format.frameRate) * 86400 - dropped.value() * (1440 - 144);
+    }
+
+    /**
+     * Frames since midnight up to the timecode, nothing for a label out of range or one the drop frame count
+     * skips. */
+    constexpr std::optional<int64_t> toFrameCount(const opentrackiotypes::Timecode& timecode)
+    {
+        const auto dropped = droppedLabels(timecode.format);
+        const int64_t nominal = nominalRate(timecode.format.frameRate);
+        if (!dropped.has_value() || timecode.hours >= 24 || timecode.minutes >= 60 || timecode.seconds >= 60 ||
+            timecode.frames >= nominal)
+        {
+            return std::nullopt;
+        }
+
+        const int64_t minutes = int64_t{timecode.hours} * 60 + timecode.minutes;
+        if (timecode.seconds == 0 && timecode.frames < dropped.value() && minutes % 10 != 0)
+        {
+            return std::nullopt;
+        }
+
+        return (minutes * 60 + timecode.seconds) * nominal + timecode.frames -
+               dropped.value() * (minutes - minutes / 10);
+    }
+
+    /**
+     * The timecode labelling the frame, frame counts outside a day wrap around midnight in either direction. */
+    constexpr std::optional<opentrackiotypes::Timecode> toTimecode(int64_t frameCount,
+                                                                   const opentrackiotypes::Timecode::Format& format)
+    {
+        const auto dropped = droppedLabels(format);
+        if (!dropped.has_value())
+        {
+            return std::nullopt;
+        }
+
+        const int64_t nominal = nominalRate(format.frameRate);
+        const int64_t day = framesPerDay(format).value();
+        int64_t frame = frameCount % day;
+        frame += (frame < 0) * day;
+
+        // Put back the labels dropped before this frame, 9 minutes in every 10 skip theirs.
+        const int64_t drop = dropped.value();
+        const int64_t perTenMinutes = nominal * 600 - drop * 9;
+        const int64_t perMinute = nominal * 60 - drop;
+        const int64_t remainder = frame % perTenMinutes;
+        frame += drop * 9 * (frame / perTenMinutes) + drop * (std::max(remainder - drop, int64_t{0}) / perMinute);
+
+        return opentrackiotypes::Timecode(static_cast<uint8_t>(frame / (nominal * 3600)),
+                                          static_cast<uint8_t>(frame / (nominal * 60) % 60),
+                                          static_cast<uint8_t>(frame / nominal % 60),
+                                          static_cast<uint8_t>(frame % nominal), format);
+    }
+
+    constexpr std::optional<opentrackiotypes::Timecode> addFrames(const opentrackiotypes::Timecode& timecode,
+                                                                  int64_t frames)
+    {
+        const auto count = toFrameCount(timecode);
+        return count.has_value() ? toTimecode(count.value() + frames, timecode.format) : std::nullopt;
+    }
+
+    /**
+     * Time since midnight at which the timecode's frame starts, at the real rate of its format, so 01:00:00;00 at
+     * 30000/1001 drop frame is 3599.9964 seconds in. */
+    constexpr std::optional<opentrackiotypes::Timestamp> timeOfDay(const opentrackiotypes::Timecode& timecode)
+    {
+        const auto count = toFrameCount(timecode);
+        return count.has_value() ? frameStart(count.value(), timecode.format.frameRate) : std::nullopt;
+    }
+
+    /**
+     * The timecode of the frame a time since midnight falls in. */
+    constexpr std::optional<opentrackiotypes::Timecode> timecodeAt(const opentrackiotypes::Timestamp& timeOfDay,
+                                                                   const opentrackiotypes::Timecode::Format& format)
+    {
+        const auto frame = frameAt(timeOfDay, format.frameRate);
+        return frame.has_value() ? toTimecode(frame.value(), format) : std::nullopt;
+    }
+
+    /**
+     * Batch forms of the conversions above for spans of the same length, sharing the rate or format checks. They
+     * return false without writing anything if the lengths differ or the rate or format is invalid, and toFrameCounts
+     * writes -1 for each timecode it can't convert and returns false if there were any. */
+    constexpr bool framesAt(std::span<const opentrackiotypes::Timestamp> timestamps,
+                            const opentrackiotypes::Rational& rate, std::span<int64_t> frames)
+    {
+        if (timestamps.size() != frames.size() || !isValidRate(rate))
+        {
+            return false;
+        }
+
+        const auto numerator = static_cast<uint32_t>(rate.numerator);
+        const auto denominator = static_cast<uint64_t>(rate.denominator);
+        for (std::size_t i = 0; i < timestamps.size(); ++i)
+        {
+            frames[i] = static_cast<int64_t>(scaled(timestamps[i], numerator).seconds / denominator);
+        }
+        return true;
+    }
+
+    constexpr bool toFrameCounts(std::span<const opentrackiotypes::Timecode> timecodes, std::span<int64_t> frames)
+    {
+        if (timecodes.size() != frames.size())
+        {
+            return false;
+        }
+
+        bool converted = true;
+        for (std::size_t i = 0; i < timecodes.size(); ++i)
+        {
+            const auto count = toFrameCount(timecodes[i]);
+            converted &= count.has_value();
+            frames[i] = count.value_or(-1);
+        }
+        return converted;
+    }
+
+    constexpr bool toTimecodes(std::span<const int64_t> frames, const opentrackiotypes::Timecode::Format& format,
+                               std::span<opentrackiotypes::Timecode> timecodes)
+    {
+        if (frames.size() != timecodes.size() || !droppedLabels(format).has_value())
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < frames.size(); ++i)
+        {
+            timecodes[i] = toTimecode(frames[i], format).value();
+        }
+        return true;
+    }
+} // namespace opentrackio
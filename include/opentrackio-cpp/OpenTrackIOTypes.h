@@ -12,6 +12,7 @@
  */
 
 #pragma once
+#include <compare>
 #include <optional>
 #include <string>
 #include <vector>
@@ -26,12 +27,13 @@ namespace opentrackio::opentrackiotypes
         int64_t numerator = 0;
         int64_t denominator = 0;
 
-        Rational() = default;
+        constexpr Rational() = default;
 
-        Rational(int64_t n, int64_t d) : numerator{n}, denominator{d}
+        constexpr Rational(int64_t n, int64_t d) : numerator{n}, denominator{d}
         {};
         
-        static std::optional<Rational> parse(nlohmann::json &json, std::string_view fieldStr, std::vector<std::string> &errors)
+        template<JsonNode Json>
+        static std::optional<Rational> parse(const Json &json, std::string_view fieldStr, ParseContext &ctx)
         {
             const auto& rationalJson = json[fieldStr];
 
@@ -39,19 +41,21 @@ namespace opentrackio::opentrackiotypes
             uint32_t denom;
             if (!rationalJson.contains("num") || !rationalJson.contains("denom"))
             {
-                errors.emplace_back(std::format("Key: {} is missing numerator or denominator field.", fieldStr));
+                ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "Key: {} is missing numerator or denominator field.", fieldStr);
                 return std::nullopt;
             }
 
             if (!OpenTrackIOHelpers::checkTypeAndSetField(rationalJson["num"], num) ||
                 !OpenTrackIOHelpers::checkTypeAndSetField(rationalJson["denom"], denom))
             {
-                errors.emplace_back(std::format("Key: {} numerator or denominator field types are incorrect.", fieldStr));
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "Key: {} numerator or denominator field types are incorrect.", fieldStr, "uint32");
                 return std::nullopt;
             }
 
             return Rational(num, denom);
         }
+
+        bool operator==(const Rational&) const = default;
     };
 
     struct Vector3
@@ -65,14 +69,15 @@ namespace opentrackio::opentrackiotypes
         Vector3(double x, double y, double z) : x{x}, y{y}, z{z}
         {};
 
-        static std::optional<Vector3> parse(nlohmann::json &json, std::string_view fieldStr, std::vector<std::string> &errors)
+        template<JsonNode Json>
+        static std::optional<Vector3> parse(const Json &json, std::string_view fieldStr, ParseContext &ctx)
         {
             const auto& vecJson = json[fieldStr];
 
             Vector3 vec{};
             if (!vecJson.contains("x") || !vecJson.contains("y") || !vecJson.contains("z"))
             {
-                errors.emplace_back(std::format("Key: {} Vector3 is missing required fields", fieldStr));
+                ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "Key: {} Vector3 is missing required fields", fieldStr);
                 return std::nullopt;
             }
 
@@ -80,12 +85,14 @@ namespace opentrackio::opentrackiotypes
                 !OpenTrackIOHelpers::checkTypeAndSetField(vecJson["y"], vec.y) ||
                 !OpenTrackIOHelpers::checkTypeAndSetField(vecJson["z"], vec.z))
             {
-                errors.emplace_back(std::format("Key: {} Vector3 fields aren't of type double", fieldStr));
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "Key: {} Vector3 fields aren't of type {}", fieldStr, "double");
                 return std::nullopt;
             }
 
             return vec;
         }
+
+        bool operator==(const Vector3&) const = default;
     };
 
     struct Rotation
@@ -99,14 +106,15 @@ namespace opentrackio::opentrackiotypes
         Rotation(double p, double t, double r) : pan{p}, tilt{t}, roll{r}
         {};
 
-        static std::optional<Rotation> parse(nlohmann::json &json, std::string_view fieldStr, std::vector<std::string> &errors)
+        template<JsonNode Json>
+        static std::optional<Rotation> parse(const Json &json, std::string_view fieldStr, ParseContext &ctx)
         {
             const auto& rotJson = json[fieldStr];
 
             Rotation rot{};
             if (!rotJson.contains("pan") || !rotJson.contains("tilt") || !rotJson.contains("roll"))
             {
-                errors.emplace_back(std::format("Key: {} Rotation is missing required fields", fieldStr));
+                ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "Key: {} Rotation is missing required fields", fieldStr);
                 return std::nullopt;
             }
 
@@ -114,12 +122,14 @@ namespace opentrackio::opentrackiotypes
                 !OpenTrackIOHelpers::checkTypeAndSetField(rotJson["pan"], rot.pan) ||
                 !OpenTrackIOHelpers::checkTypeAndSetField(rotJson["roll"], rot.roll))
             {
-                errors.emplace_back(std::format("Key: {} Rotation fields aren't of type double", fieldStr));
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "Key: {} Rotation fields aren't of type {}", fieldStr, "double");
                 return std::nullopt;
             }
 
             return rot;
         }
+
+        bool operator==(const Rotation&) const = default;
     };
 
     struct Timecode
@@ -134,35 +144,43 @@ namespace opentrackio::opentrackiotypes
             Rational frameRate{};
             bool dropFrame = false;
             std::optional<bool> oddField = std::nullopt;            
+
+            bool operator==(const Format&) const = default;
         };
         Format format{};
         
-        Timecode() = default;
+        constexpr Timecode() = default;
 
-        Timecode(uint8_t h, uint8_t m, uint8_t s, uint8_t f, Format fmt)
+        constexpr Timecode(uint8_t h, uint8_t m, uint8_t s, uint8_t f, Format fmt)
                 : hours{h}, minutes{m}, seconds{s}, frames{f}, format{fmt} {};
 
-        static std::optional<Timecode> parse(nlohmann::json &json, std::string_view fieldStr, std::vector<std::string> &errors)
+        template<JsonNode Json>
+        static std::optional<Timecode> parse(const Json &json, std::string_view fieldStr, ParseContext &ctx)
         {
-            auto& tcJson = json[fieldStr];
+            const auto& tcJson = json[fieldStr];
 
             std::optional<uint8_t> hours = std::nullopt;
             std::optional<uint8_t> minutes = std::nullopt;
             std::optional<uint8_t> seconds = std::nullopt;
             std::optional<uint8_t> frames = std::nullopt;
 
-            OpenTrackIOHelpers::assignField(tcJson, "hours", hours, "uint8", errors);
-            OpenTrackIOHelpers::assignField(tcJson, "minutes", minutes, "uint8", errors);
-            OpenTrackIOHelpers::assignField(tcJson, "seconds", seconds, "uint8", errors);
-            OpenTrackIOHelpers::assignField(tcJson, "frames", frames, "uint8", errors);
+            {
+                DiagnosticScope timecodeScope{ctx.diagnostics, fieldStr};
+                OpenTrackIOHelpers::assignField(tcJson, "hours", hours, "uint8", ctx);
+                OpenTrackIOHelpers::assignField(tcJson, "minutes", minutes, "uint8", ctx);
+                OpenTrackIOHelpers::assignField(tcJson, "seconds", seconds, "uint8", ctx);
+                OpenTrackIOHelpers::assignField(tcJson, "frames", frames, "uint8", ctx);
+            }
 
             if (!hours.has_value() || !minutes.has_value() || !seconds.has_value() || !frames.has_value())
             {
-                errors.emplace_back("field: timing/timecode is missing required fields");
+                ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "field: {} is missing required fields", fieldStr);
                 return std::nullopt;
             }
 
+            DiagnosticScope timecodeScope{ctx.diagnostics, fieldStr};
             const bool formatFieldValid =
+                    tcJson.contains("format") &&
                     tcJson["format"].contains("frameRate") &&
                     tcJson["format"].contains("dropFrame") &&
                     tcJson["format"]["frameRate"].contains("num") &&
@@ -170,17 +188,18 @@ namespace opentrackio::opentrackiotypes
 
             if (!formatFieldValid)
             {
-                errors.emplace_back("field: timing/timecode/format is missing required fields");
+                ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "field: {} is missing required fields", "format");
                 return std::nullopt;
             }
 
-            auto fr = Rational::parse(tcJson["format"], "frameRate", errors);
+            DiagnosticScope formatScope{ctx.diagnostics, "format"};
+            auto fr = Rational::parse(tcJson["format"], "frameRate", ctx);
             bool drop;
             std::optional<bool> odd;
 
             if (!OpenTrackIOHelpers::checkTypeAndSetField(tcJson["format"]["dropFrame"], drop))
             {
-                errors.emplace_back("field: timing/timecode/format/dropFrame isn't of type: bool");
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", "dropFrame", "bool");
                 return std::nullopt;
             }
 
@@ -189,10 +208,12 @@ namespace opentrackio::opentrackiotypes
                 return std::nullopt;
             }
 
-            OpenTrackIOHelpers::assignField(tcJson["format"], "oddField", odd, "bool", errors);
+            OpenTrackIOHelpers::assignField(tcJson["format"], "oddField", odd, "bool", ctx);
 
             return Timecode{hours.value(), minutes.value(), seconds.value(), frames.value(), Format{fr.value(), drop, odd}};
         }
+
+        bool operator==(const Timecode&) const = default;
     };
 
     struct Timestamp
@@ -201,31 +222,41 @@ namespace opentrackio::opentrackiotypes
         uint32_t nanoseconds = 0;
         uint32_t attoseconds = 0;
 
-        Timestamp() = default;
+        constexpr Timestamp() = default;
 
-        Timestamp(uint64_t s, uint32_t n, uint32_t a) : seconds{s}, nanoseconds{n}, attoseconds{a}
+        constexpr Timestamp(uint64_t s, uint32_t n, uint32_t a) : seconds{s}, nanoseconds{n}, attoseconds{a}
         {};
 
-        static std::optional<Timestamp> parse(nlohmann::json &json, std::string_view fieldStr, std::vector<std::string> &errors)
+        template<JsonNode Json>
+        static std::optional<Timestamp> parse(const Json &json, std::string_view fieldStr, ParseContext &ctx)
         {
-            auto& tsJson = json[fieldStr];
+            const auto& tsJson = json[fieldStr];
 
             std::optional<uint64_t> seconds = std::nullopt;
             std::optional<uint32_t> nanoseconds = std::nullopt;
             std::optional<uint32_t> attoseconds = std::nullopt;
 
-            OpenTrackIOHelpers::assignField(tsJson, "seconds", seconds, "uint64", errors);
-            OpenTrackIOHelpers::assignField(tsJson, "nanoseconds", nanoseconds, "uint32_t", errors);
-            OpenTrackIOHelpers::assignField(tsJson, "attoseconds", attoseconds, "uint32_t", errors);
+            {
+                DiagnosticScope timestampScope{ctx.diagnostics, fieldStr};
+                OpenTrackIOHelpers::assignField(tsJson, "seconds", seconds, "uint64", ctx);
+                OpenTrackIOHelpers::assignField(tsJson, "nanoseconds", nanoseconds, "uint32_t", ctx);
+                OpenTrackIOHelpers::assignField(tsJson, "attoseconds", attoseconds, "uint32_t", ctx);
+            }
 
             if (!seconds.has_value() || !nanoseconds.has_value())
             {
-                errors.emplace_back("field: timestamp is missing required fields");
+                ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "field: {} is missing required fields", fieldStr);
                 return std::nullopt;
             }
 
             return Timestamp(seconds.value(), nanoseconds.value(), attoseconds.value_or(0));
         }
+
+        bool operator==(const Timestamp&) const = default;
+        /**
+         * Orders by the fields in turn, which is chronological for timestamps whose nanoseconds and attoseconds
+         * are each below a billion. */
+        auto operator<=>(const Timestamp&) const = default;
     };
 
     template<typename T>
@@ -240,24 +271,30 @@ namespace opentrackio::opentrackiotypes
         Dimensions(T w, T h) : width{w}, height{h}
         {};
 
-        static std::optional<Dimensions<T>> parse(nlohmann::json &json, std::string_view fieldStr, std::vector<std::string> &errors)
+        template<JsonNode Json>
+        static std::optional<Dimensions<T>> parse(const Json &json, std::string_view fieldStr, ParseContext &ctx)
         {
-            auto& dimJson = json[fieldStr];
+            const auto& dimJson = json[fieldStr];
 
             std::optional<T> width = std::nullopt;
             std::optional<T> height = std::nullopt;
 
-            OpenTrackIOHelpers::assignField(dimJson, "width", width, "number", errors);
-            OpenTrackIOHelpers::assignField(dimJson, "height", height, "number", errors);
+            {
+                DiagnosticScope dimensionsScope{ctx.diagnostics, fieldStr};
+                OpenTrackIOHelpers::assignField(dimJson, "width", width, "number", ctx);
+                OpenTrackIOHelpers::assignField(dimJson, "height", height, "number", ctx);
+            }
 
             if (!width.has_value() || !height.has_value())
             {
-                errors.emplace_back(std::format("Key: {} dimensions is missing required fields", fieldStr));
+                ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "Key: {} dimensions is missing required fields", fieldStr);
                 return std::nullopt;
             }
 
             return Dimensions(width.value(), height.value());
         }
+
+        bool operator==(const Dimensions&) const = default;
     };
 
     struct Transform
@@ -265,35 +302,37 @@ namespace opentrackio::opentrackiotypes
         Vector3 translation{};
         Rotation rotation{};
         std::optional<Vector3> scale = std::nullopt;
-        std::optional<std::string> transformId = std::nullopt;
-        std::optional<std::string> parentTransformId = std::nullopt;
+        std::optional<String> transformId = std::nullopt;
+        std::optional<String> parentTransformId = std::nullopt;
 
         Transform() = default;
 
         Transform(Vector3 trans, Rotation rot) : translation{trans}, rotation{rot} {};
         
-        static std::optional<Transform> parse(nlohmann::json &json, std::vector<std::string> &errors)
+        /**
+         * Parses into an existing transform so that its id strings keep their capacity, returns false and leaves
+         * the transform in an unspecified state if the required fields are missing or invalid. */
+        template<JsonNode Json>
+        static bool parse(const Json &json, ParseContext &ctx, Transform &tf)
         {
-            Transform tf{};
-
             // Required Fields --------
             std::optional<Vector3> translation = std::nullopt;
             std::optional<Rotation> rotation = std::nullopt;
 
             if (!json.contains("translation") || !json.contains("rotation"))
             {
-                return std::nullopt;
+                return false;
             }
 
-            translation = Vector3::parse(json, "translation", errors);
-            json.erase("translation");
+            translation = Vector3::parse(json, "translation", ctx);
+            ctx.consumed.consume(json["translation"]);
 
-            rotation = Rotation::parse(json, "rotation", errors);
-            json.erase("rotation");
+            rotation = Rotation::parse(json, "rotation", ctx);
+            ctx.consumed.consume(json["rotation"]);
             
             if (!translation.has_value() || !rotation.has_value())
             {
-                return std::nullopt;
+                return false;
             }
             
             tf.translation = translation.value();
@@ -302,14 +341,38 @@ namespace opentrackio::opentrackiotypes
             // Non-required fields ------
             if (json.contains("scale"))
             {
-                tf.scale = Vector3::parse(json, "scale", errors);
-                json.erase("scale");
+                tf.scale = Vector3::parse(json, "scale", ctx);
+                ctx.consumed.consume(json["scale"]);
+            }
+            else
+            {
+                tf.scale = std::nullopt;
             }
             
-            OpenTrackIOHelpers::assignField(json, "transformId", tf.transformId, "string", errors);
-            OpenTrackIOHelpers::assignField(json, "parentTransformId", tf.parentTransformId, "string", errors);
+            OpenTrackIOHelpers::assignField(json, "transformId", tf.transformId, "string", ctx);
+            OpenTrackIOHelpers::assignField(json, "parentTransformId", tf.parentTransformId, "string", ctx);
 
-            return tf;
+            return true;
         }
+
+        bool operator==(const Transform&) const = default;
     };
+
+    /**
+     * nlohmann conversions so that UrnUuid values are written to and read from JSON as their urn:uuid strings. */
+    inline void to_json(nlohmann::json& json, const UrnUuid& uuid)
+    {
+        const auto chars = uuid.toChars();
+        json = std::string_view{chars.data(), chars.size()};
+    }
+
+    inline void from_json(const nlohmann::json& json, UrnUuid& uuid)
+    {
+        const auto parsed = UrnUuid::parse(json.get_ref<const std::string&>());
+        if (!parsed.has_value())
+        {
+            throw nlohmann::json::other_error::create(501, "string isn't a urn:uuid", &json);
+        }
+        uuid = parsed.value();
+    }
 } // namespace opentrackio::opentrackiotypes
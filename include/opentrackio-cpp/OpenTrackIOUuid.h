@@ -0,0 +1,184 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace opentrackio::opentrackiotypes
+{
+    /**
+     * A urn:uuid identifier held as its 16 bytes. It parses exactly the strings the spec pattern
+     * ^urn:uuid:[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}$ accepts, and as upper case hex is
+     * rejected the canonical string it formats back to is always the text it was parsed from. Being trivially copyable
+     * and cheap to hash and compare it can key the per source caches directly. The default value is the nil UUID. */
+    struct UrnUuid
+    {
+        static constexpr std::string_view PREFIX = "urn:uuid:";
+        static constexpr std::size_t LENGTH = PREFIX.size() + 36;
+
+        std::array<uint8_t, 16> bytes{};
+
+        constexpr UrnUuid() = default;
+        constexpr explicit UrnUuid(const std::array<uint8_t, 16>& b) : bytes{b} {};
+
+        /**
+         * Construction and assignment from a urn:uuid string, so that writers which set ids from strings, such as
+         * sampleId->id = "urn:uuid:...", keep compiling. A string parse() rejects throws std::invalid_argument, call
+         * parse() instead to check untrusted text without throwing. */
+        constexpr explicit UrnUuid(std::string_view str) : UrnUuid{parseOrThrow(str)} {};
+        constexpr UrnUuid& operator=(std::string_view str) { return *this = parseOrThrow(str); };
+
+        /**
+         * The UUID in a urn:uuid string, or nullopt if the string doesn't match the spec pattern. */
+        static constexpr std::optional<UrnUuid> parse(std::string_view str) noexcept
+        {
+            if (str.size() != LENGTH || !str.starts_with(PREFIX))
+            {
+                return std::nullopt;
+            }
+
+            UrnUuid uuid{};
+            std::size_t byte = 0;
+            for (std::size_t i = PREFIX.size(); i < LENGTH; i += 2)
+            {
+                if (isSeparator(i - PREFIX.size()))
+                {
+                    if (str[i] != '-')
+                    {
+                        return std::nullopt;
+                    }
+                    ++i;
+                }
+
+                const int high = hexValue(str[i]);
+                const int low = hexValue(str[i + 1]);
+                if (high < 0 || low < 0)
+                {
+                    return std::nullopt;
+                }
+                uuid.bytes[byte++] = static_cast<uint8_t>(high << 4 | low);
+            }
+            return uuid;
+        }
+
+        /**
+         * The canonical urn:uuid string, formatted into a fixed buffer so that writing it out needn't allocate. */
+        constexpr std::array<char, LENGTH> toChars() const noexcept
+        {
+            constexpr std::string_view digits = "0123456789abcdef";
+            std::array<char, LENGTH> chars{};
+            std::size_t out = 0;
+            for (const char c : PREFIX)
+            {
+                chars[out++] = c;
+            }
+
+            for (std::size_t byte = 0; byte < bytes.size(); ++byte)
+            {
+                if (isSeparator(out - PREFIX.size()))
+                {
+                    chars[out++] = '-';
+                }
+                chars[out++] = digits[bytes[byte] >> 4];
+                chars[out++] = digits[bytes[byte] & 0xF];
+            }
+            return chars;
+        }
+
+        std::string toString() const
+        {
+            const auto chars = toChars();
+            return {chars.data(), chars.size()};
+        }
+
+        /**
+         * Converts to the canonical string for code written against the string ids. */
+        operator std::string() const { return toString(); };
+
+        constexpr bool isNil() const noexcept { return *this == UrnUuid{}; };
+
+        constexpr std::size_t hash() const noexcept
+        {
+            uint64_t high = 0;
+            uint64_t low = 0;
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+                high = high << 8 | bytes[i];
+                low = low << 8 | bytes[i + 8];
+            }
+            // Most UUIDs are already random, the mix only guards against sequential or hand written ones.
+            uint64_t hash = (high ^ std::rotl(low, 32)) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 29;
+            return static_cast<std::size_t>(hash);
+        }
+
+        constexpr bool operator==(const UrnUuid&) const = default;
+        constexpr auto operator<=>(const UrnUuid&) const = default;
+
+        friend constexpr bool operator==(const UrnUuid& uuid, std::string_view str) noexcept
+        {
+            const auto other = parse(str);
+            return other.has_value() && other.value() == uuid;
+        }
+
+    private:
+        static constexpr UrnUuid parseOrThrow(std::string_view str)
+        {
+            const auto uuid = parse(str);
+            if (!uuid.has_value())
+            {
+                throw std::invalid_argument{"string isn't a urn:uuid"};
+            }
+            return uuid.value();
+        }
+
+        static constexpr bool isSeparator(std::size_t index) noexcept
+        {
+            return index == 8 || index == 13 || index == 18 || index == 23;
+        }
+
+        static constexpr int hexValue(char c) noexcept
+        {
+            if (c >= '0' && c <= '9')
+            {
+                return c - '0';
+            }
+            if (c >= 'a' && c <= 'f')
+            {
+                return c - 'a' + 10;
+            }
+            return -1;
+        }
+    };
+
+    static_assert(sizeof(UrnUuid) == 16 && std::is_trivially_copyable_v<UrnUuid>);
+} // namespace opentrackio::opentrackiotypes
+
+template<>
+struct std::hash<opentrackio::opentrackiotypes::UrnUuid>
+{
+    std::size_t operator()(const opentrackio::opentrackiotypes::UrnUuid& uuid) const noexcept
+    {
+        return uuid.hash();
+    }
+};
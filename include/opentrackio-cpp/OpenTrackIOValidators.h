@@ -0,0 +1,120 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+/**
+ * Hand-written matchers for the string patterns used by the OpenTrackIO schema. These replace std::regex, which is
+ * expensive to construct, and are constexpr so they can be shared freely and evaluated at compile time. */
+namespace opentrackio::opentrackiovalidators
+{
+    constexpr bool isDigit(char c) noexcept
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    constexpr bool isLowerHex(char c) noexcept
+    {
+        return isDigit(c) || (c >= 'a' && c <= 'f');
+    }
+
+    constexpr bool isUpperHex(char c) noexcept
+    {
+        return isDigit(c) || (c >= 'A' && c <= 'F');
+    }
+
+    /**
+     * Pattern: ^urn:uuid:[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}$ */
+    struct UrnUuid
+    {
+        static constexpr std::string_view prefix = "urn:uuid:";
+        static constexpr std::size_t length = prefix.size() + 36;
+
+        constexpr bool operator()(std::string_view str) const noexcept
+        {
+            if (str.size() != length || !str.starts_with(prefix))
+            {
+                return false;
+            }
+
+            const std::string_view uuid = str.substr(prefix.size());
+            for (std::size_t i = 0; i < uuid.size(); ++i)
+            {
+                const bool isSeparator = i == 8 || i == 13 || i == 18 || i == 23;
+                if (isSeparator ? uuid[i] != '-' : !isLowerHex(uuid[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /**
+     * Pattern: ^([A-F0-9]{2}:){5}[A-F0-9]{2}$ */
+    struct MacAddress
+    {
+        static constexpr std::size_t length = 17;
+
+        constexpr bool operator()(std::string_view str) const noexcept
+        {
+            if (str.size() != length)
+            {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < str.size(); ++i)
+            {
+                if (i % 3 == 2 ? str[i] != ':' : !isUpperHex(str[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /**
+     * Pattern: ^[0-9]+.[0-9]+.[0-9]+$ where the separators are dots. */
+    struct Version
+    {
+        constexpr bool operator()(std::string_view str) const noexcept
+        {
+            int components = 0;
+            std::size_t digits = 0;
+            for (const char c : str)
+            {
+                if (isDigit(c))
+                {
+                    ++digits;
+                }
+                else if (c == '.' && digits > 0 && components < 2)
+                {
+                    ++components;
+                    digits = 0;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            return components == 2 && digits > 0;
+        }
+    };
+
+    inline constexpr UrnUuid urnUuid{};
+    inline constexpr MacAddress macAddress{};
+    inline constexpr Version version{};
+} // namespace opentrackio::opentrackiovalidators
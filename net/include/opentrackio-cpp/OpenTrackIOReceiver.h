@@ -0,0 +1,136 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+
+namespace opentrackio
+{
+    /**
+     * The transport sends each source to its own multicast group, 235.135.1.<source number>, on a shared port. */
+    constexpr uint16_t OPEN_TRACK_IO_MULTICAST_PORT = 55555;
+    std::string multicastGroup(uint32_t sourceNumber);
+
+    struct ReceiverOptions
+    {
+        uint16_t port = OPEN_TRACK_IO_MULTICAST_PORT;
+
+        /**
+         * IPv4 address of the interface to bind and join groups on, any interface if empty. */
+        std::string interfaceAddress{};
+
+        /**
+         * Most datagrams taken from the socket by a single poll() and the largest datagram that can be received. */
+        std::size_t batchSize = 32;
+        std::size_t maxDatagramSize = 65536;
+
+        /**
+         * Size of the reassembly buffer of each sender, the largest segmented payload that can be received. */
+        std::size_t maxPayloadSize = 1 << 20;
+
+        /**
+         * Senders that can have a reassembly buffer and sample at once. A sender that hasn't sent for streamTimeout
+         * gives up its stream to the next new one, datagrams from new senders beyond that are dropped. */
+        std::size_t maxStreams = 64;
+        std::chrono::milliseconds streamTimeout{5000};
+
+        /**
+         * Kernel receive buffer to ask for, the system default if 0. Many sources on one socket may need more. */
+        int receiveBufferSize = 0;
+
+        /**
+         * Ask the kernel to timestamp each datagram as it arrives, only supported on Linux. */
+        bool timestamps = true;
+
+        ParseOptions parseOptions{};
+    };
+
+    struct ReceivedSample
+    {
+        /**
+         * Owned by the receiver and reused for the sender's next payload, so it is only valid inside the sink. */
+        OpenTrackIOSample& sample;
+        uint32_t senderAddress = 0;
+        uint16_t senderPort = 0;
+        uint16_t sequenceNumber = 0;
+
+        /**
+         * CLOCK_REALTIME at which the kernel received the datagram that completed the payload, if available. */
+        std::optional<std::chrono::nanoseconds> receiveTime = std::nullopt;
+    };
+
+    struct ReceiverStats
+    {
+        std::size_t datagrams = 0;
+        std::size_t payloads = 0;
+        std::size_t rejectedPackets = 0;
+        std::size_t abandonedPayloads = 0;
+        std::size_t failedParses = 0;
+
+        /**
+         * Streams evicted after streamTimeout and senders turned away because maxStreams were in use. */
+        std::size_t droppedStreams = 0;
+    };
+
+    /**
+     * Receives OpenTrackIO datagrams from any number of multicast groups on one socket. Each poll() takes a batch of
+     * datagrams from the socket in as few system calls as the platform allows, recvmmsg on Linux, then reassembles
+     * and parses all of them before returning. Every sender has its own reassembly buffer and sample, which is reset
+     * and initialised again for each of its payloads so the steady state doesn't allocate. */
+    class MulticastReceiver
+    {
+    public:
+        MulticastReceiver();
+        ~MulticastReceiver();
+        MulticastReceiver(const MulticastReceiver&) = delete;
+        MulticastReceiver& operator=(const MulticastReceiver&) = delete;
+
+        bool open(const ReceiverOptions& options = {});
+        void close();
+        bool isOpen() const;
+
+        bool join(std::string_view group);
+        bool leave(std::string_view group);
+
+        /**
+         * Waits up to timeout for datagrams, then calls sink(const ReceivedSample&) for every payload completed by
+         * the batch. Returns the number of samples passed to the sink. Datagrams that fail validation and payloads
+         * that fail to parse are skipped and counted in stats(). */
+        template<typename Sink>
+        std::size_t poll(std::chrono::milliseconds timeout, Sink&& sink)
+        {
+            using SinkType = std::remove_reference_t<Sink>;
+            return receive(timeout, [](void* context, const ReceivedSample& received)
+            {
+                (*static_cast<SinkType*>(context))(received);
+            }, &sink);
+        }
+
+        ReceiverStats stats() const;
+
+    private:
+        using SinkFunction = void (*)(void*, const ReceivedSample&);
+        std::size_t receive(std::chrono::milliseconds timeout, SinkFunction sink, void* context);
+
+        struct Impl;
+        std::unique_ptr<Impl> m_impl;
+    };
+} // namespace opentrackio
@@ -0,0 +1,510 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOReceiver.h"
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <time.h>
+#endif
+
+namespace opentrackio
+{
+    namespace
+    {
+#if defined(_WIN32)
+        using SocketHandle = SOCKET;
+        constexpr SocketHandle INVALID_HANDLE = INVALID_SOCKET;
+
+        void closeSocket(SocketHandle handle) { closesocket(handle); }
+#else
+        using SocketHandle = int;
+        constexpr SocketHandle INVALID_HANDLE = -1;
+
+        void closeSocket(SocketHandle handle) { ::close(handle); }
+#endif
+
+        bool toAddress(std::string_view text, in_addr& out)
+        {
+            // inet_pton wants a terminated string and addresses are short, so copy onto the stack.
+            char buffer[INET_ADDRSTRLEN]{};
+            if (text.size() >= sizeof(buffer))
+            {
+                return false;
+            }
+            std::copy(text.begin(), text.end(), buffer);
+            return inet_pton(AF_INET, buffer, &out) == 1;
+        }
+    } // namespace
+
+    std::string multicastGroup(uint32_t sourceNumber)
+    {
+        return std::format("235.135.1.{}", sourceNumber);
+    }
+
+    struct MulticastReceiver::Impl
+    {
+        /**
+         * Everything kept per sender. The assembler points into the buffer so a stream never moves once made. */
+        struct Stream
+        {
+            explicit Stream(std::size_t payloadSize) : buffer(payloadSize), assembler{buffer} {};
+
+            std::vector<uint8_t> buffer;
+            PacketAssembler assembler;
+            OpenTrackIOSample sample{};
+            std::chrono::steady_clock::time_point lastActive{};
+        };
+
+        /**
+         * A datagram taken from the socket, its data points into the batch buffer. */
+        struct Datagram
+        {
+            std::span<const uint8_t> data{};
+            uint32_t address = 0;
+            uint16_t port = 0;
+            std::optional<std::chrono::nanoseconds> receiveTime = std::nullopt;
+        };
+
+        bool waitReadable(std::chrono::milliseconds timeout);
+        std::size_t receiveBatch();
+        void handle(const Datagram& datagram, SinkFunction sink, void* context, std::size_t& delivered);
+        Stream* streamFor(uint32_t address, uint16_t port);
+        void evictIdleStreams();
+        bool membership(std::string_view group, bool join);
+
+        SocketHandle socket = INVALID_HANDLE;
+        ReceiverOptions options{};
+        in_addr interfaceAddress{};
+        ReceiverStats stats{};
+        std::unordered_map<uint64_t, std::unique_ptr<Stream>> streams{};
+        std::chrono::steady_clock::time_point now{};
+
+        std::vector<uint8_t> data{};
+        std::vector<Datagram> datagrams{};
+#if defined(_WIN32)
+        bool started = false;
+#endif
+#if defined(__linux__)
+        static constexpr std::size_t CONTROL_SIZE = CMSG_SPACE(sizeof(scm_timestamping)) +
+                                                    CMSG_SPACE(sizeof(timespec));
+        std::vector<mmsghdr> messages{};
+        std::vector<iovec> vectors{};
+        std::vector<sockaddr_in> senders{};
+        std::vector<uint8_t> control{};
+#endif
+    };
+
+    MulticastReceiver::MulticastReceiver() : m_impl{std::make_unique<Impl>()} {}
+
+    MulticastReceiver::~MulticastReceiver()
+    {
+        close();
+    }
+
+    bool MulticastReceiver::open(const ReceiverOptions& options)
+    {
+        close();
+        if (options.batchSize == 0 || options.maxDatagramSize == 0)
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        WSADATA wsaData{};
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+        {
+            return false;
+        }
+        m_impl->started = true;
+#endif
+
+        auto& impl = *m_impl;
+        impl.options = options;
+        impl.interfaceAddress.s_addr = htonl(INADDR_ANY);
+        if (!options.interfaceAddress.empty() && !toAddress(options.interfaceAddress, impl.interfaceAddress))
+        {
+            close();
+            return false;
+        }
+
+        impl.socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (impl.socket == INVALID_HANDLE)
+        {
+            close();
+            return false;
+        }
+
+        // Several receivers on one machine can listen for the same groups.
+        int reuse = 1;
+        setsockopt(impl.socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+        if (options.receiveBufferSize > 0)
+        {
+            setsockopt(impl.socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&options.receiveBufferSize),
+                       sizeof(options.receiveBufferSize));
+        }
+
+        // Multicast groups are received on a socket bound to the wildcard address, not the interface.
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(options.port);
+        if (bind(impl.socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            close();
+            return false;
+        }
+
+#if defined(_WIN32)
+        // Winsock has no per call flag, so the socket is made non-blocking once and waited on with select.
+        u_long nonBlocking = 1;
+        ioctlsocket(impl.socket, FIONBIO, &nonBlocking);
+#endif
+
+        impl.data.resize(options.batchSize * options.maxDatagramSize);
+        impl.datagrams.resize(options.batchSize);
+
+#if defined(__linux__)
+        if (options.timestamps)
+        {
+            // Prefer SO_TIMESTAMPING, falling back to the older nanosecond option on kernels without it.
+            const int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+            if (setsockopt(impl.socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) != 0)
+            {
+                const int enable = 1;
+                setsockopt(impl.socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+            }
+        }
+
+        impl.messages.resize(options.batchSize);
+        impl.vectors.resize(options.batchSize);
+        impl.senders.resize(options.batchSize);
+        impl.control.resize(options.batchSize * Impl::CONTROL_SIZE);
+        for (std::size_t i = 0; i < options.batchSize; ++i)
+        {
+            impl.vectors[i].iov_base = impl.data.data() + i * options.maxDatagramSize;
+            impl.vectors[i].iov_len = options.maxDatagramSize;
+        }
+#endif
+        return true;
+    }
+
+    void MulticastReceiver::close()
+    {
+        auto& impl = *m_impl;
+        if (impl.socket != INVALID_HANDLE)
+        {
+            closeSocket(impl.socket);
+            impl.socket = INVALID_HANDLE;
+        }
+#if defined(_WIN32)
+        if (impl.started)
+        {
+            WSACleanup();
+            impl.started = false;
+        }
+#endif
+        impl.streams.clear();
+    }
+
+    bool MulticastReceiver::isOpen() const
+    {
+        return m_impl->socket != INVALID_HANDLE;
+    }
+
+    bool MulticastReceiver::join(std::string_view group)
+    {
+        return m_impl->membership(group, true);
+    }
+
+    bool MulticastReceiver::leave(std::string_view group)
+    {
+        return m_impl->membership(group, false);
+    }
+
+    ReceiverStats MulticastReceiver::stats() const
+    {
+        ReceiverStats stats = m_impl->stats;
+        for (const auto& [key, stream] : m_impl->streams)
+        {
+            stats.abandonedPayloads += stream->assembler.abandoned();
+        }
+        return stats;
+    }
+
+    std::size_t MulticastReceiver::receive(std::chrono::milliseconds timeout, SinkFunction sink, void* context)
+    {
+        auto& impl = *m_impl;
+        if (impl.socket == INVALID_HANDLE || !impl.waitReadable(timeout))
+        {
+            return 0;
+        }
+
+        // Everything in the batch is parsed before the socket is read again, the unsegmented payloads point
+        // straight into the batch buffer.
+        std::size_t delivered = 0;
+        const std::size_t count = impl.receiveBatch();
+        impl.now = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            impl.handle(impl.datagrams[i], sink, context, delivered);
+        }
+        return delivered;
+    }
+
+    bool MulticastReceiver::Impl::membership(std::string_view group, bool join)
+    {
+        ip_mreq request{};
+        if (socket == INVALID_HANDLE || !toAddress(group, request.imr_multiaddr))
+        {
+            return false;
+        }
+        request.imr_interface = interfaceAddress;
+
+        const int option = join ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP;
+        return setsockopt(socket, IPPROTO_IP, option, reinterpret_cast<const char*>(&request), sizeof(request)) == 0;
+    }
+
+    bool MulticastReceiver::Impl::waitReadable(std::chrono::milliseconds timeout)
+    {
+#if defined(_WIN32)
+        fd_set readable{};
+        FD_ZERO(&readable);
+        FD_SET(socket, &readable);
+        timeval limit{};
+        limit.tv_sec = static_cast<long>(timeout.count() / 1000);
+        limit.tv_usec = static_cast<long>((timeout.count() % 1000) * 1000);
+        return select(0, &readable, nullptr, nullptr, &limit) > 0;
+#else
+        pollfd descriptor{};
+        descriptor.fd = socket;
+        descriptor.events = POLLIN;
+        return ::poll(&descriptor, 1, static_cast<int>(timeout.count())) > 0 && (descriptor.revents & POLLIN) != 0;
+#endif
+    }
+
+#if defined(__linux__)
+    std::size_t MulticastReceiver::Impl::receiveBatch()
+    {
+        // recvmmsg overwrites the lengths, so every header is reset before each call.
+        for (std::size_t i = 0; i < options.batchSize; ++i)
+        {
+            auto& header = messages[i].msg_hdr;
+            header = msghdr{};
+            header.msg_name = &senders[i];
+            header.msg_namelen = sizeof(sockaddr_in);
+            header.msg_iov = &vectors[i];
+            header.msg_iovlen = 1;
+            header.msg_control = control.data() + i * CONTROL_SIZE;
+            header.msg_controllen = CONTROL_SIZE;
+            messages[i].msg_len = 0;
+        }
+
+        const int count = recvmmsg(socket, messages.data(), static_cast<unsigned int>(options.batchSize),
+                                   MSG_DONTWAIT, nullptr);
+        if (count <= 0)
+        {
+            return 0;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto& header = messages[i].msg_hdr;
+            auto& datagram = datagrams[i];
+            datagram.data = {static_cast<const uint8_t*>(vectors[i].iov_base), messages[i].msg_len};
+            datagram.address = ntohl(senders[i].sin_addr.s_addr);
+            datagram.port = ntohs(senders[i].sin_port);
+            datagram.receiveTime = std::nullopt;
+
+            // A truncated datagram can't be a valid packet, let the header checks reject it.
+            if ((header.msg_flags & MSG_TRUNC) != 0)
+            {
+                datagram.data = {};
+            }
+
+            for (cmsghdr* message = CMSG_FIRSTHDR(&header); message != nullptr;
+                 message = CMSG_NXTHDR(&header, message))
+            {
+                if (message->cmsg_level != SOL_SOCKET)
+                {
+                    continue;
+                }
+
+                timespec time{};
+                if (message->cmsg_type == SCM_TIMESTAMPING)
+                {
+                    scm_timestamping timestamps{};
+                    std::memcpy(&timestamps, CMSG_DATA(message), sizeof(timestamps));
+                    time = timestamps.ts[0];
+                }
+                else if (message->cmsg_type == SCM_TIMESTAMPNS)
+                {
+                    std::memcpy(&time, CMSG_DATA(message), sizeof(time));
+                }
+                else
+                {
+                    continue;
+                }
+
+                if (time.tv_sec != 0 || time.tv_nsec != 0)
+                {
+                    datagram.receiveTime = std::chrono::seconds{time.tv_sec} + std::chrono::nanoseconds{time.tv_nsec};
+                }
+            }
+        }
+        return static_cast<std::size_t>(count);
+    }
+#else
+    std::size_t MulticastReceiver::Impl::receiveBatch()
+    {
+        // Without recvmmsg the batch is one recvfrom per datagram, stopping as soon as the socket is drained.
+#if defined(_WIN32)
+        constexpr int flags = 0;
+#else
+        constexpr int flags = MSG_DONTWAIT;
+#endif
+
+        std::size_t count = 0;
+        for (; count < options.batchSize; ++count)
+        {
+            uint8_t* buffer = data.data() + count * options.maxDatagramSize;
+            sockaddr_in sender{};
+            socklen_t senderLength = sizeof(sender);
+            const auto received = recvfrom(socket, reinterpret_cast<char*>(buffer),
+                                           static_cast<int>(options.maxDatagramSize), flags,
+                                           reinterpret_cast<sockaddr*>(&sender), &senderLength);
+            if (received < 0)
+            {
+                break;
+            }
+
+            auto& datagram = datagrams[count];
+            datagram.data = {buffer, static_cast<std::size_t>(received)};
+            datagram.address = ntohl(sender.sin_addr.s_addr);
+            datagram.port = ntohs(sender.sin_port);
+            datagram.receiveTime = std::nullopt;
+        }
+        return count;
+    }
+#endif
+
+    MulticastReceiver::Impl::Stream* MulticastReceiver::Impl::streamFor(uint32_t address, uint16_t port)
+    {
+        const uint64_t key = (static_cast<uint64_t>(address) << 16) | port;
+        if (const auto found = streams.find(key); found != streams.end())
+        {
+            found->second->lastActive = now;
+            return found->second.get();
+        }
+
+        // Senders restarting on new ports or spoofed datagrams would otherwise grow the streams without bound.
+        if (streams.size() >= options.maxStreams)
+        {
+            evictIdleStreams();
+        }
+        if (streams.size() >= options.maxStreams)
+        {
+            ++stats.droppedStreams;
+            return nullptr;
+        }
+
+        auto& stream = streams[key];
+        stream = std::make_unique<Stream>(options.maxPayloadSize);
+        stream->lastActive = now;
+        return stream.get();
+    }
+
+    void MulticastReceiver::Impl::evictIdleStreams()
+    {
+        std::erase_if(streams, [this](const auto& entry)
+        {
+            const auto& stream = *entry.second;
+            if (now - stream.lastActive < options.streamTimeout)
+            {
+                return false;
+            }
+
+            stats.abandonedPayloads += stream.assembler.abandoned();
+            ++stats.droppedStreams;
+            return true;
+        });
+    }
+
+    void MulticastReceiver::Impl::handle(const Datagram& datagram, SinkFunction sink, void* context,
+                                         std::size_t& delivered)
+    {
+        ++stats.datagrams;
+
+        Packet packet{};
+        if (Packet::parse(datagram.data, packet) != PacketStatus::OK)
+        {
+            ++stats.rejectedPackets;
+            return;
+        }
+
+        // Segments are reassembled per sender, so interleaved payloads from different sources don't collide.
+        Stream* const found = streamFor(datagram.address, datagram.port);
+        if (found == nullptr)
+        {
+            return;
+        }
+
+        auto& stream = *found;
+        PacketPayload payload{};
+        const auto status = stream.assembler.add(packet, payload);
+        if (status == PacketStatus::INCOMPLETE || status == PacketStatus::DUPLICATE_SEGMENT)
+        {
+            return;
+        }
+        if (status != PacketStatus::OK)
+        {
+            ++stats.rejectedPackets;
+            return;
+        }
+
+        stream.sample.reset();
+        try
+        {
+            stream.sample.initialise(payload, options.parseOptions);
+        }
+        catch (const nlohmann::json::exception&)
+        {
+            ++stats.failedParses;
+            return;
+        }
+
+        ++stats.payloads;
+        ++delivered;
+        sink(context, ReceivedSample{stream.sample, datagram.address, datagram.port, payload.sequenceNumber,
+                                     datagram.receiveTime});
+    }
+} // namespace opentrackio
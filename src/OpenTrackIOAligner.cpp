@@ -0,0 +1,309 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOAligner.h"
+#include "opentrackio-cpp/OpenTrackIOTime.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace opentrackio
+{
+    namespace
+    {
+        double offsetOf(const opentrackioproperties::Timing& timing, AlignerOffset offset)
+        {
+            if (offset == AlignerOffset::NONE || !timing.synchronization.has_value() ||
+                !timing.synchronization->offsets.has_value())
+            {
+                return 0.0;
+            }
+
+            const auto& offsets = timing.synchronization->offsets.value();
+            switch (offset)
+            {
+                case AlignerOffset::TRANSLATION:
+                    return offsets.translation.value_or(0.0);
+                case AlignerOffset::ROTATION:
+                    return offsets.rotation.value_or(0.0);
+                case AlignerOffset::LENS_ENCODERS:
+                    return offsets.lensEncoders.value_or(0.0);
+                default:
+                    return 0.0;
+            }
+        }
+
+        std::optional<int64_t> timecodeKey(const opentrackiotypes::Timecode& timecode)
+        {
+            const auto& rate = timecode.format.frameRate;
+            if (rate.numerator <= 0 || rate.denominator <= 0)
+            {
+                return std::nullopt;
+            }
+
+            // Drop frame timecodes skip labels rather than frames, so counting labels at the nominal rate still
+            // gives every frame of the day its own key.
+            const int64_t nominal = (rate.numerator + rate.denominator - 1) / rate.denominator;
+            const int64_t seconds = (int64_t{timecode.hours} * 60 + timecode.minutes) * 60 + timecode.seconds;
+            return seconds * nominal + timecode.frames;
+        }
+
+        /**
+         * Keys a timecode counts from one midnight to the next. */
+        std::optional<int64_t> timecodeDay(const opentrackiotypes::Timecode& timecode)
+        {
+            const auto& rate = timecode.format.frameRate;
+            if (rate.numerator <= 0 || rate.denominator <= 0)
+            {
+                return std::nullopt;
+            }
+            return (rate.numerator + rate.denominator - 1) / rate.denominator * 86400;
+        }
+
+        std::optional<int64_t> timestampKey(const opentrackiotypes::Timestamp& timestamp,
+                                            const opentrackiotypes::Rational& rate, double offset)
+        {
+            // Done exactly in integers, so however far past the epoch a frame boundary is it never moves.
+            return nearestFrameAt(timestamp - opentrackiotypes::TimeOffset::fromSeconds(offset), rate);
+        }
+    } // namespace
+
+    FrameAligner::FrameAligner(std::vector<AlignerSource> sources, AlignerOptions options)
+            : m_options{std::move(options)}
+    {
+        m_sources.reserve(sources.size());
+        for (const auto& source : sources)
+        {
+            m_sources.push_back(Source{source, std::make_unique<SpscQueue<OpenTrackIOSample>>(m_options.depth)});
+        }
+        m_frame.resize(m_sources.size(), nullptr);
+    }
+
+    std::optional<std::size_t> FrameAligner::find(const OpenTrackIOSample& sample) const
+    {
+        const opentrackiotypes::UrnUuid id = sample.sourceId.has_value() ? sample.sourceId->id
+                                                                         : opentrackiotypes::UrnUuid{};
+        for (std::size_t i = 0; i < m_sources.size(); ++i)
+        {
+            const auto& source = m_sources[i].id;
+            if (source.sourceId != id)
+            {
+                continue;
+            }
+
+            if (source.sourceNumber.has_value() &&
+                (!sample.sourceNumber.has_value() || sample.sourceNumber->value != source.sourceNumber.value()))
+            {
+                continue;
+            }
+            return i;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<int64_t> FrameAligner::keyOf(const OpenTrackIOSample& sample) const
+    {
+        if (!sample.timing.has_value())
+        {
+            return std::nullopt;
+        }
+        const auto& timing = sample.timing.value();
+
+        if (m_options.key == AlignerKey::TIMECODE)
+        {
+            return timing.timecode.has_value() ? timecodeKey(timing.timecode.value()) : std::nullopt;
+        }
+
+        if (!timing.sampleTimestamp.has_value())
+        {
+            return std::nullopt;
+        }
+
+        const auto* rate = m_options.frameRate.has_value() ? &m_options.frameRate.value()
+                           : timing.synchronization.has_value() ? &timing.synchronization->frequency
+                           : timing.frameRate.has_value() ? &timing.frameRate.value()
+                           : nullptr;
+        if (rate == nullptr)
+        {
+            return std::nullopt;
+        }
+        return timestampKey(timing.sampleTimestamp.value(), *rate, offsetOf(timing, m_options.offset));
+    }
+
+    bool FrameAligner::push(const OpenTrackIOSample& sample)
+    {
+        const auto source = find(sample);
+        if (!source.has_value())
+        {
+            return false;
+        }
+
+        return push(source.value(), [&sample](OpenTrackIOSample& slot)
+        {
+            slot = sample;
+            return true;
+        });
+    }
+
+    std::optional<int64_t> FrameAligner::continuedKeyOf(const OpenTrackIOSample& sample) const
+    {
+        const auto key = keyOf(sample);
+        if (!key.has_value() || m_options.key != AlignerKey::TIMECODE || !m_released.has_value())
+        {
+            return key;
+        }
+
+        // Moved to whichever day puts it nearest the last frame released, so the first frame after midnight
+        // follows the last one before it.
+        const int64_t day = timecodeDay(sample.timing->timecode.value()).value();
+        const int64_t behind = m_released.value() - key.value() + day / 2;
+        const int64_t days = behind / day - (behind < 0 && behind % day != 0);
+        return key.value() + days * day;
+    }
+
+    void FrameAligner::reset(int64_t key)
+    {
+        // Whatever the other sources queued before the jump belongs to frames that will never complete.
+        for (auto& source : m_sources)
+        {
+            while (const OpenTrackIOSample* sample = source.queue->front())
+            {
+                if (!source.headKey.has_value())
+                {
+                    source.headKey = keyOf(*sample);
+                }
+
+                if (source.headKey.has_value() && source.headKey.value() - key <= m_options.resetFrames)
+                {
+                    break;
+                }
+
+                source.queue->pop();
+                source.headKey = std::nullopt;
+                ++m_dropped;
+            }
+        }
+
+        m_released = std::nullopt;
+        m_waiting = std::nullopt;
+        ++m_resets;
+    }
+
+    const OpenTrackIOSample* FrameAligner::head(Source& source)
+    {
+        while (const OpenTrackIOSample* sample = source.queue->front())
+        {
+            if (!source.headKey.has_value())
+            {
+                source.headKey = continuedKeyOf(*sample);
+            }
+
+            if (source.headKey.has_value() && m_released.has_value() &&
+                m_released.value() - source.headKey.value() > m_options.resetFrames)
+            {
+                reset(source.headKey.value());
+                continue;
+            }
+
+            if (source.headKey.has_value() &&
+                (!m_released.has_value() || source.headKey.value() > m_released.value()))
+            {
+                return sample;
+            }
+
+            source.queue->pop();
+            source.headKey = std::nullopt;
+            ++m_dropped;
+        }
+        return nullptr;
+    }
+
+    std::optional<AlignedFrame> FrameAligner::next(int64_t now)
+    {
+        if (m_current.has_value())
+        {
+            return m_current;
+        }
+
+        // A reset while finding the heads can drop the heads of sources already visited, so they are all found
+        // before any is used.
+        for (auto& source : m_sources)
+        {
+            head(source);
+        }
+
+        int64_t oldest = std::numeric_limits<int64_t>::max();
+        bool any = false;
+        bool all = true;
+        for (auto& source : m_sources)
+        {
+            if (head(source) == nullptr)
+            {
+                all = false;
+                continue;
+            }
+            any = true;
+            oldest = std::min(oldest, source.headKey.value());
+        }
+
+        if (!any)
+        {
+            return std::nullopt;
+        }
+
+        if (m_waiting != oldest)
+        {
+            m_waiting = oldest;
+            m_waitingSince = now;
+        }
+
+        if (!all && now - m_waitingSince < m_options.deadline)
+        {
+            return std::nullopt;
+        }
+
+        std::size_t present = 0;
+        for (std::size_t i = 0; i < m_sources.size(); ++i)
+        {
+            const auto& source = m_sources[i];
+            const bool matches = source.headKey == oldest;
+            m_frame[i] = matches ? source.queue->front() : nullptr;
+            present += matches ? 1 : 0;
+        }
+
+        m_current = AlignedFrame{oldest, m_frame, present};
+        return m_current;
+    }
+
+    void FrameAligner::release()
+    {
+        if (!m_current.has_value())
+        {
+            return;
+        }
+
+        for (std::size_t i = 0; i < m_sources.size(); ++i)
+        {
+            if (m_frame[i] != nullptr)
+            {
+                m_sources[i].queue->pop();
+                m_sources[i].headKey = std::nullopt;
+                m_frame[i] = nullptr;
+            }
+        }
+
+        m_released = m_current->key;
+        m_waiting = std::nullopt;
+        m_current = std::nullopt;
+    }
+} // namespace opentrackio
@@ -0,0 +1,149 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOBatch.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace opentrackio
+{
+    namespace
+    {
+        DecodeStatus decode(std::span<const uint8_t> payload, OpenTrackIOSample& sample, PacketEncoding encoding,
+                            const ParseOptions& parseOptions)
+        {
+            sample.reset();
+            try
+            {
+                if (encoding == PacketEncoding::JSON)
+                {
+                    const std::string_view text{reinterpret_cast<const char*>(payload.data()), payload.size()};
+                    sample.initialise(text, parseOptions);
+                }
+                else
+                {
+                    sample.initialise(payload, parseOptions);
+                }
+            }
+            catch (const nlohmann::json::exception&)
+            {
+                sample.reset();
+                return DecodeStatus::MALFORMED;
+            }
+            return sample.getDiagnostics().errorCount() == 0 ? DecodeStatus::OK : DecodeStatus::INVALID;
+        }
+    } // namespace
+
+    std::size_t decodeBatch(std::span<const std::span<const uint8_t>> payloads, std::span<OpenTrackIOSample> samples,
+                            std::span<DecodeStatus> statuses, const BatchOptions& options)
+    {
+        const std::size_t count = std::min(payloads.size(), samples.size());
+        const std::size_t chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+        const std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+
+        unsigned int threads = options.threads == 0 ? std::thread::hardware_concurrency() : options.threads;
+        if (options.parseOptions.staticCache != nullptr ||
+            (options.parseOptions.memoryResource != nullptr && options.memoryResources.empty()))
+        {
+            threads = 1;
+        }
+        if (!options.memoryResources.empty())
+        {
+            threads = static_cast<unsigned int>(std::min<std::size_t>(threads, options.memoryResources.size()));
+        }
+        threads = static_cast<unsigned int>(std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(chunks, 1)));
+
+        std::atomic<std::size_t> nextChunk{0};
+        std::atomic<std::size_t> decoded{0};
+        std::exception_ptr failure = nullptr;
+        std::atomic<bool> failed{false};
+
+        auto work = [&](unsigned int worker)
+        {
+            ParseOptions parseOptions = options.parseOptions;
+            parseOptions.snapshot = nullptr;
+            if (!options.memoryResources.empty())
+            {
+                parseOptions.memoryResource = options.memoryResources[worker];
+            }
+
+            std::size_t valid = 0;
+            try
+            {
+                for (std::size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < chunks;
+                     chunk = nextChunk.fetch_add(1, std::memory_order_relaxed))
+                {
+                    const std::size_t end = std::min(count, (chunk + 1) * chunkSize);
+                    for (std::size_t i = chunk * chunkSize; i < end; ++i)
+                    {
+                        if (!options.snapshots.empty())
+                        {
+                            parseOptions.snapshot = &options.snapshots[i];
+                        }
+                        const DecodeStatus status = decode(payloads[i], samples[i], options.encoding, parseOptions);
+                        if (!statuses.empty())
+                        {
+                            statuses[i] = status;
+                        }
+                        valid += status == DecodeStatus::OK;
+                    }
+                }
+            }
+            catch (...)
+            {
+                // Anything other than a parse error, such as running out of memory, is rethrown on the caller.
+                if (!failed.exchange(true))
+                {
+                    failure = std::current_exception();
+                }
+                nextChunk.store(chunks, std::memory_order_relaxed);
+            }
+            decoded.fetch_add(valid, std::memory_order_relaxed);
+        };
+
+        std::vector<std::thread> workers{};
+        workers.reserve(threads - 1);
+        try
+        {
+            for (unsigned int i = 1; i < threads; ++i)
+            {
+                workers.emplace_back(work, i);
+            }
+        }
+        catch (...)
+        {
+            // The workers already started share this frame, so they are stopped and joined before it unwinds.
+            nextChunk.store(chunks, std::memory_order_relaxed);
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+            throw;
+        }
+        work(0);
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        if (failure != nullptr)
+        {
+            std::rethrow_exception(failure);
+        }
+        return decoded.load();
+    }
+} // namespace opentrackio
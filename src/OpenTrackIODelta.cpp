@@ -0,0 +1,487 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIODelta.h"
+#include <algorithm>
+
+namespace opentrackio
+{
+    namespace
+    {
+        using opentrackioproperties::Lens;
+        using opentrackioproperties::Timing;
+        using opentrackioproperties::Tracker;
+
+        void copyProperties(const OpenTrackIOSample& from, OpenTrackIOSample& to)
+        {
+            to.camera = from.camera;
+            to.duration = from.duration;
+            to.globalStage = from.globalStage;
+            to.lens = from.lens;
+            to.protocol = from.protocol;
+            to.relatedSampleIds = from.relatedSampleIds;
+            to.sampleId = from.sampleId;
+            to.sourceId = from.sourceId;
+            to.sourceNumber = from.sourceNumber;
+            to.timing = from.timing;
+            to.tracker = from.tracker;
+            to.transforms = from.transforms;
+            to.staticProperties = from.staticProperties;
+        }
+
+        /**
+         * Calls fn with the same per sample member of each value, for every member a delta can leave out. The
+         * static lens and tracker fields are visited through their descriptors instead. */
+        template<typename Fn, typename... T>
+        void forEachDynamic(Fn&& fn, T&... timing) requires (std::is_same_v<std::remove_const_t<T>, Timing> && ...)
+        {
+            fn(timing.frameRate...);
+            fn(timing.mode...);
+            fn(timing.recordedTimestamp...);
+            fn(timing.sampleTimestamp...);
+            fn(timing.sequenceNumber...);
+            fn(timing.synchronization...);
+            fn(timing.timecode...);
+        }
+
+        template<typename Fn, typename... T>
+        void forEachDynamic(Fn&& fn, T&... lens) requires (std::is_same_v<std::remove_const_t<T>, Lens> && ...)
+        {
+            fn(lens.custom...);
+            fn(lens.distortion...);
+            fn(lens.distortionOverscan...);
+            fn(lens.distortionShift...);
+            fn(lens.encoders...);
+            fn(lens.entrancePupilOffset...);
+            fn(lens.exposureFalloff...);
+            fn(lens.fStop...);
+            fn(lens.focalLength...);
+            fn(lens.focusDistance...);
+            fn(lens.perspectiveShift...);
+            fn(lens.rawEncoders...);
+            fn(lens.tStop...);
+            fn(lens.undistortion...);
+        }
+
+        template<typename Fn, typename... T>
+        void forEachDynamic(Fn&& fn, T&... tracker) requires (std::is_same_v<std::remove_const_t<T>, Tracker> && ...)
+        {
+            schema::forEachField<Tracker, schema::Scope::DYNAMIC>([&](auto field)
+            {
+                fn((tracker.*decltype(field)::member)...);
+            });
+        }
+
+        template<typename Fn, typename... T>
+        void forEachDynamic(Fn&& fn, T&... transform)
+                requires (std::is_same_v<std::remove_const_t<T>, opentrackiotypes::Transform> && ...)
+        {
+            fn(transform.scale...);
+            fn(transform.transformId...);
+            fn(transform.parentTransformId...);
+        }
+
+        template<typename T>
+        bool removesField(const T& current, const T& reference)
+        {
+            bool removes = false;
+            forEachDynamic([&](const auto& c, const auto& r)
+            {
+                removes |= r.has_value() && !c.has_value();
+            }, current, reference);
+            return removes;
+        }
+
+        template<typename T>
+        bool removes(const std::optional<T>& current, const std::optional<T>& reference)
+        {
+            if (!reference.has_value())
+            {
+                return false;
+            }
+            if (!current.has_value())
+            {
+                return true;
+            }
+
+            if constexpr (std::is_same_v<T, opentrackioproperties::Transforms>)
+            {
+                const auto& c = current->transforms;
+                const auto& r = reference->transforms;
+                if (c.size() != r.size())
+                {
+                    return false;
+                }
+                for (std::size_t i = 0; i < c.size(); ++i)
+                {
+                    if (removesField(c[i], r[i]))
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            else
+            {
+                return removesField(current.value(), reference.value());
+            }
+        }
+
+        template<typename T>
+        void clearStatic(std::optional<T>& value)
+        {
+            if (value.has_value())
+            {
+                schema::resetFields<schema::Scope::STATIC>(value.value());
+            }
+        }
+
+        template<typename T>
+        void copyStatic(const std::optional<T>& from, std::optional<T>& to)
+        {
+            if (!from.has_value())
+            {
+                return;
+            }
+            auto& value = to.has_value() ? to.value() : to.emplace();
+            schema::forEachField<T, schema::Scope::STATIC>([&](auto field)
+            {
+                using F = decltype(field);
+                if (!(value.*F::member).has_value())
+                {
+                    value.*F::member = from.value().*F::member;
+                }
+            });
+        }
+
+        /**
+         * Clears the members of out that equal the reference's, static ones having already been cleared, and drops
+         * the whole property if nothing is left. */
+        template<typename T>
+        void keepChanged(std::optional<T>& out, const std::optional<T>& reference)
+        {
+            if (!out.has_value() || !reference.has_value())
+            {
+                return;
+            }
+
+            forEachDynamic([](auto& o, const auto& r)
+            {
+                if (o == r)
+                {
+                    o = std::nullopt;
+                }
+            }, out.value(), reference.value());
+
+            if (out.value() == T{})
+            {
+                out = std::nullopt;
+            }
+        }
+
+        /**
+         * Fills the members the delta left out from the reference. */
+        template<typename T>
+        void fillUnchanged(std::optional<T>& out, const std::optional<T>& reference)
+        {
+            if (!reference.has_value())
+            {
+                return;
+            }
+            if (!out.has_value())
+            {
+                out = reference;
+                return;
+            }
+
+            forEachDynamic([](auto& o, const auto& r)
+            {
+                if (!o.has_value())
+                {
+                    o = r;
+                }
+            }, out.value(), reference.value());
+        }
+    } // namespace
+
+    DeltaEncoder::DeltaEncoder(DeltaOptions options)
+            : m_options{options},
+              m_recent(std::max<std::size_t>(options.history, 2))
+    {
+    }
+
+    void DeltaEncoder::reset()
+    {
+        m_keyframe.serial = 0;
+        m_acknowledged.serial = 0;
+        for (auto& sent : m_recent)
+        {
+            sent.serial = 0;
+        }
+        m_serial = 0;
+        m_sinceKeyframe = 0;
+        m_keyframeDue = true;
+    }
+
+    const DeltaEncoder::Sent* DeltaEncoder::reference() const
+    {
+        const Sent* sent = &m_keyframe;
+        if (m_options.reference == DeltaReference::PREVIOUS)
+        {
+            sent = &m_recent[m_serial % m_recent.size()];
+        }
+        else if (m_options.reference == DeltaReference::ACKNOWLEDGED && m_acknowledged.serial > m_keyframe.serial)
+        {
+            sent = &m_acknowledged;
+        }
+        return sent->serial != 0 ? sent : nullptr;
+    }
+
+    bool DeltaEncoder::needsKeyframe(const OpenTrackIOSample& reference) const
+    {
+        const auto& current = m_recent[m_serial % m_recent.size()].sample;
+        if (!current.sampleId.has_value() || !reference.sampleId.has_value())
+        {
+            return true;
+        }
+
+        // An empty list would decode as no list at all.
+        if (current.relatedSampleIds.has_value() && current.relatedSampleIds->samples.empty())
+        {
+            return true;
+        }
+
+        if (current.camera != reference.camera || current.duration != reference.duration ||
+            !schema::sameFields<schema::Scope::STATIC>(current.lens, reference.lens) ||
+            !schema::sameFields<schema::Scope::STATIC>(current.tracker, reference.tracker))
+        {
+            return true;
+        }
+
+        return (reference.globalStage.has_value() && !current.globalStage.has_value()) ||
+               removes(current.lens, reference.lens) || removes(current.timing, reference.timing) ||
+               removes(current.tracker, reference.tracker) || removes(current.transforms, reference.transforms);
+    }
+
+    bool DeltaEncoder::encode(const OpenTrackIOSample& sample, OpenTrackIOSample& out)
+    {
+        // The reference is found before the new sample takes its slot, history is at least two so the previous
+        // sample is never the slot being written.
+        const Sent* sent = m_serial != 0 ? reference() : nullptr;
+
+        ++m_serial;
+        auto& current = m_recent[m_serial % m_recent.size()];
+        copyProperties(sample, current.sample);
+        current.serial = m_serial;
+        if (const auto& properties = sample.staticProperties)
+        {
+            auto& full = current.sample;
+            full.camera = full.camera.has_value() ? full.camera : properties->camera;
+            full.duration = full.duration.has_value() ? full.duration : properties->duration;
+            copyStatic(properties->lens, full.lens);
+            copyStatic(properties->tracker, full.tracker);
+            full.staticProperties = nullptr;
+        }
+
+        const bool intervalDue = m_options.keyframeInterval != 0 && m_sinceKeyframe >= m_options.keyframeInterval;
+        out.reset();
+        copyProperties(current.sample, out);
+        if (sent == nullptr || m_keyframeDue || intervalDue || needsKeyframe(sent->sample))
+        {
+            copyProperties(current.sample, m_keyframe.sample);
+            m_keyframe.serial = m_serial;
+            m_sinceKeyframe = 1;
+            m_keyframeDue = false;
+            return true;
+        }
+
+        const auto& reference = sent->sample;
+        out.camera = std::nullopt;
+        out.duration = std::nullopt;
+        clearStatic(out.lens);
+        clearStatic(out.tracker);
+
+        if (out.globalStage == reference.globalStage)
+        {
+            out.globalStage = std::nullopt;
+        }
+        keepChanged(out.lens, reference.lens);
+        keepChanged(out.timing, reference.timing);
+        if (out.timing.has_value())
+        {
+            // The parser reports a timing object without a mode as an error, so it is always kept.
+            out.timing->mode = current.sample.timing->mode;
+        }
+        keepChanged(out.tracker, reference.tracker);
+
+        if (out.transforms == reference.transforms)
+        {
+            out.transforms = std::nullopt;
+        }
+        else if (out.transforms.has_value() && reference.transforms.has_value() &&
+                 out.transforms->transforms.size() == reference.transforms->transforms.size())
+        {
+            // Translations and rotations are required, so only the optional fields can be left out.
+            auto& transforms = out.transforms->transforms;
+            for (std::size_t i = 0; i < transforms.size(); ++i)
+            {
+                forEachDynamic([](auto& o, const auto& r)
+                {
+                    if (o == r)
+                    {
+                        o = std::nullopt;
+                    }
+                }, transforms[i], reference.transforms->transforms[i]);
+            }
+        }
+
+        auto& related = out.relatedSampleIds.has_value() ? out.relatedSampleIds.value()
+                                                         : out.relatedSampleIds.emplace();
+        related.samples.push_back(reference.sampleId->id);
+        ++m_sinceKeyframe;
+        return false;
+    }
+
+    std::optional<std::size_t> DeltaEncoder::encodeJson(const OpenTrackIOSample& sample, std::span<char> buffer)
+    {
+        encode(sample, m_scratch);
+        return m_scratch.serializeJson(buffer);
+    }
+
+    std::optional<std::size_t> DeltaEncoder::encodeCbor(const OpenTrackIOSample& sample, std::span<uint8_t> buffer)
+    {
+        encode(sample, m_scratch);
+        return m_scratch.serializeCbor(buffer);
+    }
+
+    bool DeltaEncoder::acknowledge(const opentrackiotypes::UrnUuid& sampleId)
+    {
+        const uint64_t newest = std::max(m_acknowledged.serial, m_keyframe.serial);
+        for (const auto& sent : m_recent)
+        {
+            if (sent.serial > newest && sent.sample.sampleId.has_value() && sent.sample.sampleId->id == sampleId)
+            {
+                copyProperties(sent.sample, m_acknowledged.sample);
+                m_acknowledged.serial = sent.serial;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    DeltaDecoder::DeltaDecoder(std::size_t history) : m_recent(std::max<std::size_t>(history, 1))
+    {
+    }
+
+    void DeltaDecoder::reset()
+    {
+        m_keyframe.sampleId = std::nullopt;
+        m_pinned.sampleId = std::nullopt;
+        m_next = 0;
+        m_count = 0;
+    }
+
+    const OpenTrackIOSample* DeltaDecoder::find(const opentrackiotypes::UrnUuid& sampleId) const
+    {
+        if (m_keyframe.sampleId.has_value() && m_keyframe.sampleId->id == sampleId)
+        {
+            return &m_keyframe;
+        }
+
+        if (m_pinned.sampleId.has_value() && m_pinned.sampleId->id == sampleId)
+        {
+            return &m_pinned;
+        }
+
+        for (std::size_t i = 0; i < m_count; ++i)
+        {
+            const auto& sample = m_recent[i];
+            if (sample.sampleId.has_value() && sample.sampleId->id == sampleId)
+            {
+                return &sample;
+            }
+        }
+        return nullptr;
+    }
+
+    bool DeltaDecoder::decode(const OpenTrackIOSample& received, OpenTrackIOSample& out)
+    {
+        const auto& related = received.relatedSampleIds;
+        const OpenTrackIOSample* reference = related.has_value() && !related->samples.empty()
+                                             ? find(related->samples.back()) : nullptr;
+
+        // Anything but the latest sample is an acknowledged reference the ring would otherwise overwrite.
+        const auto* latest = m_count != 0 ? &m_recent[(m_next + m_recent.size() - 1) % m_recent.size()] : nullptr;
+        if (reference != nullptr && reference != latest && reference != &m_keyframe && reference != &m_pinned)
+        {
+            copyProperties(*reference, m_pinned);
+            reference = &m_pinned;
+        }
+
+        // Built in out first, as the reference may be the slot the result is stored in.
+        out.reset();
+        copyProperties(received, out);
+        if (reference == nullptr)
+        {
+            copyProperties(out, m_keyframe);
+        }
+        else
+        {
+            auto& samples = out.relatedSampleIds->samples;
+            samples.pop_back();
+            if (samples.empty())
+            {
+                out.relatedSampleIds = std::nullopt;
+            }
+
+            out.camera = reference->camera;
+            out.duration = reference->duration;
+            out.globalStage = out.globalStage.has_value() ? out.globalStage : reference->globalStage;
+            fillUnchanged(out.lens, reference->lens);
+            copyStatic(reference->lens, out.lens);
+            fillUnchanged(out.timing, reference->timing);
+            fillUnchanged(out.tracker, reference->tracker);
+            copyStatic(reference->tracker, out.tracker);
+
+            if (!out.transforms.has_value())
+            {
+                out.transforms = reference->transforms;
+            }
+            else if (reference->transforms.has_value() &&
+                     out.transforms->transforms.size() == reference->transforms->transforms.size())
+            {
+                auto& transforms = out.transforms->transforms;
+                for (std::size_t i = 0; i < transforms.size(); ++i)
+                {
+                    forEachDynamic([](auto& o, const auto& r)
+                    {
+                        if (!o.has_value())
+                        {
+                            o = r;
+                        }
+                    }, transforms[i], reference->transforms->transforms[i]);
+                }
+            }
+
+            if (out.staticProperties == nullptr)
+            {
+                out.staticProperties = reference->staticProperties;
+            }
+        }
+
+        copyProperties(out, m_recent[m_next]);
+        m_next = (m_next + 1) % m_recent.size();
+        m_count = std::min(m_count + 1, m_recent.size());
+        return reference != nullptr;
+    }
+} // namespace opentrackio
@@ -0,0 +1,258 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIODiagnostics.h"
+#include <algorithm>
+#include <format>
+
+namespace opentrackio
+{
+    namespace
+    {
+        std::string formatMessage(std::string_view message, std::string_view field, std::string_view expected,
+                                  std::string_view value)
+        {
+            return std::vformat(message, std::make_format_args(field, expected, value));
+        }
+    } // namespace
+
+    void Diagnostics::configure(bool structured, bool collectWarnings)
+    {
+        if (structured || structured != m_structured)
+        {
+            clear();
+        }
+        m_structured = structured;
+        m_collectWarnings = collectWarnings;
+    }
+
+    void Diagnostics::clear()
+    {
+        m_count = 0;
+        m_pathCount = 0;
+        m_valueSize = 0;
+        m_dropped = 0;
+        m_errorCount = 0;
+        m_warningCount = 0;
+        m_formatted = 0;
+        m_errorMessages.clear();
+        m_warningMessages.clear();
+    }
+
+    void Diagnostics::error(DiagnosticCode code, std::string_view message, std::string_view field,
+                            std::string_view expected)
+    {
+        Diagnostic diagnostic{};
+        diagnostic.code = code;
+        diagnostic.severity = DiagnosticSeverity::ERROR;
+        diagnostic.message = message.data();
+        diagnostic.expected = expected.empty() ? "" : expected.data();
+        report(diagnostic, field, {});
+    }
+
+    void Diagnostics::warning(DiagnosticCode code, std::string_view message, std::string_view value)
+    {
+        if (!m_collectWarnings)
+        {
+            return;
+        }
+
+        Diagnostic diagnostic{};
+        diagnostic.code = code;
+        diagnostic.severity = DiagnosticSeverity::WARNING;
+        diagnostic.message = message.data();
+        report(diagnostic, {}, value);
+    }
+
+    void Diagnostics::enter(std::string_view key)
+    {
+        if (m_depth < m_scope.size())
+        {
+            m_scope[m_depth] = key.data();
+        }
+        ++m_depth;
+    }
+
+    void Diagnostics::leave()
+    {
+        --m_depth;
+    }
+
+    std::string_view Diagnostics::field(const Diagnostic& diagnostic) const
+    {
+        return diagnostic.pathId == Diagnostic::NO_PATH ? std::string_view{} : m_paths[diagnostic.pathId].key;
+    }
+
+    std::string Diagnostics::path(const Diagnostic& diagnostic) const
+    {
+        std::string joined{};
+        for (uint8_t id = diagnostic.pathId; id != Diagnostic::NO_PATH; id = m_paths[id].parent)
+        {
+            const std::string_view key{m_paths[id].key};
+            if (!joined.empty() && !key.empty())
+            {
+                joined.insert(0, 1, '/');
+            }
+            joined.insert(0, key);
+        }
+        return joined;
+    }
+
+    bool Diagnostics::hasPath(const Diagnostic& diagnostic, std::string_view path) const
+    {
+        // Walks the table innermost first, so the path is matched from its end.
+        for (uint8_t id = diagnostic.pathId; id != Diagnostic::NO_PATH; id = m_paths[id].parent)
+        {
+            const std::string_view key{m_paths[id].key};
+            if (key.empty())
+            {
+                continue;
+            }
+            if (!path.ends_with(key))
+            {
+                return false;
+            }
+            path.remove_suffix(key.size());
+            if (!path.empty())
+            {
+                if (path.back() != '/')
+                {
+                    return false;
+                }
+                path.remove_suffix(1);
+            }
+        }
+        return path.empty();
+    }
+
+    std::string_view Diagnostics::value(const Diagnostic& diagnostic) const
+    {
+        return {m_values.data() + diagnostic.valueOffset, diagnostic.valueLength};
+    }
+
+    std::string Diagnostics::toString(const Diagnostic& diagnostic) const
+    {
+        return formatMessage(diagnostic.message, path(diagnostic), diagnostic.expected, value(diagnostic));
+    }
+
+    void Diagnostics::report(Diagnostic diagnostic, std::string_view field, std::string_view value)
+    {
+        if (diagnostic.severity == DiagnosticSeverity::ERROR)
+        {
+            ++m_errorCount;
+        }
+        else
+        {
+            ++m_warningCount;
+        }
+
+        if (!m_structured)
+        {
+            // Formatted straight from the scope and value so that nothing is truncated or dropped.
+            std::string joined{};
+            for (std::size_t i = 0; i < std::min<std::size_t>(m_depth, m_scope.size()); ++i)
+            {
+                joined.append(m_scope[i]).push_back('/');
+            }
+            joined.append(field);
+            if (field.empty() && !joined.empty())
+            {
+                joined.pop_back();
+            }
+            auto& messages = diagnostic.severity == DiagnosticSeverity::ERROR ? m_errorMessages : m_warningMessages;
+            messages.push_back(formatMessage(diagnostic.message, joined, diagnostic.expected, value));
+            return;
+        }
+
+        if (m_count == CAPACITY)
+        {
+            ++m_dropped;
+            return;
+        }
+
+        if (diagnostic.severity == DiagnosticSeverity::ERROR)
+        {
+            diagnostic.pathId = internPath(field);
+            if (diagnostic.pathId == Diagnostic::NO_PATH)
+            {
+                ++m_dropped;
+                return;
+            }
+        }
+
+        diagnostic.valueOffset = m_valueSize;
+        diagnostic.valueLength = static_cast<uint8_t>(std::min({value.size(), VALUE_CAPACITY - m_valueSize,
+                                                                std::size_t{UINT8_MAX}}));
+        std::copy_n(value.data(), diagnostic.valueLength, m_values.data() + m_valueSize);
+        m_valueSize += diagnostic.valueLength;
+
+        m_entries[m_count] = diagnostic;
+        ++m_count;
+    }
+
+    /**
+     * Paths are only interned when an error is reported, entering a scope just records its key. */
+    uint8_t Diagnostics::internPath(std::string_view field)
+    {
+        uint8_t parent = Diagnostic::NO_PATH;
+        for (std::size_t i = 0; i < std::min<std::size_t>(m_depth, m_scope.size()); ++i)
+        {
+            parent = internNode(parent, m_scope[i]);
+            if (parent == Diagnostic::NO_PATH)
+            {
+                return Diagnostic::NO_PATH;
+            }
+        }
+        return internNode(parent, field.empty() ? "" : field.data());
+    }
+
+    uint8_t Diagnostics::internNode(uint8_t parent, const char* key)
+    {
+        for (uint8_t id = 0; id < m_pathCount; ++id)
+        {
+            if (m_paths[id].parent == parent && std::string_view{m_paths[id].key} == key)
+            {
+                return id;
+            }
+        }
+
+        if (m_pathCount == PATH_CAPACITY)
+        {
+            return Diagnostic::NO_PATH;
+        }
+        m_paths[m_pathCount] = {key, parent};
+        return m_pathCount++;
+    }
+
+    const std::vector<std::string>& Diagnostics::errors()
+    {
+        formatEntries();
+        return m_errorMessages;
+    }
+
+    const std::vector<std::string>& Diagnostics::warnings()
+    {
+        formatEntries();
+        return m_warningMessages;
+    }
+
+    void Diagnostics::formatEntries()
+    {
+        for (; m_formatted < m_count; ++m_formatted)
+        {
+            const auto& diagnostic = m_entries[m_formatted];
+            auto& messages = diagnostic.severity == DiagnosticSeverity::ERROR ? m_errorMessages : m_warningMessages;
+            messages.push_back(toString(diagnostic));
+        }
+    }
+} // namespace opentrackio
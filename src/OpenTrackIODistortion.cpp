@@ -0,0 +1,422 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIODistortion.h"
+#include <algorithm>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  if defined(__GNUC__) || defined(__clang__)
+#    define OPEN_TRACK_IO_AVX2 1
+#    define OPEN_TRACK_IO_AVX2_TARGET __attribute__((target("avx2,fma")))
+#  elif defined(__AVX2__)
+#    define OPEN_TRACK_IO_AVX2 1
+#    define OPEN_TRACK_IO_AVX2_TARGET
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define OPEN_TRACK_IO_NEON 1
+#endif
+
+#if defined(OPEN_TRACK_IO_AVX2)
+#  include <immintrin.h>
+#elif defined(OPEN_TRACK_IO_NEON)
+#  include <arm_neon.h>
+#endif
+
+namespace opentrackio
+{
+    namespace
+    {
+        static_assert(sizeof(Point2) == 2 * sizeof(double), "Kernels treat point arrays as interleaved doubles");
+
+        // Points inverted together, small enough to keep on the stack.
+        constexpr std::size_t INVERT_BLOCK = 64;
+
+        template<std::size_t K, bool TANGENTIAL>
+        void scalarKernel(const DistortionModel& model, const Point2* in, Point2* out, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const double x = in[i].x;
+                const double y = in[i].y;
+                const double r2 = x * x + y * y;
+
+                double radial = 0;
+                for (std::size_t j = K; j-- > 0;)
+                {
+                    radial = radial * r2 + model.k[j];
+                }
+                radial = 1 + radial * r2;
+
+                double xOut = x * radial;
+                double yOut = y * radial;
+                if constexpr (TANGENTIAL)
+                {
+                    const double xy = x * y;
+                    xOut += 2 * model.p[0] * xy + model.p[1] * (r2 + 2 * x * x);
+                    yOut += model.p[0] * (r2 + 2 * y * y) + 2 * model.p[1] * xy;
+                }
+                out[i] = {xOut, yOut};
+            }
+        }
+
+        void genericKernel(const DistortionModel& model, const Point2* in, Point2* out, std::size_t count)
+        {
+            const auto& radialCoefficients = model.radial();
+            const auto& tangentialCoefficients = model.tangential();
+            const double p1 = !tangentialCoefficients.empty() ? tangentialCoefficients[0] : 0.0;
+            const double p2 = tangentialCoefficients.size() > 1 ? tangentialCoefficients[1] : 0.0;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const double x = in[i].x;
+                const double y = in[i].y;
+                const double r2 = x * x + y * y;
+
+                double radial = 0;
+                for (std::size_t j = radialCoefficients.size(); j-- > 0;)
+                {
+                    radial = radial * r2 + radialCoefficients[j];
+                }
+                radial = 1 + radial * r2;
+
+                double scale = 0;
+                for (std::size_t j = tangentialCoefficients.size(); j-- > 2;)
+                {
+                    scale = scale * r2 + tangentialCoefficients[j];
+                }
+                scale = 1 + scale * r2;
+
+                const double xy = x * y;
+                out[i] = {x * radial + (2 * p1 * xy + p2 * (r2 + 2 * x * x)) * scale,
+                          y * radial + (p1 * (r2 + 2 * y * y) + 2 * p2 * xy) * scale};
+            }
+        }
+
+#if defined(OPEN_TRACK_IO_AVX2)
+        template<std::size_t K, bool TANGENTIAL>
+        OPEN_TRACK_IO_AVX2_TARGET void vectorKernel(const DistortionModel& model, const Point2* in, Point2* out,
+                                                    std::size_t count)
+        {
+            const auto* src = reinterpret_cast<const double*>(in);
+            auto* dst = reinterpret_cast<double*>(out);
+            const __m256d one = _mm256_set1_pd(1.0);
+            const __m256d two = _mm256_set1_pd(2.0);
+            const __m256d p1 = _mm256_set1_pd(model.p[0]);
+            const __m256d p2 = _mm256_set1_pd(model.p[1]);
+
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                // Unpacking two registers of x, y pairs gives x and y in the lane order 0 2 1 3, which unpacking
+                // the results again puts back.
+                const __m256d a = _mm256_loadu_pd(src + 2 * i);
+                const __m256d b = _mm256_loadu_pd(src + 2 * i + 4);
+                const __m256d x = _mm256_unpacklo_pd(a, b);
+                const __m256d y = _mm256_unpackhi_pd(a, b);
+                const __m256d r2 = _mm256_fmadd_pd(x, x, _mm256_mul_pd(y, y));
+
+                __m256d radial = _mm256_setzero_pd();
+                for (std::size_t j = K; j-- > 0;)
+                {
+                    radial = _mm256_fmadd_pd(radial, r2, _mm256_set1_pd(model.k[j]));
+                }
+                radial = _mm256_fmadd_pd(radial, r2, one);
+
+                __m256d xOut = _mm256_mul_pd(x, radial);
+                __m256d yOut = _mm256_mul_pd(y, radial);
+                if constexpr (TANGENTIAL)
+                {
+                    const __m256d xy2 = _mm256_mul_pd(two, _mm256_mul_pd(x, y));
+                    xOut = _mm256_fmadd_pd(p1, xy2, xOut);
+                    xOut = _mm256_fmadd_pd(p2, _mm256_fmadd_pd(_mm256_mul_pd(two, x), x, r2), xOut);
+                    yOut = _mm256_fmadd_pd(p1, _mm256_fmadd_pd(_mm256_mul_pd(two, y), y, r2), yOut);
+                    yOut = _mm256_fmadd_pd(p2, xy2, yOut);
+                }
+
+                _mm256_storeu_pd(dst + 2 * i, _mm256_unpacklo_pd(xOut, yOut));
+                _mm256_storeu_pd(dst + 2 * i + 4, _mm256_unpackhi_pd(xOut, yOut));
+            }
+            scalarKernel<K, TANGENTIAL>(model, in + i, out + i, count - i);
+        }
+
+        bool detectVector()
+        {
+#  if defined(__GNUC__) || defined(__clang__)
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#  else
+            return true;
+#  endif
+        }
+
+        constexpr DistortionIsa VECTOR_ISA = DistortionIsa::AVX2;
+#elif defined(OPEN_TRACK_IO_NEON)
+        template<std::size_t K, bool TANGENTIAL>
+        void vectorKernel(const DistortionModel& model, const Point2* in, Point2* out, std::size_t count)
+        {
+            const auto* src = reinterpret_cast<const double*>(in);
+            auto* dst = reinterpret_cast<double*>(out);
+            const float64x2_t one = vdupq_n_f64(1.0);
+            const float64x2_t two = vdupq_n_f64(2.0);
+
+            std::size_t i = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                const float64x2x2_t points = vld2q_f64(src + 2 * i);
+                const float64x2_t x = points.val[0];
+                const float64x2_t y = points.val[1];
+                const float64x2_t r2 = vfmaq_f64(vmulq_f64(y, y), x, x);
+
+                float64x2_t radial = vdupq_n_f64(0.0);
+                for (std::size_t j = K; j-- > 0;)
+                {
+                    radial = vfmaq_f64(vdupq_n_f64(model.k[j]), radial, r2);
+                }
+                radial = vfmaq_f64(one, radial, r2);
+
+                float64x2x2_t result;
+                result.val[0] = vmulq_f64(x, radial);
+                result.val[1] = vmulq_f64(y, radial);
+                if constexpr (TANGENTIAL)
+                {
+                    const float64x2_t xy2 = vmulq_f64(two, vmulq_f64(x, y));
+                    result.val[0] = vfmaq_n_f64(result.val[0], xy2, model.p[0]);
+                    result.val[0] = vfmaq_n_f64(result.val[0], vfmaq_f64(r2, vmulq_f64(two, x), x), model.p[1]);
+                    result.val[1] = vfmaq_n_f64(result.val[1], vfmaq_f64(r2, vmulq_f64(two, y), y), model.p[0]);
+                    result.val[1] = vfmaq_n_f64(result.val[1], xy2, model.p[1]);
+                }
+                vst2q_f64(dst + 2 * i, result);
+            }
+            scalarKernel<K, TANGENTIAL>(model, in + i, out + i, count - i);
+        }
+
+        bool detectVector()
+        {
+            return true;
+        }
+
+        constexpr DistortionIsa VECTOR_ISA = DistortionIsa::NEON;
+#else
+        template<std::size_t K, bool TANGENTIAL>
+        void vectorKernel(const DistortionModel& model, const Point2* in, Point2* out, std::size_t count)
+        {
+            scalarKernel<K, TANGENTIAL>(model, in, out, count);
+        }
+
+        bool detectVector()
+        {
+            return false;
+        }
+
+        constexpr DistortionIsa VECTOR_ISA = DistortionIsa::SCALAR;
+#endif
+
+        bool useVector()
+        {
+            static const bool vector = detectVector();
+            return vector;
+        }
+
+        template<std::size_t K, bool TANGENTIAL>
+        DistortionModel::Kernel kernelFor()
+        {
+            return useVector() ? &vectorKernel<K, TANGENTIAL> : &scalarKernel<K, TANGENTIAL>;
+        }
+
+        template<std::size_t... Ks>
+        DistortionModel::Kernel selectKernel(std::size_t radial, bool tangential, std::index_sequence<Ks...>)
+        {
+            DistortionModel::Kernel kernel = &genericKernel;
+            ((radial == Ks ? (kernel = tangential ? kernelFor<Ks, true>() : kernelFor<Ks, false>(), 0) : 0), ...);
+            return kernel;
+        }
+
+        std::span<const double> coefficientsOf(const std::optional<Vector<double>>& coefficients)
+        {
+            return coefficients.has_value() ? std::span<const double>{coefficients.value()} : std::span<const double>{};
+        }
+    } // namespace
+
+    DistortionModel::DistortionModel() : m_kernel{&scalarKernel<0, false>}
+    {
+    }
+
+    DistortionModel::DistortionModel(std::span<const double> radial, std::span<const double> tangential)
+            : m_radial(radial.begin(), radial.end()),
+              m_tangential(tangential.begin(), tangential.end()),
+              m_kernel{&genericKernel}
+    {
+        // Trailing zeros don't change the result, dropping them picks a shorter kernel.
+        while (!m_radial.empty() && m_radial.back() == 0.0)
+        {
+            m_radial.pop_back();
+        }
+        while (!m_tangential.empty() && m_tangential.back() == 0.0)
+        {
+            m_tangential.pop_back();
+        }
+
+        m_identity = m_radial.empty() && m_tangential.empty();
+        if (m_radial.size() <= MAX_RADIAL && m_tangential.size() <= p.size())
+        {
+            std::copy(m_radial.begin(), m_radial.end(), k.begin());
+            std::copy(m_tangential.begin(), m_tangential.end(), p.begin());
+            m_kernel = selectKernel(m_radial.size(), !m_tangential.empty(),
+                                    std::make_index_sequence<MAX_RADIAL + 1>{});
+        }
+    }
+
+    DistortionIsa DistortionModel::isa()
+    {
+        return useVector() ? VECTOR_ISA : DistortionIsa::SCALAR;
+    }
+
+    void DistortionModel::apply(std::span<const Point2> in, std::span<Point2> out) const
+    {
+        const std::size_t count = std::min(in.size(), out.size());
+        if (m_identity)
+        {
+            if (in.data() != out.data())
+            {
+                std::copy_n(in.begin(), count, out.begin());
+            }
+            return;
+        }
+        m_kernel(*this, in.data(), out.data(), count);
+    }
+
+    void DistortionModel::invert(std::span<const Point2> in, std::span<Point2> out, std::size_t iterations) const
+    {
+        const std::size_t count = std::min(in.size(), out.size());
+        if (m_identity)
+        {
+            apply(in.first(count), out);
+            return;
+        }
+
+        std::array<Point2, INVERT_BLOCK> guess{};
+        std::array<Point2, INVERT_BLOCK> mapped{};
+        for (std::size_t start = 0; start < count; start += INVERT_BLOCK)
+        {
+            const std::size_t size = std::min(INVERT_BLOCK, count - start);
+            const Point2* target = in.data() + start;
+            std::copy_n(target, size, guess.begin());
+
+            // Moving each guess by how far its image misses the target converges while the distortion is close
+            // to the identity, as a lens' is once normalised by its focal length.
+            for (std::size_t iteration = 0; iteration < iterations; ++iteration)
+            {
+                m_kernel(*this, guess.data(), mapped.data(), size);
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    guess[i].x += target[i].x - mapped[i].x;
+                    guess[i].y += target[i].y - mapped[i].y;
+                }
+            }
+            std::copy_n(guess.begin(), size, out.begin() + static_cast<std::ptrdiff_t>(start));
+        }
+    }
+
+    LensDistortion::LensDistortion(const opentrackioproperties::Lens& lens)
+            : m_focalLength{lens.focalLength},
+              m_overscan{lens.distortionOverscan.value_or(1.0)}
+    {
+        if (lens.distortion.has_value())
+        {
+            const auto& distortion = lens.distortion.value();
+            m_distortion = DistortionModel(distortion.radial, coefficientsOf(distortion.tangential));
+        }
+        if (lens.undistortion.has_value())
+        {
+            const auto& undistortion = lens.undistortion.value();
+            m_undistortion.emplace(undistortion.radial, coefficientsOf(undistortion.tangential));
+        }
+        if (lens.distortionShift.has_value())
+        {
+            m_shift = {lens.distortionShift->x, lens.distortionShift->y};
+        }
+    }
+
+    void LensDistortion::distort(std::span<const Point2> in, std::span<Point2> out) const
+    {
+        m_distortion.apply(in, out);
+    }
+
+    void LensDistortion::undistort(std::span<const Point2> in, std::span<Point2> out) const
+    {
+        if (m_undistortion.has_value())
+        {
+            m_undistortion->apply(in, out);
+            return;
+        }
+        m_distortion.invert(in, out);
+    }
+
+    Point2 LensDistortion::toNormalised(Point2 millimetres) const
+    {
+        const double focalLength = m_focalLength.value_or(1.0);
+        return {(millimetres.x - m_shift.x) / focalLength, (millimetres.y - m_shift.y) / focalLength};
+    }
+
+    Point2 LensDistortion::fromNormalised(Point2 normalised) const
+    {
+        const double focalLength = m_focalLength.value_or(1.0);
+        return {normalised.x * focalLength + m_shift.x, normalised.y * focalLength + m_shift.y};
+    }
+
+    bool bakeStMap(const LensDistortion& distortion, const StMapOptions& options, std::vector<float>& uv)
+    {
+        if (!distortion.focalLength().has_value() || options.width == 0 || options.height == 0 ||
+            options.sensorWidth <= 0 || options.sensorHeight <= 0)
+        {
+            return false;
+        }
+
+        const double overscan = options.overscan.value_or(distortion.overscan());
+        const bool apply = options.direction == StMapOptions::Direction::APPLY_DISTORTION;
+        const double gridWidth = options.sensorWidth * (apply ? 1.0 : overscan);
+        const double gridHeight = options.sensorHeight * (apply ? 1.0 : overscan);
+        const double targetWidth = options.sensorWidth * (apply ? overscan : 1.0);
+        const double targetHeight = options.sensorHeight * (apply ? overscan : 1.0);
+
+        uv.resize(static_cast<std::size_t>(options.width) * options.height * 2);
+        std::vector<Point2> row(options.width);
+        for (uint32_t r = 0; r < options.height; ++r)
+        {
+            const double y = (0.5 - (r + 0.5) / options.height) * gridHeight;
+            for (uint32_t c = 0; c < options.width; ++c)
+            {
+                row[c] = distortion.toNormalised({((c + 0.5) / options.width - 0.5) * gridWidth, y});
+            }
+
+            // Each pixel of an APPLY_DISTORTION map is a distorted position, so its lookup is where it came from.
+            if (apply)
+            {
+                distortion.undistort(row, row);
+            }
+            else
+            {
+                distortion.distort(row, row);
+            }
+
+            float* out = uv.data() + static_cast<std::size_t>(r) * options.width * 2;
+            for (uint32_t c = 0; c < options.width; ++c)
+            {
+                const Point2 millimetres = distortion.fromNormalised(row[c]);
+                out[2 * c] = static_cast<float>(0.5 + millimetres.x / targetWidth);
+                out[2 * c + 1] = static_cast<float>(0.5 - millimetres.y / targetHeight);
+            }
+        }
+        return true;
+    }
+} // namespace opentrackio
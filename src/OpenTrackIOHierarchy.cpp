@@ -0,0 +1,171 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOHierarchy.h"
+#include <algorithm>
+#include <string_view>
+
+namespace opentrackio
+{
+    namespace
+    {
+        const std::span<const opentrackiotypes::Transform> NO_TRANSFORMS{};
+    } // namespace
+
+    void TransformHierarchy::build(std::span<const opentrackiotypes::Transform> transforms, TransformHierarchy& out)
+    {
+        const auto count = static_cast<uint32_t>(transforms.size());
+        out.order.clear();
+        out.parents.assign(count, ROOT);
+        out.unresolvedParents = 0;
+        out.cyclic = false;
+        out.m_ids.resize(count);
+        out.m_parentIds.resize(count);
+
+        std::unordered_map<std::string_view, uint32_t> indices{};
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            out.m_ids[i] = transforms[i].transformId;
+            out.m_parentIds[i] = transforms[i].parentTransformId;
+            if (transforms[i].transformId.has_value())
+            {
+                indices.try_emplace(transforms[i].transformId.value(), i);
+            }
+        }
+
+        // Children are linked in list order so that siblings come out in the order they were listed.
+        std::vector<uint32_t> firstChild(count, ROOT);
+        std::vector<uint32_t> nextSibling(count, ROOT);
+        std::vector<uint32_t> lastChild(count, ROOT);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (!transforms[i].parentTransformId.has_value())
+            {
+                continue;
+            }
+
+            const auto parent = indices.find(transforms[i].parentTransformId.value());
+            if (parent == indices.end())
+            {
+                ++out.unresolvedParents;
+                continue;
+            }
+
+            const uint32_t p = parent->second;
+            out.parents[i] = p;
+            (lastChild[p] == ROOT ? firstChild[p] : nextSibling[lastChild[p]]) = i;
+            lastChild[p] = i;
+        }
+
+        std::vector<bool> placed(count, false);
+        auto placeFrom = [&](uint32_t root)
+        {
+            // Breadth first, the order itself is the queue.
+            std::size_t head = out.order.size();
+            out.order.push_back(root);
+            placed[root] = true;
+            for (; head < out.order.size(); ++head)
+            {
+                for (uint32_t child = firstChild[out.order[head]]; child != ROOT; child = nextSibling[child])
+                {
+                    if (!placed[child])
+                    {
+                        placed[child] = true;
+                        out.order.push_back(child);
+                    }
+                }
+            }
+        };
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (out.parents[i] == ROOT)
+            {
+                placeFrom(i);
+            }
+        }
+
+        // Whatever is left is in or hangs off a cycle. Following parents from it until one repeats finds the cycle,
+        // which is broken at its first transform in list order, placing it places everything hanging off it too.
+        std::vector<uint32_t> walkedFrom(count, ROOT);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (placed[i])
+            {
+                continue;
+            }
+
+            uint32_t node = i;
+            for (; walkedFrom[node] != i; node = out.parents[node])
+            {
+                walkedFrom[node] = i;
+            }
+
+            uint32_t first = node;
+            for (uint32_t member = out.parents[node]; member != node; member = out.parents[member])
+            {
+                first = std::min(first, member);
+            }
+
+            out.cyclic = true;
+            out.parents[first] = ROOT;
+            placeFrom(first);
+        }
+    }
+
+    bool TransformHierarchy::matches(std::span<const opentrackiotypes::Transform> transforms) const
+    {
+        if (transforms.size() != m_ids.size())
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < transforms.size(); ++i)
+        {
+            if (transforms[i].transformId != m_ids[i] || transforms[i].parentTransformId != m_parentIds[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const TransformHierarchy& HierarchyResolver::hierarchy(const OpenTrackIOSample& sample)
+    {
+        const opentrackiotypes::UrnUuid source = sample.sourceId.has_value() ? sample.sourceId->id
+                                                                               : opentrackiotypes::UrnUuid{};
+        const auto transforms = sample.transforms.has_value()
+                                ? std::span<const opentrackiotypes::Transform>(sample.transforms->transforms)
+                                : NO_TRANSFORMS;
+
+        auto it = m_hierarchies.find(source);
+        if (it == m_hierarchies.end())
+        {
+            it = m_hierarchies.try_emplace(source).first;
+        }
+        else if (it->second.matches(transforms))
+        {
+            return it->second;
+        }
+
+        TransformHierarchy::build(transforms, it->second);
+        ++m_builds;
+        return it->second;
+    }
+
+    void HierarchyResolver::clear()
+    {
+        m_hierarchies.clear();
+        m_builds = 0;
+    }
+} // namespace opentrackio
@@ -0,0 +1,294 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOHistory.h"
+#include <algorithm>
+#include <utility>
+
+namespace opentrackio
+{
+    namespace
+    {
+        // How far a query steps on from the previous bracket before giving up and binary searching.
+        constexpr std::size_t CURSOR_STEPS = 4;
+
+        void setLens(std::array<double, LENS_VALUE_COUNT>& lens, uint32_t& valid, LensValue value,
+                     const std::optional<double>& field)
+        {
+            if (field.has_value())
+            {
+                lens[static_cast<std::size_t>(value)] = field.value();
+                valid |= 1u << static_cast<uint32_t>(value);
+            }
+        }
+    } // namespace
+
+    SampleHistory::SampleHistory(std::size_t capacity, std::size_t maxTransforms, int64_t maxExtrapolation)
+            : m_entries(std::max<std::size_t>(capacity, 2)),
+              m_transforms(m_entries.size() * std::max<std::size_t>(maxTransforms, 1)),
+              m_maxTransforms{std::max<std::size_t>(maxTransforms, 1)},
+              m_maxExtrapolation{maxExtrapolation}
+    {
+    }
+
+    int64_t SampleHistory::toNanoseconds(const opentrackiotypes::Timestamp& timestamp)
+    {
+        return static_cast<int64_t>(timestamp.seconds) * 1'000'000'000 + timestamp.nanoseconds;
+    }
+
+    void SampleHistory::clear()
+    {
+        m_head = 0;
+        m_count = 0;
+        m_cursor = 0;
+    }
+
+    bool SampleHistory::push(const OpenTrackIOSample& sample)
+    {
+        if (!sample.timing.has_value() || !sample.timing->sampleTimestamp.has_value())
+        {
+            return false;
+        }
+        return insert(toNanoseconds(sample.timing->sampleTimestamp.value()), sample);
+    }
+
+    bool SampleHistory::push(const TrackingSnapshot& snapshot)
+    {
+        if (!snapshot.has(SnapshotField::SAMPLE_TIMESTAMP))
+        {
+            return false;
+        }
+        return insert(toNanoseconds(snapshot.sampleTimestamp), snapshot);
+    }
+
+    template<typename Source>
+    bool SampleHistory::insert(int64_t time, const Source& source)
+    {
+        std::size_t low = 0;
+        std::size_t high = m_count;
+        while (low < high)
+        {
+            const std::size_t middle = low + (high - low) / 2;
+            if (entry(middle).time < time)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        if (low < m_count && entry(low).time == time)
+        {
+            store(slot(low), time, source);
+            return true;
+        }
+
+        if (m_count == m_entries.size())
+        {
+            if (low == 0)
+            {
+                return false;
+            }
+            m_head = slot(1);
+            --m_count;
+            --low;
+            m_cursor = m_cursor > 0 ? m_cursor - 1 : 0;
+        }
+
+        // Stored after the newest, then moved back past any newer samples that arrived before it.
+        std::size_t index = m_count++;
+        store(slot(index), time, source);
+        for (; index > low; --index)
+        {
+            swapEntries(index - 1, index);
+        }
+        return true;
+    }
+
+    void SampleHistory::store(std::size_t position, int64_t time, const OpenTrackIOSample& sample)
+    {
+        Entry& stored = m_entries[position];
+        stored.time = time;
+        stored.lensValid = 0;
+        stored.transformCount = 0;
+
+        if (sample.lens.has_value())
+        {
+            const auto& lens = sample.lens.value();
+            setLens(stored.lens, stored.lensValid, LensValue::FOCAL_LENGTH, lens.focalLength);
+            setLens(stored.lens, stored.lensValid, LensValue::FOCUS_DISTANCE, lens.focusDistance);
+            setLens(stored.lens, stored.lensValid, LensValue::F_STOP, lens.fStop);
+            setLens(stored.lens, stored.lensValid, LensValue::T_STOP, lens.tStop);
+            setLens(stored.lens, stored.lensValid, LensValue::ENTRANCE_PUPIL_OFFSET, lens.entrancePupilOffset);
+            if (lens.encoders.has_value())
+            {
+                setLens(stored.lens, stored.lensValid, LensValue::ENCODER_FOCUS, lens.encoders->focus);
+                setLens(stored.lens, stored.lensValid, LensValue::ENCODER_IRIS, lens.encoders->iris);
+                setLens(stored.lens, stored.lensValid, LensValue::ENCODER_ZOOM, lens.encoders->zoom);
+            }
+        }
+
+        if (sample.transforms.has_value())
+        {
+            const auto& transforms = sample.transforms->transforms;
+            stored.transformCount = static_cast<uint32_t>(std::min(transforms.size(), m_maxTransforms));
+            TransformState* states = &m_transforms[position * m_maxTransforms];
+            for (std::size_t i = 0; i < stored.transformCount; ++i)
+            {
+                states[i].translation = transforms[i].translation;
+                states[i].rotation = transforms[i].rotation;
+                states[i].orientation = Quaternion::fromRotation(transforms[i].rotation);
+                states[i].scale = transforms[i].scale.value_or(opentrackiotypes::Vector3{1, 1, 1});
+            }
+        }
+    }
+
+    void SampleHistory::store(std::size_t position, int64_t time, const TrackingSnapshot& snapshot)
+    {
+        Entry& stored = m_entries[position];
+        stored.time = time;
+        stored.lens = snapshot.lens;
+        stored.lensValid = snapshot.lensValid;
+        stored.transformCount = static_cast<uint32_t>(std::min<std::size_t>(snapshot.transformCount, m_maxTransforms));
+
+        TransformState* states = &m_transforms[position * m_maxTransforms];
+        for (std::size_t i = 0; i < stored.transformCount; ++i)
+        {
+            const auto& transform = snapshot.transforms[i];
+            states[i].translation = {transform.translation[0], transform.translation[1], transform.translation[2]};
+            states[i].rotation = {transform.rotation[0], transform.rotation[1], transform.rotation[2]};
+            states[i].orientation = Quaternion::fromRotation(states[i].rotation);
+            states[i].scale = {transform.scale[0], transform.scale[1], transform.scale[2]};
+        }
+    }
+
+    void SampleHistory::swapEntries(std::size_t a, std::size_t b)
+    {
+        std::swap(m_entries[slot(a)], m_entries[slot(b)]);
+        std::swap_ranges(m_transforms.begin() + static_cast<std::ptrdiff_t>(slot(a) * m_maxTransforms),
+                         m_transforms.begin() + static_cast<std::ptrdiff_t>((slot(a) + 1) * m_maxTransforms),
+                         m_transforms.begin() + static_cast<std::ptrdiff_t>(slot(b) * m_maxTransforms));
+    }
+
+    std::size_t SampleHistory::findBracket(int64_t time) const
+    {
+        // The index i of the last sample at or before time, given entry(0).time <= time < entry(m_count - 1).time.
+        std::size_t i = std::min(m_cursor, m_count - 2);
+        if (entry(i).time <= time)
+        {
+            for (std::size_t step = 0; step < CURSOR_STEPS; ++step)
+            {
+                if (entry(i + 1).time > time)
+                {
+                    m_cursor = i;
+                    return i;
+                }
+                ++i;
+            }
+        }
+
+        std::size_t low = 0;
+        std::size_t high = m_count - 1;
+        while (high - low > 1)
+        {
+            const std::size_t middle = low + (high - low) / 2;
+            (entry(middle).time <= time ? low : high) = middle;
+        }
+        m_cursor = low;
+        return low;
+    }
+
+    bool SampleHistory::at(int64_t time, InterpolatedState& out) const
+    {
+        out.time = time;
+        if (m_count == 0)
+        {
+            out.status = InterpolatedState::Status::EMPTY;
+            out.lensValid = 0;
+            out.transforms.clear();
+            return false;
+        }
+
+        if (m_count == 1 || time <= entry(0).time)
+        {
+            hold(0, out);
+            return true;
+        }
+
+        const std::size_t newest = m_count - 1;
+        if (time >= entry(newest).time)
+        {
+            if (time == entry(newest).time || m_maxExtrapolation <= 0)
+            {
+                hold(newest, out);
+                return true;
+            }
+
+            const int64_t limited = std::min(time, entry(newest).time + m_maxExtrapolation);
+            const auto span = static_cast<double>(entry(newest).time - entry(newest - 1).time);
+            blend(newest - 1, static_cast<double>(limited - entry(newest - 1).time) / span, out);
+            out.status = InterpolatedState::Status::EXTRAPOLATED;
+            return true;
+        }
+
+        const std::size_t from = findBracket(time);
+        const auto span = static_cast<double>(entry(from + 1).time - entry(from).time);
+        blend(from, static_cast<double>(time - entry(from).time) / span, out);
+        out.status = InterpolatedState::Status::INTERPOLATED;
+        return true;
+    }
+
+    void SampleHistory::hold(std::size_t index, InterpolatedState& out) const
+    {
+        const Entry& held = entry(index);
+        out.status = InterpolatedState::Status::HELD;
+        out.lens = held.lens;
+        out.lensValid = held.lensValid;
+        out.transforms.assign(transformsOf(index), transformsOf(index) + held.transformCount);
+    }
+
+    void SampleHistory::blend(std::size_t from, double alpha, InterpolatedState& out) const
+    {
+        const Entry& a = entry(from);
+        const Entry& b = entry(from + 1);
+
+        // Plain loops over fixed size arrays so the compiler can vectorise them.
+        for (std::size_t i = 0; i < LENS_VALUE_COUNT; ++i)
+        {
+            out.lens[i] = a.lens[i] + (b.lens[i] - a.lens[i]) * alpha;
+        }
+        out.lensValid = a.lensValid & b.lensValid;
+
+        const std::size_t count = std::min(a.transformCount, b.transformCount);
+        out.transforms.resize(count);
+        const TransformState* as = transformsOf(from);
+        const TransformState* bs = transformsOf(from + 1);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto& transform = out.transforms[i];
+            transform.translation = lerp(as[i].translation, bs[i].translation, alpha);
+            transform.scale = lerp(as[i].scale, bs[i].scale, alpha);
+            transform.orientation = slerp(as[i].orientation, bs[i].orientation, alpha);
+
+            // Unwrapped against the angles lerped directly, so a pan that has wound past 360 carries on winding.
+            const auto& ra = as[i].rotation;
+            const auto& rb = bs[i].rotation;
+            const auto angles = transform.orientation.toRotation();
+            transform.rotation.pan = nearestAngle(angles.pan, ra.pan + (rb.pan - ra.pan) * alpha);
+            transform.rotation.tilt = nearestAngle(angles.tilt, ra.tilt + (rb.tilt - ra.tilt) * alpha);
+            transform.rotation.roll = nearestAngle(angles.roll, ra.roll + (rb.roll - ra.roll) * alpha);
+        }
+    }
+} // namespace opentrackio
@@ -0,0 +1,248 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOInstrumentation.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+
+namespace opentrackio
+{
+    namespace
+    {
+        // Half the range of a sequence number, a larger step forwards is a step back.
+        constexpr uint16_t SEQUENCE_HALF_RANGE = 0x8000;
+
+        // A step back further than this is the source restarting rather than a late sample.
+        constexpr uint16_t REORDER_WINDOW = 256;
+
+        void countField(std::vector<FieldCount>& counts, std::string_view field)
+        {
+            const auto it = std::find_if(counts.begin(), counts.end(), [field](const FieldCount& count)
+            {
+                return count.field == field;
+            });
+
+            if (it != counts.end())
+            {
+                ++it->count;
+                return;
+            }
+            counts.push_back({std::string{field}, 1});
+        }
+
+        /**
+         * Errors are counted by path so that fields sharing a key in different objects are told apart, the path is
+         * only built the first time it is seen. */
+        void countField(std::vector<FieldCount>& counts, const Diagnostics& diagnostics, const Diagnostic& diagnostic)
+        {
+            const auto it = std::find_if(counts.begin(), counts.end(), [&](const FieldCount& count)
+            {
+                return diagnostics.hasPath(diagnostic, count.field);
+            });
+
+            if (it != counts.end())
+            {
+                ++it->count;
+                return;
+            }
+            counts.push_back({diagnostics.path(diagnostic), 1});
+        }
+
+        void recordPhases(SourceStats& stats, const PhaseMeasurement& measurement)
+        {
+            for (std::size_t i = 0; i < INSTRUMENTED_PHASE_COUNT; ++i)
+            {
+                if ((measurement.timed >> i & 1) != 0)
+                {
+                    stats.phases[i].record(measurement.durations[i]);
+                }
+            }
+        }
+    } // namespace
+
+    void Histogram::record(uint64_t value)
+    {
+        ++buckets[std::min<std::size_t>(std::bit_width(value), BUCKETS - 1)];
+        ++count;
+        total += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    uint64_t Histogram::quantile(double q) const
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        const auto target = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(count)));
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i)
+        {
+            seen += buckets[i];
+            if (seen >= std::max<uint64_t>(target, 1))
+            {
+                return i == 0 ? 0 : std::min(max, (uint64_t{1} << i) - 1);
+            }
+        }
+        return max;
+    }
+
+    std::vector<SourceStats> Instrumentation::stats() const
+    {
+        std::lock_guard lock{m_mutex};
+        std::vector<SourceStats> out;
+        out.reserve(m_sources.size());
+        for (const auto& [id, source] : m_sources)
+        {
+            out.push_back(source.stats);
+        }
+        return out;
+    }
+
+    std::optional<SourceStats> Instrumentation::stats(const opentrackiotypes::UrnUuid& sourceId) const
+    {
+        std::lock_guard lock{m_mutex};
+        const auto it = m_sources.find(sourceId);
+        if (it == m_sources.end())
+        {
+            return std::nullopt;
+        }
+        return it->second.stats;
+    }
+
+    void Instrumentation::clear()
+    {
+        std::lock_guard lock{m_mutex};
+        m_sources.clear();
+    }
+
+    void Instrumentation::setCallback(Callback callback, std::chrono::nanoseconds period)
+    {
+        std::lock_guard lock{m_mutex};
+        m_callback = std::move(callback);
+        m_period = period;
+    }
+
+    Instrumentation::Source& Instrumentation::sourceOf(const OpenTrackIOSample& sample)
+    {
+        const opentrackiotypes::UrnUuid id = sample.sourceId.has_value() ? sample.sourceId->id
+                                                                         : opentrackiotypes::UrnUuid{};
+        auto [it, inserted] = m_sources.try_emplace(id);
+        if (inserted)
+        {
+            it->second.stats.sourceId = id;
+            it->second.lastReport = std::chrono::steady_clock::now();
+        }
+        return it->second;
+    }
+
+    void Instrumentation::recordParse(const OpenTrackIOSample& sample, const Diagnostics& diagnostics,
+                                      const PhaseMeasurement& measurement)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        std::unique_lock lock{m_mutex};
+        Source& source = sourceOf(sample);
+        SourceStats& stats = source.stats;
+
+        ++stats.parsed;
+        stats.bytesIn += measurement.bytes;
+        stats.allocations += measurement.allocations;
+        stats.errors += measurement.errors;
+        stats.warnings += measurement.warnings;
+        recordPhases(stats, measurement);
+
+        // Structured diagnostics only ever describe the latest parse, their paths and values are copied out here.
+        for (const auto& diagnostic : diagnostics.entries())
+        {
+            if (diagnostic.severity == DiagnosticSeverity::ERROR)
+            {
+                countField(stats.fieldErrors, diagnostics, diagnostic);
+            }
+            else
+            {
+                countField(stats.fieldWarnings, diagnostics.value(diagnostic));
+            }
+        }
+
+        const auto& timing = sample.timing;
+        if (timing.has_value() && timing->sequenceNumber.has_value())
+        {
+            const uint16_t sequence = timing->sequenceNumber.value();
+            const auto step = static_cast<uint16_t>(sequence - source.lastSequence.value_or(sequence - 1));
+            if (step == 0)
+            {
+                ++stats.sequenceRepeats;
+            }
+            else if (step > SEQUENCE_HALF_RANGE && static_cast<uint16_t>(-step) <= REORDER_WINDOW)
+            {
+                ++stats.sequenceReorders;
+            }
+            else if (step > SEQUENCE_HALF_RANGE)
+            {
+                ++stats.sequenceResets;
+                source.lastSequence = sequence;
+            }
+            else
+            {
+                stats.sequenceGaps += step - 1u;
+                source.lastSequence = sequence;
+            }
+        }
+
+        if (timing.has_value() && timing->frameRate.has_value() && source.lastArrival.has_value())
+        {
+            const auto& rate = timing->frameRate.value();
+            if (rate.numerator > 0 && rate.denominator > 0)
+            {
+                const double period = 1e9 * static_cast<double>(rate.denominator) / static_cast<double>(rate.numerator);
+                const auto interval = static_cast<double>((now - source.lastArrival.value()).count());
+                stats.jitter.record(static_cast<uint64_t>(std::abs(interval - period)));
+            }
+        }
+        source.lastArrival = now;
+
+        report(source, now, lock);
+    }
+
+    void Instrumentation::recordSerialise(const OpenTrackIOSample& sample, const PhaseMeasurement& measurement)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        std::unique_lock lock{m_mutex};
+        Source& source = sourceOf(sample);
+        ++source.stats.serialised;
+        source.stats.bytesOut += measurement.bytes;
+        recordPhases(source.stats, measurement);
+
+        report(source, now, lock);
+    }
+
+    void Instrumentation::report(Source& source, std::chrono::steady_clock::time_point now,
+                                 std::unique_lock<std::mutex>& lock)
+    {
+        if (!m_callback || now - source.lastReport < m_period)
+        {
+            return;
+        }
+
+        // Copied so the callback runs unlocked and can pull stats() itself.
+        source.lastReport = now;
+        const SourceStats stats = source.stats;
+        const Callback callback = m_callback;
+        lock.unlock();
+        callback(stats);
+    }
+} // namespace opentrackio
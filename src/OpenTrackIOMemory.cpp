@@ -0,0 +1,49 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "opentrackio-cpp/OpenTrackIOMemory.h"
+
+namespace opentrackio
+{
+    namespace
+    {
+        thread_local std::pmr::memory_resource* t_resource = nullptr;
+        thread_local std::size_t t_allocations = 0;
+    } // namespace
+
+    std::size_t allocationCount() noexcept
+    {
+        return t_allocations;
+    }
+
+    void countAllocation() noexcept
+    {
+        ++t_allocations;
+    }
+
+    std::pmr::memory_resource* currentMemoryResource() noexcept
+    {
+        return t_resource != nullptr ? t_resource : std::pmr::get_default_resource();
+    }
+
+    MemoryResourceScope::MemoryResourceScope(std::pmr::memory_resource* resource) noexcept : m_previous{t_resource}
+    {
+        t_resource = resource;
+    }
+
+    MemoryResourceScope::~MemoryResourceScope()
+    {
+        t_resource = m_previous;
+    }
+} // namespace opentrackio
@@ -0,0 +1,250 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOPacket.h"
+#include <cstring>
+
+namespace opentrackio
+{
+    namespace
+    {
+        constexpr std::size_t CHECKSUM_OFFSET = 14;
+        constexpr uint16_t LAST_SEGMENT_FLAG = 0x8000;
+
+        /**
+         * Fletcher-16 with the modulo deferred, 5802 bytes is the most that can be summed before a 32 bit sum2 could
+         * overflow. */
+        class Fletcher16
+        {
+        public:
+            void update(std::span<const uint8_t> data)
+            {
+                while (!data.empty())
+                {
+                    const auto block = std::min<std::size_t>(data.size(), 5802);
+                    for (std::size_t i = 0; i < block; ++i)
+                    {
+                        m_sum1 += data[i];
+                        m_sum2 += m_sum1;
+                    }
+                    m_sum1 %= 255;
+                    m_sum2 %= 255;
+                    data = data.subspan(block);
+                }
+            }
+
+            uint16_t value() const { return static_cast<uint16_t>((m_sum2 << 8) | m_sum1); };
+
+        private:
+            uint32_t m_sum1 = 0;
+            uint32_t m_sum2 = 0;
+        };
+
+        uint16_t checksum(std::span<const uint8_t> header, std::span<const uint8_t> segment)
+        {
+            Fletcher16 fletcher{};
+            fletcher.update(header.first(CHECKSUM_OFFSET));
+            fletcher.update(segment);
+            return fletcher.value();
+        }
+
+        uint16_t readU16(const uint8_t* data)
+        {
+            return static_cast<uint16_t>((data[0] << 8) | data[1]);
+        }
+
+        uint32_t readU32(const uint8_t* data)
+        {
+            return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+                   (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+        }
+
+        void writeU16(uint8_t* data, uint16_t value)
+        {
+            data[0] = static_cast<uint8_t>(value >> 8);
+            data[1] = static_cast<uint8_t>(value);
+        }
+
+        void writeU32(uint8_t* data, uint32_t value)
+        {
+            data[0] = static_cast<uint8_t>(value >> 24);
+            data[1] = static_cast<uint8_t>(value >> 16);
+            data[2] = static_cast<uint8_t>(value >> 8);
+            data[3] = static_cast<uint8_t>(value);
+        }
+    } // namespace
+
+    void PacketHeader::write(std::span<const uint8_t> segment, std::span<uint8_t, SIZE> out)
+    {
+        payloadLength = static_cast<uint16_t>(std::min(segment.size(), MAX_SEGMENT_SIZE));
+
+        std::copy(IDENTIFIER.begin(), IDENTIFIER.end(), out.begin());
+        out[4] = 0;
+        out[5] = static_cast<uint8_t>(encoding);
+        writeU16(&out[6], sequenceNumber);
+        writeU32(&out[8], segmentOffset);
+        writeU16(&out[12], static_cast<uint16_t>((lastSegment ? LAST_SEGMENT_FLAG : 0) | payloadLength));
+
+        checksum = opentrackio::checksum(out, segment.first(payloadLength));
+        writeU16(&out[CHECKSUM_OFFSET], checksum);
+    }
+
+    PacketStatus Packet::parse(std::span<const uint8_t> datagram, Packet& out)
+    {
+        if (datagram.size() < PacketHeader::SIZE)
+        {
+            return PacketStatus::TOO_SHORT;
+        }
+
+        if (!std::equal(PacketHeader::IDENTIFIER.begin(), PacketHeader::IDENTIFIER.end(), datagram.begin()))
+        {
+            return PacketStatus::INVALID_IDENTIFIER;
+        }
+
+        const auto encoding = static_cast<PacketEncoding>(datagram[5]);
+        if (encoding != PacketEncoding::JSON && encoding != PacketEncoding::CBOR)
+        {
+            return PacketStatus::UNSUPPORTED_ENCODING;
+        }
+
+        const auto lengthField = readU16(&datagram[12]);
+        const std::size_t payloadLength = lengthField & ~LAST_SEGMENT_FLAG;
+        if (datagram.size() - PacketHeader::SIZE < payloadLength)
+        {
+            return PacketStatus::INVALID_LENGTH;
+        }
+
+        const auto payload = datagram.subspan(PacketHeader::SIZE, payloadLength);
+        const auto received = readU16(&datagram[CHECKSUM_OFFSET]);
+        if (checksum(datagram, payload) != received)
+        {
+            return PacketStatus::CHECKSUM_MISMATCH;
+        }
+
+        out.header.encoding = encoding;
+        out.header.sequenceNumber = readU16(&datagram[6]);
+        out.header.segmentOffset = readU32(&datagram[8]);
+        out.header.lastSegment = (lengthField & LAST_SEGMENT_FLAG) != 0;
+        out.header.payloadLength = static_cast<uint16_t>(payloadLength);
+        out.header.checksum = received;
+        out.payload = payload;
+        return PacketStatus::OK;
+    }
+
+    PacketStatus PacketAssembler::add(const Packet& packet, PacketPayload& out)
+    {
+        const auto& header = packet.header;
+
+        // Unsegmented payloads don't need to touch the buffer at all.
+        if (header.segmentOffset == 0 && header.lastSegment)
+        {
+            if (m_active && header.sequenceNumber != m_sequenceNumber)
+            {
+                abandon();
+            }
+            out = PacketPayload{header.encoding, header.sequenceNumber, packet.payload};
+            return PacketStatus::OK;
+        }
+
+        if (!m_active || header.sequenceNumber != m_sequenceNumber)
+        {
+            if (m_active)
+            {
+                abandon();
+            }
+            begin(header);
+        }
+        else if (header.encoding != m_encoding)
+        {
+            abandon();
+            return PacketStatus::INCONSISTENT_SEGMENT;
+        }
+
+        const std::size_t offset = header.segmentOffset;
+        const std::size_t length = packet.payload.size();
+        if (offset > m_buffer.size() || length > m_buffer.size() - offset)
+        {
+            abandon();
+            return PacketStatus::BUFFER_TOO_SMALL;
+        }
+
+        const auto end = offset + length;
+        if ((m_lastSeen && end > m_total) || (header.lastSegment && m_received > 0 && end < m_total) ||
+            (header.lastSegment && m_lastSeen && end != m_total))
+        {
+            abandon();
+            return PacketStatus::INCONSISTENT_SEGMENT;
+        }
+
+        for (std::size_t i = 0; i < m_segmentCount; ++i)
+        {
+            const auto& segment = m_segments[i];
+            if (offset < segment.offset + segment.length && segment.offset < end)
+            {
+                if (segment.offset == offset && segment.length == length)
+                {
+                    return PacketStatus::DUPLICATE_SEGMENT;
+                }
+                abandon();
+                return PacketStatus::INCONSISTENT_SEGMENT;
+            }
+        }
+
+        if (m_segmentCount == MAX_SEGMENTS)
+        {
+            abandon();
+            return PacketStatus::TOO_MANY_SEGMENTS;
+        }
+
+        m_segments[m_segmentCount++] = Segment{static_cast<uint32_t>(offset), static_cast<uint32_t>(length)};
+        std::memcpy(m_buffer.data() + offset, packet.payload.data(), length);
+        m_received += length;
+        m_total = std::max(m_total, end);
+        if (header.lastSegment)
+        {
+            m_lastSeen = true;
+        }
+
+        if (!m_lastSeen || m_received != m_total)
+        {
+            return PacketStatus::INCOMPLETE;
+        }
+
+        out = PacketPayload{m_encoding, m_sequenceNumber, m_buffer.first(m_total)};
+        clear();
+        return PacketStatus::OK;
+    }
+
+    void PacketAssembler::clear()
+    {
+        m_segmentCount = 0;
+        m_received = 0;
+        m_total = 0;
+        m_active = false;
+        m_lastSeen = false;
+    }
+
+    void PacketAssembler::begin(const PacketHeader& header)
+    {
+        clear();
+        m_active = true;
+        m_encoding = header.encoding;
+        m_sequenceNumber = header.sequenceNumber;
+    }
+
+    void PacketAssembler::abandon()
+    {
+        ++m_abandoned;
+        clear();
+    }
+} // namespace opentrackio
@@ -12,133 +12,112 @@
  */
 
 #include "opentrackio-cpp/OpenTrackIOProperties.h"
-#include <regex>
 #include "opentrackio-cpp/OpenTrackIOHelper.h"
+#include "opentrackio-cpp/OpenTrackIOTape.h"
+#include "opentrackio-cpp/OpenTrackIOValidators.h"
 
 namespace opentrackio::opentrackioproperties
 {
-    std::optional<Camera> Camera::parse(nlohmann::json &json, std::vector<std::string>& errors)
+    template<JsonNode Json>
+    void Camera::parse(const Json &json, ParseContext &ctx, std::optional<Camera> &out)
     {
-        if (!json.contains("static") || !json["static"].contains("camera"))
+        if (!ctx.parseStatic || !json.contains("static") || !json["static"].contains("camera"))
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
+        DiagnosticScope staticScope{ctx.diagnostics, "static"};
         if (!json["static"]["camera"].is_object())
         {
-            errors.emplace_back("field: camera isn't of type: object");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", "camera", "object");
+            out = std::nullopt;
+            return;
         }
         
-        Camera cam{};
-        auto& cameraJson = json["static"]["camera"];
-        
-        if (cameraJson.contains("activeSensorPhysicalDimensions"))
-        {
-            cam.activeSensorPhysicalDimensions = opentrackiotypes::Dimensions<double>::parse(
-                    cameraJson, "activeSensorPhysicalDimensions", errors);
-            cameraJson.erase("activeSensorPhysicalDimensions");
-        }
-
-        if (cameraJson.contains("activeSensorResolution"))
-        {
-            cam.activeSensorResolution = opentrackiotypes::Dimensions<uint32_t>::parse(cameraJson,
-                   "activeSensorResolution", errors);
-            cameraJson.erase("activeSensorResolution");
-        }
-
-        if (cameraJson.contains("anamorphicSqueeze"))
-        {
-            cam.anamorphicSqueeze = opentrackiotypes::Rational::parse(cameraJson, "anamorphicSqueeze", errors);
-            cameraJson.erase("anamorphicSqueeze");
-        }
-        
-        OpenTrackIOHelpers::assignField(cameraJson, "firmwareVersion", cam.firmwareVersion, "string", errors);
-        OpenTrackIOHelpers::assignField(cameraJson, "label", cam.label, "string", errors);
-        OpenTrackIOHelpers::assignField(cameraJson, "make", cam.make, "string", errors);
-        OpenTrackIOHelpers::assignField(cameraJson, "model", cam.model, "string", errors);
-        OpenTrackIOHelpers::assignField(cameraJson, "serialNumber", cam.serialNumber, "string", errors);
-
-        if (cameraJson.contains("captureFrameRate"))
-        {
-            cam.captureFrameRate = opentrackiotypes::Rational::parse(cameraJson, "captureFrameRate", errors);
-            cameraJson.erase("captureFrameRate");
-        }
-        
-        const std::regex pattern{R"(^urn:uuid:[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}$)"};
-        OpenTrackIOHelpers::assignRegexField(cameraJson, "fdlLink", cam.fdlLink, pattern, errors);
-        
-        OpenTrackIOHelpers::assignField(cameraJson, "isoSpeed", cam.isoSpeed, "integer", errors);
-        OpenTrackIOHelpers::assignField(cameraJson, "shutterAngle", cam.shutterAngle, "double", errors);
+        DiagnosticScope cameraScope{ctx.diagnostics, "camera"};
+        auto& cam = out.has_value() ? out.value() : out.emplace();
+        schema::parseFields<schema::Scope::STATIC>(json["static"]["camera"], ctx, cam);
         
         if (cam.shutterAngle.has_value() && cam.shutterAngle.value() > 360)
         {
-            errors.emplace_back("field: shutterAngle is outside the expected range 1 - 360.");
+            ctx.diagnostics.error(DiagnosticCode::OUT_OF_RANGE, "field: {} is outside the expected range 1 - 360.", "shutterAngle");
             cam.shutterAngle = std::nullopt;            
         }
 
         
-        OpenTrackIOHelpers::clearFieldIfEmpty(json["static"], "camera");
-        return cam;
+        OpenTrackIOHelpers::consumeFieldIfEmpty(json["static"], "camera", ctx);
     }
 
-    std::optional<Duration> Duration::parse(nlohmann::json &json, std::vector<std::string>& errors)
+    template<JsonNode Json>
+    void Duration::parse(const Json &json, ParseContext &ctx, std::optional<Duration> &out)
     {
-        if (!json.contains("static") || !json["static"].contains("duration"))
+        if (!ctx.parseStatic || !json.contains("static") || !json["static"].contains("duration"))
         {
-            return std::nullopt;    
+            out = std::nullopt;
+            return;
         }
 
+        DiagnosticScope staticScope{ctx.diagnostics, "static"};
         if (!json["static"]["duration"].is_object())
         {
-            errors.emplace_back("field: duration isn't of type: object");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", "duration", "object");
+            out = std::nullopt;
+            return;
         }
         
-        auto& durationJson = json["static"]["duration"];
+        const auto& durationJson = json["static"]["duration"];
         std::optional<uint32_t> numerator = std::nullopt;
         std::optional<uint32_t> denominator = std::nullopt;
         
-        OpenTrackIOHelpers::assignField(durationJson, "num", numerator, "uint32", errors);
-        OpenTrackIOHelpers::assignField(durationJson, "denom", denominator, "uint32", errors);
+        {
+            DiagnosticScope durationScope{ctx.diagnostics, "duration"};
+            OpenTrackIOHelpers::assignField(durationJson, "num", numerator, "uint32", ctx);
+            OpenTrackIOHelpers::assignField(durationJson, "denom", denominator, "uint32", ctx);
+        }
         
         if (!numerator.has_value() || !denominator.has_value())
         {
-            errors.emplace_back("field: duration is missing required fields");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "field: {} is missing required fields", "duration");
+            out = std::nullopt;
+            return;
         }
 
-        OpenTrackIOHelpers::clearFieldIfEmpty(json["static"], "duration");
-        return Duration{{numerator.value(), denominator.value()}};
+        OpenTrackIOHelpers::consumeFieldIfEmpty(json["static"], "duration", ctx);
+        out = Duration{{numerator.value(), denominator.value()}};
     }
 
-    std::optional<GlobalStage> GlobalStage::parse(nlohmann::json &json, std::vector<std::string>& errors)
+    template<JsonNode Json>
+    void GlobalStage::parse(const Json &json, ParseContext &ctx, std::optional<GlobalStage> &out)
     {
         if (!json.contains("globalStage"))
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
         if (!json["globalStage"].is_object())
         {
-            errors.emplace_back("field: globalStage isn't of type: object");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", "globalStage", "object");
+            out = std::nullopt;
+            return;
         }
 
         GlobalStage gs{};
         const auto& gsJson = json["globalStage"];
+        DiagnosticScope globalStageScope{ctx.diagnostics, "globalStage"};
         
         const auto fieldCheckAndAssign = [&](std::string_view fieldStr, double& field) 
         {
             if (!gsJson.contains(fieldStr))
             {
-                errors.emplace_back(std::format("field: globalStage is missing require field: {}", fieldStr));
+                ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "field: {} is missing", fieldStr);
                 return false;
             }
             
             if (!OpenTrackIOHelpers::checkTypeAndSetField(gsJson[fieldStr], field))
             {
-                errors.emplace_back(std::format("field: globalStage/{} isn't a number", fieldStr));
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't a {}", fieldStr, "number");
                 return false;
             }
             return true;
@@ -151,504 +130,617 @@ namespace opentrackio::opentrackioproperties
         
         if (!fieldsSet)
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
-        json.erase("globalStage");
-        return gs;
+        ctx.consumed.consume(json["globalStage"]);
+        out = gs;
     }
 
-    std::optional<Lens> Lens::parse(nlohmann::json &json, std::vector<std::string>& errors)
+    template<JsonNode Json>
+    void Lens::parse(const Json &json, ParseContext &ctx, std::optional<Lens> &out)
     {
-        if (!json.contains("lens") && (!json.contains("static") || !json["static"].contains("lens")))
+        const bool hasStatic = ctx.parseStatic && json.contains("static") && json["static"].contains("lens");
+        const bool hasDynamic = ctx.parseDynamic && json.contains("lens");
+        if (!hasStatic && !hasDynamic)
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
-        Lens lens{};
+        auto& lens = out.has_value() ? out.value() : out.emplace();
         
         // ------- Static Fields
-        if (json.contains("static") && json["static"].contains("lens"))
+        if (hasStatic)
         {
-            auto& lensJson = json["static"]["lens"];
-            OpenTrackIOHelpers::assignField(lensJson, "firmwareVersion", lens.firmwareVersion, "string", errors);
-            OpenTrackIOHelpers::assignField(lensJson, "make", lens.make, "string", errors);
-            OpenTrackIOHelpers::assignField(lensJson, "model", lens.model, "string", errors);
-            OpenTrackIOHelpers::assignField(lensJson, "nominalFocalLength", lens.nominalFocalLength, "double", errors);
-            OpenTrackIOHelpers::assignField(lensJson, "serialNumber", lens.serialNumber, "string", errors);
-            OpenTrackIOHelpers::assignField(lensJson, "distortionOverscanMax", lens.distortionOverscanMax, "double", errors);
+            {
+                DiagnosticScope staticScope{ctx.diagnostics, "static"};
+                DiagnosticScope lensScope{ctx.diagnostics, "lens"};
+                schema::parseFields<schema::Scope::STATIC>(json["static"]["lens"], ctx, lens);
+            }
 
-            OpenTrackIOHelpers::clearFieldIfEmpty(json["static"], "lens");
+            OpenTrackIOHelpers::consumeFieldIfEmpty(json["static"], "lens", ctx);
+        }
+        else
+        {
+            schema::resetFields<schema::Scope::STATIC>(lens);
         }
         
         // ------- Standard Fields
-        if (json.contains("lens"))
+        if (!hasDynamic)
+        {
+            lens.custom = std::nullopt;
+            lens.distortion = std::nullopt;
+            lens.distortionOverscan = std::nullopt;
+            lens.distortionShift = std::nullopt;
+            lens.encoders = std::nullopt;
+            lens.entrancePupilOffset = std::nullopt;
+            lens.exposureFalloff = std::nullopt;
+            lens.fStop = std::nullopt;
+            lens.focalLength = std::nullopt;
+            lens.focusDistance = std::nullopt;
+            lens.perspectiveShift = std::nullopt;
+            lens.rawEncoders = std::nullopt;
+            lens.tStop = std::nullopt;
+            lens.undistortion = std::nullopt;
+            return;
+        }
+        
+        const auto& lensJson = json["lens"];
+        DiagnosticScope lensScope{ctx.diagnostics, "lens"};
+        if (lensJson.contains("custom") && lensJson["custom"].is_array())
         {
-            auto& lensJson = json["lens"];
-            if (lensJson.contains("custom") && lensJson["custom"].is_array())
+            if (!OpenTrackIOHelpers::iterateJsonArrayAndPopulateVector(lensJson["custom"], lens.custom))
             {
-                if (!OpenTrackIOHelpers::iterateJsonArrayAndPopulateVector(lensJson["custom"], lens.custom))
-                {
-                    errors.emplace_back("field: lens/custom value isn't of type: double");
-                    lens.custom = std::nullopt;
-                }
-                lensJson.erase("custom");
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} value isn't of type: {}", "custom", "double");
+                lens.custom = std::nullopt;
             }
+            ctx.consumed.consume(lensJson["custom"]);
+        }
+        else
+        {
+            lens.custom = std::nullopt;
+        }
 
-            if (lensJson.contains("distortion"))
-            {
-                std::optional<std::vector<double>> radial = std::nullopt;
-                std::optional<std::vector<double>> tangential = std::nullopt;
-
-                OpenTrackIOHelpers::assignField(lensJson["distortion"], "radial", radial, "double", errors);
-                OpenTrackIOHelpers::assignField(lensJson["distortion"], "tangential", tangential, "double", errors);
-
-                if (radial.has_value())
-                {
-                    lens.distortion = Distortion();
-                    lens.distortion->radial = std::move(radial.value());
-                    lens.distortion->tangential = std::move(tangential);
-                }
-                lensJson.erase("distortion");
-            }
+        if (lensJson.contains("distortion"))
+        {
+            DiagnosticScope distortionScope{ctx.diagnostics, "distortion"};
+            parseCoefficients(lensJson["distortion"], ctx, lens.distortion);
+            ctx.consumed.consume(lensJson["distortion"]);
+        }
+        else
+        {
+            lens.distortion = std::nullopt;
+        }
 
-            OpenTrackIOHelpers::assignField(lensJson, "distortionOverscan", lens.distortionOverscan, "double", errors);
+        OpenTrackIOHelpers::assignField(lensJson, "distortionOverscan", lens.distortionOverscan, "double", ctx);
 
-            if (lensJson.contains("distortionShift"))
-            {
-                std::optional<double> x = std::nullopt;
-                std::optional<double> y = std::nullopt;
+        lens.distortionShift = std::nullopt;
+        if (lensJson.contains("distortionShift"))
+        {
+            DiagnosticScope scope{ctx.diagnostics, "distortionShift"};
+            std::optional<double> x = std::nullopt;
+            std::optional<double> y = std::nullopt;
 
-                OpenTrackIOHelpers::assignField(lensJson["distortionShift"], "x", x, "double", errors);
-                OpenTrackIOHelpers::assignField(lensJson["distortionShift"], "y", y, "double", errors);
+            OpenTrackIOHelpers::assignField(lensJson["distortionShift"], "x", x, "double", ctx);
+            OpenTrackIOHelpers::assignField(lensJson["distortionShift"], "y", y, "double", ctx);
 
-                if (x.has_value() && y.has_value())
-                {
-                    lens.distortionShift = DistortionShift{x.value(), y.value()};
-                }
-                lensJson.erase("distortionShift");
+            if (x.has_value() && y.has_value())
+            {
+                lens.distortionShift = DistortionShift{x.value(), y.value()};
             }
+            ctx.consumed.consume(lensJson["distortionShift"]);
+        }
 
-            OpenTrackIOHelpers::assignField(lensJson, "encoders", lens.encoders, "double", errors);
-            OpenTrackIOHelpers::assignField(lensJson, "entrancePupilOffset", lens.entrancePupilOffset, "double", errors);
+        OpenTrackIOHelpers::assignField(lensJson, "encoders", lens.encoders, "double", ctx);
+        OpenTrackIOHelpers::assignField(lensJson, "entrancePupilOffset", lens.entrancePupilOffset, "double", ctx);
 
-            if (lensJson.contains("exposureFalloff"))
-            {
-                std::optional<double> a1 = std::nullopt;
-                std::optional<double> a2 = std::nullopt;
-                std::optional<double> a3 = std::nullopt;
-
-                OpenTrackIOHelpers::assignField(lensJson["exposureFalloff"], "a1", a1, "double", errors);
-                OpenTrackIOHelpers::assignField(lensJson["exposureFalloff"], "a2", a2, "double", errors);
-                OpenTrackIOHelpers::assignField(lensJson["exposureFalloff"], "a3", a3, "double", errors);
-
-                if (a1.has_value())
-                {
-                    lens.exposureFalloff = ExposureFalloff{a1.value(), a2, a3};
-                }
-                lensJson.erase("exposureFalloff");
-            }
+        lens.exposureFalloff = std::nullopt;
+        if (lensJson.contains("exposureFalloff"))
+        {
+            DiagnosticScope scope{ctx.diagnostics, "exposureFalloff"};
+            std::optional<double> a1 = std::nullopt;
+            std::optional<double> a2 = std::nullopt;
+            std::optional<double> a3 = std::nullopt;
 
-            OpenTrackIOHelpers::assignField(lensJson, "fStop", lens.fStop, "double", errors);
-            OpenTrackIOHelpers::assignField(lensJson, "focalLength", lens.focalLength, "double", errors);
-            OpenTrackIOHelpers::assignField(lensJson, "focusDistance", lens.focusDistance, "double", errors);
+            OpenTrackIOHelpers::assignField(lensJson["exposureFalloff"], "a1", a1, "double", ctx);
+            OpenTrackIOHelpers::assignField(lensJson["exposureFalloff"], "a2", a2, "double", ctx);
+            OpenTrackIOHelpers::assignField(lensJson["exposureFalloff"], "a3", a3, "double", ctx);
 
-            if (lensJson.contains("perspectiveShift"))
+            if (a1.has_value())
             {
-                std::optional<double> x = std::nullopt;
-                std::optional<double> y = std::nullopt;
+                lens.exposureFalloff = ExposureFalloff{a1.value(), a2, a3};
+            }
+            ctx.consumed.consume(lensJson["exposureFalloff"]);
+        }
 
-                OpenTrackIOHelpers::assignField(lensJson["perspectiveShift"], "x", x, "double", errors);
-                OpenTrackIOHelpers::assignField(lensJson["perspectiveShift"], "y", y, "double", errors);
+        OpenTrackIOHelpers::assignField(lensJson, "fStop", lens.fStop, "double", ctx);
+        OpenTrackIOHelpers::assignField(lensJson, "focalLength", lens.focalLength, "double", ctx);
+        OpenTrackIOHelpers::assignField(lensJson, "focusDistance", lens.focusDistance, "double", ctx);
 
-                if (x.has_value() && y.has_value())
-                {
-                    lens.perspectiveShift = PerspectiveShift{x.value(), y.value()};
-                }
-                lensJson.erase("perspectiveShift");
-            }
+        lens.perspectiveShift = std::nullopt;
+        if (lensJson.contains("perspectiveShift"))
+        {
+            DiagnosticScope scope{ctx.diagnostics, "perspectiveShift"};
+            std::optional<double> x = std::nullopt;
+            std::optional<double> y = std::nullopt;
 
-            OpenTrackIOHelpers::assignField(lensJson, "rawEncoders", lens.rawEncoders, "double", errors);
-            OpenTrackIOHelpers::assignField(lensJson, "tStop", lens.tStop, "double", errors);
+            OpenTrackIOHelpers::assignField(lensJson["perspectiveShift"], "x", x, "double", ctx);
+            OpenTrackIOHelpers::assignField(lensJson["perspectiveShift"], "y", y, "double", ctx);
 
-            if (lensJson.contains("undistortion"))
+            if (x.has_value() && y.has_value())
             {
-                std::optional<std::vector<double>> radial = std::nullopt;
-                std::optional<std::vector<double>> tangential = std::nullopt;
-
-                OpenTrackIOHelpers::assignField(lensJson["undistortion"], "radial", radial, "double", errors);
-                OpenTrackIOHelpers::assignField(lensJson["undistortion"], "tangential", tangential, "double", errors);
-
-                if (radial.has_value())
-                {
-                    lens.undistortion = Undistortion();
-                    lens.undistortion->radial = std::move(radial.value());
-                    lens.undistortion->tangential = std::move(tangential);
-                }
-                lensJson.erase("undistortion");
+                lens.perspectiveShift = PerspectiveShift{x.value(), y.value()};
             }
+            ctx.consumed.consume(lensJson["perspectiveShift"]);
+        }
+
+        OpenTrackIOHelpers::assignField(lensJson, "rawEncoders", lens.rawEncoders, "uint16", ctx);
+        OpenTrackIOHelpers::assignField(lensJson, "tStop", lens.tStop, "double", ctx);
 
-            OpenTrackIOHelpers::clearFieldIfEmpty(json, "lens");
+        if (lensJson.contains("undistortion"))
+        {
+            DiagnosticScope undistortionScope{ctx.diagnostics, "undistortion"};
+            parseCoefficients(lensJson["undistortion"], ctx, lens.undistortion);
+            ctx.consumed.consume(lensJson["undistortion"]);
         }
-        
-        return lens;
+        else
+        {
+            lens.undistortion = std::nullopt;
+        }
+
+        OpenTrackIOHelpers::consumeFieldIfEmpty(json, "lens", ctx);
     }
 
-    std::optional<Protocol> Protocol::parse(nlohmann::json &json, std::vector<std::string>& errors)
+    template<JsonNode Json, typename Coefficients>
+    void Lens::parseCoefficients(const Json &json, ParseContext &ctx, std::optional<Coefficients> &out)
+    {
+        // Parsed straight into the previous coefficients, if there were any, so the vectors are refilled in place.
+        auto& coefficients = out.has_value() ? out.value() : out.emplace();
+        std::optional<Vector<double>> radial{std::move(coefficients.radial)};
+
+        OpenTrackIOHelpers::assignField(json, "radial", radial, "double", ctx);
+        OpenTrackIOHelpers::assignField(json, "tangential", coefficients.tangential, "double", ctx);
+
+        if (!radial.has_value())
+        {
+            out = std::nullopt;
+            return;
+        }
+        coefficients.radial = std::move(radial.value());
+    }
+
+    template<JsonNode Json>
+    void Protocol::parse(const Json &json, ParseContext &ctx, std::optional<Protocol> &out)
     {
         if (!json.contains("protocol"))
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
         
-        Protocol pro{};
-        auto& proJson = json["protocol"];
-        if (!OpenTrackIOHelpers::checkTypeAndSetField(proJson["name"], pro.name))
+        auto& pro = out.has_value() ? out.value() : out.emplace();
+        const auto& proJson = json["protocol"];
+        if (!proJson.contains("name") || !OpenTrackIOHelpers::checkTypeAndSetField(proJson["name"], pro.name))
         {
-            errors.emplace_back("field: protocol isn't of type: string");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", "protocol", "string");
+            out = std::nullopt;
+            return;
         }
 
 
-        std::optional<std::string> versionStr;
-        const std::regex pattern{R"(^[0-9]+.[0-9]+.[0-9]+$)"};
-        OpenTrackIOHelpers::assignRegexField(proJson, "version", versionStr, pattern, errors);
+        std::optional<String> versionStr{std::move(pro.version)};
+        {
+            DiagnosticScope protocolScope{ctx.diagnostics, "protocol"};
+            OpenTrackIOHelpers::assignRegexField(proJson, "version", versionStr, opentrackiovalidators::version, ctx);
+        }
         
         if (!versionStr.has_value())
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
         pro.version = std::move(versionStr.value());
 
-        json.erase("protocol");
-        return pro;
+        ctx.consumed.consume(json["protocol"]);
     }
 
-    std::optional<RelatedSampleIds> RelatedSampleIds::parse(nlohmann::json &json, std::vector<std::string>& errors)
+    template<JsonNode Json>
+    void RelatedSampleIds::parse(const Json &json, ParseContext &ctx, std::optional<RelatedSampleIds> &out)
     {
         if (!json.contains("relatedSampleIds"))
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
         if (!json["relatedSampleIds"].is_array())
         {
-            errors.emplace_back("field: relatedSampleIds isn't of type: array");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", "relatedSampleIds", "array");
+            out = std::nullopt;
+            return;
         }
 
-        RelatedSampleIds rs{};
+        auto& rs = out.has_value() ? out.value() : out.emplace();
         const auto& rsJson = json["relatedSampleIds"];
-        const std::regex pattern{R"(^urn:uuid:[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}$)"};
+        DiagnosticScope relatedSampleIdsScope{ctx.diagnostics, "relatedSampleIds"};
         
-        for (const auto& item : rsJson.items()) 
+        rs.samples.clear();
+        for (const auto& item : rsJson) 
         {
-            std::string str;
-            if (!OpenTrackIOHelpers::checkTypeAndSetField(item.value(), str)) 
+            const auto str = getString(item);
+            if (!str.has_value())
             {
-                errors.emplace_back("field: relatedSampleIds/element isn't of type: string");
+                ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", "element", "string");
                 continue;
             }
 
             // Check the string received to ensure that it matches the pattern described by the spec.
-            if (std::smatch res; !std::regex_match(str, res, pattern))
+            const auto uuid = opentrackiotypes::UrnUuid::parse(str.value());
+            if (!uuid.has_value())
             {
-                errors.emplace_back("field: relatedSampleIds/element doesn't match required pattern");
+                ctx.diagnostics.error(DiagnosticCode::PATTERN_MISMATCH, "field: {} doesn't match required pattern", "element");
                 continue;
             }
             
-            rs.samples.emplace_back(std::move(str));
+            rs.samples.push_back(uuid.value());
         }
 
-        json.erase("relatedSampleIds");
-        return rs;
+        ctx.consumed.consume(json["relatedSampleIds"]);
     }
 
-    std::optional<SampleId> SampleId::parse(nlohmann::json &json, std::vector<std::string>& errors)
+    template<JsonNode Json>
+    void SampleId::parse(const Json &json, ParseContext &ctx, std::optional<SampleId> &out)
     {
         if (!json.contains("sampleId"))
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
-        std::optional<std::string> str;
-        const std::regex pattern{R"(^urn:uuid:[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}$)"};
-        OpenTrackIOHelpers::assignRegexField(json, "sampleId", str, pattern, errors);
-        
-        if (!str.has_value())
+        std::optional<opentrackiotypes::UrnUuid> uuid = std::nullopt;
+        OpenTrackIOHelpers::assignUuidField(json, "sampleId", uuid, ctx);
+
+        if (!uuid.has_value())
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
-        json.erase("sampleId");
-        return SampleId{std::move(str.value())};
+        out = SampleId{uuid.value()};
     }
   
-    std::optional<SourceId> SourceId::parse(nlohmann::json &json, std::vector<std::string> &errors)
+    template<JsonNode Json>
+    void SourceId::parse(const Json &json, ParseContext &ctx, std::optional<SourceId> &out)
     {
         if (!json.contains("sourceId"))
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
-        std::optional<std::string> str;
-        const std::regex pattern{R"(^urn:uuid:[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}$)"};
-        OpenTrackIOHelpers::assignRegexField(json, "sourceId", str, pattern, errors);
+        std::optional<opentrackiotypes::UrnUuid> uuid = std::nullopt;
+        OpenTrackIOHelpers::assignUuidField(json, "sourceId", uuid, ctx);
 
-        if (!str.has_value())
+        if (!uuid.has_value())
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
-        json.erase("sourceId");
-        return SourceId{std::move(str.value())};
+        out = SourceId{uuid.value()};
     }
 
-    std::optional<SourceNumber> SourceNumber::parse(nlohmann::json &json, std::vector<std::string> &errors)
+    template<JsonNode Json>
+    void SourceNumber::parse(const Json &json, ParseContext &ctx, std::optional<SourceNumber> &out)
     {
         if (!json.contains("sourceNumber"))
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
         std::optional<uint32_t> val;
-        OpenTrackIOHelpers::assignField(json, "sourceNumber", val, "integer", errors);
+        OpenTrackIOHelpers::assignField(json, "sourceNumber", val, "integer", ctx);
 
         if (!val.has_value())
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
-        json.erase("sourceNumber");
-        return SourceNumber{val.value()};
+        out = SourceNumber{val.value()};
     }
 
-    std::optional<Timing> Timing::parse(nlohmann::json &json, std::vector<std::string>& errors)
+    template<JsonNode Json>
+    void Timing::parse(const Json &json, ParseContext &ctx, std::optional<Timing> &out)
     {
         if (!json.contains("timing"))
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
         if (!json["timing"].is_object())
         {
-            errors.emplace_back("field: timing isn't of type: object");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", "timing", "object");
+            out = std::nullopt;
+            return;
         }
 
-        Timing timing{};
-        auto& timingJson = json["timing"];
+        auto& timing = out.has_value() ? out.value() : out.emplace();
+        const auto& timingJson = json["timing"];
+        DiagnosticScope timingScope{ctx.diagnostics, "timing"};
 
+        timing.frameRate = std::nullopt;
         if (timingJson.contains("frameRate"))
         {
-            timing.frameRate = opentrackiotypes::Rational::parse(timingJson, "frameRate", errors);
-            timingJson.erase("frameRate");
+            timing.frameRate = opentrackiotypes::Rational::parse(timingJson, "frameRate", ctx);
+            ctx.consumed.consume(timingJson["frameRate"]);
         }
         
         std::optional<std::string> str;
-        OpenTrackIOHelpers::assignField(timingJson, "mode", str, "string", errors);
+        OpenTrackIOHelpers::assignField(timingJson, "mode", str, "string", ctx);
         if (str.has_value() && (str == "external" || "internal"))
         {
             timing.mode = str == "external" ? Mode::EXTERNAL : Mode::INTERNAL;
-            timingJson.erase("mode");
+            ctx.consumed.consume(timingJson["mode"]);
         }
         else
         {
-            errors.emplace_back("field: timing/mode has an invalid string value.");
+            ctx.diagnostics.error(DiagnosticCode::INVALID_VALUE, "field: {} has an invalid string value.", "mode");
             timing.mode = std::nullopt;
         }
         
+        timing.recordedTimestamp = std::nullopt;
         if (timingJson.contains("recordedTimestamp"))
         {
-            timing.recordedTimestamp = opentrackiotypes::Timestamp::parse(timingJson, "recordedTimestamp", errors);
-            timingJson.erase("recordedTimestamp");
+            timing.recordedTimestamp = opentrackiotypes::Timestamp::parse(timingJson, "recordedTimestamp", ctx);
+            ctx.consumed.consume(timingJson["recordedTimestamp"]);
         }
 
+        timing.sampleTimestamp = std::nullopt;
         if (timingJson.contains("sampleTimestamp"))
         {
-            timing.sampleTimestamp = opentrackiotypes::Timestamp::parse(timingJson, "sampleTimestamp", errors);
-            timingJson.erase("sampleTimestamp");
+            timing.sampleTimestamp = opentrackiotypes::Timestamp::parse(timingJson, "sampleTimestamp", ctx);
+            ctx.consumed.consume(timingJson["sampleTimestamp"]);
         }
 
-        OpenTrackIOHelpers::assignField(timingJson, "sequenceNumber", timing.sequenceNumber, "uint16", errors);
+        OpenTrackIOHelpers::assignField(timingJson, "sequenceNumber", timing.sequenceNumber, "uint16", ctx);
         
         if (timingJson.contains("synchronization"))
         {
-            timing.synchronization = parseSynchronization(timingJson["synchronization"], errors);
-            OpenTrackIOHelpers::clearFieldIfEmpty(timingJson, "synchronization");
+            parseSynchronization(timingJson["synchronization"], ctx, timing.synchronization);
+            OpenTrackIOHelpers::consumeFieldIfEmpty(timingJson, "synchronization", ctx);
+        }
+        else
+        {
+            timing.synchronization = std::nullopt;
         }
         
+        timing.timecode = std::nullopt;
         if (timingJson.contains("timecode"))
         {
-            timing.timecode = opentrackiotypes::Timecode::parse(timingJson, "timecode", errors);
-            timingJson.erase("timecode");
+            timing.timecode = opentrackiotypes::Timecode::parse(timingJson, "timecode", ctx);
+            ctx.consumed.consume(timingJson["timecode"]);
         }
 
-        OpenTrackIOHelpers::clearFieldIfEmpty(json, "timing");
-        return timing;
+        OpenTrackIOHelpers::consumeFieldIfEmpty(json, "timing", ctx);
     }
 
-    std::optional<Timing::Synchronization>
-    Timing::parseSynchronization(nlohmann::json &json, std::vector<std::string> &errors)
+    template<JsonNode Json>
+    void Timing::parseSynchronization(const Json &json, ParseContext &ctx, std::optional<Synchronization> &out)
     {
-        Timing::Synchronization outSync{};
-
         // Required Fields -------
         bool hasRequired = json.contains("frequency") && json.contains("locked") && json.contains("source");
         if (!hasRequired)
         {
-            errors.emplace_back("field: timing/synchronization is missing required fields");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "field: {} is missing required fields", "synchronization");
+            out = std::nullopt;
+            return;
         }
+        DiagnosticScope synchronizationScope{ctx.diagnostics, "synchronization"};
         
-        std::optional<opentrackiotypes::Rational> freq = opentrackiotypes::Rational::parse(json, "frequency", errors);
+        std::optional<opentrackiotypes::Rational> freq = opentrackiotypes::Rational::parse(json, "frequency", ctx);
         if (!freq.has_value())
         {
-            errors.emplace_back("field: timing/synchronization/frequency is missing required fields");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::MISSING_FIELD, "field: {} is missing required fields", "frequency");
+            out = std::nullopt;
+            return;
         }
+        
+        auto& outSync = out.has_value() ? out.value() : out.emplace();
         outSync.frequency = freq.value();
-        json.erase("frequency");
+        ctx.consumed.consume(json["frequency"]);
         
         if (!OpenTrackIOHelpers::checkTypeAndSetField(json["locked"], outSync.locked))
         {
-            errors.emplace_back("field: timing/synchronization/lock isn't of type: bool");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", "locked", "bool");
+            out = std::nullopt;
+            return;
         }
-        json.erase("locked");
+        ctx.consumed.consume(json["locked"]);
 
-        std::string str;
-        if (!OpenTrackIOHelpers::checkTypeAndSetField(json["source"], str))
+        const auto source = getString(json["source"]);
+        if (!source.has_value())
         {
-            errors.emplace_back("field: timing/synchronization/source isn't of type: string");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "field: {} isn't of type: {}", "source", "string");
+            out = std::nullopt;
+            return;
         }
         else
         {
-            if (str == "genlock")
+            if (source == "genlock")
             {
                 outSync.source = Synchronization::SourceType::GEN_LOCK;
             }
-            else if (str == "videoIn")
+            else if (source == "videoIn")
             {
                 outSync.source = Synchronization::SourceType::VIDEO_IN;
             }
-            else if (str == "ptp")
+            else if (source == "ptp")
             {
                 outSync.source = Synchronization::SourceType::PTP;
             }
-            else if (str == "ntp")
+            else if (source == "ntp")
             {
                 outSync.source = Synchronization::SourceType::NTP;
             }
             else
             {
-                errors.emplace_back("field: timing/synchronization/source isn't a valid enumeration");
-                return std::nullopt;
+                ctx.diagnostics.error(DiagnosticCode::INVALID_VALUE, "field: {} isn't a valid enumeration", "source");
+                out = std::nullopt;
+                return;
             }
-            json.erase("source");
+            ctx.consumed.consume(json["source"]);
         }
 
         // Non-Required Fields --------
+        outSync.offsets = std::nullopt;
         if (json.contains("offsets"))
         {
+            DiagnosticScope offsetsScope{ctx.diagnostics, "offsets"};
             outSync.offsets = Synchronization::Offsets{};
-            OpenTrackIOHelpers::assignField(json["offsets"], "translation", outSync.offsets->translation, "double", errors);
-            OpenTrackIOHelpers::assignField(json["offsets"], "rotation", outSync.offsets->rotation, "double", errors);
-            OpenTrackIOHelpers::assignField(json["offsets"], "lensEncoders", outSync.offsets->lensEncoders, "double", errors);
+            OpenTrackIOHelpers::assignField(json["offsets"], "translation", outSync.offsets->translation, "double", ctx);
+            OpenTrackIOHelpers::assignField(json["offsets"], "rotation", outSync.offsets->rotation, "double", ctx);
+            OpenTrackIOHelpers::assignField(json["offsets"], "lensEncoders", outSync.offsets->lensEncoders, "double", ctx);
 
             if (!outSync.offsets->translation.has_value() && !outSync.offsets->rotation.has_value() &&
                 !outSync.offsets->lensEncoders.has_value())
             {
                 outSync.offsets = std::nullopt;
             }
-            json.erase("offsets");
+            ctx.consumed.consume(json["offsets"]);
         }
 
-        OpenTrackIOHelpers::assignField(json, "present", outSync.present, "bool", errors);
+        OpenTrackIOHelpers::assignField(json, "present", outSync.present, "bool", ctx);
         
         if (json.contains("ptp"))
         {
-            outSync.ptp = Synchronization::Ptp{};
-            OpenTrackIOHelpers::assignField(json["ptp"], "domain", outSync.ptp->domain, "uint16", errors);
-            OpenTrackIOHelpers::assignField(json["ptp"], "offset", outSync.ptp->offset, "double", errors);
-            const std::regex pattern{R"(^([A-F0-9]{2}:){5}[A-F0-9]{2}$)"};
-            OpenTrackIOHelpers::assignRegexField(json["ptp"], "master", outSync.ptp->master, pattern, errors);
+            DiagnosticScope ptpScope{ctx.diagnostics, "ptp"};
+            // Kept in place when it was already present so the master address keeps its storage.
+            if (!outSync.ptp.has_value())
+            {
+                outSync.ptp.emplace();
+            }
+            OpenTrackIOHelpers::assignField(json["ptp"], "domain", outSync.ptp->domain, "uint16", ctx);
+            OpenTrackIOHelpers::assignField(json["ptp"], "offset", outSync.ptp->offset, "double", ctx);
+            OpenTrackIOHelpers::assignRegexField(json["ptp"], "master", outSync.ptp->master, opentrackiovalidators::macAddress, ctx);
 
             if (!outSync.ptp->domain.has_value() && !outSync.ptp->offset.has_value() && !outSync.ptp->master.has_value())
             {
                 outSync.ptp = std::nullopt;
             }
-            json.erase("ptp");
+            ctx.consumed.consume(json["ptp"]);
+        }
+        else
+        {
+            outSync.ptp = std::nullopt;
         }
-        
-        return outSync;
     }
 
-    std::optional<Tracker> Tracker::parse(nlohmann::json &json, std::vector<std::string>& errors)
+    template<JsonNode Json>
+    void Tracker::parse(const Json &json, ParseContext &ctx, std::optional<Tracker> &out)
     {
-        if (!json.contains("tracker") && (!json.contains("static") || !json["static"].contains("tracker")))
+        const bool hasStatic = ctx.parseStatic && json.contains("static") && json["static"].contains("tracker");
+        const bool hasDynamic = ctx.parseDynamic && json.contains("tracker");
+        if (!hasStatic && !hasDynamic)
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
-        Tracker tkr{};
+        auto& tkr = out.has_value() ? out.value() : out.emplace();
 
         // ------- Static Fields
-        if (json.contains("static") && json["static"].contains("tracker"))
+        if (hasStatic)
         {
-            auto& tkrJson = json["static"]["tracker"];
-            OpenTrackIOHelpers::assignField(tkrJson, "firmwareVersion", tkr.firmwareVersion, "string", errors);
-            OpenTrackIOHelpers::assignField(tkrJson, "make", tkr.make, "string", errors);
-            OpenTrackIOHelpers::assignField(tkrJson, "model", tkr.model, "string", errors);
-            OpenTrackIOHelpers::assignField(tkrJson, "serialNumber", tkr.serialNumber, "string", errors);
+            {
+                DiagnosticScope staticScope{ctx.diagnostics, "static"};
+                DiagnosticScope trackerScope{ctx.diagnostics, "tracker"};
+                schema::parseFields<schema::Scope::STATIC>(json["static"]["tracker"], ctx, tkr);
+            }
 
-            OpenTrackIOHelpers::clearFieldIfEmpty(json["static"], "tracker");
+            OpenTrackIOHelpers::consumeFieldIfEmpty(json["static"], "tracker", ctx);
+        }
+        else
+        {
+            schema::resetFields<schema::Scope::STATIC>(tkr);
         }
         
         // ------- Standard Fields
-        if (json.contains("tracker"))
+        if (hasDynamic)
         {
-            auto& tkrJson = json["tracker"];
-            OpenTrackIOHelpers::assignField(tkrJson, "notes", tkr.notes, "string", errors);
-            OpenTrackIOHelpers::assignField(tkrJson, "recording", tkr.recording, "boolean", errors);
-            OpenTrackIOHelpers::assignField(tkrJson, "slate", tkr.slate, "string", errors);
-            OpenTrackIOHelpers::assignField(tkrJson, "status", tkr.status, "string", errors);
+            {
+                DiagnosticScope trackerScope{ctx.diagnostics, "tracker"};
+                schema::parseFields<schema::Scope::DYNAMIC>(json["tracker"], ctx, tkr);
+            }
 
-            OpenTrackIOHelpers::clearFieldIfEmpty(json, "tracker");
+            OpenTrackIOHelpers::consumeFieldIfEmpty(json, "tracker", ctx);
+        }
+        else
+        {
+            schema::resetFields<schema::Scope::DYNAMIC>(tkr);
         }
-        
-        return tkr;
     }    
 
-    std::optional<Transforms> Transforms::parse(nlohmann::json &json, std::vector<std::string>& errors)
+    template<JsonNode Json>
+    void Transforms::parse(const Json &json, ParseContext &ctx, std::optional<Transforms> &out)
     {
         if (!json.contains("transforms"))
         {
-            return std::nullopt;
+            out = std::nullopt;
+            return;
         }
 
         if (!json["transforms"].is_array())
         {
-            errors.emplace_back("Transforms is not an array.");
-            return std::nullopt;
+            ctx.diagnostics.error(DiagnosticCode::TYPE_MISMATCH, "Transforms is not an array.", "transforms", "array");
+            out = std::nullopt;
+            return;
         }
 
-        Transforms tfs{};
-        auto& tfsJson = json["transforms"];
+        auto& tfs = out.has_value() ? out.value() : out.emplace();
+        const auto& tfsJson = json["transforms"];
 
-        for (auto& item : tfsJson.items())
+        // Valid transforms are parsed over the previous ones in order so their id strings are reused.
+        DiagnosticScope transformsScope{ctx.diagnostics, "transforms"};
+        std::size_t count = 0;
+        for (const auto& transformJson : tfsJson)
         {
-            auto& transformJson = item.value();
-            auto tf = opentrackiotypes::Transform::parse(transformJson, errors);
+            if (count == tfs.transforms.size())
+            {
+                tfs.transforms.emplace_back();
+            }
 
-            if (tf.has_value())
+            if (opentrackiotypes::Transform::parse(transformJson, ctx, tfs.transforms[count]))
             {
-                tfs.transforms.emplace_back(tf.value());
+                ++count;
             }
         }
+        tfs.transforms.resize(count);
         
-        json.erase("transforms");
-        return tfs;
+        ctx.consumed.consume(json["transforms"]);
     }
+
+    /**
+     * The parsers are only ever run against the nlohmann DOM and the DOM-free TapeNode view. */
+#define OPEN_TRACK_IO_INSTANTIATE_PARSERS(JsonType) \
+    template void Camera::parse(const JsonType&, ParseContext&, std::optional<Camera>&); \
+    template void Duration::parse(const JsonType&, ParseContext&, std::optional<Duration>&); \
+    template void GlobalStage::parse(const JsonType&, ParseContext&, std::optional<GlobalStage>&); \
+    template void Lens::parse(const JsonType&, ParseContext&, std::optional<Lens>&); \
+    template void Protocol::parse(const JsonType&, ParseContext&, std::optional<Protocol>&); \
+    template void RelatedSampleIds::parse(const JsonType&, ParseContext&, std::optional<RelatedSampleIds>&); \
+    template void SampleId::parse(const JsonType&, ParseContext&, std::optional<SampleId>&); \
+    template void SourceId::parse(const JsonType&, ParseContext&, std::optional<SourceId>&); \
+    template void SourceNumber::parse(const JsonType&, ParseContext&, std::optional<SourceNumber>&); \
+    template void Timing::parse(const JsonType&, ParseContext&, std::optional<Timing>&); \
+    template void Tracker::parse(const JsonType&, ParseContext&, std::optional<Tracker>&); \
+    template void Transforms::parse(const JsonType&, ParseContext&, std::optional<Transforms>&);
+
+    OPEN_TRACK_IO_INSTANTIATE_PARSERS(nlohmann::json)
+    OPEN_TRACK_IO_INSTANTIATE_PARSERS(TapeNode)
+#undef OPEN_TRACK_IO_INSTANTIATE_PARSERS
 } // opentrackioproperties
@@ -0,0 +1,874 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIORecording.h"
+#include <algorithm>
+#include <cstring>
+#include "opentrackio-cpp/OpenTrackIOTakeStore.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace opentrackio
+{
+    using namespace recording;
+
+    namespace
+    {
+        // CBOR for an empty map, what a sample without any properties serialises to.
+        constexpr uint8_t EMPTY_SAMPLE[] = {0xA0};
+        constexpr uint8_t PADDING[8]{};
+
+        template<typename T>
+        std::span<const uint8_t> bytesOf(const T& value)
+        {
+            return {reinterpret_cast<const uint8_t*>(&value), sizeof(T)};
+        }
+
+        template<typename T>
+        std::span<const uint8_t> bytesOf(const std::vector<T>& values)
+        {
+            return {reinterpret_cast<const uint8_t*>(values.data()), values.size() * sizeof(T)};
+        }
+
+        constexpr uint64_t padded(uint64_t size)
+        {
+            return (size + 7) & ~uint64_t{7};
+        }
+
+        constexpr uint32_t packTimecode(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames)
+        {
+            return (uint32_t{hours} << 24) | (uint32_t{minutes} << 16) | (uint32_t{seconds} << 8) | frames;
+        }
+
+        bool before(uint64_t seconds, uint32_t nanoseconds, const opentrackiotypes::Timestamp& timestamp)
+        {
+            return seconds < timestamp.seconds || (seconds == timestamp.seconds && nanoseconds < timestamp.nanoseconds);
+        }
+
+        /**
+         * Keys the first frame in each stride that has the value, shared by the writer and the rebuilt index. */
+        void addKeys(const RecordedFrame& frame, uint64_t index, std::vector<TimestampKey>& timestampKeys,
+                     std::vector<TimecodeKey>& timecodeKeys)
+        {
+            const uint64_t stride = index / INDEX_STRIDE;
+            if (frame.has(SAMPLE_TIMESTAMP) &&
+                (timestampKeys.empty() || timestampKeys.back().frame / INDEX_STRIDE != stride))
+            {
+                timestampKeys.push_back({frame.sampleTimestamp.seconds, frame.sampleTimestamp.nanoseconds, 0, index});
+            }
+
+            if (frame.has(TIMECODE) && (timecodeKeys.empty() || timecodeKeys.back().frame / INDEX_STRIDE != stride))
+            {
+                const auto& tc = frame.timecode;
+                timecodeKeys.push_back({packTimecode(tc.hours, tc.minutes, tc.seconds, tc.frames), 0, index});
+            }
+        }
+
+        template<typename T>
+        T& engage(std::optional<T>& out)
+        {
+            return out.has_value() ? out.value() : out.emplace();
+        }
+
+        template<typename T>
+        void assignId(std::optional<T>& out, std::string_view text)
+        {
+            const auto id = opentrackiotypes::UrnUuid::parse(text);
+            out = id.has_value() ? std::optional<T>{T{id.value()}} : std::nullopt;
+        }
+
+        template<typename T>
+        void assign(std::optional<T>& out, bool present, const T& value)
+        {
+            if (present)
+            {
+                out = value;
+            }
+            else
+            {
+                out = std::nullopt;
+            }
+        }
+    } // namespace
+
+    RecordingWriter::~RecordingWriter()
+    {
+        close();
+    }
+
+    bool RecordingWriter::open(const std::filesystem::path& path)
+    {
+        close();
+        m_file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!m_file.is_open())
+        {
+            return false;
+        }
+
+        m_offset = 0;
+        m_stringIds.clear();
+        m_stringOffsets.clear();
+        m_staticOffsets.clear();
+        m_statics.clear();
+        m_staticIndex.clear();
+        m_frameOffsets.clear();
+        m_timestampKeys.clear();
+        m_timecodeKeys.clear();
+
+        FileHeader header{};
+        header.frameSize = sizeof(RecordedFrame);
+        header.transformSize = sizeof(RecordedTransform);
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_offset = sizeof(header);
+        return m_file.good();
+    }
+
+    bool RecordingWriter::append(const OpenTrackIOSample& sample)
+    {
+        if (!m_file.is_open())
+        {
+            return false;
+        }
+
+        RecordedFrame frame{};
+        if (sample.sampleId.has_value())
+        {
+            static_assert(opentrackiotypes::UrnUuid::LENGTH <= RecordedFrame::SAMPLE_ID_CAPACITY);
+            const auto id = sample.sampleId->id.toChars();
+            frame.fields |= SAMPLE_ID;
+            std::memcpy(frame.sampleId, id.data(), id.size());
+            frame.sampleIdLength = static_cast<uint8_t>(id.size());
+        }
+
+        if (sample.sourceId.has_value())
+        {
+            const auto id = sample.sourceId->id.toChars();
+            frame.fields |= SOURCE_ID;
+            frame.sourceId = intern(std::string_view{id.data(), id.size()});
+        }
+
+        if (sample.sourceNumber.has_value())
+        {
+            frame.fields |= SOURCE_NUMBER;
+            frame.sourceNumber = sample.sourceNumber->value;
+        }
+
+        if (sample.timing.has_value())
+        {
+            const auto& timing = sample.timing.value();
+            frame.fields |= TIMING;
+            if (timing.sampleTimestamp.has_value())
+            {
+                const auto& ts = timing.sampleTimestamp.value();
+                frame.fields |= SAMPLE_TIMESTAMP;
+                frame.sampleTimestamp = {ts.seconds, ts.nanoseconds, ts.attoseconds};
+            }
+            if (timing.recordedTimestamp.has_value())
+            {
+                const auto& ts = timing.recordedTimestamp.value();
+                frame.fields |= RECORDED_TIMESTAMP;
+                frame.recordedTimestamp = {ts.seconds, ts.nanoseconds, ts.attoseconds};
+            }
+            if (timing.sequenceNumber.has_value())
+            {
+                frame.fields |= SEQUENCE_NUMBER;
+                frame.sequenceNumber = timing.sequenceNumber.value();
+            }
+            if (timing.timecode.has_value())
+            {
+                const auto& tc = timing.timecode.value();
+                frame.fields |= TIMECODE;
+                frame.timecode.hours = tc.hours;
+                frame.timecode.minutes = tc.minutes;
+                frame.timecode.seconds = tc.seconds;
+                frame.timecode.frames = tc.frames;
+                frame.timecode.frameRateNumerator = tc.format.frameRate.numerator;
+                frame.timecode.frameRateDenominator = tc.format.frameRate.denominator;
+                frame.timecode.dropFrame = tc.format.dropFrame ? 1 : 0;
+                if (tc.format.oddField.has_value())
+                {
+                    frame.fields |= TIMECODE_ODD_FIELD;
+                    frame.timecode.oddField = tc.format.oddField.value() ? 1 : 0;
+                }
+            }
+        }
+
+        if (sample.lens.has_value())
+        {
+            const auto& lens = sample.lens.value();
+            frame.fields |= LENS;
+            const auto store = [&frame](const std::optional<double>& value, FrameField field, double& out)
+            {
+                if (value.has_value())
+                {
+                    frame.fields |= field;
+                    out = value.value();
+                }
+            };
+            store(lens.entrancePupilOffset, ENTRANCE_PUPIL_OFFSET, frame.entrancePupilOffset);
+            store(lens.fStop, F_STOP, frame.fStop);
+            store(lens.focalLength, FOCAL_LENGTH, frame.focalLength);
+            store(lens.focusDistance, FOCUS_DISTANCE, frame.focusDistance);
+            store(lens.tStop, T_STOP, frame.tStop);
+
+            if (const auto& e = lens.encoders; e.has_value() && e->focus && e->iris && e->zoom)
+            {
+                frame.fields |= ENCODERS;
+                frame.encoders[0] = e->focus.value();
+                frame.encoders[1] = e->iris.value();
+                frame.encoders[2] = e->zoom.value();
+            }
+            if (const auto& e = lens.rawEncoders; e.has_value() && e->focus && e->iris && e->zoom)
+            {
+                frame.fields |= RAW_ENCODERS;
+                frame.rawEncoders[0] = e->focus.value();
+                frame.rawEncoders[1] = e->iris.value();
+                frame.rawEncoders[2] = e->zoom.value();
+            }
+        }
+
+        if (sample.tracker.has_value())
+        {
+            const auto& tracker = sample.tracker.value();
+            frame.fields |= TRACKER;
+            if (tracker.notes.has_value())
+            {
+                frame.fields |= NOTES;
+                frame.notes = intern(tracker.notes.value());
+            }
+            if (tracker.recording.has_value())
+            {
+                frame.fields |= RECORDING | (tracker.recording.value() ? uint64_t{RECORDING_ACTIVE} : 0);
+            }
+            if (tracker.slate.has_value())
+            {
+                frame.fields |= SLATE;
+                frame.slate = intern(tracker.slate.value());
+            }
+            if (tracker.status.has_value())
+            {
+                frame.fields |= STATUS;
+                frame.status = intern(tracker.status.value());
+            }
+        }
+
+        m_transforms.clear();
+        if (sample.transforms.has_value())
+        {
+            frame.fields |= TRANSFORMS;
+            for (const auto& transform : sample.transforms->transforms)
+            {
+                RecordedTransform& recorded = m_transforms.emplace_back();
+                recorded.translation[0] = transform.translation.x;
+                recorded.translation[1] = transform.translation.y;
+                recorded.translation[2] = transform.translation.z;
+                recorded.rotation[0] = transform.rotation.pan;
+                recorded.rotation[1] = transform.rotation.tilt;
+                recorded.rotation[2] = transform.rotation.roll;
+                if (transform.scale.has_value())
+                {
+                    recorded.fields |= SCALE;
+                    recorded.scale[0] = transform.scale->x;
+                    recorded.scale[1] = transform.scale->y;
+                    recorded.scale[2] = transform.scale->z;
+                }
+                if (transform.transformId.has_value())
+                {
+                    recorded.fields |= TRANSFORM_ID;
+                    recorded.transformId = intern(transform.transformId.value());
+                }
+                if (transform.parentTransformId.has_value())
+                {
+                    recorded.fields |= PARENT_TRANSFORM_ID;
+                    recorded.parentTransformId = intern(transform.parentTransformId.value());
+                }
+            }
+            frame.transformCount = static_cast<uint32_t>(m_transforms.size());
+        }
+
+        frame.staticBlock = storeStatic(sample);
+
+        const uint64_t index = m_frameOffsets.size();
+        addKeys(frame, index, m_timestampKeys, m_timecodeKeys);
+        m_frameOffsets.push_back(m_offset);
+        writeRecord(RecordType::FRAME, {bytesOf(frame), bytesOf(m_transforms)});
+        return m_file.good();
+    }
+
+    bool RecordingWriter::close()
+    {
+        if (!m_file.is_open())
+        {
+            return false;
+        }
+
+        IndexHeader index{};
+        index.frameCount = m_frameOffsets.size();
+        index.staticCount = m_staticOffsets.size();
+        index.stringCount = m_stringOffsets.size();
+        index.timestampKeyCount = m_timestampKeys.size();
+        index.timecodeKeyCount = m_timecodeKeys.size();
+
+        RecordingTrailer trailer{};
+        trailer.indexOffset = m_offset;
+        writeRecord(RecordType::INDEX, {bytesOf(index), bytesOf(m_frameOffsets), bytesOf(m_staticOffsets),
+                                        bytesOf(m_stringOffsets), bytesOf(m_timestampKeys),
+                                        bytesOf(m_timecodeKeys)});
+        m_file.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+
+        const bool good = m_file.good();
+        m_file.close();
+        return good;
+    }
+
+    uint32_t RecordingWriter::intern(std::string_view text)
+    {
+        if (const auto it = m_stringIds.find(text); it != m_stringIds.end())
+        {
+            return it->second;
+        }
+
+        const auto id = static_cast<uint32_t>(m_stringOffsets.size());
+        m_stringIds.emplace(std::string{text}, id);
+        m_stringOffsets.push_back(m_offset);
+        writeRecord(RecordType::STRING, {{reinterpret_cast<const uint8_t*>(text.data()), text.size()}});
+        return id;
+    }
+
+    uint32_t RecordingWriter::storeStatic(const OpenTrackIOSample& sample)
+    {
+        copyResidualProperties(sample, m_scratch);
+        if (m_scratchBytes.empty())
+        {
+            m_scratchBytes.resize(1024);
+        }
+        std::optional<std::size_t> written = m_scratch.serializeCbor(m_scratchBytes);
+        while (!written.has_value())
+        {
+            m_scratchBytes.resize(m_scratchBytes.size() * 2);
+            written = m_scratch.serializeCbor(m_scratchBytes);
+        }
+
+        const std::span<const uint8_t> bytes{m_scratchBytes.data(), written.value()};
+        if (std::ranges::equal(bytes, EMPTY_SAMPLE))
+        {
+            return NONE;
+        }
+
+        const std::string_view key{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+        const std::size_t hash = std::hash<std::string_view>{}(key);
+        const auto [begin, end] = m_staticIndex.equal_range(hash);
+        for (auto it = begin; it != end; ++it)
+        {
+            if (std::ranges::equal(bytes, m_statics[it->second]))
+            {
+                return it->second;
+            }
+        }
+
+        const auto id = static_cast<uint32_t>(m_statics.size());
+        m_statics.emplace_back(bytes.begin(), bytes.end());
+        m_staticIndex.emplace(hash, id);
+        m_staticOffsets.push_back(m_offset);
+        writeRecord(RecordType::STATIC, {bytes});
+        return id;
+    }
+
+    void RecordingWriter::writeRecord(RecordType type, std::initializer_list<std::span<const uint8_t>> parts)
+    {
+        uint64_t size = 0;
+        for (const auto& part : parts)
+        {
+            size += part.size();
+        }
+
+        if (size > UINT32_MAX)
+        {
+            m_file.setstate(std::ios::failbit);
+            return;
+        }
+
+        const RecordHeader header{type, static_cast<uint32_t>(size)};
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto& part : parts)
+        {
+            m_file.write(reinterpret_cast<const char*>(part.data()), static_cast<std::streamsize>(part.size()));
+        }
+        m_file.write(reinterpret_cast<const char*>(PADDING), static_cast<std::streamsize>(padded(size) - size));
+        m_offset += sizeof(header) + padded(size);
+    }
+
+    RecordingReader::~RecordingReader()
+    {
+        close();
+    }
+
+    bool RecordingReader::open(const std::filesystem::path& path)
+    {
+        close();
+
+#if defined(_WIN32)
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER size{};
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &size) && size.QuadPart >= static_cast<LONGLONG>(sizeof(FileHeader)))
+        {
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+        CloseHandle(file);
+        if (mapping == nullptr)
+        {
+            return false;
+        }
+
+        // The view keeps the mapping alive once it is made.
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr)
+        {
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+        const int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            return false;
+        }
+
+        struct stat status{};
+        void* view = MAP_FAILED;
+        if (fstat(file, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(FileHeader)))
+        {
+            view = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        }
+        ::close(file);
+        if (view == MAP_FAILED)
+        {
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<std::size_t>(status.st_size);
+#endif
+
+        FileHeader header{};
+        std::memcpy(&header, m_data, sizeof(header));
+        if (header.magic != FILE_MAGIC || header.version != VERSION || header.byteOrder != BYTE_ORDER_MARK ||
+            header.frameSize != sizeof(RecordedFrame) || header.transformSize != sizeof(RecordedTransform))
+        {
+            close();
+            return false;
+        }
+
+        m_hasIndex = loadIndex();
+        if (!m_hasIndex)
+        {
+            rebuildIndex();
+        }
+        return true;
+    }
+
+    void RecordingReader::close()
+    {
+        if (m_data != nullptr)
+        {
+#if defined(_WIN32)
+            UnmapViewOfFile(m_data);
+#else
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        }
+
+        m_data = nullptr;
+        m_size = 0;
+        m_hasIndex = false;
+        m_frameOffsets = {};
+        m_staticOffsets = {};
+        m_stringOffsets = {};
+        m_timestampKeys = {};
+        m_timecodeKeys = {};
+        m_rebuiltFrames.clear();
+        m_rebuiltStatics.clear();
+        m_rebuiltStrings.clear();
+        m_rebuiltTimestampKeys.clear();
+        m_rebuiltTimecodeKeys.clear();
+    }
+
+    std::span<const uint8_t> RecordingReader::payload(uint64_t offset) const
+    {
+        if (offset > m_size || m_size - offset < sizeof(RecordHeader))
+        {
+            return {};
+        }
+
+        RecordHeader header{};
+        std::memcpy(&header, m_data + offset, sizeof(header));
+        if (m_size - offset - sizeof(RecordHeader) < header.size)
+        {
+            return {};
+        }
+        return {m_data + offset + sizeof(RecordHeader), header.size};
+    }
+
+    bool RecordingReader::loadIndex()
+    {
+        if (m_size < sizeof(FileHeader) + sizeof(RecordingTrailer))
+        {
+            return false;
+        }
+
+        RecordingTrailer trailer{};
+        std::memcpy(&trailer, m_data + m_size - sizeof(trailer), sizeof(trailer));
+        if (trailer.magic != INDEX_MAGIC || trailer.indexOffset % 8 != 0 ||
+            trailer.indexOffset > m_size - sizeof(trailer) - sizeof(RecordHeader))
+        {
+            return false;
+        }
+
+        RecordHeader header{};
+        std::memcpy(&header, m_data + trailer.indexOffset, sizeof(header));
+        const auto index = payload(trailer.indexOffset);
+        if (header.type != RecordType::INDEX || index.size() < sizeof(IndexHeader))
+        {
+            return false;
+        }
+
+        const auto& counts = *reinterpret_cast<const IndexHeader*>(index.data());
+        const uint64_t offsetCount = counts.frameCount + counts.staticCount + counts.stringCount;
+        const uint64_t expected = sizeof(IndexHeader) + offsetCount * sizeof(uint64_t) +
+                                  counts.timestampKeyCount * sizeof(TimestampKey) +
+                                  counts.timecodeKeyCount * sizeof(TimecodeKey);
+        if (offsetCount > index.size() || expected != index.size())
+        {
+            return false;
+        }
+
+        const uint8_t* cursor = index.data() + sizeof(IndexHeader);
+        const auto take = [&cursor]<typename T>(std::span<const T>& out, uint64_t count)
+        {
+            out = {reinterpret_cast<const T*>(cursor), static_cast<std::size_t>(count)};
+            cursor += count * sizeof(T);
+        };
+        take(m_frameOffsets, counts.frameCount);
+        take(m_staticOffsets, counts.staticCount);
+        take(m_stringOffsets, counts.stringCount);
+        take(m_timestampKeys, counts.timestampKeyCount);
+        take(m_timecodeKeys, counts.timecodeKeyCount);
+
+        // Only the offsets are checked, so opening doesn't touch every frame's page.
+        const auto inBounds = [this](uint64_t offset) { return offset % 8 == 0 && offset < m_size; };
+        if (!std::ranges::all_of(m_frameOffsets, [this](uint64_t offset)
+            {
+                return offset % 8 == 0 && offset <= m_size - sizeof(RecordHeader) - sizeof(RecordedFrame);
+            }) || !std::ranges::all_of(m_staticOffsets, inBounds) || !std::ranges::all_of(m_stringOffsets, inBounds))
+        {
+            m_frameOffsets = {};
+            m_staticOffsets = {};
+            m_stringOffsets = {};
+            m_timestampKeys = {};
+            m_timecodeKeys = {};
+            return false;
+        }
+        return true;
+    }
+
+    void RecordingReader::rebuildIndex()
+    {
+        // Stop at the first record that runs past the end, which is where an interrupted writer stopped.
+        uint64_t offset = sizeof(FileHeader);
+        while (offset <= m_size && m_size - offset >= sizeof(RecordHeader))
+        {
+            RecordHeader header{};
+            std::memcpy(&header, m_data + offset, sizeof(header));
+            if (m_size - offset - sizeof(RecordHeader) < header.size)
+            {
+                break;
+            }
+
+            if (header.type == RecordType::FRAME)
+            {
+                if (header.size < sizeof(RecordedFrame))
+                {
+                    break;
+                }
+                const auto& frame = *reinterpret_cast<const RecordedFrame*>(m_data + offset + sizeof(RecordHeader));
+                addKeys(frame, m_rebuiltFrames.size(), m_rebuiltTimestampKeys, m_rebuiltTimecodeKeys);
+                m_rebuiltFrames.push_back(offset);
+            }
+            else if (header.type == RecordType::STATIC)
+            {
+                m_rebuiltStatics.push_back(offset);
+            }
+            else if (header.type == RecordType::STRING)
+            {
+                m_rebuiltStrings.push_back(offset);
+            }
+            else
+            {
+                break;
+            }
+            offset += sizeof(RecordHeader) + padded(header.size);
+        }
+
+        m_frameOffsets = m_rebuiltFrames;
+        m_staticOffsets = m_rebuiltStatics;
+        m_stringOffsets = m_rebuiltStrings;
+        m_timestampKeys = m_rebuiltTimestampKeys;
+        m_timecodeKeys = m_rebuiltTimecodeKeys;
+    }
+
+    const RecordedFrame& RecordingReader::frame(std::size_t index) const
+    {
+        return *reinterpret_cast<const RecordedFrame*>(m_data + m_frameOffsets[index] + sizeof(RecordHeader));
+    }
+
+    std::span<const RecordedTransform> RecordingReader::transforms(std::size_t index) const
+    {
+        const auto record = payload(m_frameOffsets[index]);
+        if (record.size() < sizeof(RecordedFrame))
+        {
+            return {};
+        }
+
+        const auto& recorded = *reinterpret_cast<const RecordedFrame*>(record.data());
+        const std::size_t available = (record.size() - sizeof(RecordedFrame)) / sizeof(RecordedTransform);
+        return {reinterpret_cast<const RecordedTransform*>(record.data() + sizeof(RecordedFrame)),
+                std::min<std::size_t>(recorded.transformCount, available)};
+    }
+
+    std::string_view RecordingReader::string(uint32_t id) const
+    {
+        if (id >= m_stringOffsets.size())
+        {
+            return {};
+        }
+        const auto text = payload(m_stringOffsets[id]);
+        return {reinterpret_cast<const char*>(text.data()), text.size()};
+    }
+
+    std::span<const uint8_t> RecordingReader::staticBlock(uint32_t id) const
+    {
+        if (id >= m_staticOffsets.size())
+        {
+            return {};
+        }
+        return payload(m_staticOffsets[id]);
+    }
+
+    std::optional<std::size_t> RecordingReader::findTimestamp(const opentrackiotypes::Timestamp& timestamp) const
+    {
+        // Start from the last key before the timestamp, every frame before that key is earlier still.
+        const auto key = std::ranges::lower_bound(m_timestampKeys, true, std::less<>{}, [&timestamp](const auto& k)
+        {
+            return !before(k.seconds, k.nanoseconds, timestamp);
+        });
+        const std::size_t start = key == m_timestampKeys.begin() ? 0 : std::prev(key)->frame;
+
+        for (std::size_t i = start; i < frameCount(); ++i)
+        {
+            const auto& recorded = frame(i);
+            if (recorded.has(SAMPLE_TIMESTAMP) &&
+                !before(recorded.sampleTimestamp.seconds, recorded.sampleTimestamp.nanoseconds, timestamp))
+            {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<std::size_t> RecordingReader::findTimecode(const opentrackiotypes::Timecode& timecode) const
+    {
+        const uint32_t packed = packTimecode(timecode.hours, timecode.minutes, timecode.seconds, timecode.frames);
+        const auto key = std::ranges::lower_bound(m_timecodeKeys, packed, std::less<>{}, &TimecodeKey::timecode);
+        const std::size_t start = key == m_timecodeKeys.begin() ? 0 : std::prev(key)->frame;
+
+        for (std::size_t i = start; i < frameCount(); ++i)
+        {
+            const auto& tc = frame(i).timecode;
+            if (frame(i).has(TIMECODE) && packTimecode(tc.hours, tc.minutes, tc.seconds, tc.frames) >= packed)
+            {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool RecordingReader::read(std::size_t index, OpenTrackIOSample& out) const
+    {
+        if (index >= frameCount())
+        {
+            return false;
+        }
+
+        // The static block fills in everything a frame doesn't hold and clears the rest, its parse is then
+        // discarded since a static block on its own lacks fields the schema requires.
+        const auto& recorded = frame(index);
+        const auto block = recorded.staticBlock == NONE ? std::span<const uint8_t>{EMPTY_SAMPLE}
+                                                        : staticBlock(recorded.staticBlock);
+        out.reset();
+        try
+        {
+            out.initialise(block);
+        }
+        catch (const nlohmann::json::exception&)
+        {
+            out.reset();
+            return false;
+        }
+        out.reset();
+
+        // Ids that don't parse can only come from a damaged file and are dropped.
+        assignId(out.sampleId, !recorded.has(SAMPLE_ID) ? std::string_view{}
+                               : recorded.has(SAMPLE_ID_STRING) ? string(recorded.sampleIdString) : recorded.id());
+        assignId(out.sourceId, recorded.has(SOURCE_ID) ? string(recorded.sourceId) : std::string_view{});
+
+        if (recorded.has(SOURCE_NUMBER))
+        {
+            engage(out.sourceNumber).value = recorded.sourceNumber;
+        }
+        else
+        {
+            out.sourceNumber = std::nullopt;
+        }
+
+        if (recorded.has(TIMING))
+        {
+            auto& timing = engage(out.timing);
+            const auto toTimestamp = [](const recording::Timestamp& ts)
+            {
+                opentrackiotypes::Timestamp timestamp{};
+                timestamp.seconds = ts.seconds;
+                timestamp.nanoseconds = ts.nanoseconds;
+                timestamp.attoseconds = ts.attoseconds;
+                return timestamp;
+            };
+            assign(timing.sampleTimestamp, recorded.has(SAMPLE_TIMESTAMP), toTimestamp(recorded.sampleTimestamp));
+            assign(timing.recordedTimestamp, recorded.has(RECORDED_TIMESTAMP),
+                   toTimestamp(recorded.recordedTimestamp));
+            assign(timing.sequenceNumber, recorded.has(SEQUENCE_NUMBER), recorded.sequenceNumber);
+
+            timing.timecode = std::nullopt;
+            if (recorded.has(TIMECODE))
+            {
+                const auto& tc = recorded.timecode;
+                opentrackiotypes::Timecode::Format format{};
+                format.frameRate = {tc.frameRateNumerator, tc.frameRateDenominator};
+                format.dropFrame = tc.dropFrame != 0;
+                if (recorded.has(TIMECODE_ODD_FIELD))
+                {
+                    format.oddField = tc.oddField != 0;
+                }
+                timing.timecode = opentrackiotypes::Timecode{tc.hours, tc.minutes, tc.seconds, tc.frames, format};
+            }
+        }
+        else
+        {
+            out.timing = std::nullopt;
+        }
+
+        if (recorded.has(LENS))
+        {
+            auto& lens = engage(out.lens);
+            assign(lens.entrancePupilOffset, recorded.has(ENTRANCE_PUPIL_OFFSET), recorded.entrancePupilOffset);
+            assign(lens.fStop, recorded.has(F_STOP), recorded.fStop);
+            assign(lens.focalLength, recorded.has(FOCAL_LENGTH), recorded.focalLength);
+            assign(lens.focusDistance, recorded.has(FOCUS_DISTANCE), recorded.focusDistance);
+            assign(lens.tStop, recorded.has(T_STOP), recorded.tStop);
+
+            lens.encoders = std::nullopt;
+            if (recorded.has(ENCODERS))
+            {
+                lens.encoders = opentrackioproperties::Lens::Encoders{recorded.encoders[0], recorded.encoders[1],
+                                                                      recorded.encoders[2]};
+            }
+
+            lens.rawEncoders = std::nullopt;
+            if (recorded.has(RAW_ENCODERS))
+            {
+                lens.rawEncoders = opentrackioproperties::Lens::RawEncoders{
+                        recorded.rawEncoders[0], recorded.rawEncoders[1], recorded.rawEncoders[2]};
+            }
+        }
+        else
+        {
+            out.lens = std::nullopt;
+        }
+
+        if (recorded.has(TRACKER))
+        {
+            auto& tracker = engage(out.tracker);
+            assign(tracker.notes, recorded.has(NOTES), String{string(recorded.notes)});
+            assign(tracker.recording, recorded.has(RECORDING), recorded.has(RECORDING_ACTIVE));
+            assign(tracker.slate, recorded.has(SLATE), String{string(recorded.slate)});
+            assign(tracker.status, recorded.has(STATUS), String{string(recorded.status)});
+        }
+        else
+        {
+            out.tracker = std::nullopt;
+        }
+
+        if (recorded.has(TRANSFORMS))
+        {
+            // Overwritten in place so the transforms keep their strings, as the parsers do.
+            const auto recordedTransforms = transforms(index);
+            auto& list = engage(out.transforms).transforms;
+            list.resize(recordedTransforms.size());
+            for (std::size_t i = 0; i < recordedTransforms.size(); ++i)
+            {
+                const auto& from = recordedTransforms[i];
+                auto& transform = list[i];
+                transform.translation = {from.translation[0], from.translation[1], from.translation[2]};
+                transform.rotation = {from.rotation[0], from.rotation[1], from.rotation[2]};
+                assign(transform.scale, (from.fields & SCALE) != 0,
+                       opentrackiotypes::Vector3{from.scale[0], from.scale[1], from.scale[2]});
+
+                if ((from.fields & TRANSFORM_ID) != 0)
+                {
+                    engage(transform.transformId).assign(string(from.transformId));
+                }
+                else
+                {
+                    transform.transformId = std::nullopt;
+                }
+
+                if ((from.fields & PARENT_TRANSFORM_ID) != 0)
+                {
+                    engage(transform.parentTransformId).assign(string(from.parentTransformId));
+                }
+                else
+                {
+                    transform.parentTransformId = std::nullopt;
+                }
+            }
+        }
+        else
+        {
+            out.transforms = std::nullopt;
+        }
+        return true;
+    }
+} // namespace opentrackio
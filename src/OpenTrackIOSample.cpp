@@ -12,6 +12,7 @@
  */
 
 #include "opentrackio-cpp/OpenTrackIOSample.h"
+#include "opentrackio-cpp/OpenTrackIOSnapshot.h"
 #include <numbers>
 #include <format>
 
@@ -57,57 +58,362 @@ namespace opentrackio
         }
     };
     
-    bool OpenTrackIOSample::initialise(const nlohmann::json &json)
-    {
-        // Take a copy of the full JSON for referencing later if needed.
-        m_json = json;
-        
-        /** 
-         * Take a second copy of the original which will have all processed fields removed (this is to check for
-         * leftover fields. */
-        
-        nlohmann::json jsonCopy = json;
-        camera = opentrackioproperties::Camera::parse(jsonCopy, m_errorMessages);
-        duration = opentrackioproperties::Duration::parse(jsonCopy, m_errorMessages);
-        globalStage = opentrackioproperties::GlobalStage::parse(jsonCopy, m_errorMessages);
-        lens = opentrackioproperties::Lens::parse(jsonCopy, m_errorMessages);
-        protocol = opentrackioproperties::Protocol::parse(jsonCopy, m_errorMessages);
-        relatedSampleIds = opentrackioproperties::RelatedSampleIds::parse(jsonCopy, m_errorMessages);
-        sampleId = opentrackioproperties::SampleId::parse(jsonCopy, m_errorMessages);
-        sourceId = opentrackioproperties::SourceId::parse(jsonCopy, m_errorMessages);
-        sourceNumber = opentrackioproperties::SourceNumber::parse(jsonCopy, m_errorMessages);
-        timing = opentrackioproperties::Timing::parse(jsonCopy, m_errorMessages);
-        tracker = opentrackioproperties::Tracker::parse(jsonCopy, m_errorMessages);
-        transforms = opentrackioproperties::Transforms::parse(jsonCopy, m_errorMessages);
-        
-        // Check the copy to see if it has remaining fields and if so bubble up warnings.
-        warnForRemainingFields(jsonCopy);
+    /**
+     * Assigns every described field of scope S, the generated counterpart of a run of assignJson calls. */
+    template<schema::Scope S, typename T>
+    void assignJsonFields(nlohmann::json &json, const T &value)
+    {
+        schema::forEachField<T, S>([&](auto field)
+        {
+            using F = decltype(field);
+            assignJson(json, F::key, value.*F::member);
+        });
+    }
+
+    nlohmann::json transformToJson(const opentrackiotypes::Transform& tf)
+    {
+        nlohmann::json tfJson{};
+        tfJson["translation"] = {{"x", tf.translation.x}, {"y", tf.translation.y}, {"z", tf.translation.z}};
+        tfJson["rotation"] = {{"pan", tf.rotation.pan}, {"tilt", tf.rotation.tilt}, {"roll", tf.rotation.roll}};
+        assignJson(tfJson, "transformId", tf.transformId);
+        assignJson(tfJson, "parentTransformId", tf.parentTransformId);
+        if (tf.scale.has_value())
+        {
+            tfJson["scale"] = {{"x", tf.scale->x}, {"y", tf.scale->y}, {"z", tf.scale->z}};
+        }
+        return tfJson;
+    }
+
+    bool OpenTrackIOSample::initialise(const nlohmann::json &json, const ParseOptions& options)
+    {
+        m_timer.start(options.instrumentation, 0);
+        parseProperties(json, options);
+        
+        // Only take a copy of the full JSON if the caller has asked for it to be kept.
+        if (options.retainJson)
+        {
+            m_json = json;
+        }
         
         return true;
     }
 
-    bool OpenTrackIOSample::initialise(const std::string_view jsonString)
+    bool OpenTrackIOSample::initialise(nlohmann::json &&json, const ParseOptions& options)
     {
-        nlohmann::json from_string = nlohmann::json::parse(jsonString);
-        return initialise(from_string);
+        m_timer.start(options.instrumentation, 0);
+        return initialiseFromDom(std::move(json), options);
+    }
+
+    bool OpenTrackIOSample::initialiseFromDom(nlohmann::json &&json, const ParseOptions& options)
+    {
+        parseProperties(json, options);
+        
+        if (options.retainJson)
+        {
+            m_json = std::move(json);
+        }
+        
+        return true;
+    }
+
+    bool OpenTrackIOSample::initialise(const std::string_view jsonString, const ParseOptions& options)
+    {
+        m_timer.start(options.instrumentation, jsonString.size());
+        
+        // A retained DOM has to be built anyway, otherwise tokenise straight into the reusable tape.
+        if (options.retainJson)
+        {
+            nlohmann::json from_string = nlohmann::json::parse(jsonString);
+            m_timer.lap(InstrumentedPhase::DOM_BUILD);
+            return initialiseFromDom(std::move(from_string), options);
+        }
+
+        m_tape.parseJson(jsonString);
+        m_timer.lap(InstrumentedPhase::DOM_BUILD);
+        parseProperties(m_tape.root(), options);
+        return true;
     }
     
-    bool OpenTrackIOSample::initialise(std::span<const uint8_t> cbor)
+    bool OpenTrackIOSample::initialise(std::span<const uint8_t> cbor, const ParseOptions& options)
+    {
+        m_timer.start(options.instrumentation, cbor.size());
+        
+        // A retained DOM has to be built anyway, otherwise decode straight into the reusable tape.
+        if (options.retainJson)
+        {
+            nlohmann::json from_cbor = nlohmann::json::from_cbor(cbor);
+            m_timer.lap(InstrumentedPhase::DOM_BUILD);
+            return initialiseFromDom(std::move(from_cbor), options);
+        }
+
+        m_tape.parseCbor(cbor);
+        m_timer.lap(InstrumentedPhase::DOM_BUILD);
+        parseProperties(m_tape.root(), options);
+        return true;
+    }
+
+    bool OpenTrackIOSample::initialise(const PacketPayload& payload, const ParseOptions& options)
     {
-        nlohmann::json from_cbor = nlohmann::json::from_cbor(cbor);
-        return initialise(from_cbor);
+        if (payload.encoding == PacketEncoding::JSON)
+        {
+            const std::string_view text{reinterpret_cast<const char*>(payload.data.data()), payload.data.size()};
+            return initialise(text, options);
+        }
+        return initialise(payload.data, options);
+    }
+
+    void OpenTrackIOSample::reset()
+    {
+        if (m_memoryResource != nullptr)
+        {
+            clearProperties();
+            m_memoryResource = nullptr;
+        }
+        m_json = std::nullopt;
+        m_dirty = 0;
+        m_tape.clear();
+        m_consumedFields.clear();
+        m_diagnostics.clear();
+    }
+
+    void OpenTrackIOSample::clearProperties()
+    {
+        camera = std::nullopt;
+        duration = std::nullopt;
+        globalStage = std::nullopt;
+        lens = std::nullopt;
+        protocol = std::nullopt;
+        relatedSampleIds = std::nullopt;
+        sampleId = std::nullopt;
+        sourceId = std::nullopt;
+        sourceNumber = std::nullopt;
+        timing = std::nullopt;
+        tracker = std::nullopt;
+        transforms = std::nullopt;
+    }
+
+    template<JsonNode Json>
+    void OpenTrackIOSample::parseProperties(const Json &json, const ParseOptions& options)
+    {
+        /**
+         * The parsers read from the document without modifying it and record every node they consume, the leftover
+         * field check then walks the same document skipping anything that was consumed. */
+        m_json = std::nullopt;
+        m_dirty = 0;
+        m_consumedFields.clear();
+        m_diagnostics.configure(options.structuredDiagnostics, options.collectWarnings);
+        m_timer.baseline(m_diagnostics);
+        ParseContext ctx{m_diagnostics, m_consumedFields};
+        
+        // Values refilled in place would keep allocating from wherever they were first built.
+        if (options.memoryResource != nullptr || m_memoryResource != nullptr)
+        {
+            clearProperties();
+        }
+        m_memoryResource = options.memoryResource;
+        
+        // Static fields are left to the cache, which is resolved once the sourceId is known.
+        ctx.parseStatic = options.staticCache == nullptr;
+        
+        {
+            MemoryResourceScope scope{options.memoryResource != nullptr ? options.memoryResource
+                                                                        : currentMemoryResource()};
+            opentrackioproperties::Camera::parse(json, ctx, camera);
+            opentrackioproperties::Duration::parse(json, ctx, duration);
+            opentrackioproperties::GlobalStage::parse(json, ctx, globalStage);
+            opentrackioproperties::Lens::parse(json, ctx, lens);
+            opentrackioproperties::Protocol::parse(json, ctx, protocol);
+            opentrackioproperties::RelatedSampleIds::parse(json, ctx, relatedSampleIds);
+            opentrackioproperties::SampleId::parse(json, ctx, sampleId);
+            opentrackioproperties::SourceId::parse(json, ctx, sourceId);
+            opentrackioproperties::SourceNumber::parse(json, ctx, sourceNumber);
+            opentrackioproperties::Timing::parse(json, ctx, timing);
+            opentrackioproperties::Tracker::parse(json, ctx, tracker);
+            opentrackioproperties::Transforms::parse(json, ctx, transforms);
+        }
+        
+        if (options.staticCache != nullptr)
+        {
+            resolveStaticProperties(json, *options.staticCache);
+        }
+        else
+        {
+            staticProperties = nullptr;
+        }
+        m_timer.lap(InstrumentedPhase::PROPERTY_PARSE);
+        
+        // Check for fields which weren't consumed by any parser and if so bubble up warnings.
+        if (options.collectWarnings)
+        {
+            OpenTrackIOHelpers::warnForRemainingFields(json, ctx);
+            m_timer.lap(InstrumentedPhase::LEFTOVER_WALK);
+        }
+        
+        if (options.snapshot != nullptr)
+        {
+            options.snapshot->capture(*this);
+        }
+        
+        if (Instrumentation* instrumentation = m_timer.finish(&m_diagnostics))
+        {
+            instrumentation->recordParse(*this, m_diagnostics, m_timer.measurement());
+        }
+    }
+
+    template<JsonNode Json>
+    void OpenTrackIOSample::resolveStaticProperties(const Json &json, StaticCache &cache)
+    {
+        const opentrackiotypes::UrnUuid source = sourceId.has_value() ? sourceId->id : opentrackiotypes::UrnUuid{};
+        
+        // Without a static block the sample carries the latest one its source sent.
+        if (!json.contains("static"))
+        {
+            staticProperties = cache.find(source);
+            return;
+        }
+        
+        const auto& staticJson = json["static"];
+        nodeBytes(staticJson, m_staticBlock);
+        if (auto cached = cache.find(source, m_staticBlock))
+        {
+            // Anything the block had to report was reported by the sample that first parsed it.
+            staticProperties = std::move(cached);
+            m_consumedFields.consume(staticJson);
+            return;
+        }
+        
+        // Cached blocks outlive the sample, so they never allocate from a resource it was given.
+        MemoryResourceScope scope{std::pmr::get_default_resource()};
+        auto parsed = std::make_shared<StaticProperties>();
+        ParseContext ctx{m_diagnostics, m_consumedFields};
+        ctx.parseDynamic = false;
+        
+        opentrackioproperties::Camera::parse(json, ctx, parsed->camera);
+        opentrackioproperties::Duration::parse(json, ctx, parsed->duration);
+        opentrackioproperties::Lens::parse(json, ctx, parsed->lens);
+        opentrackioproperties::Tracker::parse(json, ctx, parsed->tracker);
+        
+        cache.store(source, m_staticBlock, parsed);
+        staticProperties = std::move(parsed);
     }
 
     const nlohmann::json &OpenTrackIOSample::getJson()
     {
-        if (!m_json.has_value())
+        if (!m_json.has_value() || !m_json->is_object())
         {
             generateJson();
-        }        
+        }
+        else
+        {
+            updateJson();
+        }
         
         return m_json.value();
     }
 
+    void OpenTrackIOSample::updateJson()
+    {
+        /**
+         * Only the subtrees of properties marked dirty are regenerated. Lens and tracker only replace their part of
+         * the static block if their static fields were marked, so the static block of a retained document parsed
+         * through a StaticCache survives changes to the dynamic fields. */
+        const auto dirty = [this](Property property)
+        {
+            return (m_dirty >> static_cast<uint8_t>(property) & 1u) != 0;
+        };
+        
+        if (dirty(Property::CAMERA))
+        {
+            regenerateJson(&OpenTrackIOSample::parseCameraToJson, {}, "camera");
+        }
+        if (dirty(Property::DURATION))
+        {
+            regenerateJson(&OpenTrackIOSample::parseDurationToJson, {}, "duration");
+        }
+        if (dirty(Property::GLOBAL_STAGE))
+        {
+            regenerateJson(&OpenTrackIOSample::parseGlobalStageToJson, "globalStage");
+        }
+        if (dirty(Property::LENS) || dirty(Property::LENS_STATIC))
+        {
+            regenerateJson(&OpenTrackIOSample::parseLensToJson, dirty(Property::LENS) ? "lens" : "",
+                           dirty(Property::LENS_STATIC) ? "lens" : "");
+        }
+        if (dirty(Property::PROTOCOL))
+        {
+            regenerateJson(&OpenTrackIOSample::parseProtocolToJson, "protocol");
+        }
+        if (dirty(Property::RELATED_SAMPLE_IDS))
+        {
+            regenerateJson(&OpenTrackIOSample::parseRelatedSampleIdsToJson, "relatedSampleIds");
+        }
+        if (dirty(Property::SAMPLE_ID))
+        {
+            regenerateJson(&OpenTrackIOSample::parseSampleIdToJson, "sampleId");
+        }
+        if (dirty(Property::SOURCE_ID))
+        {
+            regenerateJson(&OpenTrackIOSample::parseSourceIdToJson, "sourceId");
+        }
+        if (dirty(Property::SOURCE_NUMBER))
+        {
+            regenerateJson(&OpenTrackIOSample::parseSourceNumberToJson, "sourceNumber");
+        }
+        if (dirty(Property::TIMING))
+        {
+            regenerateJson(&OpenTrackIOSample::parseTimingToJson, "timing");
+        }
+        if (dirty(Property::TRACKER) || dirty(Property::TRACKER_STATIC))
+        {
+            regenerateJson(&OpenTrackIOSample::parseTrackerToJson, dirty(Property::TRACKER) ? "tracker" : "",
+                           dirty(Property::TRACKER_STATIC) ? "tracker" : "");
+        }
+        if (dirty(Property::TRANSFORMS))
+        {
+            regenerateJson(&OpenTrackIOSample::parseTransformsToJson, "transforms");
+        }
+        m_dirty = 0;
+    }
+
+    void OpenTrackIOSample::regenerateJson(void (OpenTrackIOSample::*toJson)(nlohmann::json&), std::string_view key,
+                                           std::string_view staticKey)
+    {
+        nlohmann::json generated;
+        (this->*toJson)(generated);
+        
+        // Moves a generated subtree over the old one, removing the old one if the property no longer writes it.
+        const auto replace = [](nlohmann::json& from, nlohmann::json& to, std::string_view name)
+        {
+            const auto it = from.is_object() ? from.find(name) : from.end();
+            if (it != from.end())
+            {
+                to[name] = std::move(*it);
+            }
+            else if (to.is_object())
+            {
+                to.erase(name);
+            }
+        };
+        
+        auto& json = m_json.value();
+        if (!key.empty())
+        {
+            replace(generated, json, key);
+        }
+        
+        if (!staticKey.empty())
+        {
+            auto generatedStatic = generated.is_object() ? generated.find("static") : generated.end();
+            nlohmann::json none;
+            auto& staticJson = json["static"];
+            replace(generatedStatic != generated.end() ? *generatedStatic : none, staticJson, staticKey);
+            if (staticJson.is_null() || staticJson.empty())
+            {
+                json.erase("static");
+            }
+        }
+    }
+
     void OpenTrackIOSample::generateJson()
     {
         namespace props = opentrackioproperties;
@@ -127,7 +433,8 @@ namespace opentrackio
         parseTrackerToJson(j);
         parseTransformsToJson(j);
         
-        m_json = j;
+        m_json = std::move(j);
+        m_dirty = 0;
     }
 
     void OpenTrackIOSample::parseCameraToJson(nlohmann::json& baseJson)
@@ -137,19 +444,15 @@ namespace opentrackio
             return;
         }
         
-        auto& cameraJson = baseJson["static"]["camera"];
-        assignJson(cameraJson, "activeSensorPhysicalDimensions", camera->activeSensorPhysicalDimensions);
-        assignJson(cameraJson, "activeSensorResolution", camera->activeSensorResolution);
-        assignJson(cameraJson, "anamorphicSqueeze", camera->anamorphicSqueeze);
-        assignJson(cameraJson, "firmwareVersion", camera->firmwareVersion);
-        assignJson(cameraJson, "label", camera->label);
-        assignJson(cameraJson, "make", camera->make);
-        assignJson(cameraJson, "model", camera->model);
-        assignJson(cameraJson, "serialNumber", camera->serialNumber);
-        assignJson(cameraJson, "captureFrameRate", camera->captureFrameRate);
-        assignJson(cameraJson, "fdlLink", camera->fdlLink);
-        assignJson(cameraJson, "isoSpeed", camera->isoSpeed);
-        assignJson(cameraJson, "shutterAngle", camera->shutterAngle);
+        nlohmann::json cameraJson;
+        assignJsonFields<schema::Scope::STATIC>(cameraJson, camera.value());
+        
+        // Sub-objects are built separately and only attached if something was written to them, otherwise
+        // operator[] would leave empty properties in the output as null.
+        if (!cameraJson.is_null())
+        {
+            baseJson["static"]["camera"] = std::move(cameraJson);
+        }
     }
 
     void OpenTrackIOSample::parseDurationToJson(nlohmann::json &baseJson)
@@ -186,69 +489,86 @@ namespace opentrackio
         }
         
         // ------- Static Fields
-        assignJson(baseJson["static"]["lens"], "firmwareVersion", lens->firmwareVersion);
-        assignJson(baseJson["static"]["lens"], "make", lens->make);
-        assignJson(baseJson["static"]["lens"], "model", lens->model);
-        assignJson(baseJson["static"]["lens"], "nominalFocalLength", lens->nominalFocalLength);
-        assignJson(baseJson["static"]["lens"], "serialNumber", lens->serialNumber);
-        assignJson(baseJson["static"]["lens"], "distortionOverscanMax", lens->distortionOverscanMax);
+        nlohmann::json staticJson;
+        assignJsonFields<schema::Scope::STATIC>(staticJson, lens.value());
+
+        if (!staticJson.is_null())
+        {
+            baseJson["static"]["lens"] = std::move(staticJson);
+        }
 
         // ------- Standard Fields
-        assignJson(baseJson["lens"], "custom", lens->custom);
+        nlohmann::json lensJson;
+        assignJson(lensJson, "custom", lens->custom);
         
         if (lens->distortion.has_value())
         {
-            baseJson["lens"]["distortion"]["radial"] = lens->distortion->radial;
-            assignJson(baseJson["lens"]["distortion"], "tangential", lens->distortion->tangential);
+            lensJson["distortion"]["radial"] = lens->distortion->radial;
+            assignJson(lensJson["distortion"], "tangential", lens->distortion->tangential);
         }
 
-        assignJson(baseJson["lens"], "distortionOverscan", lens->distortionOverscan);
+        assignJson(lensJson, "distortionOverscan", lens->distortionOverscan);
 
         if (lens->distortionShift.has_value())
         {
-            baseJson["lens"]["distortionShift"]["x"] = lens->distortionShift->x;
-            baseJson["lens"]["distortionShift"]["y"] = lens->distortionShift->y;
+            lensJson["distortionShift"]["x"] = lens->distortionShift->x;
+            lensJson["distortionShift"]["y"] = lens->distortionShift->y;
         }
 
         if (lens->encoders.has_value())
         {
-            assignJson(baseJson["lens"]["encoders"], "focus", lens->encoders->focus);
-            assignJson(baseJson["lens"]["encoders"], "iris", lens->encoders->iris);
-            assignJson(baseJson["lens"]["encoders"], "zoom", lens->encoders->zoom);
+            nlohmann::json encodersJson;
+            assignJson(encodersJson, "focus", lens->encoders->focus);
+            assignJson(encodersJson, "iris", lens->encoders->iris);
+            assignJson(encodersJson, "zoom", lens->encoders->zoom);
+            if (!encodersJson.is_null())
+            {
+                lensJson["encoders"] = std::move(encodersJson);
+            }
         }
 
-        assignJson(baseJson["lens"], "entrancePupilOffset", lens->entrancePupilOffset);
+        assignJson(lensJson, "entrancePupilOffset", lens->entrancePupilOffset);
         
         if (lens->exposureFalloff.has_value())
         {
-            baseJson["lens"]["exposureFalloff"]["a1"] = lens->exposureFalloff->a1;
-            assignJson(baseJson["lens"]["exposureFalloff"], "a2", lens->exposureFalloff->a2);
-            assignJson(baseJson["lens"]["exposureFalloff"], "a3", lens->exposureFalloff->a3);
+            lensJson["exposureFalloff"]["a1"] = lens->exposureFalloff->a1;
+            assignJson(lensJson["exposureFalloff"], "a2", lens->exposureFalloff->a2);
+            assignJson(lensJson["exposureFalloff"], "a3", lens->exposureFalloff->a3);
         }
 
-        assignJson(baseJson["lens"], "fStop", lens->fStop);
-        assignJson(baseJson["lens"], "focalLength", lens->focalLength);
-        assignJson(baseJson["lens"], "focusDistance", lens->focusDistance);
+        assignJson(lensJson, "fStop", lens->fStop);
+        assignJson(lensJson, "focalLength", lens->focalLength);
+        assignJson(lensJson, "focusDistance", lens->focusDistance);
 
         if (lens->perspectiveShift.has_value())
         {
-            baseJson["lens"]["perspectiveShift"]["x"] = lens->perspectiveShift->x;
-            baseJson["lens"]["perspectiveShift"]["y"] = lens->perspectiveShift->y;
+            lensJson["perspectiveShift"]["x"] = lens->perspectiveShift->x;
+            lensJson["perspectiveShift"]["y"] = lens->perspectiveShift->y;
         }
         
         if (lens->rawEncoders.has_value())
         {
-            assignJson(baseJson["lens"]["rawEncoders"], "focus", lens->rawEncoders->focus);
-            assignJson(baseJson["lens"]["rawEncoders"], "iris", lens->rawEncoders->iris);
-            assignJson(baseJson["lens"]["rawEncoders"], "zoom", lens->rawEncoders->zoom);
+            nlohmann::json rawEncodersJson;
+            assignJson(rawEncodersJson, "focus", lens->rawEncoders->focus);
+            assignJson(rawEncodersJson, "iris", lens->rawEncoders->iris);
+            assignJson(rawEncodersJson, "zoom", lens->rawEncoders->zoom);
+            if (!rawEncodersJson.is_null())
+            {
+                lensJson["rawEncoders"] = std::move(rawEncodersJson);
+            }
         }
         
-        assignJson(baseJson["lens"], "tStop", lens->tStop);
+        assignJson(lensJson, "tStop", lens->tStop);
 
         if (lens->undistortion.has_value())
         {
-            baseJson["lens"]["undistortion"]["radial"] = lens->undistortion->radial;
-            assignJson(baseJson["lens"]["undistortion"], "tangential", lens->undistortion->tangential);
+            lensJson["undistortion"]["radial"] = lens->undistortion->radial;
+            assignJson(lensJson["undistortion"], "tangential", lens->undistortion->tangential);
+        }
+
+        if (!lensJson.is_null())
+        {
+            baseJson["lens"] = std::move(lensJson);
         }
     }
 
@@ -310,67 +630,85 @@ namespace opentrackio
             return;
         }
         
-        assignJson(baseJson["timing"], "frameRate", timing->frameRate);
+        nlohmann::json timingJson;
+        assignJson(timingJson, "frameRate", timing->frameRate);
         if (timing->mode.has_value())
         {
-            baseJson["timing"]["mode"] = timing->mode.value() == opentrackioproperties::Timing::Mode::INTERNAL ?
+            timingJson["mode"] = timing->mode.value() == opentrackioproperties::Timing::Mode::INTERNAL ?
                                   "internal" : "external";
         }
-        assignJson(baseJson["timing"], "recordedTimestamp", timing->recordedTimestamp);
-        assignJson(baseJson["timing"], "sampleTimestamp", timing->sampleTimestamp);
-        assignJson(baseJson["timing"], "sequenceNumber", timing->sequenceNumber);
+        assignJson(timingJson, "recordedTimestamp", timing->recordedTimestamp);
+        assignJson(timingJson, "sampleTimestamp", timing->sampleTimestamp);
+        assignJson(timingJson, "sequenceNumber", timing->sequenceNumber);
 
         if (timing->synchronization.has_value())
         {
-            baseJson["timing"]["synchronization"]["frequency"]["num"] = timing->synchronization->frequency.numerator;
-            baseJson["timing"]["synchronization"]["frequency"]["denom"] = timing->synchronization->frequency.denominator;
-            baseJson["timing"]["synchronization"]["locked"] = timing->synchronization->locked;
+            auto& syncJson = timingJson["synchronization"];
+            syncJson["frequency"]["num"] = timing->synchronization->frequency.numerator;
+            syncJson["frequency"]["denom"] = timing->synchronization->frequency.denominator;
+            syncJson["locked"] = timing->synchronization->locked;
             
             switch(timing->synchronization->source)
             {
                 case opentrackioproperties::Timing::Synchronization::SourceType::GEN_LOCK:
-                    baseJson["timing"]["synchronization"]["source"] = "genlock";
+                    syncJson["source"] = "genlock";
                     break;
                 case opentrackioproperties::Timing::Synchronization::SourceType::VIDEO_IN:
-                    baseJson["timing"]["synchronization"]["source"] = "videoIn";
+                    syncJson["source"] = "videoIn";
                     break;
                 case opentrackioproperties::Timing::Synchronization::SourceType::PTP:
-                    baseJson["timing"]["synchronization"]["source"] = "ptp";
+                    syncJson["source"] = "ptp";
                     break;
                 case opentrackioproperties::Timing::Synchronization::SourceType::NTP:
-                    baseJson["timing"]["synchronization"]["source"] = "ntp";
+                    syncJson["source"] = "ntp";
                     break;
             }
 
             if (timing->synchronization->offsets.has_value())
             {
                 const auto& offsets = timing->synchronization->offsets.value();
-                assignJson(baseJson["timing"]["synchronization"]["offsets"], "translation", offsets.translation);
-                assignJson(baseJson["timing"]["synchronization"]["offsets"], "rotation", offsets.rotation);
-                assignJson(baseJson["timing"]["synchronization"]["offsets"], "lensEncoders", offsets.lensEncoders);
+                nlohmann::json offsetsJson;
+                assignJson(offsetsJson, "translation", offsets.translation);
+                assignJson(offsetsJson, "rotation", offsets.rotation);
+                assignJson(offsetsJson, "lensEncoders", offsets.lensEncoders);
+                if (!offsetsJson.is_null())
+                {
+                    syncJson["offsets"] = std::move(offsetsJson);
+                }
             }            
             
-            assignJson(baseJson["timing"]["synchronization"], "present", timing->synchronization->present);
+            assignJson(syncJson, "present", timing->synchronization->present);
             
             if (timing->synchronization->ptp.has_value())
             {
                 const auto& ptp = timing->synchronization->ptp.value();
-                assignJson(baseJson["timing"]["synchronization"]["ptp"], "master", ptp.master);
-                assignJson(baseJson["timing"]["synchronization"]["ptp"], "offset", ptp.offset);
-                assignJson(baseJson["timing"]["synchronization"]["ptp"], "domain", ptp.domain);                
+                nlohmann::json ptpJson;
+                assignJson(ptpJson, "master", ptp.master);
+                assignJson(ptpJson, "offset", ptp.offset);
+                assignJson(ptpJson, "domain", ptp.domain);
+                if (!ptpJson.is_null())
+                {
+                    syncJson["ptp"] = std::move(ptpJson);
+                }
             }
         }
 
         if (timing->timecode.has_value())
         {
-            baseJson["timing"]["timecode"]["hours"] = timing->timecode->hours;
-            baseJson["timing"]["timecode"]["minutes"] = timing->timecode->minutes;
-            baseJson["timing"]["timecode"]["seconds"] = timing->timecode->seconds;
-            baseJson["timing"]["timecode"]["frames"] = timing->timecode->frames;
-            baseJson["timing"]["timecode"]["format"]["frameRate"]["num"] = timing->timecode->format.frameRate.numerator;
-            baseJson["timing"]["timecode"]["format"]["frameRate"]["denom"] = timing->timecode->format.frameRate.denominator;
-            baseJson["timing"]["timecode"]["format"]["dropFrame"] = timing->timecode->format.dropFrame;
-            assignJson(baseJson["timing"]["timecode"]["format"], "oddField", timing->timecode->format.oddField);
+            auto& tcJson = timingJson["timecode"];
+            tcJson["hours"] = timing->timecode->hours;
+            tcJson["minutes"] = timing->timecode->minutes;
+            tcJson["seconds"] = timing->timecode->seconds;
+            tcJson["frames"] = timing->timecode->frames;
+            tcJson["format"]["frameRate"]["num"] = timing->timecode->format.frameRate.numerator;
+            tcJson["format"]["frameRate"]["denom"] = timing->timecode->format.frameRate.denominator;
+            tcJson["format"]["dropFrame"] = timing->timecode->format.dropFrame;
+            assignJson(tcJson["format"], "oddField", timing->timecode->format.oddField);
+        }
+
+        if (!timingJson.is_null())
+        {
+            baseJson["timing"] = std::move(timingJson);
         }
     }
 
@@ -382,16 +720,22 @@ namespace opentrackio
         }
 
         // ------- Static Fields
-        assignJson(baseJson["static"]["tracker"], "firmwareVersion", tracker->firmwareVersion);
-        assignJson(baseJson["static"]["tracker"], "make", tracker->make);
-        assignJson(baseJson["static"]["tracker"], "model", tracker->model);
-        assignJson(baseJson["static"]["tracker"], "serialNumber", tracker->serialNumber);
+        nlohmann::json staticJson;
+        assignJsonFields<schema::Scope::STATIC>(staticJson, tracker.value());
+
+        if (!staticJson.is_null())
+        {
+            baseJson["static"]["tracker"] = std::move(staticJson);
+        }
 
         // ------- Standard Fields
-        assignJson(baseJson["tracker"], "notes", tracker->notes);
-        assignJson(baseJson["tracker"], "recording", tracker->recording);
-        assignJson(baseJson["tracker"], "slate", tracker->slate);
-        assignJson(baseJson["tracker"], "status", tracker->status);
+        nlohmann::json trackerJson;
+        assignJsonFields<schema::Scope::DYNAMIC>(trackerJson, tracker.value());
+
+        if (!trackerJson.is_null())
+        {
+            baseJson["tracker"] = std::move(trackerJson);
+        }
     }    
     
     void OpenTrackIOSample::parseTransformsToJson(nlohmann::json& baseJson)
@@ -404,38 +748,7 @@ namespace opentrackio
         baseJson["transforms"] = nlohmann::json::array();
         for (const auto& tf : transforms->transforms)
         {
-            nlohmann::json tfJson{};
-            tfJson["translation"] = {{"x", tf.translation.x}, {"y", tf.translation.y}, {"z", tf.translation.z}};
-            tfJson["rotation"] = {{"pan", tf.rotation.pan}, {"tilt", tf.rotation.tilt}, {"roll", tf.rotation.roll}};
-            assignJson(tfJson, "transformId", tf.transformId);
-            assignJson(tfJson, "parentTransformId", tf.parentTransformId);
-            if (tf.scale.has_value())
-            {
-                tfJson["scale"] = {{"x", tf.scale->x}, {"y", tf.scale->y}, {"z", tf.scale->z}};
-            }
-            
-            baseJson["transforms"].push_back(tfJson);
+            baseJson["transforms"].push_back(transformToJson(tf));
         }
     }
-
-    void OpenTrackIOSample::warnForRemainingFields(const nlohmann::json &json)
-    {
-        const std::function<void(const nlohmann::json&)> iterateItemsAndWarn = [&](const nlohmann::json& currentRoot){
-            if (!currentRoot.is_object() || std::distance(currentRoot.items().begin(), currentRoot.items().end()) == 0)
-            {
-                return;
-            }
-            
-            for (const auto& [key, val] : currentRoot.items())
-            {
-                if (key != "static")
-                {
-                    m_warningMessages.push_back(std::format("Key: {} was still remaining after parsing.", key));    
-                }
-                iterateItemsAndWarn(val);
-            }
-        };
-        
-        iterateItemsAndWarn(json);
-    }
 } // namespace opentrackio
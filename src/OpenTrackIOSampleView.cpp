@@ -0,0 +1,159 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOSampleView.h"
+
+namespace opentrackio
+{
+    bool OpenTrackIOSampleView::open(std::string_view jsonString, const ParseOptions& options)
+    {
+        // Forget the previous document before parsing, so that if the parse throws nothing from it is returned.
+        m_open = false;
+        m_decoded = 0;
+        m_tape.parseJson(jsonString);
+        opened(options);
+        return true;
+    }
+
+    bool OpenTrackIOSampleView::open(std::span<const uint8_t> cbor, const ParseOptions& options)
+    {
+        m_open = false;
+        m_decoded = 0;
+        m_tape.parseCbor(cbor);
+        opened(options);
+        return true;
+    }
+
+    bool OpenTrackIOSampleView::open(const PacketPayload& payload, const ParseOptions& options)
+    {
+        if (payload.encoding == PacketEncoding::JSON)
+        {
+            const std::string_view text{reinterpret_cast<const char*>(payload.data.data()), payload.data.size()};
+            return open(text, options);
+        }
+        return open(payload.data, options);
+    }
+
+    void OpenTrackIOSampleView::opened(const ParseOptions& options)
+    {
+        m_open = true;
+        m_consumedFields.clear();
+        m_diagnostics.configure(options.structuredDiagnostics, options.collectWarnings);
+        m_diagnostics.clear();
+    }
+
+    bool OpenTrackIOSampleView::contains(std::string_view key) const
+    {
+        return m_open && m_tape.root().contains(key);
+    }
+
+    template<typename T>
+    const std::optional<T>& OpenTrackIOSampleView::decode(Property property, std::optional<T>& out) const
+    {
+        const uint32_t bit = 1u << static_cast<uint32_t>(property);
+        if ((m_decoded & bit) != 0)
+        {
+            return out;
+        }
+
+        m_decoded |= bit;
+        if (!m_open)
+        {
+            out = std::nullopt;
+            return out;
+        }
+
+        ParseContext ctx{m_diagnostics, m_consumedFields};
+        T::parse(m_tape.root(), ctx, out);
+        return out;
+    }
+
+    const std::optional<opentrackioproperties::Camera>& OpenTrackIOSampleView::camera() const
+    {
+        return decode(Property::CAMERA, m_camera);
+    }
+
+    const std::optional<opentrackioproperties::Duration>& OpenTrackIOSampleView::duration() const
+    {
+        return decode(Property::DURATION, m_duration);
+    }
+
+    const std::optional<opentrackioproperties::GlobalStage>& OpenTrackIOSampleView::globalStage() const
+    {
+        return decode(Property::GLOBAL_STAGE, m_globalStage);
+    }
+
+    const std::optional<opentrackioproperties::Lens>& OpenTrackIOSampleView::lens() const
+    {
+        return decode(Property::LENS, m_lens);
+    }
+
+    const std::optional<opentrackioproperties::Protocol>& OpenTrackIOSampleView::protocol() const
+    {
+        return decode(Property::PROTOCOL, m_protocol);
+    }
+
+    const std::optional<opentrackioproperties::RelatedSampleIds>& OpenTrackIOSampleView::relatedSampleIds() const
+    {
+        return decode(Property::RELATED_SAMPLE_IDS, m_relatedSampleIds);
+    }
+
+    const std::optional<opentrackioproperties::SampleId>& OpenTrackIOSampleView::sampleId() const
+    {
+        return decode(Property::SAMPLE_ID, m_sampleId);
+    }
+
+    const std::optional<opentrackioproperties::SourceId>& OpenTrackIOSampleView::sourceId() const
+    {
+        return decode(Property::SOURCE_ID, m_sourceId);
+    }
+
+    const std::optional<opentrackioproperties::SourceNumber>& OpenTrackIOSampleView::sourceNumber() const
+    {
+        return decode(Property::SOURCE_NUMBER, m_sourceNumber);
+    }
+
+    const std::optional<opentrackioproperties::Timing>& OpenTrackIOSampleView::timing() const
+    {
+        return decode(Property::TIMING, m_timing);
+    }
+
+    const std::optional<opentrackioproperties::Tracker>& OpenTrackIOSampleView::tracker() const
+    {
+        return decode(Property::TRACKER, m_tracker);
+    }
+
+    const std::optional<opentrackioproperties::Transforms>& OpenTrackIOSampleView::transforms() const
+    {
+        return decode(Property::TRANSFORMS, m_transforms);
+    }
+
+    void OpenTrackIOSampleView::copyTo(OpenTrackIOSample& sample) const
+    {
+        // Drops any JSON the sample generated for its previous properties.
+        sample.reset();
+        sample.camera = camera();
+        sample.duration = duration();
+        sample.globalStage = globalStage();
+        sample.lens = lens();
+        sample.protocol = protocol();
+        sample.relatedSampleIds = relatedSampleIds();
+        sample.sampleId = sampleId();
+        sample.sourceId = sourceId();
+        sample.sourceNumber = sourceNumber();
+        sample.timing = timing();
+        sample.tracker = tracker();
+        sample.transforms = transforms();
+        sample.staticProperties = nullptr;
+    }
+} // namespace opentrackio
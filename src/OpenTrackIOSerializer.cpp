@@ -0,0 +1,1013 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+/**
+ * Writes an OpenTrackIOSample straight into a caller supplied buffer as JSON text or CBOR. The output matches
+ * getJson().dump() and nlohmann::json::to_cbor(getJson()) byte for byte, which means members are written in the
+ * same sorted key order as the nlohmann object map and numbers use the same encodings. */
+namespace opentrackio
+{
+    namespace
+    {
+        constexpr std::size_t MAX_DEPTH = 16;
+
+        class JsonBackend
+        {
+        public:
+            explicit JsonBackend(std::span<char> buffer) : m_buffer{buffer} {};
+
+            void key(std::string_view key)
+            {
+                separator();
+                string(key);
+                put(':');
+                m_afterKey = true;
+            }
+
+            void beginObject()
+            {
+                beginContainer('{');
+            }
+
+            void endObject()
+            {
+                endContainer('}');
+            }
+
+            void beginArray(std::size_t)
+            {
+                beginContainer('[');
+            }
+
+            void endArray()
+            {
+                endContainer(']');
+            }
+
+            void null()
+            {
+                beginValue();
+                put("null");
+            }
+
+            void value(bool val)
+            {
+                beginValue();
+                put(val ? std::string_view{"true"} : std::string_view{"false"});
+            }
+
+            void value(uint64_t val)
+            {
+                beginValue();
+                digits(val);
+            }
+
+            void value(int64_t val)
+            {
+                beginValue();
+                if (val < 0)
+                {
+                    put('-');
+                }
+                digits(val < 0 ? static_cast<uint64_t>(0) - static_cast<uint64_t>(val) : static_cast<uint64_t>(val));
+            }
+
+            void value(double val)
+            {
+                beginValue();
+                if (!std::isfinite(val))
+                {
+                    put("null");
+                    return;
+                }
+
+                std::array<char, 64> number{};
+                const char* end = nlohmann::detail::to_chars(number.data(), number.data() + number.size(), val);
+                put(std::string_view{number.data(), static_cast<std::size_t>(end - number.data())});
+            }
+
+            void value(std::string_view val)
+            {
+                beginValue();
+                string(val);
+            }
+
+            [[nodiscard]] bool failed() const { return m_failed; }
+            [[nodiscard]] std::size_t size() const { return m_size; }
+
+        private:
+            void beginValue()
+            {
+                if (!m_afterKey)
+                {
+                    separator();
+                }
+                m_afterKey = false;
+            }
+
+            void digits(uint64_t val)
+            {
+                std::array<char, 20> reversed{};
+                std::size_t count = 0;
+                do
+                {
+                    reversed[count++] = static_cast<char>('0' + val % 10);
+                    val /= 10;
+                } while (val != 0);
+
+                while (count > 0)
+                {
+                    put(reversed[--count]);
+                }
+            }
+
+            void separator()
+            {
+                if (m_depth > 0)
+                {
+                    if (!m_first[m_depth - 1])
+                    {
+                        put(',');
+                    }
+                    m_first[m_depth - 1] = false;
+                }
+            }
+
+            void beginContainer(char open)
+            {
+                beginValue();
+                put(open);
+                if (m_depth == MAX_DEPTH)
+                {
+                    m_failed = true;
+                    return;
+                }
+                m_first[m_depth++] = true;
+            }
+
+            void endContainer(char close)
+            {
+                put(close);
+                if (m_depth > 0)
+                {
+                    --m_depth;
+                }
+            }
+
+            void put(char c)
+            {
+                if (m_size >= m_buffer.size())
+                {
+                    m_failed = true;
+                    return;
+                }
+                m_buffer[m_size++] = c;
+            }
+
+            void put(std::string_view str)
+            {
+                if (m_buffer.size() - m_size < str.size())
+                {
+                    m_failed = true;
+                    return;
+                }
+                std::memcpy(m_buffer.data() + m_size, str.data(), str.size());
+                m_size += str.size();
+            }
+
+            /**
+             * Escapes the same characters nlohmann's dump() does when ensure_ascii is off and, like its strict
+             * error handler, rejects strings that aren't valid UTF-8. */
+            void string(std::string_view str)
+            {
+                if (!isValidUtf8(str))
+                {
+                    m_failed = true;
+                    return;
+                }
+
+                constexpr std::string_view hex = "0123456789abcdef";
+                put('"');
+                for (const char c : str)
+                {
+                    switch (c)
+                    {
+                        case '\b': put("\\b"); break;
+                        case '\t': put("\\t"); break;
+                        case '\n': put("\\n"); break;
+                        case '\f': put("\\f"); break;
+                        case '\r': put("\\r"); break;
+                        case '"': put("\\\""); break;
+                        case '\\': put("\\\\"); break;
+                        default:
+                            if (static_cast<unsigned char>(c) <= 0x1F)
+                            {
+                                put("\\u00");
+                                put(hex[static_cast<unsigned char>(c) >> 4]);
+                                put(hex[static_cast<unsigned char>(c) & 0xF]);
+                            }
+                            else
+                            {
+                                put(c);
+                            }
+                    }
+                }
+                put('"');
+            }
+
+            static bool isValidUtf8(std::string_view str)
+            {
+                std::size_t i = 0;
+                while (i < str.size())
+                {
+                    const auto lead = static_cast<unsigned char>(str[i]);
+                    if (lead < 0x80)
+                    {
+                        ++i;
+                        continue;
+                    }
+
+                    std::size_t length;
+                    uint32_t codepoint;
+                    uint32_t min;
+                    if ((lead & 0xE0) == 0xC0) { length = 2; codepoint = lead & 0x1F; min = 0x80; }
+                    else if ((lead & 0xF0) == 0xE0) { length = 3; codepoint = lead & 0x0F; min = 0x800; }
+                    else if ((lead & 0xF8) == 0xF0) { length = 4; codepoint = lead & 0x07; min = 0x10000; }
+                    else { return false; }
+
+                    if (str.size() - i < length)
+                    {
+                        return false;
+                    }
+
+                    for (std::size_t j = 1; j < length; ++j)
+                    {
+                        const auto next = static_cast<unsigned char>(str[i + j]);
+                        if ((next & 0xC0) != 0x80)
+                        {
+                            return false;
+                        }
+                        codepoint = (codepoint << 6) | (next & 0x3F);
+                    }
+
+                    const bool isSurrogate = codepoint >= 0xD800 && codepoint <= 0xDFFF;
+                    if (codepoint < min || codepoint > 0x10FFFF || isSurrogate)
+                    {
+                        return false;
+                    }
+                    i += length;
+                }
+                return true;
+            }
+
+            std::span<char> m_buffer;
+            std::size_t m_size = 0;
+            bool m_failed = false;
+            bool m_afterKey = false;
+            std::array<bool, MAX_DEPTH> m_first{};
+            std::size_t m_depth = 0;
+        };
+
+        class CborBackend
+        {
+        public:
+            explicit CborBackend(std::span<uint8_t> buffer) : m_buffer{buffer} {};
+
+            void key(std::string_view key)
+            {
+                if (m_depth > 0)
+                {
+                    ++m_counts[m_depth - 1];
+                }
+                value(key);
+            }
+
+            /**
+             * No OpenTrackIO object has more than 23 members, so an object header is always a single byte and can
+             * be patched with the member count once the object is closed. */
+            void beginObject()
+            {
+                if (m_depth == MAX_DEPTH)
+                {
+                    m_failed = true;
+                    return;
+                }
+                m_headers[m_depth] = m_size;
+                m_counts[m_depth++] = 0;
+                put(0xA0);
+            }
+
+            void endObject()
+            {
+                if (m_depth == 0)
+                {
+                    return;
+                }
+
+                --m_depth;
+                if (m_counts[m_depth] > 0x17)
+                {
+                    m_failed = true;
+                    return;
+                }
+                if (m_headers[m_depth] < m_size)
+                {
+                    m_buffer[m_headers[m_depth]] = static_cast<uint8_t>(0xA0 + m_counts[m_depth]);
+                }
+            }
+
+            void beginArray(std::size_t count)
+            {
+                header(0x80, count);
+            }
+
+            void endArray() {}
+
+            void null()
+            {
+                put(0xF6);
+            }
+
+            void value(bool val)
+            {
+                put(val ? 0xF5 : 0xF4);
+            }
+
+            void value(uint64_t val)
+            {
+                header(0x00, val);
+            }
+
+            void value(int64_t val)
+            {
+                if (val >= 0)
+                {
+                    header(0x00, static_cast<uint64_t>(val));
+                }
+                else
+                {
+                    header(0x20, static_cast<uint64_t>(-1 - val));
+                }
+            }
+
+            void value(double val)
+            {
+                if (std::isnan(val))
+                {
+                    put(0xF9);
+                    put(0x7E);
+                    put(0x00);
+                }
+                else if (std::isinf(val))
+                {
+                    put(0xF9);
+                    put(val > 0 ? 0x7C : 0xFC);
+                    put(0x00);
+                }
+                else if (val >= static_cast<double>(std::numeric_limits<float>::lowest()) &&
+                         val <= static_cast<double>(std::numeric_limits<float>::max()) &&
+                         static_cast<double>(static_cast<float>(val)) == val)
+                {
+                    put(0xFA);
+                    bigEndian(std::bit_cast<uint32_t>(static_cast<float>(val)), 4);
+                }
+                else
+                {
+                    put(0xFB);
+                    bigEndian(std::bit_cast<uint64_t>(val), 8);
+                }
+            }
+
+            void value(std::string_view val)
+            {
+                header(0x60, val.size());
+                if (m_buffer.size() - m_size < val.size())
+                {
+                    m_failed = true;
+                    return;
+                }
+                std::memcpy(m_buffer.data() + m_size, val.data(), val.size());
+                m_size += val.size();
+            }
+
+            [[nodiscard]] bool failed() const { return m_failed; }
+            [[nodiscard]] std::size_t size() const { return m_size; }
+
+        private:
+            void header(uint8_t majorType, uint64_t val)
+            {
+                if (val <= 0x17)
+                {
+                    put(static_cast<uint8_t>(majorType + val));
+                }
+                else if (val <= std::numeric_limits<uint8_t>::max())
+                {
+                    put(static_cast<uint8_t>(majorType + 0x18));
+                    bigEndian(val, 1);
+                }
+                else if (val <= std::numeric_limits<uint16_t>::max())
+                {
+                    put(static_cast<uint8_t>(majorType + 0x19));
+                    bigEndian(val, 2);
+                }
+                else if (val <= std::numeric_limits<uint32_t>::max())
+                {
+                    put(static_cast<uint8_t>(majorType + 0x1A));
+                    bigEndian(val, 4);
+                }
+                else
+                {
+                    put(static_cast<uint8_t>(majorType + 0x1B));
+                    bigEndian(val, 8);
+                }
+            }
+
+            void bigEndian(uint64_t val, std::size_t bytes)
+            {
+                for (std::size_t i = bytes; i > 0; --i)
+                {
+                    put(static_cast<uint8_t>(val >> ((i - 1) * 8)));
+                }
+            }
+
+            void put(uint8_t byte)
+            {
+                if (m_size >= m_buffer.size())
+                {
+                    m_failed = true;
+                    return;
+                }
+                m_buffer[m_size++] = byte;
+            }
+
+            std::span<uint8_t> m_buffer;
+            std::size_t m_size = 0;
+            bool m_failed = false;
+            std::array<std::size_t, MAX_DEPTH> m_headers{};
+            std::array<std::size_t, MAX_DEPTH> m_counts{};
+            std::size_t m_depth = 0;
+        };
+
+        /**
+         * Sits on top of a backend and only opens an object once its first member is written. Objects that end up
+         * with no members are never emitted, which matches generateJson() where empty objects aren't created. */
+        template<typename Backend>
+        class SampleWriter
+        {
+        public:
+            explicit SampleWriter(Backend& backend) : m_backend{backend} {};
+
+            void beginObject(std::string_view key = {})
+            {
+                push(key, false);
+            }
+
+            void endObject()
+            {
+                const auto& frame = m_frames[--m_depth];
+                if (frame.open)
+                {
+                    m_backend.endObject();
+                }
+            }
+
+            void beginArray(std::string_view key, std::size_t count)
+            {
+                flush();
+                m_backend.key(key);
+                m_backend.beginArray(count);
+                push(key, true);
+            }
+
+            void endArray()
+            {
+                --m_depth;
+                m_backend.endArray();
+            }
+
+            template<typename T>
+            void field(std::string_view key, const T& val)
+            {
+                flush();
+                m_backend.key(key);
+                write(val);
+            }
+
+            template<typename T>
+            void field(std::string_view key, const std::optional<T>& val)
+            {
+                if (val.has_value())
+                {
+                    field(key, val.value());
+                }
+            }
+
+            template<typename T>
+            void element(const T& val)
+            {
+                write(val);
+            }
+
+            /**
+             * Finishes the root object, an empty sample is written as null like a default constructed DOM. */
+            void finish()
+            {
+                const bool rootOpen = m_frames[0].open;
+                endObject();
+                if (!rootOpen)
+                {
+                    m_backend.null();
+                }
+            }
+
+            [[nodiscard]] bool failed() const { return m_failed || m_backend.failed(); }
+
+        private:
+            struct Frame
+            {
+                std::string_view key{};
+                bool open = false;
+            };
+
+            void push(std::string_view key, bool open)
+            {
+                if (m_depth == MAX_DEPTH)
+                {
+                    m_failed = true;
+                    return;
+                }
+                m_frames[m_depth++] = Frame{key, open};
+            }
+
+            void flush()
+            {
+                for (std::size_t i = 0; i < m_depth; ++i)
+                {
+                    auto& frame = m_frames[i];
+                    if (!frame.open)
+                    {
+                        // Object frames directly inside an array or at the root don't have a key.
+                        if (!frame.key.empty())
+                        {
+                            m_backend.key(frame.key);
+                        }
+                        m_backend.beginObject();
+                        frame.open = true;
+                    }
+                }
+            }
+
+            void write(bool val) { m_backend.value(val); }
+            void write(double val) { m_backend.value(val); }
+            void write(int64_t val) { m_backend.value(val); }
+            void write(uint64_t val) { m_backend.value(val); }
+            void write(uint32_t val) { m_backend.value(static_cast<uint64_t>(val)); }
+            void write(uint16_t val) { m_backend.value(static_cast<uint64_t>(val)); }
+            void write(uint8_t val) { m_backend.value(static_cast<uint64_t>(val)); }
+            void write(const std::string& val) { m_backend.value(std::string_view{val}); }
+            void write(std::string_view val) { m_backend.value(val); }
+            void write(const char* val) { m_backend.value(std::string_view{val}); }
+
+            void write(const opentrackiotypes::UrnUuid& val)
+            {
+                const auto chars = val.toChars();
+                m_backend.value(std::string_view{chars.data(), chars.size()});
+            }
+
+            void write(std::span<const double> vals)
+            {
+                m_backend.beginArray(vals.size());
+                for (const double val : vals)
+                {
+                    m_backend.value(val);
+                }
+                m_backend.endArray();
+            }
+
+            Backend& m_backend;
+            std::array<Frame, MAX_DEPTH> m_frames{};
+            std::size_t m_depth = 0;
+            bool m_failed = false;
+        };
+
+        template<typename W>
+        void writeRational(W& w, std::string_view key, const opentrackiotypes::Rational& rational)
+        {
+            w.beginObject(key);
+            w.field("denom", rational.denominator);
+            w.field("num", rational.numerator);
+            w.endObject();
+        }
+
+        template<typename W>
+        void writeRational(W& w, std::string_view key, const std::optional<opentrackiotypes::Rational>& rational)
+        {
+            if (rational.has_value())
+            {
+                writeRational(w, key, rational.value());
+            }
+        }
+
+        template<typename W, typename T>
+        void writeDimensions(W& w, std::string_view key, const std::optional<opentrackiotypes::Dimensions<T>>& dims)
+        {
+            if (dims.has_value())
+            {
+                w.beginObject(key);
+                w.field("height", dims->height);
+                w.field("width", dims->width);
+                w.endObject();
+            }
+        }
+
+        template<typename W>
+        void writeTimestamp(W& w, std::string_view key, const std::optional<opentrackiotypes::Timestamp>& ts)
+        {
+            if (ts.has_value())
+            {
+                w.beginObject(key);
+                w.field("attoseconds", ts->attoseconds);
+                w.field("nanoseconds", ts->nanoseconds);
+                w.field("seconds", ts->seconds);
+                w.endObject();
+            }
+        }
+
+        template<typename W>
+        void writeVector3(W& w, std::string_view key, const opentrackiotypes::Vector3& vec)
+        {
+            w.beginObject(key);
+            w.field("x", vec.x);
+            w.field("y", vec.y);
+            w.field("z", vec.z);
+            w.endObject();
+        }
+
+        template<typename W, typename T>
+        void writeXY(W& w, std::string_view key, const std::optional<T>& shift)
+        {
+            if (shift.has_value())
+            {
+                w.beginObject(key);
+                w.field("x", shift->x);
+                w.field("y", shift->y);
+                w.endObject();
+            }
+        }
+
+        template<typename W, typename T>
+        void writeEncoders(W& w, std::string_view key, const std::optional<T>& encoders)
+        {
+            if (encoders.has_value())
+            {
+                w.beginObject(key);
+                w.field("focus", encoders->focus);
+                w.field("iris", encoders->iris);
+                w.field("zoom", encoders->zoom);
+                w.endObject();
+            }
+        }
+
+        template<typename W, typename T>
+        void writeCoefficients(W& w, std::string_view key, const std::optional<T>& coefficients)
+        {
+            if (coefficients.has_value())
+            {
+                w.beginObject(key);
+                w.field("radial", coefficients->radial);
+                w.field("tangential", coefficients->tangential);
+                w.endObject();
+            }
+        }
+
+        template<typename W, typename T>
+        void writeField(W& w, std::string_view key, const T& value)
+        {
+            w.field(key, value);
+        }
+
+        template<typename W>
+        void writeField(W& w, std::string_view key, const std::optional<opentrackiotypes::Rational>& value)
+        {
+            writeRational(w, key, value);
+        }
+
+        template<typename W, typename T>
+        void writeField(W& w, std::string_view key, const std::optional<opentrackiotypes::Dimensions<T>>& value)
+        {
+            writeDimensions(w, key, value);
+        }
+
+        /**
+         * Writes every described field of scope S, descriptors list them in the sorted order written here. */
+        template<schema::Scope S, typename W, typename T>
+        void writeFields(W& w, const T& value)
+        {
+            schema::forEachField<T, S>([&](auto field)
+            {
+                using F = decltype(field);
+                writeField(w, F::key, value.*F::member);
+            });
+        }
+
+        template<typename W>
+        void writeStatic(W& w, const OpenTrackIOSample& sample)
+        {
+            w.beginObject("static");
+
+            if (const auto& camera = sample.camera; camera.has_value())
+            {
+                w.beginObject("camera");
+                writeFields<schema::Scope::STATIC>(w, camera.value());
+                w.endObject();
+            }
+
+            if (sample.duration.has_value())
+            {
+                writeRational(w, "duration", sample.duration->rational);
+            }
+
+            if (const auto& lens = sample.lens; lens.has_value())
+            {
+                w.beginObject("lens");
+                writeFields<schema::Scope::STATIC>(w, lens.value());
+                w.endObject();
+            }
+
+            if (const auto& tracker = sample.tracker; tracker.has_value())
+            {
+                w.beginObject("tracker");
+                writeFields<schema::Scope::STATIC>(w, tracker.value());
+                w.endObject();
+            }
+
+            w.endObject();
+        }
+
+        template<typename W>
+        void writeLens(W& w, const opentrackioproperties::Lens& lens)
+        {
+            w.beginObject("lens");
+            w.field("custom", lens.custom);
+            writeCoefficients(w, "distortion", lens.distortion);
+            w.field("distortionOverscan", lens.distortionOverscan);
+            writeXY(w, "distortionShift", lens.distortionShift);
+            writeEncoders(w, "encoders", lens.encoders);
+            w.field("entrancePupilOffset", lens.entrancePupilOffset);
+
+            if (lens.exposureFalloff.has_value())
+            {
+                w.beginObject("exposureFalloff");
+                w.field("a1", lens.exposureFalloff->a1);
+                w.field("a2", lens.exposureFalloff->a2);
+                w.field("a3", lens.exposureFalloff->a3);
+                w.endObject();
+            }
+
+            w.field("fStop", lens.fStop);
+            w.field("focalLength", lens.focalLength);
+            w.field("focusDistance", lens.focusDistance);
+            writeXY(w, "perspectiveShift", lens.perspectiveShift);
+            writeEncoders(w, "rawEncoders", lens.rawEncoders);
+            w.field("tStop", lens.tStop);
+            writeCoefficients(w, "undistortion", lens.undistortion);
+            w.endObject();
+        }
+
+        template<typename W>
+        void writeTiming(W& w, const opentrackioproperties::Timing& timing)
+        {
+            using Sync = opentrackioproperties::Timing::Synchronization;
+
+            w.beginObject("timing");
+            writeRational(w, "frameRate", timing.frameRate);
+            if (timing.mode.has_value())
+            {
+                w.field("mode", timing.mode.value() == opentrackioproperties::Timing::Mode::INTERNAL ?
+                                "internal" : "external");
+            }
+            writeTimestamp(w, "recordedTimestamp", timing.recordedTimestamp);
+            writeTimestamp(w, "sampleTimestamp", timing.sampleTimestamp);
+            w.field("sequenceNumber", timing.sequenceNumber);
+
+            if (const auto& sync = timing.synchronization; sync.has_value())
+            {
+                w.beginObject("synchronization");
+                writeRational(w, "frequency", sync->frequency);
+                w.field("locked", sync->locked);
+
+                if (sync->offsets.has_value())
+                {
+                    w.beginObject("offsets");
+                    w.field("lensEncoders", sync->offsets->lensEncoders);
+                    w.field("rotation", sync->offsets->rotation);
+                    w.field("translation", sync->offsets->translation);
+                    w.endObject();
+                }
+
+                w.field("present", sync->present);
+
+                if (sync->ptp.has_value())
+                {
+                    w.beginObject("ptp");
+                    w.field("domain", sync->ptp->domain);
+                    w.field("master", sync->ptp->master);
+                    w.field("offset", sync->ptp->offset);
+                    w.endObject();
+                }
+
+                switch (sync->source)
+                {
+                    case Sync::SourceType::GEN_LOCK:
+                        w.field("source", "genlock");
+                        break;
+                    case Sync::SourceType::VIDEO_IN:
+                        w.field("source", "videoIn");
+                        break;
+                    case Sync::SourceType::PTP:
+                        w.field("source", "ptp");
+                        break;
+                    case Sync::SourceType::NTP:
+                        w.field("source", "ntp");
+                        break;
+                }
+                w.endObject();
+            }
+
+            if (const auto& tc = timing.timecode; tc.has_value())
+            {
+                w.beginObject("timecode");
+                w.beginObject("format");
+                w.field("dropFrame", tc->format.dropFrame);
+                writeRational(w, "frameRate", tc->format.frameRate);
+                w.field("oddField", tc->format.oddField);
+                w.endObject();
+                w.field("frames", tc->frames);
+                w.field("hours", tc->hours);
+                w.field("minutes", tc->minutes);
+                w.field("seconds", tc->seconds);
+                w.endObject();
+            }
+            w.endObject();
+        }
+
+        template<typename W>
+        void writeSample(W& w, const OpenTrackIOSample& sample)
+        {
+            w.beginObject();
+
+            if (const auto& gs = sample.globalStage; gs.has_value())
+            {
+                w.beginObject("globalStage");
+                w.field("E", gs->e);
+                w.field("N", gs->n);
+                w.field("U", gs->u);
+                w.field("h0", gs->h0);
+                w.field("lat0", gs->lat0);
+                w.field("lon0", gs->lon0);
+                w.endObject();
+            }
+
+            if (sample.lens.has_value())
+            {
+                writeLens(w, sample.lens.value());
+            }
+
+            if (sample.protocol.has_value())
+            {
+                w.beginObject("protocol");
+                w.field("name", sample.protocol->name);
+                w.field("version", sample.protocol->version);
+                w.endObject();
+            }
+
+            if (sample.relatedSampleIds.has_value())
+            {
+                const auto& samples = sample.relatedSampleIds->samples;
+                w.beginArray("relatedSampleIds", samples.size());
+                for (const auto& id : samples)
+                {
+                    w.element(id);
+                }
+                w.endArray();
+            }
+
+            if (sample.sampleId.has_value())
+            {
+                w.field("sampleId", sample.sampleId->id);
+            }
+
+            if (sample.sourceId.has_value())
+            {
+                w.field("sourceId", sample.sourceId->id);
+            }
+
+            if (sample.sourceNumber.has_value())
+            {
+                w.field("sourceNumber", sample.sourceNumber->value);
+            }
+
+            writeStatic(w, sample);
+
+            if (sample.timing.has_value())
+            {
+                writeTiming(w, sample.timing.value());
+            }
+
+            if (const auto& tracker = sample.tracker; tracker.has_value())
+            {
+                w.beginObject("tracker");
+                writeFields<schema::Scope::DYNAMIC>(w, tracker.value());
+                w.endObject();
+            }
+
+            if (sample.transforms.has_value())
+            {
+                const auto& tfs = sample.transforms->transforms;
+                w.beginArray("transforms", tfs.size());
+                for (const auto& tf : tfs)
+                {
+                    w.beginObject();
+                    w.field("parentTransformId", tf.parentTransformId);
+                    w.beginObject("rotation");
+                    w.field("pan", tf.rotation.pan);
+                    w.field("roll", tf.rotation.roll);
+                    w.field("tilt", tf.rotation.tilt);
+                    w.endObject();
+                    if (tf.scale.has_value())
+                    {
+                        writeVector3(w, "scale", tf.scale.value());
+                    }
+                    w.field("transformId", tf.transformId);
+                    writeVector3(w, "translation", tf.translation);
+                    w.endObject();
+                }
+                w.endArray();
+            }
+
+            w.finish();
+        }
+    } // namespace
+
+    std::optional<std::size_t> OpenTrackIOSample::serializeJson(std::span<char> buffer,
+                                                                Instrumentation* instrumentation) const
+    {
+        PhaseTimer timer{};
+        timer.start(instrumentation, 0);
+        JsonBackend backend{buffer};
+        SampleWriter writer{backend};
+        writeSample(writer, *this);
+        timer.lap(InstrumentedPhase::SERIALISE);
+
+        if (writer.failed())
+        {
+            timer.finish();
+            return std::nullopt;
+        }
+        if (Instrumentation* recorder = timer.finish())
+        {
+            timer.measurement().bytes = backend.size();
+            recorder->recordSerialise(*this, timer.measurement());
+        }
+        return backend.size();
+    }
+
+    std::optional<std::size_t> OpenTrackIOSample::serializeCbor(std::span<uint8_t> buffer,
+                                                                Instrumentation* instrumentation) const
+    {
+        PhaseTimer timer{};
+        timer.start(instrumentation, 0);
+        CborBackend backend{buffer};
+        SampleWriter writer{backend};
+        writeSample(writer, *this);
+        timer.lap(InstrumentedPhase::SERIALISE);
+
+        if (writer.failed())
+        {
+            timer.finish();
+            return std::nullopt;
+        }
+        if (Instrumentation* recorder = timer.finish())
+        {
+            timer.measurement().bytes = backend.size();
+            recorder->recordSerialise(*this, timer.measurement());
+        }
+        return backend.size();
+    }
+} // namespace opentrackio
@@ -0,0 +1,138 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOSnapshot.h"
+#include <algorithm>
+
+namespace opentrackio
+{
+    namespace
+    {
+        uint32_t bit(SnapshotField field)
+        {
+            return 1u << static_cast<uint32_t>(field);
+        }
+
+        void setLens(TrackingSnapshot& snapshot, LensValue value, const std::optional<double>& field)
+        {
+            if (field.has_value())
+            {
+                snapshot.lens[static_cast<std::size_t>(value)] = field.value();
+                snapshot.lensValid |= 1u << static_cast<uint32_t>(value);
+            }
+        }
+
+        template<typename T, std::size_t N>
+        bool copyCoefficients(const T& from, std::array<double, N>& to, uint8_t& count)
+        {
+            count = static_cast<uint8_t>(std::min(from.size(), N));
+            std::copy_n(from.begin(), count, to.begin());
+            return from.size() <= N;
+        }
+
+        template<typename Coefficients>
+        void setCoefficients(TrackingSnapshot& snapshot, SnapshotField field, const std::optional<Coefficients>& from,
+                             TrackingSnapshot::Coefficients& to)
+        {
+            if (!from.has_value())
+            {
+                return;
+            }
+
+            snapshot.present |= bit(field);
+            bool fits = copyCoefficients(from->radial, to.radial, to.radialCount);
+            if (from->tangential.has_value())
+            {
+                fits = copyCoefficients(from->tangential.value(), to.tangential, to.tangentialCount) && fits;
+            }
+            if (!fits)
+            {
+                snapshot.overflow |= bit(field);
+            }
+        }
+    } // namespace
+
+    void TrackingSnapshot::captureTiming(const opentrackioproperties::Timing& timing)
+    {
+        if (timing.sampleTimestamp.has_value())
+        {
+            present |= bit(SnapshotField::SAMPLE_TIMESTAMP);
+            sampleTimestamp = timing.sampleTimestamp.value();
+        }
+        if (timing.sequenceNumber.has_value())
+        {
+            present |= bit(SnapshotField::SEQUENCE_NUMBER);
+            sequenceNumber = timing.sequenceNumber.value();
+        }
+        if (timing.frameRate.has_value())
+        {
+            present |= bit(SnapshotField::FRAME_RATE);
+            frameRate = timing.frameRate.value();
+        }
+    }
+
+    void TrackingSnapshot::captureLens(const opentrackioproperties::Lens& sampleLens)
+    {
+        setLens(*this, LensValue::FOCAL_LENGTH, sampleLens.focalLength);
+        setLens(*this, LensValue::FOCUS_DISTANCE, sampleLens.focusDistance);
+        setLens(*this, LensValue::F_STOP, sampleLens.fStop);
+        setLens(*this, LensValue::T_STOP, sampleLens.tStop);
+        setLens(*this, LensValue::ENTRANCE_PUPIL_OFFSET, sampleLens.entrancePupilOffset);
+        if (sampleLens.encoders.has_value())
+        {
+            setLens(*this, LensValue::ENCODER_FOCUS, sampleLens.encoders->focus);
+            setLens(*this, LensValue::ENCODER_IRIS, sampleLens.encoders->iris);
+            setLens(*this, LensValue::ENCODER_ZOOM, sampleLens.encoders->zoom);
+        }
+
+        if (sampleLens.distortionOverscan.has_value())
+        {
+            present |= bit(SnapshotField::DISTORTION_OVERSCAN);
+            distortionOverscan = sampleLens.distortionOverscan.value();
+        }
+        if (sampleLens.distortionShift.has_value())
+        {
+            present |= bit(SnapshotField::DISTORTION_SHIFT);
+            distortionShift = {sampleLens.distortionShift->x, sampleLens.distortionShift->y};
+        }
+        if (sampleLens.perspectiveShift.has_value())
+        {
+            present |= bit(SnapshotField::PERSPECTIVE_SHIFT);
+            perspectiveShift = {sampleLens.perspectiveShift->x, sampleLens.perspectiveShift->y};
+        }
+        setCoefficients(*this, SnapshotField::DISTORTION, sampleLens.distortion, distortion);
+        setCoefficients(*this, SnapshotField::UNDISTORTION, sampleLens.undistortion, undistortion);
+    }
+
+    void TrackingSnapshot::captureTransforms(const opentrackioproperties::Transforms& sampleTransforms)
+    {
+        const auto& from = sampleTransforms.transforms;
+        present |= bit(SnapshotField::TRANSFORMS);
+        if (from.size() > MAX_TRANSFORMS)
+        {
+            overflow |= bit(SnapshotField::TRANSFORMS);
+        }
+
+        transformCount = static_cast<uint32_t>(std::min(from.size(), MAX_TRANSFORMS));
+        for (std::size_t i = 0; i < transformCount; ++i)
+        {
+            auto& to = transforms[i];
+            to.translation = {from[i].translation.x, from[i].translation.y, from[i].translation.z};
+            to.rotation = {from[i].rotation.pan, from[i].rotation.tilt, from[i].rotation.roll};
+            if (from[i].scale.has_value())
+            {
+                to.scale = {from[i].scale->x, from[i].scale->y, from[i].scale->z};
+            }
+        }
+    }
+} // namespace opentrackio
@@ -0,0 +1,50 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOStaticCache.h"
+
+namespace opentrackio
+{
+    std::shared_ptr<const StaticProperties> StaticCache::find(const opentrackiotypes::UrnUuid& sourceId) const
+    {
+        const auto it = m_sources.find(sourceId);
+        if (it == m_sources.end())
+        {
+            return nullptr;
+        }
+        return it->second.properties;
+    }
+
+    std::shared_ptr<const StaticProperties> StaticCache::find(const opentrackiotypes::UrnUuid& sourceId,
+                                                               std::string_view block) const
+    {
+        const auto it = m_sources.find(sourceId);
+        if (it == m_sources.end() || it->second.block != block)
+        {
+            return nullptr;
+        }
+        return it->second.properties;
+    }
+
+    void StaticCache::store(const opentrackiotypes::UrnUuid& sourceId, std::string_view block,
+                            std::shared_ptr<const StaticProperties> properties)
+    {
+        auto it = m_sources.find(sourceId);
+        if (it == m_sources.end())
+        {
+            it = m_sources.emplace(sourceId, Entry{}).first;
+        }
+        it->second.block.assign(block);
+        it->second.properties = std::move(properties);
+    }
+} // namespace opentrackio
@@ -0,0 +1,375 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOTakeStore.h"
+#include <algorithm>
+
+namespace opentrackio
+{
+    namespace
+    {
+        // CBOR for an empty map, what a sample without any properties serialises to.
+        constexpr uint8_t EMPTY_SAMPLE[] = {0xA0};
+
+        template<typename T>
+        void assignId(std::optional<T>& out, std::optional<opentrackiotypes::UrnUuid> id)
+        {
+            if (!id.has_value())
+            {
+                out = std::nullopt;
+                return;
+            }
+            out = T{id.value()};
+        }
+
+        template<typename T>
+        T& engage(std::optional<T>& out)
+        {
+            return out.has_value() ? out.value() : out.emplace();
+        }
+    } // namespace
+
+    void copyResidualProperties(const OpenTrackIOSample& sample, OpenTrackIOSample& residual)
+    {
+        residual.camera = sample.camera;
+        residual.duration = sample.duration;
+        residual.globalStage = sample.globalStage;
+        residual.protocol = sample.protocol;
+        residual.relatedSampleIds = sample.relatedSampleIds;
+
+        residual.lens = sample.lens;
+        if (residual.lens.has_value())
+        {
+            auto& lens = residual.lens.value();
+            lens.entrancePupilOffset = std::nullopt;
+            lens.fStop = std::nullopt;
+            lens.focalLength = std::nullopt;
+            lens.focusDistance = std::nullopt;
+            lens.tStop = std::nullopt;
+            lens.encoders = std::nullopt;
+            lens.rawEncoders = std::nullopt;
+        }
+
+        residual.timing = sample.timing;
+        if (residual.timing.has_value())
+        {
+            auto& timing = residual.timing.value();
+            timing.sampleTimestamp = std::nullopt;
+            timing.recordedTimestamp = std::nullopt;
+            timing.sequenceNumber = std::nullopt;
+            timing.timecode = std::nullopt;
+        }
+
+        residual.tracker = sample.tracker;
+        if (residual.tracker.has_value())
+        {
+            auto& tracker = residual.tracker.value();
+            tracker.notes = std::nullopt;
+            tracker.recording = std::nullopt;
+            tracker.slate = std::nullopt;
+            tracker.status = std::nullopt;
+        }
+    }
+
+    void TakeStore::append(const OpenTrackIOSample& sample)
+    {
+        auto& columns = m_columns;
+        uint8_t present = 0;
+
+        columns.sampleId.push(sample.sampleId.has_value()
+                              ? std::optional<opentrackiotypes::UrnUuid>{sample.sampleId->id} : std::nullopt);
+        columns.sourceId.push(sample.sourceId.has_value()
+                              ? std::optional<opentrackiotypes::UrnUuid>{sample.sourceId->id} : std::nullopt);
+        columns.sourceNumber.push(sample.sourceNumber.has_value()
+                                  ? std::optional<uint32_t>{sample.sourceNumber->value} : std::nullopt);
+
+        const auto* timing = sample.timing.has_value() ? &sample.timing.value() : nullptr;
+        present |= timing != nullptr ? TIMING : 0;
+        columns.timing.sampleTimestamp.push(timing != nullptr ? timing->sampleTimestamp : std::nullopt);
+        columns.timing.recordedTimestamp.push(timing != nullptr ? timing->recordedTimestamp : std::nullopt);
+        columns.timing.sequenceNumber.push(timing != nullptr ? timing->sequenceNumber : std::nullopt);
+        columns.timing.timecode.push(timing != nullptr ? timing->timecode : std::nullopt);
+
+        const auto* lens = sample.lens.has_value() ? &sample.lens.value() : nullptr;
+        present |= lens != nullptr ? LENS : 0;
+        columns.lens.entrancePupilOffset.push(lens != nullptr ? lens->entrancePupilOffset : std::nullopt);
+        columns.lens.fStop.push(lens != nullptr ? lens->fStop : std::nullopt);
+        columns.lens.focalLength.push(lens != nullptr ? lens->focalLength : std::nullopt);
+        columns.lens.focusDistance.push(lens != nullptr ? lens->focusDistance : std::nullopt);
+        columns.lens.tStop.push(lens != nullptr ? lens->tStop : std::nullopt);
+
+        const auto* encoders = lens != nullptr && lens->encoders.has_value() ? &lens->encoders.value() : nullptr;
+        columns.lens.encoders.focus.push(encoders != nullptr ? encoders->focus : std::nullopt);
+        columns.lens.encoders.iris.push(encoders != nullptr ? encoders->iris : std::nullopt);
+        columns.lens.encoders.zoom.push(encoders != nullptr ? encoders->zoom : std::nullopt);
+
+        const auto* raw = lens != nullptr && lens->rawEncoders.has_value() ? &lens->rawEncoders.value() : nullptr;
+        columns.lens.rawEncoders.focus.push(raw != nullptr ? raw->focus : std::nullopt);
+        columns.lens.rawEncoders.iris.push(raw != nullptr ? raw->iris : std::nullopt);
+        columns.lens.rawEncoders.zoom.push(raw != nullptr ? raw->zoom : std::nullopt);
+
+        const auto* tracker = sample.tracker.has_value() ? &sample.tracker.value() : nullptr;
+        present |= tracker != nullptr ? TRACKER : 0;
+        columns.tracker.notes.push(tracker != nullptr ? intern(tracker->notes) : std::nullopt);
+        columns.tracker.recording.push(tracker != nullptr ? tracker->recording : std::nullopt);
+        columns.tracker.slate.push(tracker != nullptr ? intern(tracker->slate) : std::nullopt);
+        columns.tracker.status.push(tracker != nullptr ? intern(tracker->status) : std::nullopt);
+
+        auto& transforms = columns.transforms;
+        if (sample.transforms.has_value())
+        {
+            present |= TRANSFORMS;
+            const auto& list = sample.transforms->transforms;
+            transforms.rows.push(TransformRange{static_cast<uint32_t>(transforms.translation.size()),
+                                                static_cast<uint32_t>(list.size())});
+            for (const auto& transform : list)
+            {
+                transforms.translation.push_back(transform.translation);
+                transforms.rotation.push_back(transform.rotation);
+                transforms.scale.push(transform.scale);
+                transforms.transformId.push(intern(transform.transformId));
+                transforms.parentTransformId.push(intern(transform.parentTransformId));
+            }
+        }
+        else
+        {
+            transforms.rows.push(std::nullopt);
+        }
+
+        m_present.push_back(present);
+        m_residualIds.push_back(storeResidual(sample));
+    }
+
+    bool TakeStore::row(std::size_t index, OpenTrackIOSample& out) const
+    {
+        if (index >= size())
+        {
+            return false;
+        }
+
+        // The residual fills in everything that isn't a column and clears the rest, its parse is then discarded
+        // since residuals on their own lack fields the schema requires.
+        const uint32_t residual = m_residualIds[index];
+        const std::span<const uint8_t> cbor = residual == NO_RESIDUAL
+                                              ? std::span<const uint8_t>{EMPTY_SAMPLE}
+                                              : std::span<const uint8_t>{m_residuals}.subspan(
+                                                      m_residualOffsets[residual],
+                                                      m_residualOffsets[residual + 1] - m_residualOffsets[residual]);
+        out.reset();
+        out.initialise(cbor);
+        out.reset();
+
+        const auto& columns = m_columns;
+        const uint8_t present = m_present[index];
+
+        assignId(out.sampleId, columns.sampleId.get(index));
+        assignId(out.sourceId, columns.sourceId.get(index));
+        if (const auto number = columns.sourceNumber.get(index))
+        {
+            engage(out.sourceNumber).value = number.value();
+        }
+        else
+        {
+            out.sourceNumber = std::nullopt;
+        }
+
+        if ((present & TIMING) != 0)
+        {
+            auto& timing = engage(out.timing);
+            timing.sampleTimestamp = columns.timing.sampleTimestamp.get(index);
+            timing.recordedTimestamp = columns.timing.recordedTimestamp.get(index);
+            timing.sequenceNumber = columns.timing.sequenceNumber.get(index);
+            timing.timecode = columns.timing.timecode.get(index);
+        }
+        else
+        {
+            out.timing = std::nullopt;
+        }
+
+        if ((present & LENS) != 0)
+        {
+            auto& lens = engage(out.lens);
+            lens.entrancePupilOffset = columns.lens.entrancePupilOffset.get(index);
+            lens.fStop = columns.lens.fStop.get(index);
+            lens.focalLength = columns.lens.focalLength.get(index);
+            lens.focusDistance = columns.lens.focusDistance.get(index);
+            lens.tStop = columns.lens.tStop.get(index);
+
+            lens.encoders = std::nullopt;
+            if (columns.lens.encoders.focus.valid(index))
+            {
+                lens.encoders = opentrackioproperties::Lens::Encoders{columns.lens.encoders.focus.get(index),
+                                                                      columns.lens.encoders.iris.get(index),
+                                                                      columns.lens.encoders.zoom.get(index)};
+            }
+
+            lens.rawEncoders = std::nullopt;
+            if (columns.lens.rawEncoders.focus.valid(index))
+            {
+                lens.rawEncoders = opentrackioproperties::Lens::RawEncoders{columns.lens.rawEncoders.focus.get(index),
+                                                                            columns.lens.rawEncoders.iris.get(index),
+                                                                            columns.lens.rawEncoders.zoom.get(index)};
+            }
+        }
+        else
+        {
+            out.lens = std::nullopt;
+        }
+
+        if ((present & TRACKER) != 0)
+        {
+            auto& tracker = engage(out.tracker);
+            tracker.notes = lookup(columns.tracker.notes, index);
+            tracker.recording = columns.tracker.recording.get(index);
+            tracker.slate = lookup(columns.tracker.slate, index);
+            tracker.status = lookup(columns.tracker.status, index);
+        }
+        else
+        {
+            out.tracker = std::nullopt;
+        }
+
+        const auto range = columns.transforms.rows.get(index);
+        if ((present & TRANSFORMS) != 0 && range.has_value())
+        {
+            // Overwritten in place so the transforms keep their strings, as the parsers do.
+            auto& list = engage(out.transforms).transforms;
+            list.resize(range->count);
+            for (uint32_t i = 0; i < range->count; ++i)
+            {
+                const std::size_t entry = range->first + i;
+                auto& transform = list[i];
+                transform.translation = columns.transforms.translation[entry];
+                transform.rotation = columns.transforms.rotation[entry];
+                transform.scale = columns.transforms.scale.get(entry);
+                transform.transformId = lookup(columns.transforms.transformId, entry);
+                transform.parentTransformId = lookup(columns.transforms.parentTransformId, entry);
+            }
+        }
+        else
+        {
+            out.transforms = std::nullopt;
+        }
+        return true;
+    }
+
+    void TakeStore::reserve(std::size_t rows)
+    {
+        auto& columns = m_columns;
+        columns.sampleId.reserve(rows);
+        columns.sourceId.reserve(rows);
+        columns.sourceNumber.reserve(rows);
+        columns.timing.sampleTimestamp.reserve(rows);
+        columns.timing.recordedTimestamp.reserve(rows);
+        columns.timing.sequenceNumber.reserve(rows);
+        columns.timing.timecode.reserve(rows);
+        columns.lens.entrancePupilOffset.reserve(rows);
+        columns.lens.fStop.reserve(rows);
+        columns.lens.focalLength.reserve(rows);
+        columns.lens.focusDistance.reserve(rows);
+        columns.lens.tStop.reserve(rows);
+        columns.lens.encoders.focus.reserve(rows);
+        columns.lens.encoders.iris.reserve(rows);
+        columns.lens.encoders.zoom.reserve(rows);
+        columns.lens.rawEncoders.focus.reserve(rows);
+        columns.lens.rawEncoders.iris.reserve(rows);
+        columns.lens.rawEncoders.zoom.reserve(rows);
+        columns.tracker.notes.reserve(rows);
+        columns.tracker.recording.reserve(rows);
+        columns.tracker.slate.reserve(rows);
+        columns.tracker.status.reserve(rows);
+        columns.transforms.rows.reserve(rows);
+        m_present.reserve(rows);
+        m_residualIds.reserve(rows);
+    }
+
+    void TakeStore::clear()
+    {
+        m_columns = TakeColumns{};
+        m_present.clear();
+        m_strings.clear();
+        m_stringIds.clear();
+        m_residualIds.clear();
+        m_residuals.clear();
+        m_residualOffsets.assign(1, 0);
+        m_residualIndex.clear();
+    }
+
+    std::optional<uint32_t> TakeStore::intern(const std::optional<String>& text)
+    {
+        if (!text.has_value())
+        {
+            return std::nullopt;
+        }
+
+        const std::string_view view{text.value()};
+        if (const auto it = m_stringIds.find(view); it != m_stringIds.end())
+        {
+            return it->second;
+        }
+
+        const auto id = static_cast<uint32_t>(m_strings.size());
+        m_strings.emplace_back(view);
+        m_stringIds.emplace(m_strings.back(), id);
+        return id;
+    }
+
+    std::optional<String> TakeStore::lookup(const TakeColumn<uint32_t>& column, std::size_t row) const
+    {
+        const auto id = column.get(row);
+        return id.has_value() ? std::optional<String>{String{m_strings[id.value()]}} : std::nullopt;
+    }
+
+    uint32_t TakeStore::storeResidual(const OpenTrackIOSample& sample)
+    {
+        // Copy assigning into the same scratch sample every time reuses its strings and vectors.
+        copyResidualProperties(sample, m_scratch);
+        auto& residual = m_scratch;
+
+        if (m_scratchBytes.empty())
+        {
+            m_scratchBytes.resize(1024);
+        }
+        std::optional<std::size_t> written = residual.serializeCbor(m_scratchBytes);
+        while (!written.has_value())
+        {
+            m_scratchBytes.resize(m_scratchBytes.size() * 2);
+            written = residual.serializeCbor(m_scratchBytes);
+        }
+
+        const std::span<const uint8_t> bytes{m_scratchBytes.data(), written.value()};
+        if (std::ranges::equal(bytes, EMPTY_SAMPLE))
+        {
+            return NO_RESIDUAL;
+        }
+
+        const std::string_view key{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+        const std::size_t hash = std::hash<std::string_view>{}(key);
+        const auto [begin, end] = m_residualIndex.equal_range(hash);
+        for (auto it = begin; it != end; ++it)
+        {
+            const uint32_t offset = m_residualOffsets[it->second];
+            const uint32_t length = m_residualOffsets[it->second + 1] - offset;
+            if (std::ranges::equal(bytes, std::span<const uint8_t>{m_residuals}.subspan(offset, length)))
+            {
+                return it->second;
+            }
+        }
+
+        const auto id = static_cast<uint32_t>(residualCount());
+        m_residuals.insert(m_residuals.end(), bytes.begin(), bytes.end());
+        m_residualOffsets.push_back(static_cast<uint32_t>(m_residuals.size()));
+        m_residualIndex.emplace(hash, id);
+        return id;
+    }
+} // namespace opentrackio
@@ -0,0 +1,675 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "opentrackio-cpp/OpenTrackIOTape.h"
+#include <bit>
+#include <cmath>
+#include <format>
+#include <limits>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace opentrackio
+{
+    namespace
+    {
+        /**
+         * Nesting deeper than this is rejected rather than risking the stack, real samples are around five deep. */
+        constexpr int MAX_CBOR_DEPTH = 512;
+
+        /**
+         * Pull decoder which walks a CBOR byte span once and appends each item to a SampleTape. Definite length
+         * strings are read in place, only indefinite length strings are gathered into the scratch buffer. */
+        class CborReader
+        {
+        public:
+            CborReader(std::span<const uint8_t> input, SampleTape& tape, String& scratch)
+                : m_input{input}, m_tape{tape}, m_scratch{scratch} {};
+
+            void read()
+            {
+                readValue(0);
+                if (m_pos != m_input.size())
+                {
+                    fail(110, "value", std::format("expected end of input; last byte: 0x{:02X}", m_input[m_pos]));
+                }
+            }
+
+        private:
+            [[noreturn]] void fail(int id, std::string_view context, const std::string& detail) const
+            {
+                throw nlohmann::json::parse_error::create(
+                        id, m_pos, std::format("syntax error while parsing CBOR {}: {}", context, detail), nullptr);
+            }
+
+            [[noreturn]] void failInvalidByte(uint8_t byte) const
+            {
+                fail(112, "value", std::format("invalid byte: 0x{:02X}", byte));
+            }
+
+            uint8_t next(std::string_view context)
+            {
+                if (m_pos >= m_input.size())
+                {
+                    fail(110, context, "unexpected end of input");
+                }
+                return m_input[m_pos++];
+            }
+
+            std::span<const uint8_t> take(uint64_t length, std::string_view context)
+            {
+                if (length > m_input.size() - m_pos)
+                {
+                    m_pos = m_input.size();
+                    fail(110, context, "unexpected end of input");
+                }
+                const auto bytes = m_input.subspan(m_pos, static_cast<std::size_t>(length));
+                m_pos += static_cast<std::size_t>(length);
+                return bytes;
+            }
+
+            uint64_t readBigEndian(std::size_t width, std::string_view context)
+            {
+                uint64_t value = 0;
+                for (const uint8_t byte : take(width, context))
+                {
+                    value = (value << 8) | byte;
+                }
+                return value;
+            }
+
+            /**
+             * Reads the argument that follows an initial byte, the caller deals with the indefinite marker. */
+            uint64_t readArgument(uint8_t initial, std::string_view context)
+            {
+                const uint8_t info = initial & 0x1F;
+                if (info < 24)
+                {
+                    return info;
+                }
+                if (info > 27)
+                {
+                    failInvalidByte(initial);
+                }
+                return readBigEndian(std::size_t{1} << (info - 24), context);
+            }
+
+            /**
+             * Reads a text string item, definite strings are returned as a view of the input. */
+            std::string_view readText(uint8_t initial)
+            {
+                if ((initial & 0xE0) != 0x60 || (initial & 0x1F) == 28 || (initial & 0x1F) == 29 ||
+                    (initial & 0x1F) == 30)
+                {
+                    fail(113, "string", std::format("expected length specification (0x60-0x7B) or indefinite "
+                                                    "string type (0x7F); last byte: 0x{:02X}", initial));
+                }
+
+                if (initial == 0x7F)
+                {
+                    m_scratch.clear();
+                    appendTextChunks();
+                    return m_scratch;
+                }
+
+                const auto bytes = take(readArgument(initial, "string"), "string");
+                return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+            }
+
+            void appendTextChunks()
+            {
+                for (uint8_t chunkInitial = next("string"); chunkInitial != 0xFF; chunkInitial = next("string"))
+                {
+                    if (chunkInitial == 0x7F)
+                    {
+                        appendTextChunks();
+                        continue;
+                    }
+                    const std::string_view chunk = readText(chunkInitial);
+                    m_scratch.append(chunk);
+                }
+            }
+
+            void readBinary(uint8_t initial)
+            {
+                if (initial != 0x5F)
+                {
+                    m_tape.addBinary(take(readArgument(initial, "binary"), "binary"));
+                    return;
+                }
+
+                // Indefinite byte strings never appear in samples, gather the chunks through the scratch buffer.
+                m_scratch.clear();
+                for (uint8_t chunkInitial = next("binary"); chunkInitial != 0xFF; chunkInitial = next("binary"))
+                {
+                    if ((chunkInitial & 0xE0) != 0x40 || chunkInitial == 0x5F)
+                    {
+                        fail(113, "binary", std::format("expected length specification (0x40-0x5B) or indefinite "
+                                                        "binary array type (0x5F); last byte: 0x{:02X}", chunkInitial));
+                    }
+                    const auto bytes = take(readArgument(chunkInitial, "binary"), "binary");
+                    m_scratch.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+                }
+                m_tape.addBinary({reinterpret_cast<const uint8_t*>(m_scratch.data()), m_scratch.size()});
+            }
+
+            bool atBreak(std::string_view context)
+            {
+                if (m_pos >= m_input.size())
+                {
+                    fail(110, context, "unexpected end of input");
+                }
+                if (m_input[m_pos] == 0xFF)
+                {
+                    ++m_pos;
+                    return true;
+                }
+                return false;
+            }
+
+            void readMember(int depth)
+            {
+                m_tape.key(readText(next("string")));
+                readValue(depth + 1);
+            }
+
+            void readValue(int depth)
+            {
+                if (depth > MAX_CBOR_DEPTH)
+                {
+                    fail(112, "value", "maximum nesting depth exceeded");
+                }
+
+                const uint8_t initial = next("value");
+                const bool indefinite = (initial & 0x1F) == 31;
+                switch (initial >> 5)
+                {
+                    case 0:
+                        m_tape.addUnsigned(readArgument(initial, "number"));
+                        return;
+                    case 1:
+                        // Same wrapping as nlohmann for arguments that don't fit in an int64.
+                        m_tape.addInteger(int64_t{-1} - static_cast<int64_t>(readArgument(initial, "number")));
+                        return;
+                    case 2:
+                        readBinary(initial);
+                        return;
+                    case 3:
+                        if (const uint8_t info = initial & 0x1F; info > 27 && info < 31)
+                        {
+                            failInvalidByte(initial);
+                        }
+                        m_tape.addString(readText(initial));
+                        return;
+                    case 4:
+                    {
+                        m_tape.beginArray();
+                        if (indefinite)
+                        {
+                            while (!atBreak("value"))
+                            {
+                                readValue(depth + 1);
+                            }
+                        }
+                        else
+                        {
+                            for (uint64_t i = readArgument(initial, "value"); i > 0; --i)
+                            {
+                                readValue(depth + 1);
+                            }
+                        }
+                        m_tape.endContainer();
+                        return;
+                    }
+                    case 5:
+                    {
+                        m_tape.beginObject();
+                        if (indefinite)
+                        {
+                            while (!atBreak("string"))
+                            {
+                                readMember(depth);
+                            }
+                        }
+                        else
+                        {
+                            for (uint64_t i = readArgument(initial, "value"); i > 0; --i)
+                            {
+                                readMember(depth);
+                            }
+                        }
+                        m_tape.endContainer();
+                        return;
+                    }
+                    case 7:
+                        readSimple(initial);
+                        return;
+                    default:
+                        // Tagged items are rejected, as nlohmann does by default.
+                        failInvalidByte(initial);
+                }
+            }
+
+            void readSimple(uint8_t initial)
+            {
+                switch (initial)
+                {
+                    case 0xF4:
+                        m_tape.addBoolean(false);
+                        return;
+                    case 0xF5:
+                        m_tape.addBoolean(true);
+                        return;
+                    case 0xF6:
+                        m_tape.addNull();
+                        return;
+                    case 0xF9:
+                        m_tape.addFloat(decodeHalf(static_cast<uint16_t>(readBigEndian(2, "number"))));
+                        return;
+                    case 0xFA:
+                        m_tape.addFloat(std::bit_cast<float>(static_cast<uint32_t>(readBigEndian(4, "number"))));
+                        return;
+                    case 0xFB:
+                        m_tape.addFloat(std::bit_cast<double>(readBigEndian(8, "number")));
+                        return;
+                    default:
+                        failInvalidByte(initial);
+                }
+            }
+
+            /**
+             * RFC 7049 Appendix D, identical to the decoding nlohmann uses. */
+            static double decodeHalf(uint16_t half)
+            {
+                const int exp = (half >> 10) & 0x1F;
+                const unsigned int mant = half & 0x3FF;
+                double val;
+                switch (exp)
+                {
+                    case 0:
+                        val = std::ldexp(mant, -24);
+                        break;
+                    case 31:
+                        val = mant == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+                        break;
+                    default:
+                        val = std::ldexp(mant + 1024, exp - 25);
+                        break;
+                }
+                return (half & 0x8000) != 0 ? -val : val;
+            }
+
+            std::span<const uint8_t> m_input;
+            SampleTape& m_tape;
+            String& m_scratch;
+            std::size_t m_pos = 0;
+        };
+
+        /**
+         * nlohmann SAX handler which appends each event to a SampleTape. The lexer hands over decoded keys and strings
+         * in its own reused buffer, so they are copied into the tape rather than held onto. */
+        class JsonReader
+        {
+        public:
+            explicit JsonReader(SampleTape& tape) : m_tape{tape} {};
+
+            bool null()
+            {
+                m_tape.addNull();
+                return true;
+            }
+
+            bool boolean(bool val)
+            {
+                m_tape.addBoolean(val);
+                return true;
+            }
+
+            bool number_integer(nlohmann::json::number_integer_t val)
+            {
+                m_tape.addInteger(val);
+                return true;
+            }
+
+            bool number_unsigned(nlohmann::json::number_unsigned_t val)
+            {
+                m_tape.addUnsigned(val);
+                return true;
+            }
+
+            bool number_float(nlohmann::json::number_float_t val, const nlohmann::json::string_t&)
+            {
+                m_tape.addFloat(val);
+                return true;
+            }
+
+            bool string(nlohmann::json::string_t& val)
+            {
+                m_tape.addString(val);
+                return true;
+            }
+
+            bool binary(nlohmann::json::binary_t& val)
+            {
+                m_tape.addBinary(val);
+                return true;
+            }
+
+            bool start_object(std::size_t)
+            {
+                m_tape.beginObject();
+                return true;
+            }
+
+            bool key(nlohmann::json::string_t& val)
+            {
+                m_tape.key(val);
+                return true;
+            }
+
+            bool end_object()
+            {
+                m_tape.endContainer();
+                return true;
+            }
+
+            bool start_array(std::size_t)
+            {
+                m_tape.beginArray();
+                return true;
+            }
+
+            bool end_array()
+            {
+                m_tape.endContainer();
+                return true;
+            }
+
+            /**
+             * Rethrows with the concrete exception type, the same way nlohmann's own DOM builder does. */
+            [[noreturn]] bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex)
+            {
+                switch ((ex.id / 100) % 100)
+                {
+                    case 1:
+                        throw *static_cast<const nlohmann::detail::parse_error*>(&ex);
+                    case 2:
+                        throw *static_cast<const nlohmann::detail::invalid_iterator*>(&ex);
+                    case 3:
+                        throw *static_cast<const nlohmann::detail::type_error*>(&ex);
+                    case 4:
+                        throw *static_cast<const nlohmann::detail::out_of_range*>(&ex);
+                    default:
+                        throw *static_cast<const nlohmann::detail::other_error*>(&ex);
+                }
+            }
+
+        private:
+            SampleTape& m_tape;
+        };
+    } // namespace
+
+    void SampleTape::parseJson(std::string_view json)
+    {
+        clear();
+        JsonReader reader{*this};
+        nlohmann::json::sax_parse(json, &reader);
+    }
+
+    void SampleTape::parseCbor(std::span<const uint8_t> cbor)
+    {
+        clear();
+        CborReader reader{cbor, *this, m_scratch};
+        reader.read();
+    }
+
+    void SampleTape::clear()
+    {
+        m_entries.clear();
+        m_text.clear();
+        m_openContainers.clear();
+        m_pendingKeyOffset = 0;
+        m_pendingKeyLength = 0;
+    }
+
+    TapeNode SampleTape::root() const
+    {
+        if (m_entries.empty())
+        {
+            return {};
+        }
+        return {*this, 0};
+    }
+
+    std::string_view SampleTape::text(uint32_t offset, uint32_t length) const
+    {
+        return {m_text.data() + offset, length};
+    }
+
+    void SampleTape::key(std::string_view key)
+    {
+        m_pendingKeyOffset = storeText(key);
+        m_pendingKeyLength = static_cast<uint32_t>(key.size());
+    }
+
+    void SampleTape::beginObject()
+    {
+        addEntry(Type::OBJECT);
+        m_openContainers.push_back(static_cast<uint32_t>(m_entries.size() - 1));
+    }
+
+    void SampleTape::beginArray()
+    {
+        addEntry(Type::ARRAY);
+        m_openContainers.push_back(static_cast<uint32_t>(m_entries.size() - 1));
+    }
+
+    void SampleTape::endContainer()
+    {
+        m_entries[m_openContainers.back()].next = static_cast<uint32_t>(m_entries.size());
+        m_openContainers.pop_back();
+    }
+
+    void SampleTape::addNull()
+    {
+        addEntry(Type::NULL_VALUE);
+    }
+
+    void SampleTape::addBoolean(bool value)
+    {
+        addEntry(Type::BOOLEAN).boolean = value;
+    }
+
+    void SampleTape::addInteger(int64_t value)
+    {
+        addEntry(Type::NUMBER_INTEGER).numberInteger = value;
+    }
+
+    void SampleTape::addUnsigned(uint64_t value)
+    {
+        addEntry(Type::NUMBER_UNSIGNED).numberUnsigned = value;
+    }
+
+    void SampleTape::addFloat(double value)
+    {
+        addEntry(Type::NUMBER_FLOAT).numberFloat = value;
+    }
+
+    void SampleTape::addString(std::string_view value)
+    {
+        const uint32_t offset = storeText(value);
+        Entry& entry = addEntry(Type::STRING);
+        entry.stringOffset = offset;
+        entry.size = static_cast<uint32_t>(value.size());
+    }
+
+    void SampleTape::addBinary(std::span<const uint8_t> value)
+    {
+        const uint32_t offset = storeText({reinterpret_cast<const char*>(value.data()), value.size()});
+        Entry& entry = addEntry(Type::BINARY);
+        entry.stringOffset = offset;
+        entry.size = static_cast<uint32_t>(value.size());
+    }
+
+    SampleTape::Entry& SampleTape::addEntry(Type type)
+    {
+        if (!m_openContainers.empty())
+        {
+            ++m_entries[m_openContainers.back()].size;
+        }
+
+        Entry& entry = m_entries.emplace_back();
+        entry.type = type;
+        entry.keyOffset = m_pendingKeyOffset;
+        entry.keyLength = m_pendingKeyLength;
+        entry.next = static_cast<uint32_t>(m_entries.size());
+        m_pendingKeyOffset = 0;
+        m_pendingKeyLength = 0;
+        return entry;
+    }
+
+    uint32_t SampleTape::storeText(std::string_view text)
+    {
+        const auto offset = static_cast<uint32_t>(m_text.size());
+        m_text.insert(m_text.end(), text.begin(), text.end());
+        return offset;
+    }
+
+    std::size_t TapeNode::size() const
+    {
+        switch (type())
+        {
+            case SampleTape::Type::NULL_VALUE:
+                return 0;
+            case SampleTape::Type::OBJECT:
+            case SampleTape::Type::ARRAY:
+                return m_entry->size;
+            default:
+                return 1;
+        }
+    }
+
+    std::optional<uint32_t> TapeNode::find(std::string_view key) const
+    {
+        if (!is_object())
+        {
+            return std::nullopt;
+        }
+
+        const auto& entries = m_tape->entries();
+        for (uint32_t i = m_index + 1; i < m_entry->next; i = entries[i].next)
+        {
+            if (m_tape->text(entries[i].keyOffset, entries[i].keyLength) == key)
+            {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool TapeNode::contains(std::string_view key) const
+    {
+        return find(key).has_value();
+    }
+
+    TapeNode TapeNode::operator[](std::string_view key) const
+    {
+        const auto index = find(key);
+        if (!index.has_value())
+        {
+            return {};
+        }
+        return {*m_tape, index.value()};
+    }
+
+    TapeNode::Iterator TapeNode::begin() const
+    {
+        if (!is_object() && !is_array())
+        {
+            return end();
+        }
+        return {m_tape, m_index + 1};
+    }
+
+    TapeNode::Iterator TapeNode::end() const
+    {
+        return {m_tape, m_entry->next};
+    }
+
+    std::string_view TapeNode::key() const
+    {
+        if (m_tape == nullptr)
+        {
+            return {};
+        }
+        return m_tape->text(m_entry->keyOffset, m_entry->keyLength);
+    }
+
+    void nodeBytes(const TapeNode& node, std::string& out)
+    {
+        // Every entry of the subtree, which the tape stores contiguously, with lengths written ahead of the text
+        // they measure so that two subtrees only give the same bytes if they are equal.
+        const auto append = [&out](const void* data, std::size_t size)
+        {
+            out.append(static_cast<const char*>(data), size);
+        };
+
+        out.clear();
+        if (node.tape() == nullptr)
+        {
+            const auto type = SampleTape::Type::NULL_VALUE;
+            append(&type, sizeof(type));
+            return;
+        }
+
+        const auto& tape = *node.tape();
+        const auto* last = tape.entries().data() + node.entry()->next;
+        for (const auto* entry = node.entry(); entry != last; ++entry)
+        {
+            // Keys belong to the parent, so the root's own key is left out.
+            if (entry != node.entry())
+            {
+                const auto key = tape.text(entry->keyOffset, entry->keyLength);
+                append(&entry->keyLength, sizeof(entry->keyLength));
+                append(key.data(), key.size());
+            }
+            
+            append(&entry->type, sizeof(entry->type));
+            switch (entry->type)
+            {
+                case SampleTape::Type::BOOLEAN:
+                    append(&entry->boolean, sizeof(entry->boolean));
+                    break;
+                case SampleTape::Type::NUMBER_INTEGER:
+                case SampleTape::Type::NUMBER_UNSIGNED:
+                case SampleTape::Type::NUMBER_FLOAT:
+                    append(&entry->numberUnsigned, sizeof(entry->numberUnsigned));
+                    break;
+                case SampleTape::Type::STRING:
+                case SampleTape::Type::BINARY:
+                {
+                    const auto text = tape.text(entry->stringOffset, entry->size);
+                    append(&entry->size, sizeof(entry->size));
+                    append(text.data(), text.size());
+                    break;
+                }
+                case SampleTape::Type::OBJECT:
+                case SampleTape::Type::ARRAY:
+                    append(&entry->size, sizeof(entry->size));
+                    break;
+                case SampleTape::Type::NULL_VALUE:
+                    break;
+            }
+        }
+    }
+} // namespace opentrackio
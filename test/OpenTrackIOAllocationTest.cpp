@@ -0,0 +1,186 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <span>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOSample.h"
+
+/**
+ * Every allocation made by the process is counted so that the test can check a reused sample makes none. */
+namespace
+{
+    std::atomic<std::size_t> g_allocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+// Every replaced operator new allocates with malloc or aligned_alloc, both of which free releases, but GCC pairs the
+// inlined free with operator new and warns.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// The default memory resource allocates through the aligned overloads, so the property containers land here.
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void* ptr = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+    using namespace opentrackio;
+
+    constexpr const char* COMPLETE_SAMPLE = R"({
+        "static": {
+            "duration": {"num": 1, "denom": 25},
+            "camera": {
+                "captureFrameRate": {"num": 24000, "denom": 1001},
+                "activeSensorPhysicalDimensions": {"height": 24.0, "width": 36.0},
+                "activeSensorResolution": {"height": 2160, "width": 3840},
+                "make": "SampleMake", "model": "SampleModel", "serialNumber": "1234567890A",
+                "firmwareVersion": "1.0", "label": "A", "anamorphicSqueeze": {"num": 1, "denom": 1},
+                "isoSpeed": 4000, "fdlLink": "urn:uuid:0e0e0e0e-0e0e-0e0e-0e0e-0e0e0e0e0e0e", "shutterAngle": 45.0
+            },
+            "lens": {
+                "distortionOverscanMax": 1.2, "firmwareVersion": "1.0", "make": "SampleMake",
+                "model": "SampleModel", "nominalFocalLength": 14.0, "serialNumber": "1234567890A"
+            },
+            "tracker": {"firmwareVersion": "1.0", "make": "SampleMake", "model": "SampleModel", "serialNumber": "1234567890A"}
+        },
+        "tracker": {"notes": "Example generated sample.", "recording": false, "slate": "A101_A_4", "status": "Optical Good"},
+        "timing": {
+            "mode": "internal",
+            "recordedTimestamp": {"seconds": 1718806000, "nanoseconds": 0},
+            "sampleTimestamp": {"seconds": 1718806554, "nanoseconds": 0, "attoseconds": 0},
+            "sequenceNumber": 0,
+            "synchronization": {
+                "locked": true, "source": "ptp", "frequency": {"num": 24000, "denom": 1001},
+                "offsets": {"translation": 0.0, "rotation": 0.0, "lensEncoders": 0.0},
+                "present": true,
+                "ptp": {"master": "00:11:22:33:44:55", "offset": 0.0, "domain": 1}
+            },
+            "timecode": {
+                "hours": 1, "minutes": 2, "seconds": 3, "frames": 4,
+                "format": {"frameRate": {"num": 24, "denom": 1}, "dropFrame": false, "oddField": true}
+            },
+            "frameRate": {"num": 24000, "denom": 1001}
+        },
+        "lens": {
+            "custom": [1.0, 2.0],
+            "distortion": {"radial": [1.0, 2.0, 3.0], "tangential": [1.0, 2.0]},
+            "distortionOverscan": 1.0,
+            "distortionShift": {"x": 0.0, "y": 0.0},
+            "encoders": {"focus": 0.1, "iris": 0.2, "zoom": 0.3},
+            "entrancePupilOffset": 0.123,
+            "exposureFalloff": {"a1": 1.0, "a2": 2.0, "a3": 3.0},
+            "fStop": 4.0, "focalLength": 24.305, "focusDistance": 10.0,
+            "perspectiveShift": {"x": 0.1, "y": 0.1},
+            "rawEncoders": {"focus": 1000, "iris": 2000, "zoom": 3000},
+            "tStop": 4.1,
+            "undistortion": {"radial": [1.0, 2.0, 3.0], "tangential": [1.0, 2.0]}
+        },
+        "protocol": {"name": "OpenTrackIO", "version": "1.0.0"},
+        "sampleId": "urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a33",
+        "sourceId": "urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a34",
+        "sourceNumber": 1,
+        "relatedSampleIds": ["urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a32", "urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a31"],
+        "globalStage": {"E": 100.0, "N": 200.0, "U": 300.0, "lat0": 100.0, "lon0": 200.0, "h0": 300.0},
+        "transforms": [
+            {"translation": {"x": 1.0, "y": 2.0, "z": 3.0}, "rotation": {"pan": 180.0, "tilt": 90.0, "roll": 45.0}, "transformId": "Stage"},
+            {"translation": {"x": 1.0, "y": 2.0, "z": 3.0}, "rotation": {"pan": 180.0, "tilt": 90.0, "roll": 45.0},
+             "scale": {"x": 1.0, "y": 2.0, "z": 3.0}, "transformId": "Camera", "parentTransformId": "Stage"}
+        ]
+    })";
+
+    constexpr std::size_t WARM_UP = 2;
+    constexpr std::size_t ITERATIONS = 1000;
+} // namespace
+
+/**
+ * Resets and initialises one sample from the same CBOR payload over and over, which must stop allocating once the
+ * sample has grown to fit it. */
+int main()
+{
+    const std::vector<uint8_t> encoded = nlohmann::json::to_cbor(nlohmann::json::parse(COMPLETE_SAMPLE));
+    const std::span<const uint8_t> cbor{encoded};
+    OpenTrackIOSample sample{};
+
+    for (std::size_t i = 0; i < WARM_UP; ++i)
+    {
+        sample.reset();
+        if (!sample.initialise(cbor) || sample.getDiagnostics().errorCount() != 0)
+        {
+            std::fprintf(stderr, "The sample failed to parse\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    const std::size_t before = g_allocations.load();
+    for (std::size_t i = 0; i < ITERATIONS; ++i)
+    {
+        sample.reset();
+        sample.initialise(cbor);
+    }
+    const std::size_t allocations = g_allocations.load() - before;
+
+    if (allocations != 0)
+    {
+        std::fprintf(stderr, "%zu allocations over %zu reinitialisations, expected none\n", allocations, ITERATIONS);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,234 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIODelta.h"
+
+using namespace opentrackio;
+
+namespace
+{
+    constexpr std::string_view BASE_SAMPLE = R"({
+        "static": {
+            "camera": {"make": "SampleMake", "model": "SampleModel", "serialNumber": "1234567890A"},
+            "lens": {"make": "SampleMake", "model": "SampleModel", "nominalFocalLength": 14.0}
+        },
+        "lens": {
+            "encoders": {"focus": 0.1, "iris": 0.2, "zoom": 0.3},
+            "fStop": 4.0, "focalLength": 24.305, "focusDistance": 10.0,
+            "distortion": {"radial": [1.0, 2.0, 3.0], "tangential": [1.0, 2.0]}
+        },
+        "timing": {
+            "mode": "internal",
+            "sampleTimestamp": {"seconds": 1718806554, "nanoseconds": 0, "attoseconds": 0},
+            "sequenceNumber": 0,
+            "frameRate": {"num": 24000, "denom": 1001}
+        },
+        "protocol": {"name": "OpenTrackIO", "version": "1.0.0"},
+        "sourceId": "urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a34",
+        "sourceNumber": 1,
+        "relatedSampleIds": ["urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a31"],
+        "globalStage": {"E": 100.0, "N": 200.0, "U": 300.0, "lat0": 100.0, "lon0": 200.0, "h0": 300.0},
+        "transforms": [
+            {"translation": {"x": 1.0, "y": 2.0, "z": 3.0}, "rotation": {"pan": 180.0, "tilt": 90.0, "roll": 45.0},
+             "transformId": "Stage"},
+            {"translation": {"x": 1.0, "y": 2.0, "z": 3.0}, "rotation": {"pan": 180.0, "tilt": 90.0, "roll": 45.0},
+             "scale": {"x": 1.0, "y": 1.0, "z": 1.0}, "transformId": "Camera", "parentTransformId": "Stage"}
+        ]
+    })";
+
+    constexpr std::size_t FRAMES = 12;
+
+    enum class Wire
+    {
+        NONE,
+        JSON,
+        CBOR
+    };
+
+    int g_failures = 0;
+
+    void check(bool condition, const char* description)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "Failed: %s\n", description);
+            ++g_failures;
+        }
+    }
+
+    std::string sampleId(std::size_t frame)
+    {
+        char id[64];
+        std::snprintf(id, sizeof(id), "urn:uuid:5ca5f233-11b5-4f43-8815-%012zx", frame);
+        return id;
+    }
+
+    /**
+     * The frame'th sample of a stream in which the timing, the focus and the camera transform move every frame and
+     * the rest stays put. */
+    nlohmann::json frameJson(std::size_t frame)
+    {
+        auto json = nlohmann::json::parse(BASE_SAMPLE);
+        json["sampleId"] = sampleId(frame);
+        json["timing"]["sequenceNumber"] = frame;
+        json["timing"]["sampleTimestamp"]["nanoseconds"] = frame * 41'708'333;
+        json["lens"]["encoders"]["focus"] = 0.1 + 0.01 * static_cast<double>(frame);
+        json["transforms"][1]["translation"]["x"] = static_cast<double>(frame);
+        return json;
+    }
+
+    OpenTrackIOSample makeSample(const nlohmann::json& json)
+    {
+        OpenTrackIOSample sample{};
+        sample.initialise(json);
+        return sample;
+    }
+
+    bool sameProperties(const OpenTrackIOSample& a, const OpenTrackIOSample& b)
+    {
+        return a.camera == b.camera && a.duration == b.duration && a.globalStage == b.globalStage &&
+               a.lens == b.lens && a.protocol == b.protocol && a.relatedSampleIds == b.relatedSampleIds &&
+               a.sampleId == b.sampleId && a.sourceId == b.sourceId && a.sourceNumber == b.sourceNumber &&
+               a.timing == b.timing && a.tracker == b.tracker && a.transforms == b.transforms;
+    }
+
+    /**
+     * Sends what the encoder produced through the wire format, as a receiver would get it. */
+    void transmit(DeltaEncoder& encoder, const OpenTrackIOSample& sample, Wire wire, OpenTrackIOSample& received)
+    {
+        if (wire == Wire::NONE)
+        {
+            encoder.encode(sample, received);
+            return;
+        }
+
+        received.reset();
+        if (wire == Wire::JSON)
+        {
+            std::vector<char> buffer(16384);
+            const auto size = encoder.encodeJson(sample, buffer);
+            check(size.has_value(), "a sample encodes as JSON");
+            received.initialise(std::string_view{buffer.data(), size.value_or(0)});
+        }
+        else
+        {
+            std::vector<uint8_t> buffer(16384);
+            const auto size = encoder.encodeCbor(sample, buffer);
+            check(size.has_value(), "a sample encodes as CBOR");
+            received.initialise(std::span<const uint8_t>{buffer.data(), size.value_or(0)});
+        }
+        check(received.getDiagnostics().errorCount() == 0, "an encoded sample parses without errors");
+    }
+
+    void checkStream(DeltaReference reference, Wire wire)
+    {
+        DeltaOptions options{};
+        options.reference = reference;
+        DeltaEncoder encoder{options};
+        DeltaDecoder decoder{};
+        OpenTrackIOSample received{};
+        OpenTrackIOSample decoded{};
+
+        for (std::size_t frame = 0; frame < FRAMES; ++frame)
+        {
+            const auto sample = makeSample(frameJson(frame));
+            transmit(encoder, sample, wire, received);
+
+            const bool delta = decoder.decode(received, decoded);
+            check(delta == (frame != 0), "only the first sample of a stream is a keyframe");
+            check(sameProperties(decoded, sample), "a decoded sample matches the one encoded");
+            if (delta)
+            {
+                check(!received.camera.has_value() && !received.globalStage.has_value(),
+                      "a delta leaves out what didn't change");
+            }
+
+            // The receiver acknowledges every third sample it decodes, starting after the keyframe.
+            if (reference == DeltaReference::ACKNOWLEDGED && frame % 3 == 1)
+            {
+                check(encoder.acknowledge(sample.sampleId->id), "a sample just sent can be acknowledged");
+            }
+        }
+    }
+
+    void checkRemovedField()
+    {
+        DeltaEncoder encoder{};
+        DeltaDecoder decoder{};
+        OpenTrackIOSample received{};
+        OpenTrackIOSample decoded{};
+
+        const auto first = makeSample(frameJson(0));
+        check(encoder.encode(first, received), "the first sample is a keyframe");
+        decoder.decode(received, decoded);
+
+        auto json = frameJson(1);
+        json["lens"].erase("focusDistance");
+        const auto second = makeSample(json);
+        check(encoder.encode(second, received), "a field the sender dropped forces a keyframe");
+        check(!decoder.decode(received, decoded), "a keyframe decodes as one");
+        check(sameProperties(decoded, second) && !decoded.lens->focusDistance.has_value(),
+              "the dropped field stays dropped");
+
+        auto third = makeSample(frameJson(2));
+        third.transforms->transforms.pop_back();
+        check(!encoder.encode(third, received) && received.transforms->transforms.size() == 1,
+              "a changed transform count is sent whole in a delta");
+        check(decoder.decode(received, decoded), "the delta decodes against the keyframe");
+        check(sameProperties(decoded, third), "a removed transform stays removed");
+    }
+
+    /**
+     * A sample that didn't come from an encoder but whose last relatedSampleIds entry names an earlier sample of
+     * the stream can't be told apart from a delta. DeltaDecoder documents that it is taken as one, which loses the
+     * entry. */
+    void checkRelatedSampleIdsAmbiguity()
+    {
+        DeltaDecoder decoder{};
+        OpenTrackIOSample decoded{};
+
+        auto firstJson = frameJson(0);
+        firstJson.erase("relatedSampleIds");
+        decoder.decode(makeSample(firstJson), decoded);
+
+        auto json = frameJson(1);
+        json["relatedSampleIds"] = nlohmann::json::array({sampleId(0)});
+        const auto genuine = makeSample(json);
+        check(decoder.decode(genuine, decoded), "a genuine sample naming an earlier one is taken as a delta");
+        check(!decoded.relatedSampleIds.has_value(), "the related id it named is taken as the reference and lost");
+        check(decoded.timing == genuine.timing && decoded.transforms == genuine.transforms,
+              "the fields it carried are kept");
+    }
+} // namespace
+
+/**
+ * Encodes a stream of samples with each DeltaReference, passes them through JSON and CBOR or straight across, and
+ * decodes them back, every decoded sample must equal the one that was encoded. */
+int main()
+{
+    for (const auto reference : {DeltaReference::PREVIOUS, DeltaReference::KEYFRAME, DeltaReference::ACKNOWLEDGED})
+    {
+        for (const auto wire : {Wire::NONE, Wire::JSON, Wire::CBOR})
+        {
+            checkStream(reference, wire);
+        }
+    }
+    checkRemovedField();
+    checkRelatedSampleIdsAmbiguity();
+    return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
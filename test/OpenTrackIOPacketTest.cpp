@@ -0,0 +1,231 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <span>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOPacket.h"
+
+using namespace opentrackio;
+
+namespace
+{
+    using Datagram = std::vector<uint8_t>;
+
+    int g_failures = 0;
+
+    void check(bool condition, const char* description)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "Failed: %s\n", description);
+            ++g_failures;
+        }
+    }
+
+    std::vector<uint8_t> makePayload(std::size_t size)
+    {
+        std::vector<uint8_t> payload(size);
+        std::mt19937 random{static_cast<uint32_t>(size)};
+        std::generate(payload.begin(), payload.end(), [&random] { return static_cast<uint8_t>(random()); });
+        return payload;
+    }
+
+    std::vector<Datagram> fragment(std::span<const uint8_t> payload, uint16_t sequenceNumber,
+                                   std::size_t maxSegmentSize)
+    {
+        std::vector<Datagram> datagrams{};
+        writePackets(payload, PacketEncoding::CBOR, sequenceNumber, maxSegmentSize,
+                     [&datagrams](std::span<const uint8_t> header, std::span<const uint8_t> segment)
+                     {
+                         auto& datagram = datagrams.emplace_back(header.begin(), header.end());
+                         datagram.insert(datagram.end(), segment.begin(), segment.end());
+                     });
+        return datagrams;
+    }
+
+    PacketStatus parse(const Datagram& datagram)
+    {
+        Packet packet{};
+        return Packet::parse(datagram, packet);
+    }
+
+    PacketStatus add(PacketAssembler& assembler, const Datagram& datagram, PacketPayload& out)
+    {
+        Packet packet{};
+        const auto status = Packet::parse(datagram, packet);
+        return status == PacketStatus::OK ? assembler.add(packet, out) : status;
+    }
+
+    bool samePayload(const PacketPayload& payload, std::span<const uint8_t> expected)
+    {
+        return std::equal(payload.data.begin(), payload.data.end(), expected.begin(), expected.end());
+    }
+
+    void checkRoundTrip()
+    {
+        const auto payload = makePayload(1000);
+        std::vector<uint8_t> buffer(2048);
+
+        for (uint32_t seed = 0; seed < 16; ++seed)
+        {
+            auto datagrams = fragment(payload, static_cast<uint16_t>(seed), 64);
+            std::shuffle(datagrams.begin(), datagrams.end(), std::mt19937{seed});
+
+            PacketAssembler assembler{buffer};
+            PacketPayload out{};
+            bool incomplete = true;
+            for (std::size_t i = 0; i + 1 < datagrams.size(); ++i)
+            {
+                incomplete &= add(assembler, datagrams[i], out) == PacketStatus::INCOMPLETE;
+            }
+            check(incomplete, "a payload is incomplete until its last segment arrives");
+            check(add(assembler, datagrams.back(), out) == PacketStatus::OK, "the last segment completes a payload");
+            check(samePayload(out, payload) && out.sequenceNumber == seed, "shuffled segments reassemble exactly");
+        }
+
+        // A payload that fits in one datagram is handed back without being copied.
+        const auto single = fragment(payload, 7, PacketHeader::MAX_SEGMENT_SIZE);
+        PacketAssembler assembler{buffer};
+        PacketPayload out{};
+        check(single.size() == 1 && add(assembler, single.front(), out) == PacketStatus::OK,
+              "an unsegmented payload completes at once");
+        check(samePayload(out, payload) && out.data.data() == single.front().data() + PacketHeader::SIZE,
+              "an unsegmented payload points into its datagram");
+    }
+
+    void checkMalformed()
+    {
+        const auto payload = makePayload(100);
+        const auto datagram = fragment(payload, 1, PacketHeader::MAX_SEGMENT_SIZE).front();
+        check(parse(datagram) == PacketStatus::OK, "a written datagram parses");
+
+        auto padded = datagram;
+        padded.push_back(0);
+        check(parse(padded) == PacketStatus::OK, "padding after the segment is ignored");
+
+        check(parse({datagram.begin(), datagram.begin() + PacketHeader::SIZE - 1}) == PacketStatus::TOO_SHORT,
+              "a datagram shorter than a header is rejected");
+
+        auto identifier = datagram;
+        identifier[3] = 'K';
+        check(parse(identifier) == PacketStatus::INVALID_IDENTIFIER, "a wrong identifier is rejected");
+
+        auto encoding = datagram;
+        encoding[5] = 0x03;
+        check(parse(encoding) == PacketStatus::UNSUPPORTED_ENCODING, "an unknown encoding is rejected");
+
+        check(parse({datagram.begin(), datagram.end() - 1}) == PacketStatus::INVALID_LENGTH,
+              "a truncated datagram is rejected");
+
+        auto flippedPayload = datagram;
+        flippedPayload[PacketHeader::SIZE + 50] ^= 0x01;
+        check(parse(flippedPayload) == PacketStatus::CHECKSUM_MISMATCH, "a flipped payload bit fails the checksum");
+
+        auto flippedHeader = datagram;
+        flippedHeader[7] ^= 0x10;
+        check(parse(flippedHeader) == PacketStatus::CHECKSUM_MISMATCH, "a flipped header bit fails the checksum");
+
+        auto flippedChecksum = datagram;
+        flippedChecksum[15] ^= 0x01;
+        check(parse(flippedChecksum) == PacketStatus::CHECKSUM_MISMATCH, "a flipped checksum is rejected");
+    }
+
+    void checkAssembly()
+    {
+        const auto payload = makePayload(300);
+        const auto datagrams = fragment(payload, 3, 100);
+        std::vector<uint8_t> buffer(512);
+        PacketPayload out{};
+
+        {
+            // Last segment first, then a repeat of it that must be ignored.
+            PacketAssembler assembler{buffer};
+            check(add(assembler, datagrams[2], out) == PacketStatus::INCOMPLETE, "a last segment can arrive first");
+            check(add(assembler, datagrams[2], out) == PacketStatus::DUPLICATE_SEGMENT, "a repeat is a duplicate");
+            check(add(assembler, datagrams[0], out) == PacketStatus::INCOMPLETE, "a duplicate doesn't abandon");
+            check(add(assembler, datagrams[1], out) == PacketStatus::OK && samePayload(out, payload),
+                  "a payload completes after a duplicate");
+            check(assembler.abandoned() == 0, "nothing was abandoned");
+        }
+
+        {
+            // A segment that overlaps one already received without matching it.
+            const auto overlapping = fragment(payload, 3, 150);
+            PacketAssembler assembler{buffer};
+            check(add(assembler, datagrams[0], out) == PacketStatus::INCOMPLETE, "the first segment is kept");
+            check(add(assembler, overlapping[0], out) == PacketStatus::INCONSISTENT_SEGMENT,
+                  "an overlapping segment is rejected");
+            check(assembler.abandoned() == 1, "an overlapping segment abandons its payload");
+        }
+
+        {
+            // A last segment ending before data already received.
+            const auto shorter = fragment({payload.data(), 150}, 3, 100);
+            PacketAssembler assembler{buffer};
+            check(add(assembler, datagrams[2], out) == PacketStatus::INCOMPLETE, "the last segment is kept");
+            check(add(assembler, shorter[1], out) == PacketStatus::INCONSISTENT_SEGMENT,
+                  "a second last segment with a different end is rejected");
+        }
+
+        {
+            // A payload whose segments stop arriving is abandoned by the next sequence number.
+            const auto next = fragment(payload, 4, 100);
+            PacketAssembler assembler{buffer};
+            check(add(assembler, datagrams[0], out) == PacketStatus::INCOMPLETE, "a partial payload is kept");
+            for (const auto& datagram : next)
+            {
+                add(assembler, datagram, out);
+            }
+            check(assembler.abandoned() == 1 && samePayload(out, payload) && out.sequenceNumber == 4,
+                  "a new sequence number abandons the partial payload and completes its own");
+        }
+
+        {
+            std::vector<uint8_t> small(200);
+            PacketAssembler assembler{small};
+            check(add(assembler, datagrams[0], out) == PacketStatus::INCOMPLETE, "a segment that fits is kept");
+            check(add(assembler, datagrams[2], out) == PacketStatus::BUFFER_TOO_SMALL,
+                  "a segment past the end of the buffer is rejected");
+        }
+
+        {
+            const auto many = makePayload(PacketAssembler::MAX_SEGMENTS + 1);
+            const auto segments = fragment(many, 5, 1);
+            PacketAssembler assembler{buffer};
+            bool incomplete = true;
+            for (std::size_t i = 0; i < PacketAssembler::MAX_SEGMENTS; ++i)
+            {
+                incomplete &= add(assembler, segments[i], out) == PacketStatus::INCOMPLETE;
+            }
+            check(incomplete, "up to MAX_SEGMENTS segments are kept");
+            check(add(assembler, segments.back(), out) == PacketStatus::TOO_MANY_SEGMENTS,
+                  "a segment past MAX_SEGMENTS is rejected");
+            check(assembler.abandoned() == 1, "too many segments abandon the payload");
+        }
+    }
+} // namespace
+
+/**
+ * Writes payloads into datagrams and reads them back through Packet::parse and a PacketAssembler, with the segments
+ * reordered, repeated, damaged or cut short. */
+int main()
+{
+    checkRoundTrip();
+    checkMalformed();
+    checkAssembly();
+    return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include "opentrackio-cpp/OpenTrackIOProfile.h"
+
+using namespace opentrackio;
+
+namespace
+{
+    using TransformsSample = BasicOpenTrackIOSample<opentrackioproperties::Transforms>;
+
+    /**
+     * A transforms only profile is meant to be cheap enough to keep in queue slots and per source state, so its
+     * size is bounded by its transforms vector, its tape and a small diagnostics buffer. */
+    constexpr std::size_t MAX_TRANSFORMS_SAMPLE_SIZE = 1024;
+    static_assert(sizeof(Diagnostics) <= 640, "Diagnostics are no longer a few hundred bytes");
+    static_assert(sizeof(TransformsSample) <= MAX_TRANSFORMS_SAMPLE_SIZE, "A transforms only sample has grown");
+    static_assert(sizeof(TransformsSample) < sizeof(OpenTrackIOSample));
+
+    constexpr std::string_view SAMPLE = R"({
+        "static": {"camera": {"make": "Bloggs", "model": "Cam"}, "lens": {"make": "Bloggs", "model": "Lens"}},
+        "lens": {"focalLength": 24.305, "encoders": {"focus": 0.1}},
+        "timing": {"mode": "internal", "sampleRate": {"num": 24, "denom": 1}},
+        "transforms": [
+            {"translation": {"x": 1.0, "y": 2.0, "z": 3.0}, "rotation": {"pan": 180.0, "tilt": 90.0, "roll": 45.0},
+             "transformId": "Camera"}
+        ]
+    })";
+} // namespace
+
+/**
+ * Parses a sample carrying more than transforms into a transforms only profile, which must fill the transforms and
+ * skip the other properties without reporting them as leftover fields. */
+int main()
+{
+    TransformsSample sample{};
+    ParseOptions options{};
+    options.structuredDiagnostics = true;
+    sample.initialise(SAMPLE, options);
+
+    const auto& diagnostics = sample.getDiagnostics();
+    if (diagnostics.errorCount() != 0 || diagnostics.warningCount() != 0)
+    {
+        std::fprintf(stderr, "%zu errors and %zu warnings, expected none\n", diagnostics.errorCount(),
+                     diagnostics.warningCount());
+        return EXIT_FAILURE;
+    }
+
+    if (!sample.transforms.has_value() || sample.transforms->transforms.size() != 1 ||
+        sample.transforms->transforms[0].translation.y != 2.0)
+    {
+        std::fprintf(stderr, "The transforms weren't parsed\n");
+        return EXIT_FAILURE;
+    }
+
+    if (sample.lens.has_value() || sample.timing.has_value() || sample.camera.has_value())
+    {
+        std::fprintf(stderr, "An excluded property has a value\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,183 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "opentrackio-cpp/OpenTrackIOQueue.h"
+
+using namespace opentrackio;
+
+namespace
+{
+    /**
+     * Which producer a value came from and its position in that producer's sequence, so the consumer can tell a
+     * lost, repeated or reordered value apart. */
+    struct Item
+    {
+        uint32_t producer = 0;
+        uint64_t value = 0;
+    };
+
+    constexpr std::size_t CAPACITY = 64;
+    constexpr uint64_t VALUES = 200'000;
+    constexpr uint32_t PRODUCERS = 4;
+
+    /**
+     * Values the MPSC producers claim a slot for and then reject, which the consumer must never see. */
+    constexpr bool rejected(uint64_t value)
+    {
+        return value % 7 == 3;
+    }
+
+    int g_failures = 0;
+
+    void check(bool condition, const char* description)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "Failed: %s\n", description);
+            ++g_failures;
+        }
+    }
+
+    void checkSpsc()
+    {
+        SpscQueue<Item> queue{CAPACITY};
+        check(!queue.push([](Item&) { return false; }), "a rejected value isn't pushed");
+        check(queue.front() == nullptr, "a rejected value isn't committed");
+
+        std::thread producer{[&queue]
+        {
+            for (uint64_t value = 0; value < VALUES; ++value)
+            {
+                while (!queue.push([value](Item& item)
+                {
+                    item.value = value;
+                    return true;
+                }))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }};
+
+        uint64_t expected = 0;
+        bool ordered = true;
+        while (expected < VALUES)
+        {
+            const Item* item = queue.front();
+            if (item == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            ordered &= item->value == expected;
+            ++expected;
+            queue.pop();
+        }
+        producer.join();
+
+        check(ordered, "SPSC values arrive once each and in order");
+        check(queue.front() == nullptr, "nothing is left in the SPSC queue");
+    }
+
+    void checkMpsc()
+    {
+        MpscQueue<Item> queue{CAPACITY};
+        std::atomic<uint32_t> finished = 0;
+        std::vector<std::thread> producers{};
+
+        for (uint32_t producer = 0; producer < PRODUCERS; ++producer)
+        {
+            producers.emplace_back([&queue, &finished, producer]
+            {
+                for (uint64_t value = 0; value < VALUES; ++value)
+                {
+                    // push returns false both when the queue is full and when fill rejects, only a full queue is
+                    // retried.
+                    bool filled = false;
+                    while (!queue.push([&filled, producer, value](Item& item)
+                    {
+                        filled = true;
+                        item = Item{producer, value};
+                        return !rejected(value);
+                    }) && !filled)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                finished.fetch_add(1, std::memory_order_release);
+            });
+        }
+
+        // The value each producer is expected to deliver next, rejected values are never two in a row.
+        std::vector<uint64_t> next(PRODUCERS, 0);
+        const auto skipRejected = [](uint64_t value)
+        {
+            return rejected(value) ? value + 1 : value;
+        };
+
+        bool valid = true;
+        uint64_t received = 0;
+        while (true)
+        {
+            const Item* item = queue.front();
+            if (item == nullptr)
+            {
+                if (finished.load(std::memory_order_acquire) == PRODUCERS && queue.front() == nullptr)
+                {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            if (item->producer >= PRODUCERS || item->value != next[item->producer])
+            {
+                valid = false;
+            }
+            else
+            {
+                next[item->producer] = skipRejected(item->value + 1);
+            }
+            ++received;
+            queue.pop();
+        }
+
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+
+        uint64_t accepted = 0;
+        for (uint64_t value = 0; value < VALUES; ++value)
+        {
+            accepted += !rejected(value);
+        }
+        check(valid, "MPSC values arrive in order per producer and rejected ones are skipped");
+        check(received == accepted * PRODUCERS, "every kept MPSC value arrives exactly once");
+    }
+} // namespace
+
+/**
+ * Runs a producer against a consumer on SpscQueue and several producers against one consumer on MpscQueue, with
+ * queues small enough to fill up, and checks every value that was committed arrives once and in order. */
+int main()
+{
+    checkSpsc();
+    checkMpsc();
+    return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
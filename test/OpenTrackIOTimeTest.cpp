@@ -0,0 +1,111 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include "opentrackio-cpp/OpenTrackIOTime.h"
+
+using namespace opentrackio;
+using opentrackiotypes::Rational;
+using opentrackiotypes::TimeOffset;
+using opentrackiotypes::Timecode;
+using opentrackiotypes::Timestamp;
+
+namespace
+{
+    constexpr Rational NTSC{30000, 1001};
+    constexpr Timecode::Format NTSC_DROP_FRAME{NTSC, true};
+    constexpr Timecode::Format PAL{{25, 1}, false};
+
+    int g_failures = 0;
+
+    void check(bool condition, const char* description)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "Failed: %s\n", description);
+            ++g_failures;
+        }
+    }
+
+    void checkFrameIndexing()
+    {
+        check(toFrameCount({0, 10, 0, 0, NTSC_DROP_FRAME}) == 17982, "00:10:00;00 is frame 17982");
+        check(toTimecode(1800, NTSC_DROP_FRAME) == Timecode(0, 1, 0, 2, NTSC_DROP_FRAME), "frame 1800 is 00:01:00;02");
+        check(frameAt(frameStart(107892, NTSC).value(), NTSC) == 107892, "a frame starts inside itself");
+
+        // Half of a 25 fps frame is exactly 20ms, anything short of it rounds down and from it rounds up.
+        check(nearestFrameAt({0, 19'999'999, 999'999'999}, {25, 1}) == 0, "just before halfway rounds down");
+        check(nearestFrameAt({0, 20'000'000, 0}, {25, 1}) == 1, "halfway rounds up");
+        check(nearestFrameAt({1, 0, 0}, {25, 1}) == 25, "a frame start is its own nearest frame");
+
+        // Half of an odd denominator frame lands on half a second of the scaled time.
+        const auto start = frameStart(1, NTSC).value();
+        check(nearestFrameAt(start - TimeOffset::fromNanoseconds(1), NTSC) == 1, "just before a frame start");
+        check(nearestFrameAt(start + TimeOffset::fromNanoseconds(16'000'000), NTSC) == 1, "under half a frame in");
+        check(nearestFrameAt(start + TimeOffset::fromNanoseconds(17'000'000), NTSC) == 2, "over half a frame in");
+        check(!nearestFrameAt({}, {0, 1}).has_value(), "an invalid rate has no frame");
+    }
+
+    void checkTimecodes()
+    {
+        check(toTimecode(-1, NTSC_DROP_FRAME) == Timecode(23, 59, 59, 29, NTSC_DROP_FRAME),
+              "frame -1 wraps to the last drop frame label of the day");
+        check(toTimecode(-1, PAL) == Timecode(23, 59, 59, 24, PAL), "frame -1 wraps to the last label of the day");
+        check(toTimecode(-framesPerDay(PAL).value() - 25, PAL) == Timecode(23, 59, 59, 0, PAL),
+              "a negative count over a day wraps more than once");
+        const auto day = framesPerDay(NTSC_DROP_FRAME).value();
+        check(toTimecode(day, NTSC_DROP_FRAME) == Timecode(0, 0, 0, 0, NTSC_DROP_FRAME),
+              "a day of frames wraps to midnight");
+
+        // The first two labels of every minute but each tenth are skipped at 30000/1001 drop frame.
+        check(!toFrameCount({0, 1, 0, 0, NTSC_DROP_FRAME}).has_value(), "00:01:00;00 is a dropped label");
+        check(!toFrameCount({0, 1, 0, 1, NTSC_DROP_FRAME}).has_value(), "00:01:00;01 is a dropped label");
+        check(toFrameCount({0, 1, 0, 2, NTSC_DROP_FRAME}) == 1800, "00:01:00;02 follows 00:00:59;29");
+        check(toFrameCount({0, 20, 0, 0, NTSC_DROP_FRAME}) == 35964, "every tenth minute keeps its labels");
+        check(!toFrameCount({0, 0, 0, 25, PAL}).has_value(), "a label past the nominal rate is rejected");
+    }
+
+    void checkOffsets()
+    {
+        check(Timestamp{1, 0, 0} - TimeOffset{2, 0} == Timestamp{}, "subtracting past zero clamps to zero");
+        check(Timestamp{1, 500'000'000, 0} - TimeOffset::fromSeconds(1.5) == Timestamp{},
+              "subtracting down to exactly zero gives zero");
+        check(Timestamp{1, 0, 0} - TimeOffset::fromNanoseconds(1) == Timestamp{0, 999'999'999, 0},
+              "subtracting borrows from the seconds");
+        check(Timestamp{2, 0, 0} - TimeOffset::fromSeconds(0.5) == Timestamp{1, 500'000'000, 0},
+              "subtracting a fraction");
+        check(Timestamp{0, 0, 1} - TimeOffset{0, 2} == Timestamp{}, "subtracting attoseconds past zero clamps");
+
+        check(TimeOffset::fromSeconds(-0.5) == TimeOffset{-1, 500'000'000'000'000'000}, "-0.5s counts up from -1s");
+        check(TimeOffset::fromSeconds(-1.25) == TimeOffset{-2, 750'000'000'000'000'000}, "-1.25s counts up from -2s");
+        check(TimeOffset::fromSeconds(-2.0) == TimeOffset{-2, 0}, "a whole negative second has no fraction");
+        check(TimeOffset::fromSeconds(-0.5).toSeconds() == -0.5, "a negative offset converts back");
+        check(TimeOffset::fromSeconds(std::nan("")) == TimeOffset{}, "not a number gives zero");
+        check(TimeOffset::fromSeconds(-std::numeric_limits<double>::infinity()) == TimeOffset{},
+              "an offset too large gives zero");
+    }
+} // namespace
+
+/**
+ * Checks the frame, timecode and offset arithmetic of OpenTrackIOTime.h at the edges the implementation handles
+ * specially: rounding to the nearest frame, wrapping around midnight, dropped labels and clamping at zero. */
+int main()
+{
+    checkFrameIndexing();
+    checkTimecodes();
+    checkOffsets();
+    return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,127 @@
+/**
+ * Copyright 2024 Mo-Sys Engineering Ltd
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”),
+ * to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include "opentrackio-cpp/OpenTrackIOProperties.h"
+
+using namespace opentrackio;
+using opentrackiotypes::UrnUuid;
+
+namespace
+{
+    constexpr std::string_view CANONICAL = "urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a33";
+
+    int g_failures = 0;
+
+    void check(bool condition, const char* description)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "Failed: %s\n", description);
+            ++g_failures;
+        }
+    }
+
+    bool parses(std::string_view str)
+    {
+        return UrnUuid::parse(str).has_value();
+    }
+
+    void checkParse()
+    {
+        const auto uuid = UrnUuid::parse(CANONICAL);
+        check(uuid.has_value() && uuid->bytes[0] == 0x5c && uuid->bytes[15] == 0x33,
+              "lower case hex parses to its bytes");
+        check(parses("urn:uuid:00000000-0000-0000-0000-000000000000"), "the nil UUID parses");
+        check(UrnUuid::parse("urn:uuid:00000000-0000-0000-0000-000000000000")->isNil(), "the nil UUID is nil");
+
+        // The spec pattern only allows lower case, so upper case is rejected rather than folded.
+        check(!parses("urn:uuid:5CA5F233-11B5-4F43-8815-948D73E48A33"), "upper case hex is rejected");
+        check(!parses("urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48A33"), "a single upper case digit is rejected");
+        check(!parses("urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a3g"), "a digit that isn't hex is rejected");
+
+        check(!parses("5ca5f233-11b5-4f43-8815-948d73e48a33"), "a bare UUID is rejected");
+        check(!parses("URN:UUID:5ca5f233-11b5-4f43-8815-948d73e48a33"), "an upper case prefix is rejected");
+        check(!parses("urn:uid:5ca5f233-11b5-4f43-8815-948d73e48a333"), "a misspelt prefix is rejected");
+        check(!parses(""), "an empty string is rejected");
+
+        check(!parses("urn:uuid:5ca5f23-311b5-4f43-8815-948d73e48a33"), "a dash moved left is rejected");
+        check(!parses("urn:uuid:5ca5f233-11b54-f43-8815-948d73e48a33"), "a dash moved right is rejected");
+        check(!parses("urn:uuid:5ca5f233011b5-4f43-8815-948d73e48a33"), "a missing dash is rejected");
+        check(!parses("urn:uuid:5ca5f23311b54f4388-15-948d73e48a33-"), "dashes at the wrong places are rejected");
+        check(!parses("urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a3"), "a short UUID is rejected");
+        check(!parses("urn:uuid:5ca5f233-11b5-4f43-8815-948d73e48a333"), "a long UUID is rejected");
+    }
+
+    void checkFormat()
+    {
+        check(UrnUuid::parse(CANONICAL)->toString() == CANONICAL, "a parsed UUID formats back to its text");
+        check(UrnUuid{}.toString() == "urn:uuid:00000000-0000-0000-0000-000000000000", "the nil UUID formats");
+
+        std::mt19937 random{42};
+        for (int i = 0; i < 100; ++i)
+        {
+            UrnUuid uuid{};
+            for (auto& byte : uuid.bytes)
+            {
+                byte = static_cast<uint8_t>(random());
+            }
+            const auto text = uuid.toString();
+            check(text.size() == UrnUuid::LENGTH && UrnUuid::parse(text) == uuid, "any UUID round trips");
+        }
+    }
+
+    void checkStrings()
+    {
+        opentrackioproperties::SampleId sampleId{};
+        sampleId.id = CANONICAL;
+        check(sampleId.id == CANONICAL, "an id can be assigned from a string");
+        sampleId.id = std::string{"urn:uuid:00000000-0000-0000-0000-000000000001"};
+        check(sampleId.id.bytes[15] == 1, "an id can be assigned from a std::string");
+
+        const std::string text = UrnUuid{CANONICAL};
+        check(text == CANONICAL, "an id converts back to its string");
+
+        bool threw = false;
+        try
+        {
+            sampleId.id = "urn:uuid:not-a-uuid";
+        }
+        catch (const std::invalid_argument&)
+        {
+            threw = true;
+        }
+        check(threw && sampleId.id.bytes[15] == 1, "assigning a string that isn't a urn:uuid throws and keeps the id");
+
+        std::unordered_set<UrnUuid> set{UrnUuid{CANONICAL}};
+        check(set.contains(UrnUuid::parse(CANONICAL).value()), "equal ids hash equally");
+        check(UrnUuid{CANONICAL} != UrnUuid{}, "different ids compare unequal");
+    }
+} // namespace
+
+/**
+ * Checks that UrnUuid accepts exactly the strings the spec pattern accepts, formats back to the same text and can
+ * still be set from strings. */
+int main()
+{
+    checkParse();
+    checkFormat();
+    checkStrings();
+    return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}